@@ -5,6 +5,7 @@
 #define DRAW_ITEM_BOUNDING_RECT 0
 
 #include "BookmarkItem.hpp"
+#include "FileSystemScene.hpp"
 #include "SessionManager.hpp"
 #include "gui/theme/theme.hpp"
 
@@ -106,4 +107,18 @@ void SceneBookmarkItem::hoverLeaveEvent(QGraphicsSceneHoverEvent *event)
     _name->hide();
 
     QGraphicsRectItem::hoverLeaveEvent(event);
-}
\ No newline at end of file
+}
+QVariant SceneBookmarkItem::itemChange(GraphicsItemChange change, const QVariant& value)
+{
+    auto* fs = qobject_cast<FileSystemScene*>(scene());
+
+    if (fs != nullptr) {
+        if (change == ItemSelectedHasChanged) {
+            fs->noteSelected(this, value.toBool());
+        } else if (change == ItemSceneChange && value.value<QGraphicsScene*>() == nullptr) {
+            fs->noteSelected(this, false);
+        }
+    }
+
+    return QGraphicsRectItem::itemChange(change, value);
+}
@@ -29,6 +29,9 @@ namespace core
 
         [[nodiscard]] int type() const override { return Type; }
 
+    protected:
+        QVariant itemChange(GraphicsItemChange change, const QVariant& value) override;
+
     private:
         QGraphicsSimpleTextItem* _name;
     };
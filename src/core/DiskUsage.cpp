@@ -0,0 +1,812 @@
+/// Copyright (C) 2025 Arlen Avakian
+/// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "DiskUsage.hpp"
+#include "WorkQueue.hpp"
+#include "db/db.hpp"
+#include "db/stmt.hpp"
+#include "paths.hpp"
+
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutex>
+#include <QSqlDatabase>
+#include <QSqlRecord>
+#include <QThread>
+#include <QThreadPool>
+
+#include <algorithm>
+#include <atomic>
+
+#ifdef Q_OS_UNIX
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#endif
+
+
+using namespace core;
+
+namespace
+{
+    /// upper bound on the number of directories being read at the same time.
+    constexpr int MAX_WORKERS = 8;
+
+    /// the rows q selected.
+    QList<DirUsage> readUsages(QSqlQuery& q)
+    {
+        QList<DirUsage> result;
+
+        const auto rec           = q.record();
+        const auto pathIdx       = rec.indexOf(stmt::du::DIR_PATH);
+        const auto mtimeIdx      = rec.indexOf(stmt::du::DIR_MTIME);
+        const auto sizeIdx       = rec.indexOf(stmt::du::DIR_SIZE);
+        const auto entriesIdx    = rec.indexOf(stmt::du::DIR_ENTRIES);
+        const auto ownSizeIdx    = rec.indexOf(stmt::du::DIR_OWN_SIZE);
+        const auto ownEntriesIdx = rec.indexOf(stmt::du::DIR_OWN_ENTRIES);
+        const auto subdirsIdx    = rec.indexOf(stmt::du::DIR_SUBDIRS);
+
+        while (q.next()) {
+            result.push_back(DirUsage
+            {
+                .path       = q.value(pathIdx).toString(),
+                .mtime      = q.value(mtimeIdx).toLongLong(),
+                .size       = q.value(sizeIdx).toLongLong(),
+                .entries    = q.value(entriesIdx).toLongLong(),
+                .ownSize    = q.value(ownSizeIdx).toLongLong(),
+                .ownEntries = q.value(ownEntriesIdx).toLongLong(),
+                .subdirs    = q.value(subdirsIdx).toString().split(QDir::separator(), Qt::SkipEmptyParts)
+            });
+        }
+
+        return result;
+    }
+
+    /// what sorts after everything that starts with prefix, which ends with a
+    /// separator: the same, with the character after the separator.
+    QString rangeEnd(const QString& prefix)
+    {
+        return prefix.chopped(1) + QChar(QDir::separator().unicode() + 1);
+    }
+
+    /// the row of dir, and those of its children.  The children are found
+    /// one at a time, each seek past the subtree of the one before, so that
+    /// the rows further down are not read.
+    QList<DirUsage> readChildren(const QSqlDatabase& db, const QString& dir)
+    {
+        QSqlQuery q(db);
+        q.prepare(stmt::du::SELECT_USAGE);
+        q.addBindValue(dir);
+
+        if (!q.exec()) {
+            qWarning() << q.lastError();
+            return {};
+        }
+
+        auto result = readUsages(q);
+
+        const auto prefix = joinPath(dir, QString());
+        const auto end    = rangeEnd(prefix);
+
+        QSqlQuery from(db);
+        from.prepare(stmt::du::SELECT_FIRST_USAGE_FROM);
+        QSqlQuery after(db);
+        after.prepare(stmt::du::SELECT_FIRST_USAGE_AFTER);
+
+        auto bound = prefix;
+        auto* next = &from;
+
+        forever {
+            next->addBindValue(bound);
+            next->addBindValue(end);
+
+            if (!next->exec()) {
+                qWarning() << next->lastError();
+                break;
+            }
+
+            auto rows = readUsages(*next);
+
+            if (rows.empty()) {
+                break;
+            }
+
+            auto& usage = rows.first();
+
+            if (const auto sep = usage.path.indexOf(QDir::separator(), prefix.size()); sep < 0) {
+                bound = usage.path;
+                next  = &after;
+                result.push_back(std::move(usage));
+            } else {
+                /// below a child without a row of its own.
+                bound = rangeEnd(usage.path.left(sep + 1));
+                next  = &from;
+            }
+        }
+
+        return result;
+    }
+
+    /// the rows of root and of everything below it.
+    QList<DirUsage> readBelow(const QSqlDatabase& db, const QString& root)
+    {
+        const auto prefix = joinPath(root, QString());
+
+        QSqlQuery q(db);
+        q.prepare(stmt::du::SELECT_USAGES_BELOW);
+        q.addBindValue(root);
+        q.addBindValue(prefix);
+        q.addBindValue(rangeEnd(prefix));
+
+        if (!q.exec()) {
+            qWarning() << q.lastError();
+            return {};
+        }
+
+        return readUsages(q);
+    }
+
+    void save(QSqlDatabase db, const QList<DirUsage>& batch, const QStringList& vanished)
+    {
+        db.transaction();
+        QSqlQuery q(db);
+
+        q.prepare(stmt::du::DELETE_USAGE);
+
+        for (const auto& path : vanished) {
+            const auto prefix = joinPath(path, QString());
+
+            q.addBindValue(path);
+            q.addBindValue(prefix);
+            q.addBindValue(rangeEnd(prefix));
+
+            if (!q.exec()) {
+                qWarning() << q.lastError();
+            }
+        }
+
+        q.prepare(stmt::du::INSERT_USAGE);
+
+        for (const auto& usage : batch) {
+            q.addBindValue(usage.path);
+            q.addBindValue(usage.mtime);
+            q.addBindValue(usage.size);
+            q.addBindValue(usage.entries);
+            q.addBindValue(usage.ownSize);
+            q.addBindValue(usage.ownEntries);
+            q.addBindValue(usage.subdirs.join(QDir::separator()));
+
+            if (!q.exec()) {
+                qWarning() << q.lastError();
+            }
+        }
+
+        if (!db.commit()) {
+            qWarning() << db.lastError();
+        }
+    }
+
+    struct Listing
+    {
+        qint64 ownSize{0};
+        qint64 ownEntries{0};
+        QStringList subdirs;
+    };
+
+#ifdef Q_OS_UNIX
+    /// returns the mtime of the directory in nanoseconds, or -1 if path isn't
+    /// a directory.
+    qint64 modificationTime(const QString& path, quint64& device)
+    {
+        struct stat st{};
+
+        if (lstat(QFile::encodeName(path).constData(), &st) != 0 || !S_ISDIR(st.st_mode)) {
+            return -1;
+        }
+        device = st.st_dev;
+
+        return static_cast<qint64>(st.st_mtim.tv_sec) * 1'000'000'000 + st.st_mtim.tv_nsec;
+    }
+
+    /// unlike the lister, hidden entries are counted; they take up space too.
+    Listing readDirectory(const QString& path, quint64 device)
+    {
+        Listing result;
+
+        auto* dir = opendir(QFile::encodeName(path).constData());
+        if (dir == nullptr) {
+            return result;
+        }
+        const auto fd = dirfd(dir);
+
+        while (const auto* ent = readdir(dir)) {
+            const auto* name = ent->d_name;
+
+            if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) {
+                continue;
+            }
+
+            struct stat st{};
+            if (fstatat(fd, name, &st, AT_SYMLINK_NOFOLLOW) != 0) {
+                continue;
+            }
+
+            ++result.ownEntries;
+
+            if (!S_ISDIR(st.st_mode)) {
+                result.ownSize += st.st_size;
+            } else if (st.st_dev == device) {
+                result.subdirs.push_back(QFile::decodeName(name));
+            }
+        }
+
+        closedir(dir);
+
+        return result;
+    }
+#else
+    qint64 modificationTime(const QString& path, quint64& device)
+    {
+        const auto info = QFileInfo(path);
+
+        if (!info.isDir() || info.isSymLink()) {
+            return -1;
+        }
+        device = 0;
+
+        return info.lastModified().toMSecsSinceEpoch() * 1'000'000;
+    }
+
+    Listing readDirectory(const QString& path, quint64 device)
+    {
+        Q_UNUSED(device);
+
+        Listing result;
+
+        auto it = QDirIterator(path, QDir::AllEntries | QDir::NoDotAndDotDot | QDir::System | QDir::Hidden);
+
+        while (it.hasNext()) {
+            const auto info = it.nextFileInfo();
+
+            ++result.ownEntries;
+
+            if (info.isDir() && !info.isSymLink()) {
+                result.subdirs.push_back(info.fileName());
+            } else {
+                result.ownSize += info.size();
+            }
+        }
+
+        return result;
+    }
+#endif
+}
+
+struct DiskUsage::Scan
+{
+    struct Dir
+    {
+        QString path;
+        Dir* parent{nullptr};
+        DirUsage record;
+        bool whole{false};  /// the record holds the totals already
+        std::vector<std::unique_ptr<Dir>> children;
+
+        /// of the subdirectories that are done.
+        std::atomic<qint64> size{0};
+        std::atomic<qint64> entries{0};
+
+        /// the directory itself, and its subdirectories that aren't done.
+        std::atomic<int> remaining{1};
+    };
+
+    Scan(std::shared_ptr<Receiver<DiskUsage>> receiver, quint64 generation, const QString& path,
+            QHash<QString, Known> known)
+        : receiver(std::move(receiver))
+        , generation(generation)
+        , known(std::move(known))
+        , root(std::make_unique<Dir>())
+    {
+        root->path = path;
+    }
+
+    void work();
+    void visit(Dir* dir);
+    void done(Dir* dir);
+    void report(const DirUsage& record);
+    void vanish(const QString& path);
+
+    const std::shared_ptr<Receiver<DiskUsage>> receiver;
+    const quint64 generation;
+    const QHash<QString, Known> known;  /// what is known of the tree below the root
+    const std::unique_ptr<Dir> root;
+    quint64 device{0};  /// of the root; set before any other directory is visited
+
+    WorkQueue<Dir*> queue;
+    std::atomic<qint64> read{0};
+    std::atomic<int> workers{0};
+
+    QMutex resultsMutex;
+    QList<DirUsage> results;
+    QStringList vanished;
+    bool deliveryQueued{false};
+};
+
+void DiskUsage::Scan::work()
+{
+    Dir* dir{nullptr};
+
+    while (queue.pop(dir)) {
+        visit(dir);
+        queue.done();
+    }
+
+    if (--workers == 0) {
+        receiver->post([g = generation](DiskUsage* e) { e->finish(g); });
+    }
+}
+
+void DiskUsage::Scan::visit(Dir* dir)
+{
+    auto dev         = quint64{0};
+    const auto mtime = modificationTime(dir->path, dev);
+
+    if (dir->parent == nullptr) {
+        device = dev;
+    }
+
+    /// gone, or a mount point below the root.
+    if (mtime == -1 || dev != device) {
+        dir->whole = true;
+        done(dir);
+        return;
+    }
+
+    auto& record = dir->record;
+    record.path  = dir->path;
+    record.mtime = mtime;
+
+    const auto found   = known.constFind(dir->path);
+    const auto* cached = found != known.cend() ? &found->usage : nullptr;
+    const auto same    = cached != nullptr && cached->mtime == mtime && !found->stale;
+
+    if (same && found->fresh) {
+        record     = *cached;
+        dir->whole = true;
+        done(dir);
+        return;
+    }
+
+    if (same) {
+        record.ownSize    = cached->ownSize;
+        record.ownEntries = cached->ownEntries;
+        record.subdirs    = cached->subdirs;
+    } else {
+        auto listing = readDirectory(dir->path, device);
+        ++read;
+
+        record.ownSize    = listing.ownSize;
+        record.ownEntries = listing.ownEntries;
+        record.subdirs    = std::move(listing.subdirs);
+
+        if (cached != nullptr && !cached->subdirs.empty()) {
+            const auto current = QSet<QString>(record.subdirs.cbegin(), record.subdirs.cend());
+            for (const auto& name : cached->subdirs) {
+                if (!current.contains(name)) {
+                    vanish(joinPath(dir->path, name));
+                }
+            }
+        }
+    }
+
+    dir->children.reserve(record.subdirs.size());
+    for (const auto& name : std::as_const(record.subdirs)) {
+        auto child    = std::make_unique<Dir>();
+        child->path   = joinPath(dir->path, name);
+        child->parent = dir;
+        dir->children.push_back(std::move(child));
+    }
+
+    /// counted before any of them is pushed, since they can be done before
+    /// this loop is.
+    dir->remaining += static_cast<int>(dir->children.size());
+
+    for (const auto& child : dir->children) {
+        queue.push(child.get());
+    }
+
+    done(dir);
+}
+
+/// a directory is done once it and all of its subdirectories are; its totals
+/// are then added to its parent, which may be done as a result.
+void DiskUsage::Scan::done(Dir* dir)
+{
+    while (dir != nullptr && --dir->remaining == 0) {
+        auto& record = dir->record;
+
+        if (!dir->whole) {
+            record.size    = record.ownSize + dir->size;
+            record.entries = record.ownEntries + dir->entries;
+            report(record);
+        }
+        dir->children.clear();
+
+        if (auto* parent = dir->parent) {
+            parent->size    += record.size;
+            parent->entries += record.entries;
+        }
+        dir = dir->parent;
+    }
+}
+
+/// hands the record over to the GUI thread, in batches.
+void DiskUsage::Scan::report(const DirUsage& record)
+{
+    QMutexLocker locker(&resultsMutex);
+
+    results.push_back(record);
+
+    if (!deliveryQueued) {
+        deliveryQueued = true;
+        receiver->post([g = generation](DiskUsage* e) { e->deliver(g); });
+    }
+}
+
+void DiskUsage::Scan::vanish(const QString& path)
+{
+    QMutexLocker locker(&resultsMutex);
+
+    vanished.push_back(path);
+
+    if (!deliveryQueued) {
+        deliveryQueued = true;
+        receiver->post([g = generation](DiskUsage* e) { e->deliver(g); });
+    }
+}
+
+DiskUsage::DiskUsage(QObject* parent)
+    : QObject(parent)
+{
+    _receiver = std::make_shared<Receiver<DiskUsage>>(this);
+
+    _pool = new QThreadPool();
+    _pool->setMaxThreadCount(qBound(2, QThread::idealThreadCount(), MAX_WORKERS));
+    _pool->setObjectName("surkl-du-pool");
+
+    /// a connection belongs to the thread that opened it; the one worker of
+    /// the database keeps its thread, and its connection, for good.
+    _dbPool = new QThreadPool();
+    _dbPool->setMaxThreadCount(1);
+    _dbPool->setExpiryTimeout(-1);
+    _dbPool->setObjectName("surkl-du-db-pool");
+    _connectionName = QString("surkl-du-%1").arg(quintptr(this), 0, 16);
+}
+
+DiskUsage::~DiskUsage()
+{
+    if (_scan) {
+        _scan->queue.cancel();
+    }
+    _receiver->detach();
+
+    if (_pool->waitForDone(250)) {
+        delete _pool;
+    }
+
+    /// the last results are still written; the database doesn't hang.
+    _dbPool->start([name = _connectionName]
+    {
+        if (QSqlDatabase::contains(name)) {
+            QSqlDatabase::removeDatabase(name);
+        }
+    });
+    delete _dbPool;
+}
+
+/// runs f on the worker of the database, with a connection of its own, made
+/// when it is first needed; false, and f isn't run, if the database isn't
+/// open.  The jobs run one at a time, in the order they were queued.
+template <typename F>
+bool DiskUsage::withDatabase(F f)
+{
+    const auto db = db::get();
+
+    if (!db.isOpen()) {
+        return false;
+    }
+
+    _dbPool->start([source = db.connectionName(), name = _connectionName, f = std::move(f)]
+    {
+        if (!QSqlDatabase::contains(name)) {
+            QSqlDatabase::cloneDatabase(source, name).open();
+        }
+
+        if (const auto db = QSqlDatabase::database(name); db.isOpen()) {
+            f(db);
+        }
+    });
+
+    return true;
+}
+
+void DiskUsage::configure()
+{
+    createTable();
+
+    Q_ASSERT(core::db::doesTableExists(stmt::du::DISK_USAGE_TABLE));
+}
+
+/// queues path to be scanned, unless it was scanned during this session and
+/// hasn't been invalidated since.
+void DiskUsage::request(const QString& path)
+{
+    if (isFresh(path) || _queue.contains(path) || _loading == path || (_scan && _scan->root->path == path)) {
+        return;
+    }
+
+    _queue.push_back(path);
+
+    startNext();
+}
+
+/// something in path has changed; path and its ancestors are scanned again
+/// the next time they are requested.  path is read again even if its mtime
+/// is the same; if it is a file, its directory is.  Directories that aren't
+/// known are read anyway.
+void DiskUsage::invalidate(const QString& path)
+{
+    const auto cleanPath = QDir::cleanPath(path);
+
+    if (auto found = _cache.find(cleanPath); found != _cache.end()) {
+        found->stale = true;
+    } else if (found = _cache.find(QFileInfo(cleanPath).path()); found != _cache.end()) {
+        found->stale = true;
+    }
+
+    for (auto dir = cleanPath;;) {
+        if (auto found = _cache.find(dir); found != _cache.end()) {
+            found->fresh = false;
+        }
+
+        /// the running scan may have read it before the change.
+        if (_scan) {
+            _invalidated.insert(dir);
+        }
+
+        const auto parent = QFileInfo(dir).path();
+        if (parent == dir) {
+            break;
+        }
+        dir = parent;
+    }
+}
+
+/// the totals of path as of the last scan, which may have been in an earlier
+/// session; nullptr if path was never scanned, or its row hasn't been read
+/// yet (see load()).
+const DirUsage* DiskUsage::usage(const QString& path) const
+{
+    const auto found = _cache.constFind(path);
+
+    return found != _cache.cend() ? &found->usage : nullptr;
+}
+
+bool DiskUsage::isRunning() const
+{
+    return _scan != nullptr || !_loading.isEmpty();
+}
+
+void DiskUsage::startNext()
+{
+    while (!_scan && _loading.isEmpty() && !_queue.empty()) {
+        const auto root = _queue.takeFirst();
+
+        if (isFresh(root)) {
+            continue;
+        }
+
+        /// what is known of the tree decides what is read again; the scan
+        /// starts once the rows below root are read.
+        if (loadBelow(root)) {
+            _loading = root;
+            return;
+        }
+
+        const auto workers = _pool->maxThreadCount();
+
+        _invalidated.clear();
+        _scan = std::make_shared<Scan>(_receiver, ++_generation, root, knownBelow(root));
+        _scan->workers = workers;
+        _scan->queue.push(_scan->root.get());
+
+        for (int i = 0; i < workers; ++i) {
+            _pool->start([scan = _scan] { scan->work(); });
+        }
+    }
+}
+
+void DiskUsage::deliver(quint64 generation)
+{
+    if (!_scan || _scan->generation != generation) {
+        return;
+    }
+
+    QList<DirUsage> batch;
+    QStringList vanished;
+    {
+        QMutexLocker locker(&_scan->resultsMutex);
+        batch.swap(_scan->results);
+        vanished.swap(_scan->vanished);
+        _scan->deliveryQueued = false;
+    }
+
+    /// a subtree is a range of the cache.
+    for (const auto& path : std::as_const(vanished)) {
+        const auto prefix = joinPath(path, QString());
+
+        _cache.remove(path);
+
+        for (auto it = _cache.lowerBound(prefix); it != _cache.end() && it.key().startsWith(prefix); ) {
+            it = _cache.erase(it);
+        }
+    }
+
+    /// a stale directory was read by this scan, unless it was invalidated
+    /// again while it ran.
+    for (const auto& usage : std::as_const(batch)) {
+        auto& known = _cache[usage.path];
+        known.usage = usage;
+
+        if (!_invalidated.contains(usage.path)) {
+            known.fresh = true;
+            known.stale = false;
+        }
+    }
+
+    if (!batch.empty() || !vanished.empty()) {
+        withDatabase([batch, vanished](const QSqlDatabase& db) { save(db, batch, vanished); });
+    }
+
+    if (!batch.empty()) {
+        emit scanned(batch);
+    }
+}
+
+void DiskUsage::finish(quint64 generation)
+{
+    if (!_scan || _scan->generation != generation) {
+        return;
+    }
+
+    /// the last records may have been reported after the last delivery.
+    deliver(generation);
+
+    const auto root = _scan->root->path;
+    const auto read = _scan->read.load();
+
+    _scan.reset();
+
+    emit finished(root, read);
+
+    startNext();
+}
+
+/// reads the rows of dir and of its subdirectories, once; called when dir is
+/// listed, so that usage() has them for its nodes.  They are delivered with
+/// loaded().
+void DiskUsage::load(const QString& dir)
+{
+    if (_loaded.contains(dir) || isLoaded(dir)) {
+        return;
+    }
+    _loaded.insert(dir);
+
+    withDatabase([receiver = _receiver, dir](const QSqlDatabase& db)
+    {
+        if (auto rows = readChildren(db, dir); !rows.empty()) {
+            receiver->post([rows = std::move(rows)](DiskUsage* e) { e->onLoaded(rows); });
+        }
+    });
+}
+
+/// whatever was scanned in this session is newer.
+void DiskUsage::onLoaded(const QList<DirUsage>& batch)
+{
+    QList<DirUsage> added;
+    added.reserve(batch.size());
+
+    for (const auto& usage : batch) {
+        if (!_cache.contains(usage.path)) {
+            _cache.insert(usage.path, Known{.usage = usage});
+            added.push_back(usage);
+        }
+    }
+
+    if (!added.empty()) {
+        emit loaded(added);
+    }
+}
+
+/// reads the rows of root and everything below it, once; false if there is
+/// nothing to wait for.  The scan of root starts in onLoadedBelow().
+bool DiskUsage::loadBelow(const QString& root)
+{
+    if (isLoaded(root)) {
+        return false;
+    }
+
+    const auto queued = withDatabase([receiver = _receiver, root](const QSqlDatabase& db)
+    {
+        receiver->post([root, rows = readBelow(db, root)](DiskUsage* e) { e->onLoadedBelow(root, rows); });
+    });
+
+    if (!queued) {
+        onLoadedBelow(root, {});
+    }
+
+    return queued;
+}
+
+void DiskUsage::onLoadedBelow(const QString& root, const QList<DirUsage>& batch)
+{
+    for (const auto& usage : batch) {
+        if (!_cache.contains(usage.path)) {
+            _cache.insert(usage.path, Known{.usage = usage});
+        }
+    }
+
+    _loadedBelow.removeIf([&root](const QString& r) { return isWithin(r, root); });
+    _loadedBelow.push_back(root);
+
+    if (_loading == root) {
+        _loading.clear();
+        _queue.push_front(root);
+        startNext();
+    }
+}
+
+/// whether path is root, or below a root, that loadBelow() read.
+bool DiskUsage::isLoaded(const QString& path) const
+{
+    return std::ranges::any_of(_loadedBelow, [&path](const QString& root) { return isWithin(path, root); });
+}
+
+bool DiskUsage::isFresh(const QString& path) const
+{
+    const auto found = _cache.constFind(path);
+
+    return found != _cache.cend() && found->fresh;
+}
+
+/// what the scan of root needs of the cache: root and the range below it.
+QHash<QString, DiskUsage::Known> DiskUsage::knownBelow(const QString& root) const
+{
+    QHash<QString, Known> result;
+
+    if (const auto found = _cache.constFind(root); found != _cache.cend()) {
+        result.insert(root, *found);
+    }
+
+    const auto prefix = joinPath(root, QString());
+
+    for (auto it = _cache.lowerBound(prefix); it != _cache.cend() && it.key().startsWith(prefix); ++it) {
+        result.insert(it.key(), *it);
+    }
+
+    return result;
+}
+
+void DiskUsage::createTable()
+{
+    if (const auto db = db::get(); db.isOpen()) {
+        QSqlQuery q(db);
+
+        if (!q.exec(stmt::du::CREATE_DISK_USAGE_TABLE)) {
+            qWarning() << "failed to create disk usage table" << q.lastError();
+        }
+    }
+}
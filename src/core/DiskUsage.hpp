@@ -0,0 +1,114 @@
+/// Copyright (C) 2025 Arlen Avakian
+/// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include "Receiver.hpp"
+
+#include <QHash>
+#include <QMap>
+#include <QObject>
+#include <QSet>
+#include <QStringList>
+
+#include <memory>
+
+
+class QThreadPool;
+
+namespace core
+{
+    /// the recursive totals of a directory, and what it holds itself.
+    struct DirUsage
+    {
+        QString path;
+        qint64 mtime{-1};       /// of the directory, in nanoseconds
+        qint64 size{0};         /// apparent size of everything below
+        qint64 entries{0};      /// number of entries below
+        qint64 ownSize{0};      /// of the entries that aren't directories
+        qint64 ownEntries{0};
+        QStringList subdirs;    /// names of the subdirectories on the same device
+    };
+
+    /// Computes the recursive size of directories, like du -sx.
+    ///
+    /// A scan walks the tree on a pool of workers; each directory is
+    /// totalled once all of its subdirectories are, and the totals are
+    /// delivered in batches on the GUI thread.  The results are kept in the
+    /// DiskUsage table, keyed by path and the mtime of the directory.  A
+    /// directory whose mtime hasn't changed since it was stored is not read
+    /// again: its own size and its subdirectories come from the table, and
+    /// only the subdirectories are visited.  Directories scanned during this
+    /// session are taken as they are, unless invalidate()d.  A directory that
+    /// was invalidate()d is read again even if its mtime hasn't changed.
+    ///
+    /// The table isn't read up front: load() reads the rows of a directory
+    /// and its subdirectories when it is listed, and a scan reads the rows
+    /// under its root before it starts, unless they were read already.  The
+    /// table is read and written on a worker of its own, with a connection
+    /// of its own; what load() finds is delivered with loaded().  usage()
+    /// answers from memory only, since it is asked while painting.
+    ///
+    /// Sizes are apparent sizes; hard links are counted every time, symbolic
+    /// links are not followed, and other filesystems are not entered.  The
+    /// mtime of a directory changes only when entries are added, removed or
+    /// renamed, so a file that grows in place is picked up only on the next
+    /// scan after it, or its directory, was invalidated.
+    class DiskUsage final : public QObject
+    {
+        Q_OBJECT
+
+    signals:
+        void scanned(const QList<core::DirUsage>& batch);
+        void loaded(const QList<core::DirUsage>& batch);
+        void finished(const QString& root, qint64 dirsRead);
+
+    public:
+        explicit DiskUsage(QObject* parent = nullptr);
+        ~DiskUsage() override;
+
+        static void configure();
+
+        void request(const QString& path);
+        void invalidate(const QString& path);
+        void load(const QString& dir);
+        [[nodiscard]] const DirUsage* usage(const QString& path) const;
+        [[nodiscard]] bool isRunning() const;
+
+    private:
+        struct Scan;
+        struct Known
+        {
+            DirUsage usage;
+            bool fresh{false};  /// scanned in this session, and not invalidated since
+            bool stale{false};  /// to be read again, whatever its mtime
+        };
+
+        void startNext();
+        void deliver(quint64 generation);
+        void finish(quint64 generation);
+        void onLoaded(const QList<DirUsage>& batch);
+        void onLoadedBelow(const QString& root, const QList<DirUsage>& batch);
+        bool loadBelow(const QString& root);
+        [[nodiscard]] bool isLoaded(const QString& path) const;
+        [[nodiscard]] bool isFresh(const QString& path) const;
+        [[nodiscard]] QHash<QString, Known> knownBelow(const QString& root) const;
+        template <typename F>
+        bool withDatabase(F f);
+        static void createTable();
+
+        QThreadPool* _pool{nullptr};
+        QThreadPool* _dbPool{nullptr};
+        QString _connectionName;  /// of the worker of _dbPool
+        std::shared_ptr<Receiver<DiskUsage>> _receiver;
+        std::shared_ptr<Scan> _scan;
+        quint64 _generation{0};
+        QStringList _queue;
+        QString _loading;            /// the root whose rows are read before it is scanned
+
+        QMap<QString, Known> _cache;  /// ordered, so that a subtree is a range
+        QSet<QString> _invalidated;   /// during the running scan
+        QSet<QString> _loaded;        /// directories whose rows, and their children's, were read
+        QStringList _loadedBelow;     /// roots whose rows were all read
+    };
+}
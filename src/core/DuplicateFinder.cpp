@@ -0,0 +1,630 @@
+/// Copyright (C) 2025 Arlen Avakian
+/// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "DuplicateFinder.hpp"
+#include "WorkQueue.hpp"
+#include "paths.hpp"
+
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QMutex>
+#include <QThread>
+#include <QThreadPool>
+#include <QTimer>
+#include <QtEndian>
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstring>
+#include <vector>
+
+#ifdef Q_OS_UNIX
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#endif
+
+
+using namespace core;
+
+namespace
+{
+    /// upper bound on the number of workers of a pass.
+    constexpr int MAX_WORKERS = 8;
+
+    /// the second pass hashes this much of each end of a file.
+    constexpr qint64 EDGE_SIZE = 4096;
+
+    /// the third pass reads this much of a file at a time.
+    constexpr qint64 READ_SIZE = 1024 * 1024;
+
+    /// XXH64, fed as the data comes.
+    class Hash64
+    {
+    public:
+        explicit Hash64(quint64 seed)
+            : _v{seed + P1 + P2, seed + P2, seed, seed - P1}
+            , _seed(seed)
+        {
+        }
+
+        void update(const char* data, qint64 size)
+        {
+            _total += size;
+
+            /// top up the stripe left over from the last update first.
+            if (_buffered > 0) {
+                const auto n = qMin(STRIPE - _buffered, size);
+                std::memcpy(_buffer + _buffered, data, n);
+                _buffered += n;
+                data      += n;
+                size      -= n;
+
+                if (_buffered < STRIPE) {
+                    return;
+                }
+                stripe(_buffer);
+                _buffered = 0;
+            }
+
+            for (; size >= STRIPE; data += STRIPE, size -= STRIPE) {
+                stripe(data);
+            }
+
+            std::memcpy(_buffer, data, size);
+            _buffered = size;
+        }
+
+        [[nodiscard]] quint64 digest() const
+        {
+            quint64 h;
+
+            if (_total >= STRIPE) {
+                h = std::rotl(_v[0], 1) + std::rotl(_v[1], 7) + std::rotl(_v[2], 12) + std::rotl(_v[3], 18);
+                for (const auto v : _v) {
+                    h ^= round(0, v);
+                    h  = h * P1 + P4;
+                }
+            } else {
+                h = _seed + P5;
+            }
+            h += static_cast<quint64>(_total);
+
+            const auto* p = _buffer;
+            auto n        = _buffered;
+
+            for (; n >= 8; p += 8, n -= 8) {
+                h ^= round(0, qFromLittleEndian<quint64>(p));
+                h  = std::rotl(h, 27) * P1 + P4;
+            }
+            if (n >= 4) {
+                h ^= quint64{qFromLittleEndian<quint32>(p)} * P1;
+                h  = std::rotl(h, 23) * P2 + P3;
+                p += 4;
+                n -= 4;
+            }
+            for (; n > 0; ++p, --n) {
+                h ^= quint64{static_cast<quint8>(*p)} * P5;
+                h  = std::rotl(h, 11) * P1;
+            }
+
+            h ^= h >> 33;
+            h *= P2;
+            h ^= h >> 29;
+            h *= P3;
+            h ^= h >> 32;
+
+            return h;
+        }
+
+    private:
+        static constexpr qint64 STRIPE = 32;
+
+        static constexpr quint64 P1 = 11400714785074694791ULL;
+        static constexpr quint64 P2 = 14029467366897019727ULL;
+        static constexpr quint64 P3 = 1609587929392839161ULL;
+        static constexpr quint64 P4 = 9650029242287828579ULL;
+        static constexpr quint64 P5 = 2870177450012600261ULL;
+
+        static quint64 round(quint64 acc, quint64 input)
+        {
+            return std::rotl(acc + input * P2, 31) * P1;
+        }
+
+        /// the four lanes don't depend on each other, so the CPU works on
+        /// all of them at once.
+        void stripe(const char* p)
+        {
+            _v[0] = round(_v[0], qFromLittleEndian<quint64>(p));
+            _v[1] = round(_v[1], qFromLittleEndian<quint64>(p + 8));
+            _v[2] = round(_v[2], qFromLittleEndian<quint64>(p + 16));
+            _v[3] = round(_v[3], qFromLittleEndian<quint64>(p + 24));
+        }
+
+        quint64 _v[4];
+        quint64 _seed;
+        qint64 _total{0};
+        char _buffer[STRIPE]{};
+        qint64 _buffered{0};
+    };
+}
+
+struct DuplicateFinder::Search : std::enable_shared_from_this<Search>
+{
+    struct File
+    {
+        QString path;
+        qint64 size{0};
+        quint64 device{0};
+        quint64 inode{0};
+        quint64 hash{0};
+        bool failed{false};  /// could not be read
+    };
+    using Group = std::vector<File>;
+
+    Search(std::shared_ptr<Receiver<DuplicateFinder>> receiver, quint64 generation, QThreadPool* pool)
+        : receiver(std::move(receiver))
+        , generation(generation)
+        , pool(pool)
+    {
+    }
+
+    void spread(qsizetype jobs, void (Search::*work)(), void (Search::*then)());
+    void done();
+
+    void walk();
+    void visit(const QString& dir, QHash<qint64, Group>& local);
+    void bucket();
+    void hashEdges();
+    void hashedEdges();
+    void hashWhole();
+    void hashedWhole();
+    void split();
+    void queueGroups(qint64 minSize);
+
+    bool readEdges(File& file);
+    bool readWhole(File& file, QByteArray& buffer);
+
+    const std::shared_ptr<Receiver<DuplicateFinder>> receiver;
+    const quint64 generation;
+    QThreadPool* const pool;
+    quint64 device{0};  /// of the root; set before the walk starts
+
+    /// the first pass.
+    WorkQueue<QString> dirs;
+    QMutex mutex;
+    QHash<qint64, Group> sizes;  /// merged from the walkers as they finish
+
+    /// the other passes; the groups change only between them.
+    std::vector<Group> groups;
+    std::vector<File*> queue;
+    std::atomic<qint64> next{0};
+
+    std::atomic<qint64> files{0};
+    std::atomic<qint64> bytesHashed{0};
+    std::atomic<qint64> bytesTotal{0};
+    std::atomic<int> workers{0};
+    std::atomic<bool> cancelled{false};
+
+    /// written by the last worker, and read once finish() is called.
+    QList<QStringList> results;
+};
+
+/// runs work on up to jobs workers; the last one to finish runs then.
+void DuplicateFinder::Search::spread(qsizetype jobs, void (Search::*work)(), void (Search::*then)())
+{
+    const auto n = qBound<qsizetype>(1, jobs, pool->maxThreadCount());
+
+    next    = 0;
+    workers = static_cast<int>(n);
+
+    for (qsizetype i = 0; i < n; ++i) {
+        pool->start([search = shared_from_this(), work, then]
+        {
+            (search.get()->*work)();
+
+            if (--search->workers == 0) {
+                (search.get()->*then)();
+            }
+        });
+    }
+}
+
+void DuplicateFinder::Search::done()
+{
+    receiver->post([g = generation](DuplicateFinder* e) { e->finish(g); });
+}
+
+void DuplicateFinder::Search::walk()
+{
+    QHash<qint64, Group> local;
+
+    QString dir;
+
+    while (dirs.pop(dir)) {
+        visit(dir, local);
+        dirs.done();
+    }
+
+    QMutexLocker locker(&mutex);
+
+    for (auto it = local.begin(); it != local.end(); ++it) {
+        auto& group = sizes[it.key()];
+        group.insert(group.end(), std::make_move_iterator(it->begin()), std::make_move_iterator(it->end()));
+    }
+}
+
+#ifdef Q_OS_UNIX
+void DuplicateFinder::Search::visit(const QString& path, QHash<qint64, Group>& local)
+{
+    auto* dir = opendir(QFile::encodeName(path).constData());
+    if (dir == nullptr) {
+        return;
+    }
+    const auto fd = dirfd(dir);
+
+    while (const auto* ent = readdir(dir)) {
+        const auto* name = ent->d_name;
+
+        if (name[0] == '.') {
+            continue;
+        }
+
+        struct stat st{};
+        if (fstatat(fd, name, &st, AT_SYMLINK_NOFOLLOW) != 0) {
+            continue;
+        }
+
+        if (S_ISDIR(st.st_mode)) {
+            if (st.st_dev == device) {
+                dirs.push(joinPath(path, QFile::decodeName(name)));
+            }
+        } else if (S_ISREG(st.st_mode) && st.st_size > 0) {
+            local[st.st_size].push_back({
+                .path   = joinPath(path, QFile::decodeName(name)),
+                .size   = st.st_size,
+                .device = static_cast<quint64>(st.st_dev),
+                .inode  = static_cast<quint64>(st.st_ino)});
+            ++files;
+        }
+    }
+
+    closedir(dir);
+}
+#else
+void DuplicateFinder::Search::visit(const QString& path, QHash<qint64, Group>& local)
+{
+    auto it = QDirIterator(path, QDir::Dirs | QDir::Files | QDir::NoDotAndDotDot | QDir::NoSymLinks);
+
+    while (it.hasNext()) {
+        const auto info = it.nextFileInfo();
+
+        if (info.isDir()) {
+            dirs.push(info.filePath());
+        } else if (info.size() > 0) {
+            local[info.size()].push_back({.path = info.filePath(), .size = info.size()});
+            ++files;
+        }
+    }
+}
+#endif
+
+/// after the walk: the files that share their size with another are hashed
+/// at both ends.
+void DuplicateFinder::Search::bucket()
+{
+    if (cancelled) {
+        done();
+        return;
+    }
+
+    for (auto& group : sizes) {
+        if (group.size() < 2) {
+            continue;
+        }
+
+        /// hard links are the same file, not copies of it.
+        std::ranges::sort(group, {}, [](const File& f) { return std::pair(f.device, f.inode); });
+        const auto links = std::ranges::unique(group, [](const File& a, const File& b)
+        {
+            return a.inode != 0 && a.device == b.device && a.inode == b.inode;
+        });
+        group.erase(links.begin(), links.end());
+
+        if (group.size() > 1) {
+            groups.push_back(std::move(group));
+        }
+    }
+    sizes.clear();
+
+    queueGroups(0);
+
+    for (const auto* file : queue) {
+        bytesTotal += qMin(file->size, EDGE_SIZE * 2);
+    }
+
+    spread(std::ssize(queue), &Search::hashEdges, &Search::hashedEdges);
+}
+
+void DuplicateFinder::Search::hashEdges()
+{
+    while (!cancelled) {
+        const auto i = next++;
+        if (i >= std::ssize(queue)) {
+            break;
+        }
+
+        auto* file   = queue[i];
+        file->failed = !readEdges(*file);
+    }
+}
+
+/// the files that are still alike, and larger than their two ends, are
+/// hashed whole.
+void DuplicateFinder::Search::hashedEdges()
+{
+    if (cancelled) {
+        done();
+        return;
+    }
+
+    split();
+    queueGroups(EDGE_SIZE * 2 + 1);
+
+    for (const auto* file : queue) {
+        bytesTotal += file->size;
+    }
+
+    spread(std::ssize(queue), &Search::hashWhole, &Search::hashedWhole);
+}
+
+void DuplicateFinder::Search::hashWhole()
+{
+    auto buffer = QByteArray(READ_SIZE, Qt::Uninitialized);
+
+    while (!cancelled) {
+        const auto i = next++;
+        if (i >= std::ssize(queue)) {
+            break;
+        }
+
+        auto* file   = queue[i];
+        file->failed = !readWhole(*file, buffer);
+    }
+}
+
+void DuplicateFinder::Search::hashedWhole()
+{
+    if (!cancelled) {
+        split();
+
+        std::ranges::sort(groups, std::greater(), [](const Group& g)
+        {
+            return g.front().size * static_cast<qint64>(g.size() - 1);
+        });
+
+        for (const auto& group : groups) {
+            auto paths = QStringList();
+            paths.reserve(std::ssize(group));
+
+            for (const auto& file : group) {
+                paths.push_back(file.path);
+            }
+            paths.sort();
+            results.push_back(paths);
+        }
+    }
+
+    done();
+}
+
+/// splits every group by hash; files that couldn't be read, and files left
+/// on their own, are dropped.
+void DuplicateFinder::Search::split()
+{
+    std::vector<Group> result;
+
+    for (auto& group : groups) {
+        std::erase_if(group, [](const File& f) { return f.failed; });
+        std::ranges::sort(group, {}, &File::hash);
+
+        for (auto first = group.begin(); first != group.end(); ) {
+            const auto last = std::find_if(first, group.end(), [h = first->hash](const File& f)
+            {
+                return f.hash != h;
+            });
+
+            if (last - first > 1) {
+                result.emplace_back(std::make_move_iterator(first), std::make_move_iterator(last));
+            }
+            first = last;
+        }
+    }
+
+    groups = std::move(result);
+}
+
+void DuplicateFinder::Search::queueGroups(qint64 minSize)
+{
+    queue.clear();
+
+    for (auto& group : groups) {
+        if (group.front().size >= minSize) {
+            for (auto& file : group) {
+                queue.push_back(&file);
+            }
+        }
+    }
+}
+
+/// the first and the last EDGE_SIZE bytes, with the size as the seed; a file
+/// that isn't larger than the two is read whole.
+bool DuplicateFinder::Search::readEdges(File& file)
+{
+    auto f = QFile(file.path);
+    if (!f.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    auto h            = Hash64(static_cast<quint64>(file.size));
+    const auto whole  = file.size <= EDGE_SIZE * 2;
+    const auto length = whole ? file.size : EDGE_SIZE;
+
+    const auto head = f.read(length);
+    h.update(head.constData(), head.size());
+    bytesHashed += head.size();
+
+    if (head.size() != length) {
+        return false;
+    }
+
+    if (!whole) {
+        if (!f.seek(file.size - EDGE_SIZE)) {
+            return false;
+        }
+        const auto tail = f.read(EDGE_SIZE);
+        h.update(tail.constData(), tail.size());
+        bytesHashed += tail.size();
+
+        if (tail.size() != EDGE_SIZE) {
+            return false;
+        }
+    }
+
+    file.hash = h.digest();
+
+    return true;
+}
+
+/// read into the worker's buffer, a READ_SIZE at a time, so that cancel() is
+/// heard in between.  Not mapped: a file that shrinks while it is mapped
+/// faults on the pages past its new end; read() just comes up short.
+bool DuplicateFinder::Search::readWhole(File& file, QByteArray& buffer)
+{
+    auto f = QFile(file.path);
+    if (!f.open(QIODevice::ReadOnly | QIODevice::Unbuffered)) {
+        return false;
+    }
+#ifdef Q_OS_UNIX
+    posix_fadvise(f.handle(), 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+    auto h = Hash64(0);
+
+    for (qint64 offset = 0; offset < file.size; ) {
+        if (cancelled) {
+            return false;
+        }
+
+        const auto n = f.read(buffer.data(), qMin(READ_SIZE, file.size - offset));
+
+        /// it has shrunk since the walk.
+        if (n <= 0) {
+            return false;
+        }
+        h.update(buffer.constData(), n);
+
+        offset      += n;
+        bytesHashed += n;
+    }
+
+    file.hash = h.digest();
+
+    return true;
+}
+
+DuplicateFinder::DuplicateFinder(QObject* parent)
+    : QObject(parent)
+{
+    _receiver = std::make_shared<Receiver<DuplicateFinder>>(this);
+
+    _pool = new QThreadPool();
+    _pool->setMaxThreadCount(qBound(2, QThread::idealThreadCount(), MAX_WORKERS));
+    _pool->setObjectName("surkl-duplicates-pool");
+
+    _progressTimer = new QTimer(this);
+    _progressTimer->setInterval(100);
+
+    connect(_progressTimer, &QTimer::timeout, this, [this]
+    {
+        if (_search) {
+            emit progress(_search->files, _search->bytesHashed, _search->bytesTotal);
+        }
+    });
+}
+
+DuplicateFinder::~DuplicateFinder()
+{
+    cancel();
+    _receiver->detach();
+
+    if (_pool->waitForDone(250)) {
+        delete _pool;
+    }
+}
+
+/// starts looking for duplicates under root; a search that is still running
+/// is cancelled first.
+void DuplicateFinder::start(const QString& root)
+{
+    cancel();
+
+    _search = std::make_shared<Search>(_receiver, ++_generation, _pool);
+    _search->dirs.push(root);
+
+#ifdef Q_OS_UNIX
+    if (struct stat st{}; lstat(QFile::encodeName(root).constData(), &st) == 0) {
+        _search->device = st.st_dev;
+    }
+#endif
+
+    _search->spread(_pool->maxThreadCount(), &Search::walk, &Search::bucket);
+
+    _progressTimer->start();
+}
+
+/// the workers stop at the next file or directory; finished(true) follows.
+void DuplicateFinder::cancel()
+{
+    if (_search) {
+        _search->cancelled = true;
+        _search->dirs.cancel();
+    }
+}
+
+bool DuplicateFinder::isRunning() const
+{
+    return _search != nullptr;
+}
+
+quint64 DuplicateFinder::hash(const char* data, qint64 size, quint64 seed)
+{
+    auto h = Hash64(seed);
+    h.update(data, size);
+
+    return h.digest();
+}
+
+void DuplicateFinder::finish(quint64 generation)
+{
+    if (!_search || _search->generation != generation) {
+        return;
+    }
+
+    _progressTimer->stop();
+    emit progress(_search->files, _search->bytesHashed, _search->bytesTotal);
+
+    const auto cancelled = _search->cancelled.load();
+    const auto results   = std::move(_search->results);
+
+    _search.reset();
+
+    if (!cancelled) {
+        emit found(results);
+    }
+    emit finished(cancelled);
+}
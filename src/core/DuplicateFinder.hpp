@@ -0,0 +1,70 @@
+/// Copyright (C) 2025 Arlen Avakian
+/// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include "Receiver.hpp"
+
+#include <QObject>
+#include <QStringList>
+
+#include <memory>
+
+
+class QThreadPool;
+class QTimer;
+
+namespace core
+{
+    /// Finds the files under a directory that have the same contents.
+    ///
+    /// The work is done in three passes, each spread over a pool of workers,
+    /// and each only looking at what the one before couldn't tell apart:
+    ///
+    ///   1. the tree is walked and the files are grouped by size; every
+    ///      walker keeps its own groups, and they are merged at the end;
+    ///   2. the first and the last block of every file in a group are
+    ///      hashed, which tells most files of the same size apart with two
+    ///      small reads;
+    ///   3. the files that are still alike are hashed whole, a window at a
+    ///      time through a memory map.
+    ///
+    /// The hash is XXH64: four independent lanes per 32 bytes, so that it
+    /// keeps up with the disk on a single core.  Files are the same if their
+    /// sizes and 64-bit hashes are.
+    ///
+    /// Hidden entries and empty files are skipped, symbolic links are not
+    /// followed, and hard links to the same file are counted once.  The
+    /// groups are delivered at the end, on the GUI thread, the ones that
+    /// waste the most space first.
+    class DuplicateFinder final : public QObject
+    {
+        Q_OBJECT
+
+    signals:
+        void progress(qint64 files, qint64 bytesHashed, qint64 bytesTotal);
+        void found(const QList<QStringList>& groups);
+        void finished(bool cancelled);
+
+    public:
+        explicit DuplicateFinder(QObject* parent = nullptr);
+        ~DuplicateFinder() override;
+
+        void start(const QString& root);
+        void cancel();
+        [[nodiscard]] bool isRunning() const;
+
+        [[nodiscard]] static quint64 hash(const char* data, qint64 size, quint64 seed = 0);
+
+    private:
+        struct Search;
+
+        void finish(quint64 generation);
+
+        QThreadPool* _pool{nullptr};
+        std::shared_ptr<Receiver<DuplicateFinder>> _receiver;
+        QTimer* _progressTimer{nullptr};
+        std::shared_ptr<Search> _search;
+        quint64 _generation{0};
+    };
+}
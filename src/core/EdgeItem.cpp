@@ -2,8 +2,8 @@
 /// SPDX-License-Identifier: GPL-3.0-or-later
 
 #include "EdgeItem.hpp"
+#include "FileSystemScene.hpp"
 #include "SessionManager.hpp"
-#include "gui/theme/theme.hpp"
 
 #include <QPainter>
 #include <QStyleOptionGraphicsItem>
@@ -23,8 +23,6 @@ namespace
     constexpr qreal EDGE_TEXT_MARGIN_P2        = 4.0;
     constexpr qreal EDGE_COLLAPSED_LEN         = NODE_HALF_CLOSED_DIAMETER;
 
-    QFont nodeFont() { return {"Adwaita Sans", 9}; }
-
     QLineF shrinkLine(const QLineF& line, qreal margin_p1, qreal margin_p2)
     {
         auto a = line;
@@ -86,9 +84,9 @@ void EdgeLabelItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *opt
     Q_UNUSED(option);
     Q_UNUSED(widget);
 
-    const auto* tm = SessionManager::tm();
-    painter->setPen(tm->edgeTextColor());
-    painter->setFont(nodeFont());
+    const auto& rc = SessionManager::rc();
+    painter->setPen(rc.edgeText);
+    painter->setFont(rc.edgeFont);
 
     const auto left = _axis.angle() >= 90 && _axis.angle() <= 270;
 
@@ -241,26 +239,24 @@ void EdgeItem::paint(QPainter *p, const QStyleOptionGraphicsItem * option, QWidg
 {
     Q_UNUSED(widget);
 
-    const auto* tm = SessionManager::tm();
+    const auto& rc = SessionManager::rc();
 
     p->setRenderHint(QPainter::Antialiasing);
     p->setBrush(Qt::NoBrush);
 
     if (_state == CollapsedState) {
-        p->setPen(QPen(tm->edgeColor(), EDGE_WIDTH, Qt::SolidLine, Qt::FlatCap));
+        p->setPen(rc.edge);
         p->drawLine(line());
         return;
     }
 
-    auto pen = QPen(tm->edgeColor(), EDGE_WIDTH, Qt::SolidLine, Qt::FlatCap);
-
     if (option->state & QStyle::State_Selected) {
-        pen.setColor(tm->edgeLightColor());
+        p->setPen(rc.edgeSelected);
     } else if (option->state & QStyle::State_MouseOver) {
-        pen.setColor(tm->edgeMidlightColor());
+        p->setPen(rc.edgeHover);
+    } else {
+        p->setPen(rc.edge);
     }
-
-    p->setPen(pen);
     p->drawLine(line());
 
     const auto p1 = line().p1();
@@ -268,7 +264,7 @@ void EdgeItem::paint(QPainter *p, const QStyleOptionGraphicsItem * option, QWidg
     const auto v2 = QPointF(uv.dx(), uv.dy()) * 5.0;
 
     p->setBrush(Qt::NoBrush);
-    p->setPen(QPen(tm->openNodeLightColor(), EDGE_WIDTH, Qt::SolidLine, Qt::FlatCap));
+    p->setPen(rc.edgeTip);
     p->drawLine(QLineF(p1, p1 + v2));
 }
 
@@ -293,3 +289,18 @@ QPainterPath EdgeItem::shape() const
 
     return ps.createStroke(path);
 }
+
+QVariant EdgeItem::itemChange(GraphicsItemChange change, const QVariant& value)
+{
+    auto* fs = qobject_cast<FileSystemScene*>(scene());
+
+    if (fs != nullptr) {
+        if (change == ItemSelectedHasChanged) {
+            fs->noteSelected(this, value.toBool());
+        } else if (change == ItemSceneChange && value.value<QGraphicsScene*>() == nullptr) {
+            fs->noteSelected(this, false);
+        }
+    }
+
+    return QGraphicsLineItem::itemChange(change, value);
+}
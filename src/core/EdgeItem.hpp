@@ -53,6 +53,9 @@ namespace  core
         [[nodiscard]] QLineF lineWithMargin() const { return _lineWithMargin; }
         [[nodiscard]] int type() const override     { return Type; }
 
+    protected:
+        QVariant itemChange(GraphicsItemChange change, const QVariant& value) override;
+
     private:
         State _state{ActiveState};
         QLineF _lineWithMargin;
@@ -7,26 +7,34 @@
 #include "EdgeItem.hpp"
 #include "GraphicsView.hpp"
 #include "NodeItem.hpp"
+#include "PreviewItem.hpp"
+#include "SearchDialog.hpp"
 #include "SessionManager.hpp"
+#include "SortProxyModel.hpp"
 #include "bookmark.hpp"
+#include "paths.hpp"
 #include "gui/InfoBar.hpp"
 #include "gui/theme/theme.hpp"
 
 #include <QDesktopServices>
 #include <QFileSystemModel>
 #include <QGraphicsSceneMouseEvent>
+#include <QGuiApplication>
 #include <QKeyEvent>
 #include <QMetaEnum>
-#include <QMimeData>
 #include <QPainter>
 #include <QSortFilterProxyModel>
+#include <QTimer>
 #include <QUrl>
 
+#include <algorithm>
 #include <ranges>
 
 
 using namespace core;
 
+static_assert(static_cast<std::size_t>(FileCategoryCount) == gui::theme::FILE_TYPE_COLOR_COUNT);
+
 namespace
 {
     void drawCrosshairs(QPainter* p, const QRectF& rec)
@@ -73,135 +81,16 @@ namespace
     }
 
 
-    void drawBorder(QPainter* p, const QRectF& viewRec, const QRectF& sceneRec)
+    /// rect grown out to the next multiple of the margin on every side, so
+    /// that the scene rect changes, and its index is rebuilt, only once the
+    /// items have moved that far.
+    QRectF snapOut(const QRectF& rect)
     {
-        p->save();
-        p->setPen(Qt::NoPen);
-        constexpr auto borderThickness = 16.0;
-        constexpr auto borderSize      = 128.0;
-        constexpr auto increment       = borderSize*2.0;
-
-        /// viewRec is the rect() of the QGraphicsView widget mapped to the scene; it
-        /// can cover the entire scene rect, in theory.  But it's usually smaller than
-        /// the scene rect.
-        /// sceneRec is the entire scene rect.
-        const auto center   = viewRec.center();
-
-        /// The view rect can actually be larger than the scene rect, and we only
-        /// want to draw a border around where the scene rect ends.
-        /// With current scene size and max zoom range, the view rect will never
-        /// get larger than the scene rect, but in any case, only draw borders
-        /// around the scene rect.
-        const auto l = std::max(viewRec.left(), sceneRec.left());
-        const auto r = std::min(viewRec.right(), sceneRec.right());
-        const auto t = std::max(viewRec.top(), sceneRec.top());
-        const auto b = std::min(viewRec.bottom(), sceneRec.bottom());
-
-        const auto x0 = std::ceil(std::abs(l) / borderSize) * borderSize * (std::signbit(l) ? -1.0 : 1.0);
-        const auto x1 = std::ceil(std::abs(r) / borderSize) * borderSize * (std::signbit(r) ? -1.0 : 1.0);
-        const auto y0 = std::ceil(std::abs(t) / borderSize) * borderSize * (std::signbit(t) ? -1.0 : 1.0);
-        const auto y1 = std::ceil(std::abs(b) / borderSize) * borderSize * (std::signbit(b) ? -1.0 : 1.0);
-
-        const bool x0IsEven = static_cast<int>(std::abs(x0)/borderSize) % 2;
-        const bool y0IsEven = static_cast<int>(std::abs(y0)/borderSize) % 2;
-
-        auto doDrawH = [p](qreal start, qreal end, qreal y, qreal w, qreal h, const QColor& color)
-        {
-            p->setBrush(color);
-            for (qreal x = start; x < end; x += increment) {
-                p->drawRect(QRectF(x, y, w, h));
-            }
-        };
-
-        if (viewRec.contains(QPointF(center.x(), sceneRec.top() + borderThickness))) {
-            doDrawH
-            ( x0
-            , x1
-            , sceneRec.top()
-            , borderSize
-            , borderThickness
-            , x0IsEven ? Qt::black : Qt::white
-            );
-
-            doDrawH
-            ( x0+borderSize
-            , x1
-            , sceneRec.top()
-            , borderSize
-            , borderThickness
-            , x0IsEven ? Qt::white : Qt::black
-            );
-        }
-
-        if (viewRec.contains(QPointF(center.x(), sceneRec.bottom() - borderThickness))) {
-            doDrawH
-            ( x0
-            , x1
-            , sceneRec.bottom()
-            , borderSize
-            , -borderThickness
-            , x0IsEven ? Qt::white : Qt::black
-            );
-
-            doDrawH
-            ( x0+borderSize
-            , x1
-            , sceneRec.bottom()
-            , borderSize
-            , -borderThickness
-            , x0IsEven ? Qt::black : Qt::white
-            );
-        }
-
-        auto doDrawV = [p](qreal start, qreal end, qreal x, qreal w, qreal h, const QColor& color)
-        {
-            p->setBrush(color);
-            for (qreal y = start; y < end; y += increment) {
-                p->drawRect(QRectF(x, y, w, h));
-            }
-        };
-
-        if (viewRec.contains(QPointF(sceneRec.left() + borderThickness, center.y()))) {
-            doDrawV
-            ( y0
-            , y1
-            , sceneRec.left()
-            , borderThickness
-            , borderSize
-            , y0IsEven ? Qt::black : Qt::white
-            );
-
-            doDrawV
-            ( y0+borderSize
-            , y1
-            , sceneRec.left()
-            , borderThickness
-            , borderSize
-            , y0IsEven ? Qt::white : Qt::black
-            );
-        }
-
-        if (viewRec.contains(QPointF(sceneRec.right() - borderThickness, center.y()))) {
-            doDrawV
-            ( y0
-            , y1
-            , sceneRec.right()
-            , -borderThickness
-            , borderSize
-            , y0IsEven ? Qt::white : Qt::black
-            );
-
-            doDrawV
-            ( y0+borderSize
-            , y1
-            , sceneRec.right()
-            , -borderThickness
-            , borderSize
-            , y0IsEven ? Qt::black : Qt::white
-            );
-        }
+        constexpr auto M = FileSystemScene::SCENE_MARGIN;
 
-        p->restore();
+        return QRectF(
+            QPointF(std::floor(rect.left() / M) * M, std::floor(rect.top() / M) * M),
+            QPointF(std::ceil(rect.right() / M) * M, std::ceil(rect.bottom() / M) * M));
     }
 
     auto notNull = [](auto* item) -> bool
@@ -212,13 +101,8 @@ namespace
     {
         return qgraphicsitem_cast<NodeItem*>(item);
     };
-    auto toEdge = [](QGraphicsItem* item) -> EdgeItem*
-    {
-        return qgraphicsitem_cast<EdgeItem*>(item);
-    };
 
     auto filterNodes = std::views::transform(toNode) | std::views::filter(notNull);
-    auto filterEdges = std::views::transform(toEdge) | std::views::filter(notNull);
 
     DeletionDialog* createDeleteDialog(const QGraphicsScene* scene)
     {
@@ -236,27 +120,142 @@ namespace
 FileSystemScene::FileSystemScene(QObject* parent)
     : QGraphicsScene(parent)
 {
-    setSceneRect(QRect(-1024 * 32, -1024 * 32, 1024 * 64, 1024 * 64));
+    /// the scene rect follows the items: it grows as soon as one comes near
+    /// its edge, and shrinks a while after some are removed.  The index is
+    /// rebuilt for the new rect, so its cells cover only what is occupied.
+    setSceneRect(snapOut(QRectF(-SCENE_MARGIN, -SCENE_MARGIN, SCENE_MARGIN * 2, SCENE_MARGIN * 2)));
+
+    _fitTimer = new QTimer(this);
+    _fitTimer->setSingleShot(true);
+    _fitTimer->setInterval(FIT_DELAY);
+    connect(_fitTimer, &QTimer::timeout, this, &FileSystemScene::fitSceneRect);
 
     _model = new QFileSystemModel(this);
     _model->setRootPath(QDir::rootPath());
     _model->setReadOnly(true);
 
-    _proxyModel = new QSortFilterProxyModel(this);
+    _proxyModel = new SortProxyModel(this);
     _proxyModel->setSourceModel(_model);
     _proxyModel->setDynamicSortFilter(true);
     _proxyModel->sort(0);
 
+    /// connected before anything that resolves a handle in these.  Rows that
+    /// come, go or are sorted under a folder move only what is below it.
+    const auto forgetBelow = [this](const QModelIndex& parent) { forgetResolved(parent); };
+    const auto forgetBelowAll = [this](const QList<QPersistentModelIndex>& parents)
+    {
+        if (parents.isEmpty()) {
+            _resolved.clear();
+        }
+        for (const auto& parent : parents) {
+            forgetResolved(parent);
+        }
+    };
+    const auto forgetMoved = [this](const QModelIndex& from, int, int, const QModelIndex& to)
+    {
+        forgetResolved(from);
+        forgetResolved(to);
+    };
+    const auto forgetAll = [this] { _resolved.clear(); };
+    connect(_proxyModel, &QAbstractItemModel::rowsAboutToBeInserted, this, forgetBelow);
+    connect(_proxyModel, &QAbstractItemModel::rowsInserted, this, forgetBelow);
+    connect(_proxyModel, &QAbstractItemModel::rowsAboutToBeRemoved, this, forgetBelow);
+    connect(_proxyModel, &QAbstractItemModel::rowsRemoved, this, forgetBelow);
+    connect(_proxyModel, &QAbstractItemModel::rowsAboutToBeMoved, this, forgetMoved);
+    connect(_proxyModel, &QAbstractItemModel::rowsMoved, this, forgetMoved);
+    connect(_proxyModel, &QAbstractItemModel::layoutAboutToBeChanged, this, forgetBelowAll);
+    connect(_proxyModel, &QAbstractItemModel::layoutChanged, this, forgetBelowAll);
+    connect(_proxyModel, &QAbstractItemModel::modelAboutToBeReset, this, forgetAll);
+    connect(_proxyModel, &QAbstractItemModel::modelReset, this, forgetAll);
+
+    _lister = new ListingScheduler(this);
+    connect(_lister, &ListingScheduler::listed, this, &FileSystemScene::onListed);
+
+    _fetcher = new MetadataFetcher(this);
+    connect(_fetcher, &MetadataFetcher::fetched, this, &FileSystemScene::onMetadataFetched);
+    connect(_fetcher, &MetadataFetcher::reachable, this, &FileSystemScene::onMountReachable);
+
+    _types = new FileTypeClassifier(this);
+    connect(_types, &FileTypeClassifier::classified, this, &FileSystemScene::onFileTypesClassified);
+
+    _git = new GitStatus(this);
+    connect(_git, &GitStatus::updated, this, &FileSystemScene::onGitStatusUpdated);
+
+    _du = new DiskUsage(this);
+    connect(_du, &DiskUsage::scanned, this, &FileSystemScene::onDiskUsageScanned);
+    connect(_du, &DiskUsage::loaded, this, &FileSystemScene::onDiskUsageScanned);
+
+    _transfers = new TransferEngine(this);
+    connect(_transfers, &TransferEngine::progress, this, &FileSystemScene::onTransferProgress);
+    connect(_transfers, &TransferEngine::failed, this, &FileSystemScene::onFileOperationFailed);
+    connect(_transfers, &TransferEngine::finished, this, &FileSystemScene::onTransferFinished);
+
+    _purger = new Purger(this);
+    connect(_purger, &Purger::progress, this, &FileSystemScene::onPurgeProgress);
+    connect(_purger, &Purger::failed, this, &FileSystemScene::onFileOperationFailed);
+    connect(_purger, &Purger::finished, this, &FileSystemScene::onPurgeFinished);
+    _purger->resume();
+
+    _thumbnails = new Thumbnailer(this);
+    connect(_thumbnails, &Thumbnailer::ready, this, &FileSystemScene::onThumbnailsReady);
+    /// repainted, the nodes still on screen ask again.
+    connect(_thumbnails, &Thumbnailer::dropped, this, &FileSystemScene::onThumbnailsReady);
+
+    _previewer = new Previewer(this);
+    connect(_previewer, &Previewer::ready, this, &FileSystemScene::onPreviewReady);
+
+    _relaxer = new LayoutRelaxer(this);
+    connect(_relaxer, &LayoutRelaxer::relaxed, this, &FileSystemScene::onRelaxed);
+
+    _duplicates = new DuplicateFinder(this);
+    connect(_duplicates, &DuplicateFinder::progress, this, &FileSystemScene::onDuplicatesProgress);
+    connect(_duplicates, &DuplicateFinder::found, this, &FileSystemScene::onDuplicatesFound);
+    connect(_duplicates, &DuplicateFinder::finished, this, [](bool cancelled)
+    {
+        if (cancelled) {
+            SessionManager::ib()->postMsgL("duplicates: cancelled", 2000);
+        }
+    });
+
+    connect(_model, &QAbstractItemModel::dataChanged, this, &FileSystemScene::onSourceDataChanged);
+    connect(_model, &QFileSystemModel::directoryLoaded, this, [this](const QString& path) { _populated.insert(path); });
+
     connect(this, &QGraphicsScene::selectionChanged, this, &FileSystemScene::onSelectionChange);
 
+    /// the stats of a selection that changes on every mouse move, by a
+    /// rubber band, are posted at most this often.
+    _statsTimer = new QTimer(this);
+    _statsTimer->setSingleShot(true);
+    _statsTimer->setInterval(100);
+    connect(_statsTimer, &QTimer::timeout, this, &FileSystemScene::postStats);
+
     connect(_proxyModel, &QAbstractItemModel::rowsAboutToBeRemoved, this, &FileSystemScene::onRowsAboutToBeRemoved);
     connect(_proxyModel, &QAbstractItemModel::rowsInserted, this, &FileSystemScene::onRowsInserted);
     connect(_proxyModel, &QAbstractItemModel::rowsRemoved, this, &FileSystemScene::onRowsRemoved);
-
+    connect(_proxyModel, &QAbstractItemModel::layoutChanged, this, [this] { _seekIndices.clear(); });
+    /// entries that are gone from the filesystem, not those the proxy hides.
+    /// The proxy connected first, so the nodes see the removal while their
+    /// handles are still current.
+    connect(_model, &QAbstractItemModel::rowsAboutToBeRemoved, this, &FileSystemScene::onEntriesAboutToBeRemoved);
+
+    /// a key that is held down repeats faster than a rotation is animated;
+    /// the repeats are added up and applied as one rotation.
+    _rotationTimer = new QTimer(this);
+    _rotationTimer->setSingleShot(true);
+    _rotationTimer->setInterval(ROTATION_DELAY);
+    connect(_rotationTimer, &QTimer::timeout, this, &FileSystemScene::rotatePending);
+
+    _seekTimer = new QTimer(this);
+    _seekTimer->setSingleShot(true);
+    _seekTimer->setInterval(150);
+    connect(_seekTimer, &QTimer::timeout, this, &FileSystemScene::seek);
+
+    /// bookmarks saved with a larger scene may lie outside of this one.
     for (const auto& [pos, name] : SessionManager::bm()->sceneBookmarksAsList()) {
         auto* bookmarkItem = new SceneBookmarkItem(QPoint(0, 0), name);
         addItem(bookmarkItem);
         bookmarkItem->setPos(pos);
+        keepInSceneRect(bookmarkItem->sceneBoundingRect().center());
     }
 }
 
@@ -267,20 +266,46 @@ QPersistentModelIndex FileSystemScene::rootIndex() const
     return _proxyModel->mapFromSource(index);
 }
 
-bool FileSystemScene::isDir(const QModelIndex& index) const
+/// returns ClosedNode or FileNode, plus LinkNode for symbolic links.
+/// Entries of directories that went through the lister are classified from
+/// d_type without touching the disk, and the rest from their metadata.  An
+/// entry that is neither is FileNode and PendingNode, unless it is the root
+/// of the model; asking the model would stat it on this thread, which hangs
+/// on a mount that doesn't answer.  Its nodes are reclassified in onListed()
+/// or onMetadataFetched().
+NodeFlags FileSystemScene::classify(const QModelIndex& index) const
 {
     Q_ASSERT(index.isValid());
-    Q_ASSERT(index.model() == _proxyModel);
 
-    return _model->isDir(_proxyModel->mapToSource(index));
+    return classify(_cache.find(filePath(index)));
 }
 
-bool FileSystemScene::isLink(const QModelIndex& index) const
+NodeFlags FileSystemScene::classify(PathId id) const
 {
-    Q_ASSERT(index.isValid());
-    Q_ASSERT(index.model() == _proxyModel);
+    const auto* entry = _cache.entry(id);
 
-    return _model->fileInfo(_proxyModel->mapToSource(index)).isSymbolicLink();
+    if (entry == nullptr || !entry->classified) {
+        return _cache.path(id) == _model->rootPath()
+            ? NodeFlags(NodeType::ClosedNode)
+            : NodeFlags(NodeType::FileNode) | NodeType::PendingNode;
+    }
+
+    auto flags = NodeFlags(entry->isDir ? NodeType::ClosedNode : NodeType::FileNode);
+    if (entry->isLink) {
+        flags |= NodeType::LinkNode;
+    }
+
+    return flags;
+}
+
+bool FileSystemScene::isDir(const QModelIndex& index) const
+{
+    return classify(index).testAnyFlag(NodeType::ClosedNode);
+}
+
+bool FileSystemScene::isLink(const QModelIndex& index) const
+{
+    return classify(index).testAnyFlag(NodeType::LinkNode);
 }
 
 QString FileSystemScene::filePath(const QPersistentModelIndex& index) const
@@ -291,7 +316,123 @@ QString FileSystemScene::filePath(const QPersistentModelIndex& index) const
     return _model->filePath(_proxyModel->mapToSource(index));
 }
 
-QPersistentModelIndex FileSystemScene::index(const QString& path) const
+PathId FileSystemScene::intern(const QModelIndex& index)
+{
+    return _cache.intern(filePath(index));
+}
+
+NodeHandle FileSystemScene::handle(const QModelIndex& index)
+{
+    return index.isValid() ? _cache.handle(intern(index)) : NodeHandle();
+}
+
+/// drops what resolve() found below parent, whose rows are about to change
+/// or just did; an invalid parent is the top of the model.
+void FileSystemScene::forgetResolved(const QModelIndex& parent) const
+{
+    if (!parent.isValid()) {
+        _resolved.clear();
+        return;
+    }
+
+    const auto prefix = joinPath(filePath(parent), QString());
+    _resolved.removeIf([this, &prefix](QHash<NodeHandle, QModelIndex>::iterator it)
+    {
+        return _cache.path(it.key().id).startsWith(prefix);
+    });
+}
+
+/// the index of what handle refers to, as the model has it now; invalid if
+/// it was removed since the handle was made.  QFileSystemModel finds a path
+/// by going through the siblings at each level, so what it found is kept
+/// until the rows of the proxy around it change.
+QModelIndex FileSystemScene::resolve(const NodeHandle& handle) const
+{
+    if (!_cache.isCurrent(handle)) {
+        return {};
+    }
+
+    if (const auto found = _resolved.constFind(handle); found != _resolved.cend()) {
+        return *found;
+    }
+
+    const auto index = _proxyModel->mapFromSource(_model->index(_cache.path(handle.id)));
+    _resolved.insert(handle, index);
+
+    return index;
+}
+
+QString FileSystemScene::path(PathId id) const
+{
+    return _cache.path(id);
+}
+
+QString FileSystemScene::name(PathId id) const
+{
+    return _cache.name(id);
+}
+
+/// nullptr if the metadata of id hasn't been fetched, or has changed since.
+const FileMetadata* FileSystemScene::metadata(PathId id) const
+{
+    return _cache.metadata(id);
+}
+
+/// nullptr until the thumbnailer has one; asking for it is what queues it,
+/// so only nodes that are painted ask.  Files on mounts that don't answer
+/// get only what is in memory.
+const QPixmap* FileSystemScene::thumbnail(PathId id) const
+{
+    const auto path = _cache.path(id);
+
+    if (const auto* pixmap = _thumbnails->cached(path)) {
+        return pixmap;
+    }
+
+    return _fetcher->isReachable(path) ? _thumbnails->thumbnail(path) : nullptr;
+}
+
+/// OtherFile until the classifier has looked at the file (see
+/// requestFileCategory()).
+FileCategory FileSystemScene::fileCategory(PathId id) const
+{
+    return _fileCategories.value(id, OtherFile);
+}
+
+/// the type of id isn't known (see classify()); its metadata, which tells, is
+/// fetched without waiting for a node to be painted.
+void FileSystemScene::requestClassification(PathId id) const
+{
+    _fetcher->request(_cache.path(id));
+}
+
+/// the files of a listing are classified as it comes in; a file that was
+/// not listed, or was evicted since (see evictPaths()), is given to the
+/// classifier here.
+void FileSystemScene::requestFileCategory(PathId id) const
+{
+    if (const auto* entry = _cache.entry(id); !_fileCategories.contains(id) && (entry == nullptr || !entry->listed)) {
+        /// sniffing a file on a mount that doesn't answer would tie up a
+        /// worker of the classifier.
+        if (const auto path = _cache.path(id); _fetcher->isReachable(path)) {
+            _types->classify(QFileInfo(path).path(), {_cache.name(id)});
+        }
+    }
+}
+
+GitState FileSystemScene::gitState(PathId id) const
+{
+    return _git->state(_cache.path(id));
+}
+
+/// 1 + the index of the group of duplicates id is in, or 0.
+int FileSystemScene::duplicateGroup(PathId id) const
+{
+    return _duplicateGroups.value(id, 0);
+}
+
+/// valid until the model changes; keep a handle, not the index.
+QModelIndex FileSystemScene::index(const QString& path) const
 {
     return _proxyModel->mapFromSource(_model->index(path));
 }
@@ -308,6 +449,12 @@ void FileSystemScene::setRootPath(const QString& newPath) const
 
 void FileSystemScene::openTo(const QString &targetPath) const
 {
+    /// list every directory along the path in parallel before walking it.
+    for (QString subPath; const auto& dir : targetPath.split(QDir::separator(), Qt::SkipEmptyParts)) {
+        subPath += QDir::separator() + dir;
+        _lister->schedule(subPath, ListingScheduler::HighPriority);
+    }
+
     auto idx = index(QDir::rootPath());
 
     if (auto* root = nodeFromIndex(idx); root) {
@@ -343,25 +490,196 @@ void FileSystemScene::openTo(const QString &targetPath) const
     }
 }
 
-void FileSystemScene::fetchMore(const QPersistentModelIndex& index) const
+/// the model fetches the directory at once, and the ListingScheduler lists
+/// it alongside for the types of its entries; the rows that arrive first are
+/// pending until the listing does (see onListed()).
+void FileSystemScene::fetchMore(const QPersistentModelIndex& index, ListingScheduler::Priority priority) const
 {
-    if (_proxyModel->canFetchMore(index)) {
-        _proxyModel->fetchMore(index);
+    if (index.isValid() && _proxyModel->canFetchMore(index)) {
+        /// a directory on a mount that just timed out would only tie up the
+        /// gatherer of the model, and a worker.
+        if (const auto path = filePath(index); _fetcher->isReachable(path)) {
+            _proxyModel->fetchMore(index);
+            _lister->schedule(path, priority);
+        }
     }
 }
 
-qint64 FileSystemScene::fileSize(const QPersistentModelIndex& index) const
+ListingScheduler::Priority FileSystemScene::listingPriority(const NodeItem* node) const
 {
-    Q_ASSERT(index.isValid());
-    Q_ASSERT(index.model() == _proxyModel);
+    Q_ASSERT(node != nullptr);
+
+    if (node->isSelected()) {
+        return ListingScheduler::HighPriority;
+    }
+
+    const auto rec = node->sceneBoundingRect();
+
+    for (const auto* view : views()) {
+        if (view->isVisible()
+                && view->mapToScene(view->viewport()->rect()).boundingRect().intersects(rec)) {
+            return ListingScheduler::NormalPriority;
+        }
+    }
+
+    return ListingScheduler::LowPriority;
+}
+
+/// asks for the size and link target of the node's file; the node is updated
+/// in onMetadataFetched() once they arrive.  Folders show the size from their
+/// last scan right away; closed ones are scanned again once they are selected
+/// or large enough on screen to show it (see requestDiskUsage()).
+void FileSystemScene::requestMetadata(NodeItem* node) const
+{
+    if (const auto index = node->index(); index.isValid()) {
+        const auto path = node->path();
+        _fetcher->request(path);
+
+        /// finding the work tree stats every directory up from path, which
+        /// would tie up the git worker on a mount that does not answer.
+        if (_fetcher->isReachable(path)) {
+            _git->request(path);
+        }
+
+        if (node->isDir()) {
+            if (const auto* usage = _du->usage(path)) {
+                node->setDiskUsage(usage->size);
+            }
+            node->setData(NodeItem::DiskUsageAskedKey, QVariant());
+
+            if (node->isSelected()) {
+                requestDiskUsage(node);
+            }
+        }
+    }
+}
+
+/// scans a closed folder; the node is updated in onDiskUsageScanned().  Asked
+/// once per requestMetadata(), and not for folders on mounts that don't
+/// answer.  The root is only scanned if asked for (see gatherStats()).
+void FileSystemScene::requestDiskUsage(NodeItem* node) const
+{
+    if (!node->isClosed() || !node->index().isValid()) {
+        return;
+    }
+
+    if (const auto path = node->path(); path != QDir::rootPath() && _fetcher->isReachable(path)) {
+        node->setData(NodeItem::DiskUsageAskedKey, true);
+        _du->request(path);
+    }
+}
 
-    return _model->size(_proxyModel->mapToSource(index));
+/// the mouse is over a file; its preview is shown now if it is cached, or
+/// else once the worker has it.  Files on mounts that don't answer are left
+/// alone.
+void FileSystemScene::beginPreview(const NodeItem* node)
+{
+    if (QGuiApplication::mouseButtons() != Qt::NoButton) {
+        return;
+    }
+
+    const auto path = node->path();
+
+    if (!_fetcher->isReachable(path)) {
+        return;
+    }
+
+    _previewPath = path;
+    _previewPos  = node->sceneBoundingRect().topRight();
+
+    if (const auto* preview = _previewer->preview(path)) {
+        showPreview(*preview);
+    }
+}
+
+void FileSystemScene::endPreview(const NodeItem* node)
+{
+    if (!_previewPath.isEmpty() && _previewPath == node->path()) {
+        _previewer->cancel();
+        hidePreview();
+    }
+}
+
+void FileSystemScene::noteSelected(QGraphicsItem* item, bool selected)
+{
+    _selection.note(item, selected);
+}
+
+/// node has a path, and is, or is about to be, in the scene.
+void FileSystemScene::noteNode(NodeItem* node)
+{
+    Q_ASSERT(node->pathId() != 0);
+
+    if (!_nodes.contains(node->pathId(), node)) {
+        _nodes.insert(node->pathId(), node);
+    }
+}
+
+/// node is about to lose its path, or to leave the scene.
+void FileSystemScene::forgetNode(NodeItem* node)
+{
+    _nodes.remove(node->pathId(), node);
+}
+
+QList<NodeItem*> FileSystemScene::nodesOf(PathId id) const
+{
+    return _nodes.values(id);
+}
+
+/// the nodes of the entry at index, as the model has it now.
+QList<NodeItem*> FileSystemScene::nodesOf(const QModelIndex& index) const
+{
+    if (!index.isValid()) {
+        return {};
+    }
+
+    auto nodes = nodesOf(_cache.find(filePath(index)));
+    nodes.removeIf([&index](const NodeItem* node) { return node->index() != index; });
+
+    return nodes;
+}
+
+/// grows the scene rect, at once, if pos is within half a margin of its
+/// edge; a view can't be scrolled past the scene rect, so it has to be there
+/// before anything is shown there.
+void FileSystemScene::keepInSceneRect(const QPointF& pos)
+{
+    const auto rect   = sceneRect();
+    const auto inner  = rect.adjusted(SCENE_MARGIN / 2, SCENE_MARGIN / 2, -SCENE_MARGIN / 2, -SCENE_MARGIN / 2);
+
+    if (inner.contains(pos)) {
+        return;
+    }
+
+    const auto reach = QRectF(pos - QPointF(SCENE_MARGIN, SCENE_MARGIN), pos + QPointF(SCENE_MARGIN, SCENE_MARGIN));
+
+    setSceneRect(snapOut(rect.united(reach)));
+}
+
+void FileSystemScene::fitSceneRectLater()
+{
+    _fitTimer->start();
+}
+
+/// the items, and what the views show, with a margin around them.
+void FileSystemScene::fitSceneRect()
+{
+    auto needed = itemsBoundingRect();
+
+    for (const auto allViews = views(); const auto* view : allViews) {
+        needed = needed.united(view->mapToScene(view->viewport()->rect()).boundingRect());
+    }
+
+    if (const auto fitted = snapOut(needed.adjusted(-SCENE_MARGIN, -SCENE_MARGIN, SCENE_MARGIN, SCENE_MARGIN));
+        fitted != sceneRect()) {
+        setSceneRect(fitted);
+    }
 }
 
 void FileSystemScene::openSelectedNodes() const
 {
-    for (const auto selection = selectedItems(); auto* node : selection | filterNodes) {
-        if (isDir(node->index())) {
+    for (const auto nodes = _selection.nodes(); auto* node : nodes) {
+        if (node->isDir()) {
             node->open();
         } else {
             const auto ok = openFile(node);
@@ -372,18 +690,55 @@ void FileSystemScene::openSelectedNodes() const
 
 void FileSystemScene::closeSelectedNodes() const
 {
-    for (const auto selection = selectedItems(); auto* node : selection | filterNodes) {
+    for (const auto nodes = _selection.nodes(); auto* node : nodes) {
         node->closeOrHalfClose();
     }
 }
 
 void FileSystemScene::halfCloseSelectedNodes() const
 {
-    for (const auto selection = selectedItems(); auto* node : selection | filterNodes) {
+    for (const auto nodes = _selection.nodes(); auto* node : nodes) {
         node->closeOrHalfClose(true);
     }
 }
 
+/// opens a search in the selected folder, in the folder of the selected file,
+/// or in the root if nothing is selected.
+void FileSystemScene::searchSelectedNode()
+{
+    auto root = QDir::rootPath();
+
+    if (!_selection.empty()) {
+        const auto& nodes = _selection.nodes();
+        if (nodes.size() != 1) {
+            return;
+        }
+
+        const auto path = (*nodes.begin())->path();
+        root = (*nodes.begin())->isFile() ? QFileInfo(path).path() : path;
+    }
+
+    const auto allViews = views();
+    const auto found    = std::ranges::find_if(allViews, &QWidget::hasFocus);
+
+    auto* dialog = new SearchDialog(root, found != allViews.cend() ? *found : allViews.value(0));
+    dialog->show();
+}
+
+/// looks for files with the same contents under the selected folder; they
+/// are marked as they show up in the scene.
+void FileSystemScene::findDuplicatesInSelectedNode()
+{
+    const auto& nodes = _selection.nodes();
+
+    if (nodes.size() != 1 || !(*nodes.begin())->isDir()) {
+        SessionManager::ib()->postMsgL("duplicates: select one folder", 2000);
+        return;
+    }
+
+    _duplicates->start((*nodes.begin())->path());
+}
+
 void FileSystemScene::addSceneBookmark(const QPoint& clickPos, const QString& name)
 {
     auto* bm = SessionManager::bm();
@@ -411,11 +766,61 @@ void FileSystemScene::toggleReadOnly()
     emit readOnlyToggled(_model->isReadOnly());
 }
 
+/// pushes apart the open folders whose subtrees overlap.  Each is a disc
+/// that holds its files and closed folders, which move with it; the root
+/// stays where it is.
+void FileSystemScene::relaxLayout()
+{
+    /// a run that is still going would deliver positions for the old bodies.
+    _relaxer->cancel();
+    _relaxing.clear();
+
+    QHash<const NodeItem*, int> bodyOf;
+
+    for (const auto _items = items(); auto* node : _items | filterNodes) {
+        if ((node->isOpen() || node->isHalfClosed()) && node->parentItem() == nullptr) {
+            bodyOf.insert(node, static_cast<int>(_relaxing.size()));
+            _relaxing.push_back({.node = node, .handle = node->handle(), .from = node->pos()});
+        }
+    }
+
+    if (_relaxing.size() < 2) {
+        _relaxing.clear();
+        SessionManager::ib()->postMsgL("layout: nothing to relax", 2000);
+        return;
+    }
+
+    QList<LayoutBody> bodies;
+    bodies.reserve(_relaxing.size());
+
+    for (const auto& [node, handle, from] : _relaxing) {
+        auto radius = node->boundingRect().width() / 2;
+
+        for (const auto* child : node->childEdges() | asFilesOrClosedTargetNodes) {
+            if (child->isVisible()) {
+                radius = qMax(radius, QLineF(from, child->pos()).length() + child->boundingRect().width() / 2);
+            }
+        }
+
+        const auto* parent = asNodeItem(node->parentEdge()->source());
+        const auto found   = parent == nullptr ? bodyOf.cend() : bodyOf.constFind(parent);
+
+        bodies.push_back({
+            .pos    = from,
+            .radius = radius,
+            .parent = found == bodyOf.cend() ? -1 : found.value(),
+            .length = found == bodyOf.cend() ? 0.0 : QLineF(parent->pos(), from).length(),
+            .pinned = parent == nullptr});
+    }
+
+    _relaxer->relax(bodies);
+    SessionManager::ib()->postMsgL(QString("layout: relaxing %1 folders").arg(bodies.size()), 2000);
+}
+
 void FileSystemScene::drawBackground(QPainter *p, const QRectF& rec)
 {
     p->fillRect(rec, SessionManager::tm()->sceneMidarkColor());
     drawCrosshairs(p, rec);
-    drawBorder(p, rec, sceneRect());
 }
 
 void FileSystemScene::keyPressEvent(QKeyEvent *event)
@@ -423,10 +828,21 @@ void FileSystemScene::keyPressEvent(QKeyEvent *event)
     const auto key = event->key();
     const auto mod = event->modifiers();
 
-    if (key == Qt::Key_Delete) {
+    if (_seekParent.isValid() && seekKeyPressEvent(event)) {
+        return;
+    }
+
+    if (key == Qt::Key_Slash && beginSeek()) {
+        return;
+    } else if (key == Qt::Key_Escape && _transfers->isRunning()) {
+        _transfers->cancel();
+        return;
+    } else if (key == Qt::Key_Escape && _duplicates->isRunning()) {
+        _duplicates->cancel();
+        return;
+    } else if (key == Qt::Key_Delete) {
         if (!event->isAutoRepeat()) {
-            auto selection = selectedItems() | filterNodes;
-            if (std::ranges::distance(selection) > 0) {
+            if (!_selection.nodes().empty()) {
                 auto* dialog = createDeleteDialog(this);
                 connect(dialog, &QDialog::accepted, this, &FileSystemScene::deleteSelection);
                 dialog->exec();
@@ -435,15 +851,13 @@ void FileSystemScene::keyPressEvent(QKeyEvent *event)
             }
         }
     } else if (key == Qt::Key_A) {
-        rotateSelection(Rotation::CCW, event->modifiers() == Qt::ShiftModifier);
+        rotateSelection(Rotation::CCW, event->modifiers() == Qt::ShiftModifier, event->isAutoRepeat());
     } else if (key == Qt::Key_D) {
-        rotateSelection(Rotation::CW, event->modifiers() == Qt::ShiftModifier);
+        rotateSelection(Rotation::CW, event->modifiers() == Qt::ShiftModifier, event->isAutoRepeat());
     } else if (key == Qt::Key_Plus || key == Qt::Key_Minus) {
         auto amount = mod & Qt::ShiftModifier ? 10 : 2;
         amount *= key == Qt::Key_Minus ? -1 : 1;
-        const auto selection     = selectedItems();
-        const auto selectedNodes = std::ranges::to<QList>(selection | filterNodes);
-        for (auto* node : selectedNodes) {
+        for (const auto selectedNodes = _selection.nodes(); auto* node : selectedNodes) {
             if (!node->childEdges().empty()) {
                 node->growChildren(amount);
             } else {
@@ -476,6 +890,11 @@ void FileSystemScene::mouseDoubleClickEvent(QGraphicsSceneMouseEvent* event)
 
 void FileSystemScene::mouseMoveEvent(QGraphicsSceneMouseEvent *event)
 {
+    if (event->buttons() != Qt::NoButton && !_previewPath.isEmpty()) {
+        _previewer->cancel();
+        hidePreview();
+    }
+
     if (event->buttons() & Qt::LeftButton) {
         for (const auto pos = event->scenePos(); auto* edge : _selectedEdges) {
             edge->adjustSourceTo(pos);
@@ -495,31 +914,39 @@ void FileSystemScene::mouseReleaseEvent(QGraphicsSceneMouseEvent *event)
 
         const auto* destinationNode = destination.front();
 
-        const auto sourceIndices = _selectedEdges
-            | asTargetNodeIndex
-            | std::views::transform(
-                [this](const QModelIndex& i) {
-                    return _proxyModel->mapToSource(i);
-                })
-            | std::ranges::to<QModelIndexList>();
-
-        if (sourceIndices.empty()) { return; }
-
-        const auto* sourceData = _model->mimeData(sourceIndices);
-
-        if (!sourceData) { return; }
+        const auto sources = _selectedEdges
+            | asTargetNode
+            | std::views::transform(&NodeItem::path)
+            | std::ranges::to<QStringList>();
 
-        const auto destinationIndex = _proxyModel->mapToSource(destinationNode->index());
+        if (sources.empty()) { return; }
 
         auto action = Qt::MoveAction;
+        auto mode   = TransferEngine::Move;
         if (event->modifiers() == Qt::ControlModifier) {
             action = Qt::CopyAction;
+            mode   = TransferEngine::Copy;
         } else if (event->modifiers() & Qt::ControlModifier && event->modifiers() & Qt::ShiftModifier) {
             action = Qt::LinkAction;
+            mode   = TransferEngine::Link;
         }
 
-        /// TODO: dropMimeData does not support directory copy.
-        if (_model->dropMimeData(sourceData, action, -1, -1, destinationIndex)) {
+        /// a copier would hang on a mount that does not answer.
+        const auto destinationPath = destinationNode->path();
+        const auto unreachable     = std::ranges::find_if(sources, [this](const QString& path)
+        {
+            return !_fetcher->isReachable(path);
+        });
+
+        if (unreachable != sources.cend() || !_fetcher->isReachable(destinationPath)) {
+            const auto& path = unreachable != sources.cend() ? *unreachable : destinationPath;
+            SessionManager::ib()->postMsgL(QString("%1 is not responding").arg(_fetcher->mountOf(path)), 3000);
+            return;
+        }
+
+        /// the model picks up the new entries when the transfer makes them.
+        if (!_model->isReadOnly() && destinationNode->isDir()) {
+            _transfers->start(sources, destinationPath, mode);
             adjustAllEdges(destinationNode);
         } else {
             const auto actionName =
@@ -542,85 +969,441 @@ void FileSystemScene::mouseReleaseEvent(QGraphicsSceneMouseEvent *event)
     QGraphicsScene::mouseReleaseEvent(event);
 }
 
-void FileSystemScene::onRowsInserted(const QModelIndex& parent, int start, int end) const
+void FileSystemScene::onRowsInserted(const QModelIndex& parent, int start, int end)
 {
-    for (const auto _items = items(); auto* node : _items | filterNodes) {
-        if (node->index() == parent) {
-            node->onRowsInserted(start, end);
-            break;
+    _seekIndices.remove(_cache.find(filePath(parent)));
+
+    /// the stored sizes of the new folders are read before their nodes ask.
+    /// The first fetch of a folder changes nothing on disk.
+    if (parent.isValid()) {
+        const auto path = filePath(parent);
+        _du->load(path);
+
+        if (_populated.contains(path)) {
+            _du->invalidate(path);
+            _git->invalidate(path);
         }
     }
 
+    if (auto* node = nodeFromIndex(parent)) {
+        node->onRowsInserted(start, end);
+    }
+
     reportStats();
 }
 
-void FileSystemScene::onRowsAboutToBeRemoved(const QModelIndex& parent, int start, int end) const
+void FileSystemScene::onEntriesAboutToBeRemoved(const QModelIndex& parent, int start, int end)
 {
-    for (const auto nodes = items(); auto* node : nodes | filterNodes) {
-        if (node->index() == parent) {
-            node->onRowsAboutToBeRemoved(start, end);
+    QList<PathId> removed;
+    removed.reserve(end - start + 1);
+
+    for (int row = start; row <= end; ++row) {
+        if (const auto child = _model->index(row, 0, parent); child.isValid()) {
+            const auto path = _model->filePath(child);
+            removed.push_back(_cache.find(path));
+            _populated.remove(path);
         }
     }
+
+    _cache.remove(removed);
 }
 
-void FileSystemScene::onRowsRemoved(const QModelIndex& parent, int start, int end) const
+void FileSystemScene::onRowsAboutToBeRemoved(const QModelIndex& parent, int start, int end)
 {
-    std::vector<NodeItem*> parentNodes;
+    for (auto* node : nodesOf(parent)) {
+        node->onRowsAboutToBeRemoved(start, end);
+    }
+}
 
-    /// can't call Node::unload() while traversing items() because Node::unload()
-    /// deletes child nodes and subtrees of items still in items().
-    for (const auto nodes = items(); auto* node : nodes | filterNodes) {
-        if (node->index() == parent) {
-            parentNodes.push_back(node);
-        }
+void FileSystemScene::onRowsRemoved(const QModelIndex& parent, int start, int end)
+{
+    _seekIndices.remove(_cache.find(filePath(parent)));
+
+    if (parent.isValid()) {
+        _du->invalidate(filePath(parent));
+        _git->invalidate(filePath(parent));
     }
 
-    for (auto* node : parentNodes) {
+    /// a copy; Node::unload() deletes child nodes, which leave _nodes.
+    for (auto* node : nodesOf(parent)) {
         node->onRowsRemoved(start, end);
     }
 
     reportStats();
 }
 
-void FileSystemScene::onSelectionChange()
+void FileSystemScene::onListed(const QList<DirListing>& batch)
+{
+    evictPaths();
+
+    for (const auto& listing : batch) {
+        _cache.insert(listing);
+
+        /// classified on the side; the folder opens without waiting for it.
+        _types->classify(listing.path, listing.entries
+            | std::views::filter([](const DirEntry& entry) { return !entry.isDir; })
+            | std::views::transform(&DirEntry::name)
+            | std::ranges::to<QStringList>());
+
+        /// only an open folder has nodes for its entries.
+        if (!_nodes.contains(_cache.find(listing.path))) {
+            continue;
+        }
+
+        for (const auto& entry : listing.entries) {
+            for (auto* node : nodesOf(_cache.find(joinPath(listing.path, entry.name)))) {
+                if (node->isPending()) {
+                    node->reclassify();
+                }
+            }
+        }
+    }
+}
+
+void FileSystemScene::onMetadataFetched(const QList<FileMetadata>& batch)
+{
+    QSet<PathId> fetched;
+    fetched.reserve(batch.size());
+
+    for (const auto& metadata : batch) {
+        fetched.insert(_cache.update(metadata));
+    }
+
+    auto selectionChanged = false;
+
+    for (const auto id : fetched) {
+        for (auto* node : nodesOf(id)) {
+            if (node->isPending()) {
+                node->reclassify();
+            }
+            node->setMetadata(*_cache.metadata(id));
+            selectionChanged |= node->isSelected();
+        }
+    }
+
+    if (selectionChanged) {
+        reportStats();
+    }
+}
+
+/// the nodes on mount that gave up, because it didn't answer, ask again;
+/// if it still doesn't, they give up again, for twice as long.
+void FileSystemScene::onMountReachable(const QString& mount)
 {
-    disconnect(this, &QGraphicsScene::selectionChanged, this, &FileSystemScene::onSelectionChange);
+    for (auto* node : std::as_const(_nodes)) {
+        if (node->data(NodeItem::MetadataStateKey).toInt() == NodeItem::MetadataUnreachable
+            && _fetcher->mountOf(node->path()) == mount) {
+            node->retryMetadata();
+        }
+    }
+}
+
+void FileSystemScene::onFileTypesClassified(const QList<FileType>& batch)
+{
+    for (const auto& [path, category] : batch) {
+        if (const auto id = _cache.find(path); id != 0) {
+            _fileCategories.insert(id, category);
+
+            for (auto* node : nodesOf(id)) {
+                if (node->isFile()) {
+                    node->setFileCategory(category);
+                }
+            }
+        }
+    }
+}
+
+void FileSystemScene::onGitStatusUpdated(const QStringList& dirs)
+{
+    const auto update = [this](NodeItem* node)
+    {
+        if (node != nullptr && node->pathId() != 0) {
+            node->setGitState(_git->state(node->path()));
+        }
+    };
+
+    /// the entries of dirs are the nodes at the end of their child edges;
+    /// the root is an entry of itself.
+    for (const auto& dir : dirs) {
+        for (const auto* dirNode : nodesOf(_cache.find(dir))) {
+            for (const auto* edge : dirNode->childEdges()) {
+                update(asNodeItem(edge->target()));
+            }
+        }
+        if (dir == QDir::rootPath()) {
+            for (auto* node : nodesOf(_cache.find(dir))) {
+                update(node);
+            }
+        }
+    }
+}
+
+void FileSystemScene::onTransferProgress(qint64 bytesDone, qint64 bytesTotal, qint64 filesDone, qint64 filesTotal) const
+{
+    const auto locale = QLocale::system();
+
+    SessionManager::ib()->postMsgL(QString("transfer: %1 of %2 (%3 of %4 files), Esc to cancel")
+        .arg(locale.formattedDataSize(bytesDone))
+        .arg(locale.formattedDataSize(bytesTotal))
+        .arg(filesDone)
+        .arg(filesTotal));
+}
+
+void FileSystemScene::onFileOperationFailed(const QStringList& errors) const
+{
+    Q_ASSERT(!errors.empty());
+
+    const auto msg = errors.size() == 1
+        ? errors.first()
+        : QString("%1 (and %2 more)").arg(errors.first()).arg(errors.size() - 1);
+
+    qWarning() << errors;
+    SessionManager::ib()->postMsgL(msg, 5000);
+}
+
+void FileSystemScene::onTransferFinished(int mode, qint64 done, qint64 failures, bool cancelled) const
+{
+    const auto actionName = mode == TransferEngine::Copy ? "Copy" : mode == TransferEngine::Move ? "Move" : "Link";
+
+    auto msg = cancelled
+        ? QString("%1 cancelled").arg(actionName)
+        : QString("%1 done: %2").arg(actionName).arg(done);
+
+    if (failures > 0) {
+        msg += QString(", %1 failed!").arg(failures);
+    }
+
+    SessionManager::ib()->postMsgL(msg, 3000);
+}
+
+void FileSystemScene::onPurgeProgress(qint64 removed) const
+{
+    SessionManager::ib()->postMsgL(QString("delete: %1 entries removed").arg(QLocale::system().toString(removed)));
+}
+
+void FileSystemScene::onPurgeFinished(qint64 removed, qint64 failures) const
+{
+    auto msg = QString("Delete done: %1 entries").arg(QLocale::system().toString(removed));
+
+    if (failures > 0) {
+        msg += QString(", %1 failed!").arg(failures);
+    }
+
+    SessionManager::ib()->postMsgL(msg, 3000);
+}
+
+void FileSystemScene::onDuplicatesProgress(qint64 files, qint64 bytesHashed, qint64 bytesTotal) const
+{
+    const auto locale = QLocale::system();
+
+    SessionManager::ib()->postMsgL(QString("duplicates: %1 files, %2 of %3 hashed, Esc to cancel")
+        .arg(locale.toString(files))
+        .arg(locale.formattedDataSize(bytesHashed))
+        .arg(locale.formattedDataSize(bytesTotal)));
+}
+
+void FileSystemScene::onDuplicatesFound(const QList<QStringList>& groups)
+{
+    _duplicateGroups.clear();
+
+    qsizetype count = 0;
+    for (int group = 0; group < groups.size(); ++group) {
+        for (const auto& path : groups[group]) {
+            _duplicateGroups.insert(_cache.intern(path), group + 1);
+        }
+        count += groups[group].size();
+    }
+
+    for (auto* node : std::as_const(_nodes)) {
+        node->setDuplicateGroup(duplicateGroup(node->pathId()));
+    }
+
+    SessionManager::ib()->postMsgL(QString("duplicates: %1 files in %2 groups").arg(count).arg(groups.size()), 5000);
+}
+
+void FileSystemScene::onThumbnailsReady(const QStringList& paths)
+{
+    for (const auto& path : paths) {
+        for (auto* node : nodesOf(_cache.find(path))) {
+            node->update();
+        }
+    }
+}
+
+void FileSystemScene::onPreviewReady(const QString& path)
+{
+    if (path != _previewPath) {
+        return;
+    }
+
+    if (const auto* preview = _previewer->preview(path)) {
+        showPreview(*preview);
+    }
+}
+
+/// the folders that were closed, removed or picked up since the snapshot
+/// stay where they are; the rest move by as much as the relaxer moved them.
+void FileSystemScene::onRelaxed(const QList<QPointF>& positions)
+{
+    Q_ASSERT(positions.size() == _relaxing.size());
+
+    const auto current = items()
+        | filterNodes
+        | std::ranges::to<QSet<const NodeItem*>>()
+        ;
+
+    SpreadAnimationData data;
+    auto count = 0;
+
+    for (qsizetype i = 0; i < _relaxing.size(); ++i) {
+        auto* node = _relaxing[i].node;
+
+        if (!current.contains(node) || node->handle() != _relaxing[i].handle || node->parentItem() != nullptr
+            || !(node->isOpen() || node->isHalfClosed())) {
+            continue;
+        }
+
+        const auto delta = positions[i] - _relaxing[i].from;
+        if (delta.manhattanLength() < 1.0) {
+            continue;
+        }
+
+        data.movement.insert(node, {.oldPos = node->pos(), .newPos = node->pos() + delta});
+        for (auto* child : node->childEdges() | asFilesOrClosedTargetNodes) {
+            data.movement.insert(child, {.oldPos = child->pos(), .newPos = child->pos() + delta});
+        }
+        ++count;
+    }
+
+    _relaxing.clear();
+
+    animateLayout(data);
+    SessionManager::ib()->postMsgL(QString("layout: %1 folders moved").arg(count), 2000);
+}
+
+void FileSystemScene::onDiskUsageScanned(const QList<DirUsage>& batch)
+{
+    auto selectionChanged = false;
+
+    for (const auto& usage : batch) {
+        for (auto* node : nodesOf(_cache.find(usage.path))) {
+            if (node->isDir()) {
+                node->setDiskUsage(usage.size);
+                selectionChanged |= node->isSelected();
+            }
+        }
+    }
+
+    if (selectionChanged) {
+        reportStats();
+    }
+}
+
+/// the model's watcher saw entries change; their metadata is dropped from the
+/// cache, and fetched again for the nodes that show them.
+void FileSystemScene::onSourceDataChanged(const QModelIndex& topLeft, const QModelIndex& bottomRight)
+{
+    if (_cache.size() == 0) {
+        return;
+    }
+
+    QSet<PathId> changed;
+    QStringList files;
+    const auto parent = topLeft.parent();
+
+    for (int row = topLeft.row(); row <= bottomRight.row(); ++row) {
+        const auto idx  = _model->index(row, 0, parent);
+        const auto path = _model->filePath(idx);
+        const auto id   = _cache.find(path);
+
+        _thumbnails->invalidate(path);
+        _previewer->invalidate(path);
+
+        /// only what was sniffed can change with the contents; the name of
+        /// the rest still says the same.
+        if (_fileCategories.contains(id)) {
+            if (const auto name = _model->fileName(idx); FileTypeClassifier::categoryOfName(name) == FileCategoryCount) {
+                files.push_back(name);
+            }
+        }
+
+        if (id != 0 && _cache.metadata(id) != nullptr) {
+            _cache.invalidate(id);
+            changed.insert(id);
+        }
+    }
+
+    /// a file that grew in place leaves the mtime of its folder as it was.
+    /// While a folder is first fetched, the model fills in what it gathered;
+    /// nothing changed.
+    if (const auto path = parent.isValid() ? _model->filePath(parent) : QString(); _populated.contains(path)) {
+        if (_fetcher->isReachable(path)) {
+            _types->classify(path, files);
+        }
+        _git->invalidate(path);
+        _du->invalidate(path);
+    }
+
+    if (changed.empty()) {
+        return;
+    }
+
+    for (const auto id : changed) {
+        for (auto* node : nodesOf(id)) {
+            requestMetadata(node);
+        }
+    }
+}
 
-    const auto selection     = selectedItems();
-    const auto selectedNodes = std::ranges::to<QList>(selection | filterNodes);
-    const auto selectedEdges = std::ranges::to<QList>(selection | filterEdges);
+/// the edges it deselects come back here, and are ignored; blocking the
+/// signals of the scene instead would keep them from the view as well.
+void FileSystemScene::onSelectionChange()
+{
+    if (_changingSelection) {
+        return;
+    }
+    _changingSelection = true;
 
     _selectedEdges.clear();
 
     /// for now, give nodes priority over edges.
-    if ((!selectedNodes.empty() && !selectedEdges.empty()) || selectedEdges.empty()) {
-        for (auto* edge : selectedEdges) {
+    if (!_selection.nodes().empty()) {
+        for (const auto edges = _selection.edges(); auto* edge : edges) {
             edge->setSelected(false);
         }
     } else {
-        for (auto* node : selectedNodes) {
-            node->setSelected(false);
-        }
-        _selectedEdges = selectedEdges;
+        _selectedEdges = _selection.edges().values();
     }
 
-    if (selectedNodes.size() > 0) {
+    if (!_selection.nodes().empty()) {
         reportStats();
     } else {
+        _statsTimer->stop();
         SessionManager::ib()->clear();
     }
 
-    connect(this, &QGraphicsScene::selectionChanged, this, &FileSystemScene::onSelectionChange);
+    _changingSelection = false;
 }
 
+/// a node whose type isn't known yet may be a folder; it isn't opened.
 bool FileSystemScene::openFile(const NodeItem* node) const
 {
-    if (const auto& index = node->index(); index.isValid()) {
+    if (node->isPending()) {
+        return false;
+    }
+
+    if (const auto index = node->index(); index.isValid()) {
         Q_ASSERT(!isDir(index));
         Q_ASSERT(index.model() == _proxyModel);
 
         const auto info = _model->filePath(_proxyModel->mapToSource(index));
 
+        /// the application that would open the file would hang on it too.
+        if (!_fetcher->isReachable(info)) {
+            SessionManager::ib()->postMsgL(QString("%1 is not responding").arg(_fetcher->mountOf(info)), 3000);
+            return false;
+        }
+
         return QDesktopServices::openUrl(QUrl::fromLocalFile(info));
     }
 
@@ -629,31 +1412,31 @@ bool FileSystemScene::openFile(const NodeItem* node) const
 
 void FileSystemScene::deleteSelection()
 {
-    using namespace std::placeholders;
-
-    const auto selection = selectedItems();
-
-    /// 1. remove files and folders
-    auto indices = selection
-        | std::views::filter(&asNodeItem)
-        | std::views::transform(&asNodeItem)
-        | asIndex
-        | std::views::transform(std::bind(&QSortFilterProxyModel::mapToSource, _proxyModel, _1))
-        | std::views::filter(&QModelIndex::isValid)
-        ;
-
-    for (auto i : indices) {
-        _model->remove(i);
+    /// 1. remove files and folders; they are moved out of the way at once,
+    /// and purged in the background.  Moving them stats and renames on this
+    /// thread, which would hang on a mount that does not answer; those are
+    /// left alone.
+    QStringList unreachable;
+
+    for (const auto* node : _selection.nodes()) {
+        if (node->index().isValid()) {
+            if (const auto path = node->path(); _fetcher->isReachable(path)) {
+                _purger->remove(path);
+            } else {
+                unreachable.push_back(QString("could not delete %1: %2 is not responding")
+                    .arg(path, _fetcher->mountOf(path)));
+            }
+        }
+    }
+    if (!unreachable.empty()) {
+        onFileOperationFailed(unreachable);
     }
 
 
     /// 2. remove bookmarks
     auto* bm = SessionManager::bm();
 
-    auto bookmarkItems = selection
-        | std::views::filter([](QGraphicsItem* item)
-            { return qgraphicsitem_cast<SceneBookmarkItem*>(item); })
-        ;
+    const auto bookmarkItems = _selection.bookmarks();
 
     QList<SceneBookmarkData> data;
     for (auto* item : bookmarkItems) {
@@ -664,61 +1447,208 @@ void FileSystemScene::deleteSelection()
     bm->removeBookmarks(data);
 }
 
-void FileSystemScene::rotateSelection(Rotation rot, bool page) const
+/// a single press of A or D rotates by one row, queued after any rotation
+/// in progress; anything more, a page or a key held down, is added to what
+/// is pending and applied in one step.
+void FileSystemScene::rotateSelection(Rotation rot, bool page, bool repeat)
 {
-    auto nodes = selectedItems() | filterNodes;
+    const auto step = rot == Rotation::CW ? 1 : -1;
+
+    if (!page && !repeat && _pendingRows == 0 && _pendingPages == 0) {
+        for (const auto nodes = _selection.nodes(); auto* n : nodes) {
+            fetchMore(n->index());
+            n->rotate(rot);
+        }
+        return;
+    }
+
+    (page ? _pendingPages : _pendingRows) += step;
+
+    if (repeat) {
+        if (!_rotationTimer->isActive()) {
+            _rotationTimer->start();
+        }
+    } else {
+        rotatePending();
+    }
+}
+
+void FileSystemScene::rotatePending()
+{
+    const auto nodes = _selection.nodes();
 
     for (auto* n : nodes) {
         fetchMore(n->index());
     }
 
-    if (page) {
-        for (auto* n : nodes) {
-            n->rotatePage(rot);
-        }
+    if (std::ranges::any_of(nodes, &NodeItem::isRotating)) {
+        /// still rotating; try again once it's done.
+        _rotationTimer->start();
+        return;
+    }
+
+    for (auto* n : nodes) {
+        n->rotateBy(_pendingRows, _pendingPages);
+    }
+
+    _pendingRows  = 0;
+    _pendingPages = 0;
+}
+
+/// starts type-to-seek in the selected open node.
+bool FileSystemScene::beginSeek()
+{
+    const auto& nodes = _selection.nodes();
+
+    if (nodes.size() != 1 || !(*nodes.begin())->isOpen()) {
+        return false;
+    }
+
+    _seekParent = (*nodes.begin())->index();
+    _seekText.clear();
+    SessionManager::ib()->postMsgL("seek: ", 3000);
+
+    return true;
+}
+
+/// returns true if the key was taken by type-to-seek.
+bool FileSystemScene::seekKeyPressEvent(const QKeyEvent* event)
+{
+    const auto key  = event->key();
+    const auto text = event->text();
+
+    if (key == Qt::Key_Escape || key == Qt::Key_Return || key == Qt::Key_Enter) {
+        endSeek();
+        return true;
+    }
+
+    if (key == Qt::Key_Backspace) {
+        _seekText.chop(1);
+    } else if (!text.isEmpty() && text.front().isPrint()
+            && !(event->modifiers() & (Qt::ControlModifier | Qt::AltModifier))) {
+        _seekText += text;
     } else {
-        for (auto* n : nodes) {
-            n->rotate(rot);
-        }
+        endSeek();
+        return false;
+    }
+
+    SessionManager::ib()->postMsgL(QString("seek: %1").arg(_seekText), 3000);
+
+    /// only the last keystroke of a burst moves the node.
+    if (!_seekText.isEmpty()) {
+        _seekTimer->start();
     }
+
+    return true;
+}
+
+void FileSystemScene::seek()
+{
+    auto* node = nodeFromIndex(_seekParent);
+
+    if (node == nullptr || !node->isOpen() || !node->isSelected()) {
+        endSeek();
+        return;
+    }
+
+    auto found = _seekIndices.find(node->pathId());
+    if (found == _seekIndices.end()) {
+        found = _seekIndices.insert(node->pathId(), SeekIndex(_seekParent));
+    }
+
+    if (const auto row = found->find(_seekText); row == -1) {
+        SessionManager::ib()->postMsgL(QString("seek: %1 (no match)").arg(_seekText), 3000);
+    } else if (!node->seekTo(row)) {
+        /// still rotating from the previous seek; try again once it's done.
+        _seekTimer->start();
+    }
+}
+
+void FileSystemScene::endSeek()
+{
+    _seekParent = QPersistentModelIndex();
+    _seekText.clear();
+    _seekTimer->stop();
 }
 
-QString FileSystemScene::gatherStats(const QModelIndexList& indices) const
+QString FileSystemScene::gatherStats(const QList<const NodeItem*>& nodes) const
 {
     auto locale = QLocale::system();
 
-    if (indices.size() == 1) {
-        const auto& fi = _model->fileInfo(indices.first());
-        if (fi.isDir()) {
-            auto dir = fi.dir();
-            dir.setFilter(QDir::NoDotAndDotDot | QDir::AllEntries);
-            dir.cd(fi.baseName());
+    /// sizes and entry counts come from the cache.  Whatever isn't known yet
+    /// is requested, and the stats are reported again once it arrives.
+    const auto lookup = [this](const NodeItem* node) -> const FileMetadata*
+    {
+        const auto* md   = _cache.metadata(node->pathId());
+        const auto known = md != nullptr
+            && (md->status != FileMetadata::Ok || !node->isDir() || md->entryCount >= 0);
 
-            return QString("\"%1\" selected (containing %2 items)")
-                        .arg(fi.isRoot() ? QDir::separator() : fi.fileName())
-                        .arg(dir.count());
+        if (!known || (md->status == FileMetadata::Unreachable && _fetcher->isReachable(md->path))) {
+            _fetcher->request(node->path(), node->isDir());
         }
+
+        return known ? md : nullptr;
+    };
+
+    /// recursive sizes come from the last scan; a folder that is selected is
+    /// scanned again, which is cheap if nothing in it has changed.
+    const auto total = [this](const NodeItem* node) -> const DirUsage*
+    {
+        const auto path = node->path();
+
+        if (_fetcher->isReachable(path)) {
+            _du->request(path);
+        }
+
+        return _du->usage(path);
+    };
+
+    if (nodes.size() == 1) {
+        const auto* node = nodes.first();
+        const auto isDir = node->isDir();
+        const auto* md   = lookup(node);
+        const auto* du   = isDir ? total(node) : nullptr;
+
+        const auto details = md == nullptr
+            ? QString("…")
+            : md->status == FileMetadata::Unreachable
+            ? QString("unreachable")
+            : isDir && du != nullptr
+            ? QString("containing %1 items, %2 in all").arg(qMax<qint64>(0, md->entryCount)).arg(locale.formattedDataSize(du->size))
+            : isDir
+            ? QString("containing %1 items").arg(qMax<qint64>(0, md->entryCount))
+            : locale.formattedDataSize(md->size);
+
         return QString("\"%1\" selected (%2)")
-                    .arg(fi.fileName())
-                    .arg(locale.formattedDataSize(fi.size()));
+                    .arg(node->name())
+                    .arg(details);
     }
 
     qint64 selectedFolders = 0;
     qint64 folderCount = 0;
     qint64 selectedItems = 0;
     qint64 fileBytes = 0;
-
-    auto dir = QDir();
-    dir.setFilter(QDir::NoDotAndDotDot | QDir::AllEntries);
-
-    for (const auto& index : indices) {
-        if (const auto& fi = _model->fileInfo(index); fi.isDir()) {
-            selectedFolders++;
-            dir.setPath(fi.absoluteFilePath());
-            folderCount += dir.count();
+    qint64 folderBytes = 0;
+    qint64 pending = 0;
+    qint64 unreachable = 0;
+
+    for (const auto* node : nodes) {
+        const auto isDir = node->isDir();
+        const auto* md   = lookup(node);
+
+        isDir ? selectedFolders++ : selectedItems++;
+
+        if (md == nullptr) {
+            pending++;
+        } else if (md->status == FileMetadata::Unreachable) {
+            unreachable++;
+        } else if (isDir) {
+            folderCount += qMax<qint64>(0, md->entryCount);
+            if (const auto* du = total(node)) {
+                folderBytes += du->size;
+            }
         } else {
-            selectedItems++;
-            fileBytes += fi.size();
+            fileBytes += md->size;
         }
     }
 
@@ -732,12 +1662,13 @@ QString FileSystemScene::gatherStats(const QModelIndexList& indices) const
 
     auto msg = QString();
     if (selectedFolders > 0) {
-        msg += QString("%1 %2 selected (containing %3 %4 %5)")
+        msg += QString("%1 %2 selected (containing %3 %4 %5%6)")
                     .arg(selectedFolders)
                     .arg(folder)
                     .arg(aTotalOf)
                     .arg(folderCount)
-                    .arg(folderItems);
+                    .arg(folderItems)
+                    .arg(folderBytes > 0 ? QString(", %1 in all").arg(locale.formattedDataSize(folderBytes)) : QString());
     }
 
     msg += comma;
@@ -750,31 +1681,90 @@ QString FileSystemScene::gatherStats(const QModelIndexList& indices) const
                 .arg(formattedSize);
     }
 
+    if (pending > 0) {
+        msg += " …";
+    }
+
+    if (unreachable > 0) {
+        msg += QString(" (%1 unreachable)").arg(unreachable);
+    }
+
     return msg;
 }
 
 void FileSystemScene::reportStats() const
 {
-    const auto indices = selectedItems()
-        | filterNodes
-        | asIndex
-        | std::views::transform(
-            [this](const QPersistentModelIndex& i) {
-                return _proxyModel->mapToSource(i);
-            })
-        | std::ranges::to<QList>()
+    if (!_statsTimer->isActive()) {
+        _statsTimer->start();
+    }
+}
+
+void FileSystemScene::postStats() const
+{
+    const auto nodes = _selection.nodes()
+        | std::views::filter([](const NodeItem* node) { return node->index().isValid(); })
+        | std::ranges::to<QList<const NodeItem*>>()
         ;
 
-    SessionManager::ib()->postMsgR(gatherStats(indices));
+    SessionManager::ib()->postMsgR(gatherStats(nodes));
 }
 
 NodeItem* FileSystemScene::nodeFromIndex(const QModelIndex& index) const
 {
-    for (const auto nodes = items(); auto* node : nodes | filterNodes) {
-        if (node->index() == index) {
-            return node;
+    const auto nodes = nodesOf(index);
+
+    return nodes.empty() ? nullptr : nodes.front();
+}
+
+void FileSystemScene::showPreview(const Preview& preview)
+{
+    if (_preview == nullptr) {
+        _preview = new PreviewItem();
+        addItem(_preview);
+    }
+
+    _preview->setPreview(preview);
+    _preview->setPos(_previewPos);
+    _preview->show();
+}
+
+void FileSystemScene::hidePreview()
+{
+    _previewPath.clear();
+
+    if (_preview) {
+        _preview->hide();
+    }
+}
+
+/// drops the paths, and the metadata, of entries that no node holds, either
+/// as its own or as the length of a child, and that no duplicate group or
+/// relaxation refers to; every folder ever listed would otherwise stay
+/// interned.
+void FileSystemScene::evictPaths()
+{
+    if (_cache.interned() < _evictAt) {
+        return;
+    }
+
+    QSet<PathId> live;
+    for (auto it = _nodes.cbegin(); it != _nodes.cend(); ++it) {
+        live.insert(it.key());
+        for (const auto& handle : it.value()->childLengths().keys()) {
+            live.insert(handle.id);
         }
     }
+    for (const auto& r : std::as_const(_relaxing)) {
+        live.insert(r.handle.id);
+    }
+    for (auto it = _duplicateGroups.cbegin(); it != _duplicateGroups.cend(); ++it) {
+        live.insert(it.key());
+    }
+
+    for (const auto id : _cache.evict(live)) {
+        _fileCategories.remove(id);
+        _seekIndices.remove(id);
+    }
 
-    return nullptr;
+    _evictAt = qMax(EVICT_MIN_PATHS, _cache.interned() * 2);
 }
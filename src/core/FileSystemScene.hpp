@@ -3,17 +3,33 @@
 
 #pragma once
 
+#include "DiskUsage.hpp"
+#include "DuplicateFinder.hpp"
+#include "FileTypes.hpp"
+#include "GitStatus.hpp"
+#include "LayoutRelaxer.hpp"
+#include "ListingScheduler.hpp"
+#include "MetadataCache.hpp"
+#include "MetadataFetcher.hpp"
 #include "NodeItem.hpp"
+#include "Previewer.hpp"
+#include "Purger.hpp"
+#include "SceneSelection.hpp"
+#include "SeekIndex.hpp"
+#include "Thumbnailer.hpp"
+#include "TransferEngine.hpp"
 
 #include <QGraphicsScene>
 
 
 class QFileSystemModel;
 class QSortFilterProxyModel;
+class QTimer;
 
 namespace core
 {
     class NodeItem;
+    class PreviewItem;
     class SceneBookmarkItem;
 
 
@@ -29,25 +45,62 @@ namespace core
         void readOnlyToggled(bool enabled);
 
     public:
+        /// how far the scene reaches past what is in it.
+        static constexpr qreal SCENE_MARGIN = 1024 * 16;
+        static constexpr int FIT_DELAY      = 1000;
+        static constexpr int ROTATION_DELAY = 50;
+
+        /// the cache is swept once it holds twice the paths it kept after
+        /// the last sweep, and at least this many.
+        static constexpr qsizetype EVICT_MIN_PATHS = 1 << 16;
+
         explicit FileSystemScene(QObject* parent = nullptr);
         [[nodiscard]] QPersistentModelIndex rootIndex() const;
+        [[nodiscard]] NodeFlags classify(const QModelIndex& index) const;
+        [[nodiscard]] NodeFlags classify(PathId id) const;
         bool isDir(const QModelIndex& index) const;
         bool isLink(const QModelIndex& index) const;
         [[nodiscard]] QString filePath(const QPersistentModelIndex& index) const;
-        [[nodiscard]] QPersistentModelIndex index(const QString& paht) const;
+        [[nodiscard]] QModelIndex index(const QString& paht) const;
+        [[nodiscard]] PathId intern(const QModelIndex& index);
+        [[nodiscard]] NodeHandle handle(const QModelIndex& index);
+        [[nodiscard]] QModelIndex resolve(const NodeHandle& handle) const;
+        [[nodiscard]] QString path(PathId id) const;
+        [[nodiscard]] QString name(PathId id) const;
+        [[nodiscard]] const FileMetadata* metadata(PathId id) const;
+        [[nodiscard]] int duplicateGroup(PathId id) const;
+        [[nodiscard]] FileCategory fileCategory(PathId id) const;
+        [[nodiscard]] GitState gitState(PathId id) const;
+        [[nodiscard]] const QPixmap* thumbnail(PathId id) const;
         [[nodiscard]] bool isReadOnly() const;
+        [[nodiscard]] const SceneSelection& selection() const { return _selection; }
+        void noteSelected(QGraphicsItem* item, bool selected);
+        void noteNode(NodeItem* node);
+        void forgetNode(NodeItem* node);
+        void keepInSceneRect(const QPointF& pos);
+        void fitSceneRectLater();
 
         void setRootPath(const QString& newPath) const;
         void openTo(const QString &targetPath) const;
-        void fetchMore(const QPersistentModelIndex& index) const;
-        qint64 fileSize(const QPersistentModelIndex& index) const;
+        void fetchMore(const QPersistentModelIndex& index,
+            ListingScheduler::Priority priority = ListingScheduler::HighPriority) const;
+        [[nodiscard]] ListingScheduler::Priority listingPriority(const NodeItem* node) const;
+        void requestMetadata(NodeItem* node) const;
+        void requestDiskUsage(NodeItem* node) const;
+        void requestClassification(PathId id) const;
+        void requestFileCategory(PathId id) const;
+        void beginPreview(const NodeItem* node);
+        void endPreview(const NodeItem* node);
 
     public slots:
         void openSelectedNodes() const;
         void closeSelectedNodes() const;
         void halfCloseSelectedNodes() const;
+        void searchSelectedNode();
+        void findDuplicatesInSelectedNode();
         void addSceneBookmark(const QPoint& clickPos, const QString& name);
         void toggleReadOnly();
+        void relaxLayout();
 
     protected:
         void drawBackground(QPainter* p, const QRectF& rec) override;
@@ -58,21 +111,114 @@ namespace core
 
     private slots:
         void onSelectionChange();
-        void onRowsInserted(const QModelIndex& parent, int start, int end) const;
-        void onRowsAboutToBeRemoved(const QModelIndex& parent, int start, int end) const;
-        void onRowsRemoved(const QModelIndex& parent, int start, int end) const;
+        void onRowsInserted(const QModelIndex& parent, int start, int end);
+        void onEntriesAboutToBeRemoved(const QModelIndex& parent, int start, int end);
+        void onRowsAboutToBeRemoved(const QModelIndex& parent, int start, int end);
+        void onRowsRemoved(const QModelIndex& parent, int start, int end);
+        void onListed(const QList<DirListing>& batch);
+        void onMetadataFetched(const QList<FileMetadata>& batch);
+        void onMountReachable(const QString& mount);
+        void onFileTypesClassified(const QList<FileType>& batch);
+        void onGitStatusUpdated(const QStringList& dirs);
+        void onDiskUsageScanned(const QList<DirUsage>& batch);
+        void onTransferProgress(qint64 bytesDone, qint64 bytesTotal, qint64 filesDone, qint64 filesTotal) const;
+        void onFileOperationFailed(const QStringList& errors) const;
+        void onTransferFinished(int mode, qint64 done, qint64 failures, bool cancelled) const;
+        void onPurgeProgress(qint64 removed) const;
+        void onPurgeFinished(qint64 removed, qint64 failures) const;
+        void onDuplicatesProgress(qint64 files, qint64 bytesHashed, qint64 bytesTotal) const;
+        void onDuplicatesFound(const QList<QStringList>& groups);
+        void onThumbnailsReady(const QStringList& paths);
+        void onPreviewReady(const QString& path);
+        void onRelaxed(const QList<QPointF>& positions);
+        void onSourceDataChanged(const QModelIndex& topLeft, const QModelIndex& bottomRight);
 
     private:
         bool openFile(const NodeItem* node) const;
         void deleteSelection();
-        void rotateSelection(Rotation rot, bool page) const;
-        QString gatherStats(const QModelIndexList& indices) const;
+        void rotateSelection(Rotation rot, bool page, bool repeat);
+        void rotatePending();
+        bool beginSeek();
+        bool seekKeyPressEvent(const QKeyEvent* event);
+        void seek();
+        void endSeek();
+        QString gatherStats(const QList<const NodeItem*>& nodes) const;
         void reportStats() const;
+        void postStats() const;
+        void fitSceneRect();
         NodeItem* nodeFromIndex(const QModelIndex& index) const;
+        [[nodiscard]] QList<NodeItem*> nodesOf(PathId id) const;
+        [[nodiscard]] QList<NodeItem*> nodesOf(const QModelIndex& index) const;
+        void showPreview(const Preview& preview);
+        void hidePreview();
+        void evictPaths();
+        void forgetResolved(const QModelIndex& parent) const;
 
         QFileSystemModel* _model{nullptr};
         QSortFilterProxyModel* _proxyModel{nullptr};
-
+        ListingScheduler* _lister{nullptr};
+        MetadataFetcher* _fetcher{nullptr};
+        FileTypeClassifier* _types{nullptr};
+        GitStatus* _git{nullptr};
+        DiskUsage* _du{nullptr};
+        TransferEngine* _transfers{nullptr};
+        Purger* _purger{nullptr};
+        DuplicateFinder* _duplicates{nullptr};
+        Thumbnailer* _thumbnails{nullptr};
+        Previewer* _previewer{nullptr};
+        LayoutRelaxer* _relaxer{nullptr};
+
+        /// the file under the mouse, and where its preview goes.
+        PreviewItem* _preview{nullptr};
+        QString _previewPath;
+        QPointF _previewPos;
+
+        /// classified by the lister, with the latest metadata from the fetcher.
+        MetadataCache _cache;
+        qsizetype _evictAt{EVICT_MIN_PATHS};
+
+        /// the nodes in the scene, by path; what a worker delivers touches
+        /// only the nodes it is about.
+        QMultiHash<PathId, NodeItem*> _nodes;
+
+        /// the directories the model has finished loading once; rows that
+        /// arrive in one of these are a change, not the first fetch.
+        QSet<QString> _populated;
+
+        /// what resolve() found since the rows of the proxy above it last changed.
+        mutable QHash<NodeHandle, QModelIndex> _resolved;
+
+        /// the groups of the last DuplicateFinder search, by file.
+        QHash<PathId, int> _duplicateGroups;
+
+        /// what the classifier made of the files, as it is delivered.
+        QHash<PathId, FileCategory> _fileCategories;
+
+        /// the open folders given to the relaxer, in the order of its bodies,
+        /// and where they were then.
+        struct Relaxing
+        {
+            NodeItem* node;
+            NodeHandle handle;
+            QPointF from;
+        };
+        QList<Relaxing> _relaxing;
+
+        SceneSelection _selection;
         QList<EdgeItem*> _selectedEdges;
+        bool _changingSelection{false};  /// onSelectionChange() deselects edges
+        QTimer* _statsTimer{nullptr};
+        QTimer* _fitTimer{nullptr};
+
+        /// rotations asked for, by A and D held down, and not applied yet.
+        int _pendingRows{0};
+        int _pendingPages{0};
+        QTimer* _rotationTimer{nullptr};
+
+        /// type-to-seek: the directory being seeked in, and what was typed.
+        QPersistentModelIndex _seekParent;
+        QString _seekText;
+        QTimer* _seekTimer{nullptr};
+        QHash<PathId, SeekIndex> _seekIndices;  /// by the directory
     };
 }
@@ -0,0 +1,223 @@
+/// Copyright (C) 2025 Arlen Avakian
+/// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "FileTypes.hpp"
+#include "paths.hpp"
+
+#include <QCache>
+#include <QDateTime>
+#include <QFileInfo>
+#include <QHash>
+#include <QMimeDatabase>
+#include <QMutex>
+#include <QThread>
+#include <QThreadPool>
+
+#include <algorithm>
+#include <atomic>
+
+
+using namespace core;
+using namespace Qt::Literals::StringLiterals;
+
+namespace
+{
+    constexpr int MAX_WORKERS = 2;
+
+    /// results of a large directory are handed over this many at a time.
+    constexpr qsizetype BATCH_SIZE = 256;
+
+    bool inheritsAny(const QMimeType& mime, std::initializer_list<QLatin1StringView> names)
+    {
+        return std::ranges::any_of(names, [&mime](QLatin1StringView name) { return mime.inherits(name); });
+    }
+}
+
+struct FileTypeClassifier::Shared
+{
+    struct Sniffed
+    {
+        qint64 mtime{0};
+        FileCategory category{OtherFile};
+    };
+
+    explicit Shared(std::shared_ptr<Receiver<FileTypeClassifier>> receiver)
+        : receiver(std::move(receiver))
+    {
+    }
+
+    const std::shared_ptr<Receiver<FileTypeClassifier>> receiver;
+    QMutex mutex;
+    QCache<QString, Sniffed> sniffed;
+    QList<FileType> results;
+    bool deliveryQueued{false};
+    std::atomic_bool stopping{false};
+};
+
+FileTypeClassifier::FileTypeClassifier(QObject* parent)
+    : QObject(parent)
+    , _receiver(std::make_shared<Receiver<FileTypeClassifier>>(this))
+    , _shared(std::make_shared<Shared>(_receiver))
+{
+    _shared->sniffed.setMaxCost(MAX_SNIFFED);
+
+    _pool = new QThreadPool();
+    _pool->setMaxThreadCount(MAX_WORKERS);
+    _pool->setThreadPriority(QThread::LowPriority);
+    _pool->setObjectName("surkl-filetype-pool");
+}
+
+FileTypeClassifier::~FileTypeClassifier()
+{
+    _shared->stopping = true;
+    _receiver->detach();
+
+    _pool->clear();
+
+    if (_pool->waitForDone(250)) {
+        delete _pool;
+    }
+}
+
+/// names are the files of dir, as listed; directories are not classified.
+void FileTypeClassifier::classify(const QString& dir, const QStringList& names)
+{
+    if (names.empty()) {
+        return;
+    }
+
+    _pool->start([shared = _shared, dir, names]
+    {
+        QList<FileType> batch;
+        batch.reserve(qMin(names.size(), BATCH_SIZE));
+
+        auto handOver = [&]
+        {
+            QMutexLocker locker(&shared->mutex);
+
+            shared->results.append(std::move(batch));
+            batch.clear();
+
+            if (!shared->deliveryQueued) {
+                shared->deliveryQueued = true;
+                shared->receiver->post([](FileTypeClassifier* e) { e->deliver(); });
+            }
+        };
+
+        for (const auto& name : names) {
+            if (shared->stopping) {
+                return;
+            }
+
+            const auto path = joinPath(dir, name);
+            auto category   = categoryOfName(name);
+
+            if (category == FileCategoryCount) {
+                const auto mtime = QFileInfo(path).lastModified().toMSecsSinceEpoch();
+                {
+                    QMutexLocker locker(&shared->mutex);
+                    if (const auto* found = shared->sniffed.object(path); found != nullptr && found->mtime == mtime) {
+                        category = found->category;
+                    }
+                }
+
+                if (category == FileCategoryCount) {
+                    category = categoryOfContents(path);
+
+                    QMutexLocker locker(&shared->mutex);
+                    shared->sniffed.insert(path, new Sniffed{.mtime = mtime, .category = category});
+                }
+            }
+
+            batch.push_back({.path = path, .category = category});
+
+            if (batch.size() == BATCH_SIZE) {
+                handOver();
+            }
+        }
+
+        if (!batch.empty()) {
+            handOver();
+        }
+    });
+}
+
+/// what a MIME type is drawn as.  Documents are checked before archives,
+/// because the office formats are zip files underneath, and executables
+/// before code, because scripts are text underneath.
+FileCategory FileTypeClassifier::categoryOf(const QMimeType& mime)
+{
+    if (!mime.isValid() || mime.isDefault()) {
+        return OtherFile;
+    }
+
+    const auto name = mime.name();
+
+    if (name.startsWith("image/"_L1)) {
+        return ImageFile;
+    }
+    if (name.startsWith("audio/"_L1)) {
+        return AudioFile;
+    }
+    if (name.startsWith("video/"_L1)) {
+        return VideoFile;
+    }
+    if (inheritsAny(mime, {"application/pdf"_L1, "application/postscript"_L1, "application/epub+zip"_L1,
+            "application/rtf"_L1, "application/msword"_L1, "image/vnd.djvu"_L1})
+        || name.startsWith("application/vnd.oasis.opendocument."_L1)
+        || name.startsWith("application/vnd.openxmlformats-officedocument."_L1)
+        || name.startsWith("application/vnd.ms-"_L1)) {
+        return DocumentFile;
+    }
+    if (inheritsAny(mime, {"application/zip"_L1, "application/x-tar"_L1, "application/gzip"_L1,
+            "application/x-bzip2"_L1, "application/x-xz"_L1, "application/zstd"_L1, "application/x-7z-compressed"_L1,
+            "application/vnd.rar"_L1, "application/x-rpm"_L1, "application/vnd.debian.binary-package"_L1,
+            "application/x-cd-image"_L1})) {
+        return ArchiveFile;
+    }
+    if (inheritsAny(mime, {"application/x-executable"_L1, "application/x-sharedlib"_L1,
+            "application/x-pie-executable"_L1, "application/vnd.microsoft.portable-executable"_L1})) {
+        return ExecutableFile;
+    }
+    if (mime.inherits("text/plain"_L1)) {
+        const auto prose = name == "text/plain"_L1 || name == "text/markdown"_L1
+            || name == "text/x-readme"_L1 || name == "text/x-log"_L1;
+
+        return prose ? TextFile : CodeFile;
+    }
+
+    return OtherFile;
+}
+
+/// the category the name of a file implies, without touching it; or
+/// FileCategoryCount if the name says nothing.
+FileCategory FileTypeClassifier::categoryOfName(const QString& name)
+{
+    static const auto db = QMimeDatabase();
+
+    const auto types = db.mimeTypesForFileName(name);
+
+    return types.empty() ? FileCategoryCount : categoryOf(types.first());
+}
+
+/// reads the first bytes of path; the name isn't looked at.
+FileCategory FileTypeClassifier::categoryOfContents(const QString& path)
+{
+    static const auto db = QMimeDatabase();
+
+    return categoryOf(db.mimeTypeForFile(path, QMimeDatabase::MatchContent));
+}
+
+void FileTypeClassifier::deliver()
+{
+    QList<FileType> batch;
+    {
+        QMutexLocker locker(&_shared->mutex);
+        batch.swap(_shared->results);
+        _shared->deliveryQueued = false;
+    }
+
+    if (!batch.empty()) {
+        emit classified(batch);
+    }
+}
@@ -0,0 +1,80 @@
+/// Copyright (C) 2025 Arlen Avakian
+/// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include "Receiver.hpp"
+
+#include <QObject>
+#include <QStringList>
+
+#include <memory>
+
+
+class QMimeType;
+class QThreadPool;
+
+namespace core
+{
+    enum FileCategory : quint8
+    {
+        OtherFile = 0,
+        TextFile,
+        CodeFile,
+        DocumentFile,
+        ImageFile,
+        AudioFile,
+        VideoFile,
+        ArchiveFile,
+        ExecutableFile,
+
+        FileCategoryCount
+    };
+
+    struct FileType
+    {
+        QString path;
+        FileCategory category{OtherFile};
+    };
+
+    /// Sorts files into a handful of categories, for the color of their node.
+    ///
+    /// A directory is classified as a whole, once it is listed, on a pool of
+    /// low-priority workers, and the results are delivered in batches on the
+    /// GUI thread.  The name is looked up first, which costs no I/O and
+    /// settles nearly every file; only the files whose name says nothing are
+    /// opened, and the first bytes matched against the magic numbers of the
+    /// shared MIME database.  What was sniffed is remembered by path and
+    /// mtime, the most recently used up to a bound, so a directory listed
+    /// again only costs a stat per such file.
+    class FileTypeClassifier final : public QObject
+    {
+        Q_OBJECT
+
+    signals:
+        void classified(const QList<core::FileType>& batch);
+
+    public:
+        /// what was sniffed is dropped, least recently used first, beyond
+        /// this many files.
+        static constexpr qsizetype MAX_SNIFFED = 64 * 1024;
+
+        explicit FileTypeClassifier(QObject* parent = nullptr);
+        ~FileTypeClassifier() override;
+
+        void classify(const QString& dir, const QStringList& names);
+
+        [[nodiscard]] static FileCategory categoryOf(const QMimeType& mime);
+        [[nodiscard]] static FileCategory categoryOfName(const QString& name);
+        [[nodiscard]] static FileCategory categoryOfContents(const QString& path);
+
+    private:
+        struct Shared;
+
+        void deliver();
+
+        QThreadPool* _pool{nullptr};
+        std::shared_ptr<Receiver<FileTypeClassifier>> _receiver;
+        std::shared_ptr<Shared> _shared;
+    };
+}
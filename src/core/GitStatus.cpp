@@ -0,0 +1,955 @@
+/// Copyright (C) 2025 Arlen Avakian
+/// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "GitStatus.hpp"
+#include "paths.hpp"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QMutex>
+#include <QRegularExpression>
+#include <QThread>
+#include <QThreadPool>
+#include <QTimer>
+#include <QtEndian>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <ranges>
+#include <utility>
+#include <vector>
+
+#ifdef Q_OS_LINUX
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+using namespace core;
+
+namespace
+{
+    /// files bigger than this whose stat data changed are taken to be
+    /// modified, rather than hashed.
+    constexpr qint64 HASH_LIMIT = 64 * 1024 * 1024;
+
+    /// how often a long comparison looks whether it should stop.
+    constexpr int CANCEL_CHECK_INTERVAL = 256;
+
+    constexpr quint32 TYPE_MASK    = 0170000;
+    constexpr quint32 TYPE_FILE    = 0100000;
+    constexpr quint32 TYPE_LINK    = 0120000;
+    constexpr quint32 TYPE_DIR     = 0040000;  /// sparse index
+    constexpr quint32 TYPE_GITLINK = 0160000;  /// submodule
+
+    /// the directory of path, the way request() and state() key it.
+    QString parentOf(const QString& path)
+    {
+        const auto slash = path.lastIndexOf(QDir::separator());
+
+        return slash <= 0 ? QString(QDir::separator()) : path.left(slash);
+    }
+
+    /// path relative to root, or a null string if it isn't under it.
+    QString relativeTo(const QString& root, const QString& path)
+    {
+        if (path == root) {
+            return QString("");
+        }
+
+        const auto prefix = root.endsWith(QDir::separator()) ? root : root + QDir::separator();
+
+        return path.startsWith(prefix) ? path.mid(prefix.size()) : QString();
+    }
+
+    quint32 be32(const uchar* p) { return qFromBigEndian<quint32>(p); }
+    quint16 be16(const uchar* p) { return qFromBigEndian<quint16>(p); }
+
+    /// the variable-length integer of index v4: big-endian groups of seven
+    /// bits, each continuation adding one.
+    bool readVarint(const uchar*& p, const uchar* end, quint64& value)
+    {
+        if (p == end) {
+            return false;
+        }
+
+        auto c = *p++;
+        value  = c & 127;
+
+        while (c & 128) {
+            if (p == end) {
+                return false;
+            }
+            c     = *p++;
+            value = ((value + 1) << 7) | (c & 127);
+        }
+
+        return true;
+    }
+
+    std::optional<QList<GitIndexEntry>> parseIndex(const uchar* data, qint64 size, int hashSize)
+    {
+        if (size < 12 + hashSize || std::memcmp(data, "DIRC", 4) != 0) {
+            return std::nullopt;
+        }
+
+        const auto version = be32(data + 4);
+        const auto count   = be32(data + 8);
+
+        if (version < 2 || version > 4) {
+            return std::nullopt;
+        }
+
+        const auto* p   = data + 12;
+        const auto* end = data + size - hashSize;
+        const auto fixed = 40 + hashSize + 2;  /// ten 32-bit fields, the oid, and the flags
+
+        QList<GitIndexEntry> entries;
+        entries.reserve(qMin<qsizetype>(count, (end - p) / fixed));
+        QByteArray previous;
+
+        for (quint32 i = 0; i < count; ++i) {
+            if (end - p < fixed) {
+                return std::nullopt;
+            }
+
+            GitIndexEntry entry;
+            entry.mtimeSec  = be32(p + 8);
+            entry.mtimeNsec = be32(p + 12);
+            entry.ino       = be32(p + 20);
+            entry.mode      = be32(p + 24);
+            entry.size      = be32(p + 36);
+            entry.oid       = QByteArray(reinterpret_cast<const char*>(p + 40), hashSize);
+            entry.flags     = be16(p + 40 + hashSize);
+
+            const auto* q = p + fixed;
+
+            if (entry.flags & GitIndexEntry::EXTENDED) {
+                if (version < 3 || end - q < 2) {
+                    return std::nullopt;
+                }
+                entry.extendedFlags = be16(q);
+                q += 2;
+            }
+
+            if (version == 4) {
+                /// the path is what is left of the previous one after
+                /// dropping its last n bytes, and then the bytes up to NUL.
+                quint64 strip = 0;
+                if (!readVarint(q, end, strip) || strip > static_cast<quint64>(previous.size())) {
+                    return std::nullopt;
+                }
+
+                const auto* nul = static_cast<const uchar*>(std::memchr(q, 0, end - q));
+                if (nul == nullptr) {
+                    return std::nullopt;
+                }
+
+                previous.chop(static_cast<qsizetype>(strip));
+                previous.append(reinterpret_cast<const char*>(q), nul - q);
+                entry.path = previous;
+                q = nul + 1;
+            } else {
+                const auto* nul = static_cast<const uchar*>(std::memchr(q, 0, end - q));
+                if (nul == nullptr) {
+                    return std::nullopt;
+                }
+
+                /// NUL padded to a multiple of eight bytes, with at least one.
+                const auto length = ((nul - p) + 8) & ~qint64(7);
+                if (end - p < length) {
+                    return std::nullopt;
+                }
+
+                entry.path = QByteArray(reinterpret_cast<const char*>(q), nul - q);
+                q = p + length;
+            }
+
+            entries.push_back(std::move(entry));
+            p = q;
+        }
+
+        /// the entries of a split index are in another file.
+        while (end - p >= 8) {
+            const auto extensionSize = be32(p + 4);
+
+            if (std::memcmp(p, "link", 4) == 0) {
+                return std::nullopt;
+            }
+            if (static_cast<quint64>(end - p - 8) < extensionSize) {
+                break;
+            }
+            p += 8 + extensionSize;
+        }
+
+        return entries;
+    }
+
+    bool pathLess(const GitIndexEntry& entry, const QByteArray& path)
+    {
+        return entry.path < path;
+    }
+
+    /// what comes right after every path that starts with prefix.
+    QByteArray prefixEnd(QByteArray prefix)
+    {
+        Q_ASSERT(prefix.endsWith('/'));
+        prefix.back() = '/' + 1;
+
+        return prefix;
+    }
+
+    struct IgnoreRule
+    {
+        QRegularExpression re;
+        QString base;           /// the directory of the .gitignore, relative to the work tree
+        bool negate{false};
+        bool dirOnly{false};
+        bool hasSlash{false};   /// matched against the path, not the name
+    };
+
+    /// gitignore globs: * and ? don't match a slash, ** matches any number of
+    /// directories, and [...] is a class.
+    QString globToRegex(QStringView glob)
+    {
+        QString result = "^";
+
+        for (qsizetype i = 0; i < glob.size(); ++i) {
+            const auto c = glob[i];
+
+            if (c == '*') {
+                if (i + 1 < glob.size() && glob[i + 1] == '*') {
+                    const auto atStart = i == 0 || glob[i - 1] == '/';
+
+                    if (atStart && i + 2 < glob.size() && glob[i + 2] == '/') {
+                        result += "(?:.*/)?";
+                        i += 2;
+                    } else {
+                        result += ".*";
+                        i += 1;
+                    }
+                } else {
+                    result += "[^/]*";
+                }
+            } else if (c == '?') {
+                result += "[^/]";
+            } else if (c == '[') {
+                const auto close = glob.indexOf(u']', i + 2);
+
+                if (close < 0) {
+                    result += "\\[";
+                } else {
+                    auto set = glob.sliced(i + 1, close - i - 1).toString();
+                    if (set.startsWith('!')) {
+                        set[0] = '^';
+                    }
+                    result += '[' + set.replace("\\", "\\\\") + ']';
+                    i = close;
+                }
+            } else if (c == '\\' && i + 1 < glob.size()) {
+                result += QRegularExpression::escape(glob.sliced(++i, 1));
+            } else {
+                result += QRegularExpression::escape(glob.sliced(i, 1));
+            }
+        }
+
+        return result + '$';
+    }
+
+    QList<IgnoreRule> parseIgnoreFile(const QByteArray& contents, const QString& base)
+    {
+        QList<IgnoreRule> rules;
+
+        for (const auto& raw : contents.split('\n')) {
+            auto line = QString::fromUtf8(raw);
+
+            if (line.endsWith('\r')) {
+                line.chop(1);
+            }
+            while (line.endsWith(' ') && !line.endsWith("\\ ")) {
+                line.chop(1);
+            }
+            if (line.isEmpty() || line.startsWith('#')) {
+                continue;
+            }
+
+            IgnoreRule rule{.base = base};
+
+            if (line.startsWith('!')) {
+                rule.negate = true;
+                line.remove(0, 1);
+            } else if (line.startsWith("\\!") || line.startsWith("\\#")) {
+                line.remove(0, 1);
+            }
+            if (line.endsWith('/')) {
+                rule.dirOnly = true;
+                line.chop(1);
+            }
+            rule.hasSlash = line.contains('/');
+            if (line.startsWith('/')) {
+                line.remove(0, 1);
+            }
+            if (line.isEmpty()) {
+                continue;
+            }
+
+            rule.re = QRegularExpression(globToRegex(line));
+            if (rule.re.isValid()) {
+                rules.push_back(std::move(rule));
+            }
+        }
+
+        return rules;
+    }
+
+    /// the last rule that matches decides; relPath is relative to the work
+    /// tree.
+    bool isIgnored(const QList<IgnoreRule>& rules, const QString& relPath, bool isDir)
+    {
+        const auto name = relPath.mid(relPath.lastIndexOf('/') + 1);
+
+        for (const auto& rule : rules | std::views::reverse) {
+            if (rule.dirOnly && !isDir) {
+                continue;
+            }
+
+            QString subject;
+            if (!rule.hasSlash) {
+                subject = name;
+            } else if (rule.base.isEmpty()) {
+                subject = relPath;
+            } else if (relPath.startsWith(rule.base + '/')) {
+                subject = relPath.mid(rule.base.size() + 1);
+            } else {
+                continue;
+            }
+
+            if (rule.re.match(subject).hasMatch()) {
+                return !rule.negate;
+            }
+        }
+
+        return false;
+    }
+}
+
+struct GitStatus::Shared
+{
+    struct Result
+    {
+        QString dir;
+        QString gitDir;
+        QHash<QString, GitState> states;
+    };
+
+    explicit Shared(std::shared_ptr<Receiver<GitStatus>> receiver)
+        : receiver(std::move(receiver))
+    {
+    }
+
+    const std::shared_ptr<Receiver<GitStatus>> receiver;
+    QMutex mutex;
+    QList<Result> results;
+    bool deliveryQueued{false};
+    std::atomic_bool stopping{false};
+
+#ifdef Q_OS_LINUX
+    /// the rest is only touched by the worker; there is one.
+    struct WorkTree
+    {
+        QString root;
+        QString gitDir;
+        int hashSize{20};
+        bool trustExecutableBit{true};
+
+        struct timespec indexMtime{};
+        ino_t indexIno{0};
+        off_t indexSize{-1};
+        bool indexValid{false};
+        std::vector<GitIndexEntry> entries;  /// sorted by path, as in the file
+
+        /// whether a tracked entry under a directory, by its prefix, is
+        /// modified; until the index is read again, or anything in the work
+        /// tree or its git dir is said to have changed.  A file can change
+        /// deep down without any directory on the way changing, so a change
+        /// anywhere drops all of it.
+        struct Subtree
+        {
+            ino_t ino{0};
+            bool modified{false};
+        };
+        QHash<QByteArray, Subtree> subtrees;
+    };
+
+    struct IgnoreFile
+    {
+        struct timespec mtime{};
+        off_t size{-1};
+        QList<IgnoreRule> rules;
+    };
+
+    QHash<QString, std::shared_ptr<WorkTree>> workTrees;  /// by git dir
+    QHash<QString, IgnoreFile> ignoreFiles;
+
+    std::shared_ptr<WorkTree> workTreeOf(const QString& dir);
+    void refreshIndex(WorkTree& tree);
+    QList<IgnoreRule> ignoreRules(const QString& file, const QString& base);
+    bool isModified(const WorkTree& tree, const GitIndexEntry& entry);
+    bool anyModified(WorkTree& tree, const QByteArray& prefix);
+    void forget(const QString& dir);
+    Result look(const QString& dir);
+#endif
+};
+
+#ifdef Q_OS_LINUX
+namespace
+{
+    bool sameTime(const struct timespec& a, const struct timespec& b)
+    {
+        return a.tv_sec == b.tv_sec && a.tv_nsec == b.tv_nsec;
+    }
+
+    /// the git dir a .git file points to, as in worktrees and submodules.
+    QString readGitFile(const QString& file)
+    {
+        auto f = QFile(file);
+
+        if (!f.open(QIODevice::ReadOnly)) {
+            return {};
+        }
+
+        const auto line = QString::fromUtf8(f.readLine(4096)).trimmed();
+
+        if (!line.startsWith("gitdir:")) {
+            return {};
+        }
+
+        const auto target = line.mid(7).trimmed();
+
+        return QDir::cleanPath(QDir::isAbsolutePath(target) ? target : joinPath(QFileInfo(file).path(), target));
+    }
+
+    /// git's own hash of the contents, "blob <size>\0" and then the bytes.
+    bool sameContents(const GitIndexEntry& entry, const QByteArray& path, const struct stat& st, int hashSize)
+    {
+        if (st.st_size > HASH_LIMIT) {
+            return false;
+        }
+
+        auto hash = QCryptographicHash(hashSize == 32 ? QCryptographicHash::Sha256 : QCryptographicHash::Sha1);
+
+        if (S_ISLNK(st.st_mode)) {
+            QByteArray target(st.st_size + 1, Qt::Uninitialized);
+            const auto length = ::readlink(path.constData(), target.data(), target.size());
+            if (length < 0) {
+                return false;
+            }
+            target.truncate(length);
+            hash.addData("blob " + QByteArray::number(length) + '\0');
+            hash.addData(target);
+        } else {
+            auto file = QFile(QFile::decodeName(path));
+            if (!file.open(QIODevice::ReadOnly)) {
+                return false;
+            }
+            hash.addData("blob " + QByteArray::number(qint64(st.st_size)) + '\0');
+            if (!hash.addData(&file)) {
+                return false;
+            }
+        }
+
+        return hash.result() == entry.oid;
+    }
+}
+
+/// the work tree dir is in, or nullptr; the nearest .git up from dir wins,
+/// so a submodule is a work tree of its own.
+std::shared_ptr<GitStatus::Shared::WorkTree> GitStatus::Shared::workTreeOf(const QString& dir)
+{
+    auto current = QDir::cleanPath(dir);
+
+    while (true) {
+        const auto dotGit = joinPath(current, ".git");
+        struct stat st{};
+
+        if (::stat(QFile::encodeName(dotGit).constData(), &st) == 0) {
+            const auto gitDir = S_ISDIR(st.st_mode) ? dotGit : readGitFile(dotGit);
+
+            if (gitDir.isEmpty()) {
+                return nullptr;
+            }
+            if (const auto found = workTrees.constFind(gitDir); found != workTrees.cend()) {
+                return found.value();
+            }
+
+            auto tree = std::make_shared<WorkTree>();
+            tree->root   = current;
+            tree->gitDir = gitDir;
+
+            /// only what changes how the work tree is compared.
+            if (auto config = QFile(joinPath(gitDir, "config")); config.open(QIODevice::ReadOnly)) {
+                for (const auto& raw : config.readAll().split('\n')) {
+                    const auto line = raw.trimmed().toLower().replace(' ', "").replace('\t', "");
+                    if (line == "objectformat=sha256") {
+                        tree->hashSize = 32;
+                    } else if (line == "filemode=false") {
+                        tree->trustExecutableBit = false;
+                    }
+                }
+            }
+
+            workTrees.insert(gitDir, tree);
+            return tree;
+        }
+
+        if (current == QDir::rootPath()) {
+            return nullptr;
+        }
+        current = parentOf(current);
+    }
+}
+
+/// reads the index again if it changed since the last time.
+void GitStatus::Shared::refreshIndex(WorkTree& tree)
+{
+    const auto file = QFile::encodeName(joinPath(tree.gitDir, "index"));
+    struct stat st{};
+
+    if (::stat(file.constData(), &st) != 0) {
+        /// a fresh repository has no index; everything is untracked.
+        tree.entries.clear();
+        tree.indexValid = true;
+        tree.indexSize  = -1;
+        return;
+    }
+
+    if (tree.indexSize == st.st_size && tree.indexIno == st.st_ino && sameTime(tree.indexMtime, st.st_mtim)) {
+        return;
+    }
+
+    tree.indexMtime = st.st_mtim;
+    tree.indexIno   = st.st_ino;
+    tree.indexSize  = st.st_size;
+
+    tree.subtrees.clear();
+
+    if (auto entries = readIndex(QFile::decodeName(file), tree.hashSize)) {
+        tree.entries    = std::vector<GitIndexEntry>(entries->cbegin(), entries->cend());
+        tree.indexValid = true;
+    } else {
+        tree.entries.clear();
+        tree.indexValid = false;
+    }
+}
+
+QList<IgnoreRule> GitStatus::Shared::ignoreRules(const QString& file, const QString& base)
+{
+    auto& cached = ignoreFiles[file];
+    struct stat st{};
+
+    if (::stat(QFile::encodeName(file).constData(), &st) != 0) {
+        cached = {};
+        return cached.rules;
+    }
+
+    if (cached.size != st.st_size || !sameTime(cached.mtime, st.st_mtim)) {
+        auto f = QFile(file);
+        cached.mtime = st.st_mtim;
+        cached.size  = st.st_size;
+        cached.rules = f.open(QIODevice::ReadOnly) ? parseIgnoreFile(f.readAll(), base) : QList<IgnoreRule>();
+    }
+
+    return cached.rules;
+}
+
+/// what git status would say of a tracked entry.  Stat data that matches
+/// the index is trusted, unless the entry is racily clean: changed within
+/// the same tick the index was written in.
+bool GitStatus::Shared::isModified(const WorkTree& tree, const GitIndexEntry& entry)
+{
+    if (entry.stage() != 0 || (entry.extendedFlags & GitIndexEntry::INTENT_TO_ADD)) {
+        return true;
+    }
+    if ((entry.extendedFlags & GitIndexEntry::SKIP_WORKTREE) || (entry.flags & GitIndexEntry::ASSUME_VALID)) {
+        return false;
+    }
+
+    const auto type = entry.mode & TYPE_MASK;
+
+    if (type == TYPE_GITLINK || type == TYPE_DIR) {
+        return false;
+    }
+
+    const auto path = QFile::encodeName(joinPath(tree.root, QString::fromUtf8(entry.path)));
+    struct stat st{};
+
+    if (::lstat(path.constData(), &st) != 0) {
+        return true;
+    }
+    if (type == TYPE_LINK ? !S_ISLNK(st.st_mode) : !S_ISREG(st.st_mode)) {
+        return true;
+    }
+    if (type == TYPE_FILE && tree.trustExecutableBit && ((entry.mode ^ st.st_mode) & S_IXUSR)) {
+        return true;
+    }
+    if (static_cast<quint32>(st.st_size) != entry.size) {
+        return true;
+    }
+
+    const auto sameStat = static_cast<quint32>(st.st_mtim.tv_sec) == entry.mtimeSec
+        && (entry.mtimeNsec == 0 || static_cast<quint32>(st.st_mtim.tv_nsec) == entry.mtimeNsec)
+        && (entry.ino == 0 || static_cast<quint32>(st.st_ino) == entry.ino);
+
+    const auto indexSec  = static_cast<quint32>(tree.indexMtime.tv_sec);
+    const auto indexNsec = static_cast<quint32>(tree.indexMtime.tv_nsec);
+    const auto racy = entry.mtimeSec > indexSec || (entry.mtimeSec == indexSec && entry.mtimeNsec >= indexNsec);
+
+    if (sameStat && !racy) {
+        return false;
+    }
+
+    return !sameContents(entry, path, st, tree.hashSize);
+}
+
+/// looked up in tree.subtrees first; a look at the top of a large work tree
+/// would otherwise lstat every entry of the index each time.
+bool GitStatus::Shared::anyModified(WorkTree& tree, const QByteArray& prefix)
+{
+    struct stat st{};
+
+    if (::lstat(QFile::encodeName(joinPath(tree.root, QString::fromUtf8(prefix))).constData(), &st) != 0) {
+        st.st_ino = 0;
+    }
+    if (const auto found = tree.subtrees.constFind(prefix); found != tree.subtrees.cend() && found->ino == st.st_ino) {
+        return found->modified;
+    }
+
+    const auto first = std::lower_bound(tree.entries.cbegin(), tree.entries.cend(), prefix, pathLess);
+    const auto last  = std::lower_bound(first, tree.entries.cend(), prefixEnd(prefix), pathLess);
+
+    int checked = 0;
+
+    for (auto it = first; it != last; ++it) {
+        if (++checked % CANCEL_CHECK_INTERVAL == 0 && stopping) {
+            return false;
+        }
+        if (isModified(tree, *it)) {
+            tree.subtrees.insert(prefix, {.ino = st.st_ino, .modified = true});
+            return true;
+        }
+    }
+
+    tree.subtrees.insert(prefix, {.ino = st.st_ino, .modified = false});
+    return false;
+}
+
+/// dir, a directory of a work tree or a git dir, changed: whether anything
+/// is modified is worked out again for the whole of its work tree.
+void GitStatus::Shared::forget(const QString& dir)
+{
+    const auto clean = QDir::cleanPath(dir);
+
+    for (const auto& tree : std::as_const(workTrees)) {
+        if (tree->gitDir == clean || !relativeTo(tree->root, clean).isNull()) {
+            tree->subtrees.clear();
+        }
+    }
+}
+
+GitStatus::Shared::Result GitStatus::Shared::look(const QString& dir)
+{
+    auto result = Result{.dir = dir};
+    const auto tree = workTreeOf(dir);
+
+    if (tree == nullptr) {
+        return result;
+    }
+
+    const auto rel = relativeTo(tree->root, QDir::cleanPath(dir));
+
+    /// inside .git itself, or out of reach.
+    if (rel.isNull() || rel == ".git" || rel.startsWith(".git/")
+        || dir == tree->gitDir || dir.startsWith(tree->gitDir + '/')) {
+        return result;
+    }
+
+    refreshIndex(*tree);
+
+    if (!tree->indexValid) {
+        return result;
+    }
+
+    result.gitDir = tree->gitDir;
+
+    /// the rules from the top down to dir; on the way down, a directory that
+    /// is ignored takes everything under it along.
+    auto rules = ignoreRules(joinPath(tree->gitDir, "info/exclude"), QString());
+    auto dirIgnored = false;
+
+    rules.append(ignoreRules(joinPath(tree->root, ".gitignore"), QString()));
+
+    if (!rel.isEmpty()) {
+        QString partial;
+
+        for (const auto& part : rel.split('/')) {
+            partial = partial.isEmpty() ? part : partial + '/' + part;
+
+            if (isIgnored(rules, partial, true)) {
+                dirIgnored = true;
+                break;
+            }
+            rules.append(ignoreRules(joinPath(joinPath(tree->root, partial), ".gitignore"), partial));
+        }
+    }
+
+    auto* d = ::opendir(QFile::encodeName(dir).constData());
+
+    if (d == nullptr) {
+        return result;
+    }
+
+    const auto prefix = rel.isEmpty() ? QByteArray() : rel.toUtf8() + '/';
+
+    while (const auto* ent = ::readdir(d)) {
+        if (stopping) {
+            break;
+        }
+
+        const auto rawName = QByteArray(ent->d_name);
+
+        if (rawName == "." || rawName == ".." || rawName == ".git") {
+            continue;
+        }
+
+        auto isDir = ent->d_type == DT_DIR;
+
+        if (ent->d_type == DT_UNKNOWN) {
+            struct stat st{};
+            isDir = ::lstat(QFile::encodeName(joinPath(dir, QFile::decodeName(rawName))).constData(), &st) == 0
+                && S_ISDIR(st.st_mode);
+        }
+
+        const auto name    = QFile::decodeName(rawName);
+        const auto relPath = prefix + rawName;
+        auto state         = GitUntracked;
+
+        const auto found = std::lower_bound(tree->entries.cbegin(), tree->entries.cend(), relPath, pathLess);
+        const auto exact = found != tree->entries.cend() && found->path == relPath;
+
+        if (exact) {
+            /// a file, a link, a submodule, or a sparse directory.
+            state = isModified(*tree, *found) ? GitModified : GitClean;
+        } else if (isDir) {
+            const auto sub  = relPath + '/';
+            const auto next = std::lower_bound(found, tree->entries.cend(), sub, pathLess);
+
+            if (next != tree->entries.cend() && next->path.startsWith(sub)) {
+                state = anyModified(*tree, sub) ? GitModified : GitClean;
+            }
+        }
+
+        if (state == GitUntracked && (dirIgnored || isIgnored(rules, QString::fromUtf8(relPath), isDir))) {
+            state = GitIgnored;
+        }
+
+        result.states.insert(name, state);
+    }
+
+    ::closedir(d);
+
+    return result;
+}
+#endif
+
+GitStatus::GitStatus(QObject* parent)
+    : QObject(parent)
+    , _receiver(std::make_shared<Receiver<GitStatus>>(this))
+    , _shared(std::make_shared<Shared>(_receiver))
+{
+    /// lstat() of a work tree on a hung mount blocks; the pool has no parent
+    /// so that it can be left to it.
+    _pool = new QThreadPool();
+    _pool->setMaxThreadCount(1);
+    _pool->setThreadPriority(QThread::LowPriority);
+    _pool->setObjectName("surkl-git-pool");
+
+    _results.setMaxCost(MAX_RESULTS);
+
+    _watcher = new QFileSystemWatcher(this);
+    connect(_watcher, &QFileSystemWatcher::directoryChanged, this, [this](const QString& gitDir)
+    {
+        _changedGitDirs.insert(gitDir);
+        _refreshTimer->start();
+    });
+
+    /// a commit touches .git many times over; they are taken as one.
+    _refreshTimer = new QTimer(this);
+    _refreshTimer->setSingleShot(true);
+    _refreshTimer->setInterval(REFRESH_DELAY);
+    connect(_refreshTimer, &QTimer::timeout, this, &GitStatus::refreshWorkTrees);
+}
+
+GitStatus::~GitStatus()
+{
+    _shared->stopping = true;
+    _receiver->detach();
+
+    _pool->clear();
+
+    if (_pool->waitForDone(250)) {
+        delete _pool;
+    }
+}
+
+/// the state of path is wanted; the whole of its directory is looked at,
+/// once, and updated() is emitted when it has been.
+void GitStatus::request(const QString& path)
+{
+    if (const auto dir = parentOf(path); !_results.contains(dir) && !_pending.contains(dir)) {
+        schedule(dir);
+    }
+}
+
+/// the entries of dir changed; it is looked at again, and so are the
+/// directories above it in the same work tree, since a folder is modified
+/// if anything under it is.  The old states are shown until then.
+void GitStatus::invalidate(const QString& dir)
+{
+#ifdef Q_OS_LINUX
+    /// queued ahead of the looks below; the pool has one worker.
+    _pool->start([shared = _shared, dir] { shared->forget(dir); });
+#endif
+
+    for (auto current = dir;; current = parentOf(current)) {
+        if (const auto* found = _results.object(current); found != nullptr
+                && (current == dir || !found->gitDir.isEmpty())) {
+            schedule(current);
+        }
+        if (current == QDir::rootPath()) {
+            break;
+        }
+    }
+}
+
+GitState GitStatus::state(const QString& path) const
+{
+    if (const auto* found = _results.object(parentOf(path))) {
+        return found->states.value(path.mid(path.lastIndexOf(QDir::separator()) + 1), NotInGit);
+    }
+
+    return NotInGit;
+}
+
+std::optional<QList<GitIndexEntry>> GitStatus::readIndex(const QString& file, int hashSize)
+{
+    auto f = QFile(file);
+
+    if (!f.open(QIODevice::ReadOnly) || f.size() == 0) {
+        return std::nullopt;
+    }
+
+    auto* data = f.map(0, f.size());
+
+    if (data == nullptr) {
+        return std::nullopt;
+    }
+
+    auto result = parseIndex(data, f.size(), hashSize);
+    f.unmap(data);
+
+    return result;
+}
+
+void GitStatus::schedule(const QString& dir)
+{
+    if (_pending.contains(dir)) {
+        /// the worker may have read it already.
+        _stale.insert(dir);
+        return;
+    }
+
+    _pending.insert(dir);
+
+#ifdef Q_OS_LINUX
+    _pool->start([shared = _shared, dir]
+    {
+        if (shared->stopping) {
+            return;
+        }
+
+        auto result = shared->look(dir);
+
+        QMutexLocker locker(&shared->mutex);
+
+        shared->results.push_back(std::move(result));
+
+        if (!shared->deliveryQueued) {
+            shared->deliveryQueued = true;
+            shared->receiver->post([](GitStatus* e) { e->deliver(); });
+        }
+    });
+#else
+    {
+        QMutexLocker locker(&_shared->mutex);
+        _shared->results.push_back({.dir = dir});
+    }
+    QMetaObject::invokeMethod(this, &GitStatus::deliver, Qt::QueuedConnection);
+#endif
+}
+
+void GitStatus::deliver()
+{
+    QList<Shared::Result> batch;
+    {
+        QMutexLocker locker(&_shared->mutex);
+        batch.swap(_shared->results);
+        _shared->deliveryQueued = false;
+    }
+
+    QStringList dirs;
+    dirs.reserve(batch.size());
+
+    for (auto& [dir, gitDir, states] : batch) {
+        _pending.remove(dir);
+
+        if (!gitDir.isEmpty() && !_watcher->directories().contains(gitDir)) {
+            _watcher->addPath(gitDir);
+        }
+
+        const auto cost = 1 + states.size();
+        _results.insert(dir, new DirResult{.dir = dir, .gitDir = gitDir, .states = std::move(states)}, cost);
+        dirs.push_back(dir);
+
+        if (_stale.remove(dir)) {
+            schedule(dir);
+        }
+    }
+
+    if (!dirs.empty()) {
+        emit updated(dirs);
+    }
+}
+
+/// something was committed, added, or checked out.
+void GitStatus::refreshWorkTrees()
+{
+    const auto changed = std::exchange(_changedGitDirs, {});
+
+#ifdef Q_OS_LINUX
+    /// queued ahead of the looks below; the pool has one worker.
+    for (const auto& gitDir : changed) {
+        _pool->start([shared = _shared, gitDir] { shared->forget(gitDir); });
+    }
+#endif
+
+    for (const auto& dir : _results.keys()) {
+        if (const auto* found = _results.object(dir); found != nullptr && changed.contains(found->gitDir)) {
+            schedule(dir);
+        }
+    }
+}
@@ -0,0 +1,122 @@
+/// Copyright (C) 2025 Arlen Avakian
+/// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include "Receiver.hpp"
+
+#include <QCache>
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QStringList>
+
+#include <memory>
+#include <optional>
+
+
+class QFileSystemWatcher;
+class QThreadPool;
+class QTimer;
+
+namespace core
+{
+    enum GitState : quint8
+    {
+        NotInGit = 0,
+        GitClean,
+        GitModified,   /// a folder is modified if a tracked file under it is
+        GitUntracked,
+        GitIgnored
+    };
+
+    /// an entry of .git/index, as it is on disk.
+    struct GitIndexEntry
+    {
+        static constexpr quint16 ASSUME_VALID  = 0x8000;
+        static constexpr quint16 EXTENDED      = 0x4000;
+        static constexpr quint16 STAGE_MASK    = 0x3000;
+        static constexpr quint16 SKIP_WORKTREE = 0x4000;  /// of extendedFlags
+        static constexpr quint16 INTENT_TO_ADD = 0x2000;  /// of extendedFlags
+
+        QByteArray path;  /// relative to the work tree
+        QByteArray oid;
+        quint32 mtimeSec{0};
+        quint32 mtimeNsec{0};
+        quint32 ino{0};
+        quint32 mode{0};
+        quint32 size{0};  /// truncated to 32 bits
+        quint16 flags{0};
+        quint16 extendedFlags{0};
+
+        [[nodiscard]] int stage() const { return (flags & STAGE_MASK) >> 12; }
+    };
+
+    /// The git status of what the scene shows, without running git.
+    ///
+    /// A directory is looked at as a whole, on a single background worker.
+    /// The index of its work tree is mapped and parsed once, and again only
+    /// when it changes on disk; versions 2 to 4 are read, split indices
+    /// aren't.  Each entry of the directory is then compared with the index
+    /// the way git does it: by its stat data, and, if that changed but the
+    /// size didn't, or if the entry is racily clean, by the hash of its
+    /// contents.  A folder is modified if a tracked file under it is.
+    /// Untracked entries are matched against .git/info/exclude and the
+    /// .gitignore files from the top of the work tree down; the global
+    /// excludes file of the user isn't read.
+    ///
+    /// Results are kept per directory, the most recently used up to a bound
+    /// on the entries they hold.  A directory is looked at again when
+    /// invalidate() says it changed, which the scene does from the model's
+    /// watcher, and all the directories of a work tree when its .git
+    /// directory changes (commit, add, checkout), which is watched here.
+    /// Whether anything under a folder is modified is kept on the worker
+    /// too, and dropped for the whole work tree on any of those changes.
+    /// Only on Linux, for now; elsewhere everything is NotInGit.
+    class GitStatus final : public QObject
+    {
+        Q_OBJECT
+
+    signals:
+        void updated(const QStringList& dirs);
+
+    public:
+        static constexpr int REFRESH_DELAY = 250;
+        /// the results are dropped, least recently used first, beyond this
+        /// many entries.
+        static constexpr qsizetype MAX_RESULTS = 256 * 1024;
+
+        explicit GitStatus(QObject* parent = nullptr);
+        ~GitStatus() override;
+
+        void request(const QString& path);
+        void invalidate(const QString& dir);
+        [[nodiscard]] GitState state(const QString& path) const;
+
+        [[nodiscard]] static std::optional<QList<GitIndexEntry>> readIndex(const QString& file, int hashSize = 20);
+
+    private:
+        struct Shared;
+        struct DirResult
+        {
+            QString dir;
+            QString gitDir;  /// empty if dir isn't in a work tree
+            QHash<QString, GitState> states;
+        };
+
+        void schedule(const QString& dir);
+        void deliver();
+        void refreshWorkTrees();
+
+        QThreadPool* _pool{nullptr};
+        QFileSystemWatcher* _watcher{nullptr};
+        QTimer* _refreshTimer{nullptr};
+        std::shared_ptr<Receiver<GitStatus>> _receiver;
+        std::shared_ptr<Shared> _shared;
+
+        QCache<QString, DirResult> _results;  /// by directory; cost is 1 + the entries
+        QSet<QString> _pending;              /// scheduled, not delivered yet
+        QSet<QString> _stale;                /// changed since they were scheduled
+        QSet<QString> _changedGitDirs;
+    };
+}
@@ -0,0 +1,314 @@
+/// Copyright (C) 2025 Arlen Avakian
+/// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "LayoutRelaxer.hpp"
+
+#include <QThread>
+#include <QThreadPool>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <ranges>
+#include <vector>
+
+
+using namespace core;
+
+namespace
+{
+    constexpr qreal REPULSION = 1.0;
+    constexpr qreal SPRING    = 0.2;
+    constexpr qreal COLLISION = 0.5;
+    constexpr qreal MAX_STEP  = 64.0;
+    constexpr qreal SETTLED   = 0.25;  /// the largest step, once it is done
+    constexpr int MAX_DEPTH   = 32;    /// bodies at the same spot share a leaf
+
+    struct Cell
+    {
+        QPointF center;
+        qreal half{0};
+        qreal mass{0};
+        QPointF weighted;    /// the sum of mass * pos
+        qreal maxRadius{0};
+        int count{0};
+        int body{-1};        /// of a leaf with a single body
+        std::array<int, 4> children{-1, -1, -1, -1};
+
+        [[nodiscard]] bool isLeaf() const
+        {
+            return std::ranges::all_of(children, [](int c) { return c == -1; });
+        }
+    };
+
+    /// large subtrees push harder.
+    qreal massOf(const LayoutBody& body)
+    {
+        return std::max(body.radius, 1.0);
+    }
+
+    class QuadTree
+    {
+    public:
+        QuadTree(const QList<LayoutBody>& bodies, const std::vector<QPointF>& pos)
+            : _bodies(bodies)
+            , _pos(pos)
+        {
+            auto [minX, maxX] = std::ranges::minmax(pos | std::views::transform(&QPointF::x));
+            auto [minY, maxY] = std::ranges::minmax(pos | std::views::transform(&QPointF::y));
+
+            _cells.reserve(pos.size() * 2);
+            _cells.push_back({
+                .center = QPointF((minX + maxX) / 2, (minY + maxY) / 2),
+                .half   = std::max(maxX - minX, maxY - minY) / 2 + 1});
+
+            for (int i = 0; i < std::ssize(pos); ++i) {
+                insert(i);
+            }
+        }
+
+        /// the push on body i, by every other body.
+        [[nodiscard]] QPointF push(int i) const
+        {
+            auto disp = QPointF();
+            visit(0, i, disp);
+            return disp;
+        }
+
+    private:
+        void add(int c, int body)
+        {
+            const auto mass = massOf(_bodies[body]);
+
+            _cells[c].mass     += mass;
+            _cells[c].weighted += _pos[body] * mass;
+            _cells[c].maxRadius = std::max(_cells[c].maxRadius, _bodies[body].radius);
+            _cells[c].count    += 1;
+        }
+
+        int childOf(int c, const QPointF& p)
+        {
+            const auto q = (p.x() >= _cells[c].center.x() ? 1 : 0) + (p.y() >= _cells[c].center.y() ? 2 : 0);
+
+            if (_cells[c].children[q] == -1) {
+                const auto half   = _cells[c].half / 2;
+                const auto center = _cells[c].center + QPointF(q & 1 ? half : -half, q & 2 ? half : -half);
+
+                _cells[c].children[q] = static_cast<int>(_cells.size());
+                _cells.push_back({.center = center, .half = half});
+            }
+
+            return _cells[c].children[q];
+        }
+
+        void insert(int body)
+        {
+            for (int c = 0, depth = 0; ; ++depth) {
+                add(c, body);
+
+                if (_cells[c].count == 1) {
+                    _cells[c].body = body;
+                    return;
+                }
+                if (depth == MAX_DEPTH) {
+                    _cells[c].body = -1;
+                    return;
+                }
+                if (const auto other = _cells[c].body; other != -1) {
+                    _cells[c].body = -1;
+                    const auto child = childOf(c, _pos[other]);
+                    add(child, other);
+                    _cells[child].body = other;
+                }
+
+                c = childOf(c, _pos[body]);
+            }
+        }
+
+        /// a body and its parent are kept at the length of their edge by
+        /// the spring alone; they overlap by design.
+        [[nodiscard]] bool linked(int a, int b) const
+        {
+            return _bodies[a].parent == b || _bodies[b].parent == a;
+        }
+
+        void visit(int c, int i, QPointF& disp) const
+        {
+            const auto& cell = _cells[c];
+
+            if (cell.count == 0 || cell.body == i) {
+                return;
+            }
+
+            const auto r    = _bodies[i].radius;
+            const auto com  = cell.weighted / cell.mass;
+            auto d          = _pos[i] - com;
+            auto dist       = std::hypot(d.x(), d.y());
+            const auto leaf = cell.isLeaf();
+            const auto far  = dist > cell.maxRadius + r + LayoutRelaxer::GAP
+                && cell.half * 2 < LayoutRelaxer::THETA * dist;
+
+            if (!leaf && !far) {
+                for (const auto child : cell.children) {
+                    if (child != -1) {
+                        visit(child, i, disp);
+                    }
+                }
+                return;
+            }
+
+            /// bodies at the same spot are told apart by their index.
+            if (dist < 1e-3) {
+                d    = QPointF(std::cos(i), std::sin(i));
+                dist = 1.0;
+            }
+
+            const auto unit = d / dist;
+
+            disp += unit * (REPULSION * r * cell.mass / (dist * dist));
+
+            if (leaf && !(cell.body != -1 && linked(i, cell.body))) {
+                if (const auto overlap = r + cell.maxRadius + LayoutRelaxer::GAP - dist; overlap > 0) {
+                    disp += unit * (overlap * COLLISION);
+                }
+            }
+        }
+
+        const QList<LayoutBody>& _bodies;
+        const std::vector<QPointF>& _pos;
+        std::vector<Cell> _cells;
+    };
+}
+
+LayoutRelaxer::LayoutRelaxer(QObject* parent)
+    : QObject(parent)
+    , _stop(std::make_shared<std::atomic_bool>(false))
+{
+    _receiver = std::make_shared<Receiver<LayoutRelaxer>>(this);
+
+    _pool = new QThreadPool();
+    _pool->setMaxThreadCount(1);
+    _pool->setThreadPriority(QThread::LowPriority);
+    _pool->setObjectName("surkl-layout-pool");
+}
+
+LayoutRelaxer::~LayoutRelaxer()
+{
+    cancel();
+    _receiver->detach();
+
+    if (_pool->waitForDone(250)) {
+        delete _pool;
+    }
+}
+
+/// relaxed() is emitted with the new positions of bodies, in their order,
+/// unless relax() or cancel() is called again before.
+void LayoutRelaxer::relax(const QList<LayoutBody>& bodies)
+{
+    cancel();
+
+    const auto ticket = ++_ticket;
+
+    _stop = std::make_shared<std::atomic_bool>(false);
+
+    _pool->start([receiver = _receiver, stop = _stop, ticket, bodies]
+    {
+        auto positions = solve(bodies, ITERATIONS, stop.get());
+
+        if (*stop) {
+            return;
+        }
+
+        receiver->post([ticket, positions = std::move(positions)](LayoutRelaxer* engine)
+        {
+            engine->deliver(ticket, positions);
+        });
+    });
+}
+
+void LayoutRelaxer::cancel()
+{
+    *_stop = true;
+    ++_ticket;
+    _pool->clear();
+}
+
+/// runs on the worker, or anywhere; bodies that are pinned don't move.  An
+/// empty list is returned if stop is set before it is done.
+QList<QPointF> LayoutRelaxer::solve(const QList<LayoutBody>& bodies, int iterations, const std::atomic_bool* stop)
+{
+    const auto n = bodies.size();
+
+    auto pos = std::vector<QPointF>();
+    pos.reserve(n);
+    std::ranges::transform(bodies, std::back_inserter(pos), &LayoutBody::pos);
+
+    auto disp = std::vector<QPointF>(n);
+
+    for (int it = 0; n > 1 && it < iterations; ++it) {
+        if (stop != nullptr && *stop) {
+            return {};
+        }
+
+        const auto tree = QuadTree(bodies, pos);
+
+        for (qsizetype i = 0; i < n; ++i) {
+            disp[i] = bodies[i].pinned ? QPointF() : tree.push(static_cast<int>(i));
+        }
+
+        for (qsizetype i = 0; i < n; ++i) {
+            const auto p = bodies[i].parent;
+            if (p == -1) {
+                continue;
+            }
+
+            const auto d    = pos[i] - pos[p];
+            const auto dist = std::hypot(d.x(), d.y());
+            if (dist < 1e-3) {
+                continue;
+            }
+
+            const auto pull = d / dist * ((dist - bodies[i].length) * SPRING);
+
+            if (bodies[p].pinned) {
+                disp[i] -= pull;
+            } else if (!bodies[i].pinned) {
+                disp[i] -= pull / 2;
+                disp[p] += pull / 2;
+            }
+        }
+
+        /// the steps cool down to a pixel by the last iteration.
+        const auto maxStep = (MAX_STEP - 1.0) * (1.0 - static_cast<qreal>(it) / iterations) + 1.0;
+        auto largest       = 0.0;
+
+        for (qsizetype i = 0; i < n; ++i) {
+            if (bodies[i].pinned) {
+                continue;
+            }
+
+            auto step = std::hypot(disp[i].x(), disp[i].y());
+            if (step > maxStep) {
+                disp[i] *= maxStep / step;
+                step     = maxStep;
+            }
+
+            pos[i]  += disp[i];
+            largest  = std::max(largest, step);
+        }
+
+        if (largest < SETTLED) {
+            break;
+        }
+    }
+
+    return QList<QPointF>(pos.cbegin(), pos.cend());
+}
+
+void LayoutRelaxer::deliver(quint64 ticket, const QList<QPointF>& positions)
+{
+    if (ticket == _ticket) {
+        emit relaxed(positions);
+    }
+}
@@ -0,0 +1,70 @@
+/// Copyright (C) 2025 Arlen Avakian
+/// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include "Receiver.hpp"
+
+#include <QList>
+#include <QObject>
+#include <QPointF>
+
+#include <atomic>
+#include <memory>
+
+
+class QThreadPool;
+
+namespace core
+{
+    /// an open folder, as the relaxer sees it: a disc large enough to hold
+    /// the closed folders and files around it.
+    struct LayoutBody
+    {
+        QPointF pos;
+        qreal radius{0};
+        int parent{-1};      /// the body of the parent folder, or -1
+        qreal length{0};     /// of the edge to the parent
+        bool pinned{false};
+    };
+
+    /// Pushes apart the open folders of the scene whose subtrees overlap.
+    ///
+    /// spread() only places the children of a node around it, so once many
+    /// folders are open, the subtrees of siblings end up on top of each
+    /// other.  A snapshot of the open folders is relaxed on a worker: every
+    /// pair of discs repel each other, far ones through the cells of a
+    /// Barnes-Hut quadtree, near ones are kept apart by at least GAP, and
+    /// the edge to the parent pulls back toward its length.  The steps get
+    /// smaller every iteration, and the result is delivered on the GUI
+    /// thread, to be animated to; a newer snapshot cancels an older one.
+    class LayoutRelaxer final : public QObject
+    {
+        Q_OBJECT
+
+    signals:
+        void relaxed(const QList<QPointF>& positions);
+
+    public:
+        static constexpr int ITERATIONS = 300;
+        static constexpr qreal THETA    = 0.8;
+        static constexpr qreal GAP      = 24.0;
+
+        explicit LayoutRelaxer(QObject* parent = nullptr);
+        ~LayoutRelaxer() override;
+
+        void relax(const QList<LayoutBody>& bodies);
+        void cancel();
+
+        [[nodiscard]] static QList<QPointF> solve(const QList<LayoutBody>& bodies, int iterations = ITERATIONS,
+            const std::atomic_bool* stop = nullptr);
+
+    private:
+        void deliver(quint64 ticket, const QList<QPointF>& positions);
+
+        QThreadPool* _pool{nullptr};
+        std::shared_ptr<Receiver<LayoutRelaxer>> _receiver;
+        quint64 _ticket{0};
+        std::shared_ptr<std::atomic_bool> _stop;
+    };
+}
@@ -0,0 +1,298 @@
+/// Copyright (C) 2025 Arlen Avakian
+/// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "ListingScheduler.hpp"
+#include "collation.hpp"
+
+#include <QDirIterator>
+#include <QFile>
+#include <QMutex>
+#include <QThread>
+#include <QThreadPool>
+
+#include <ranges>
+
+#ifdef Q_OS_UNIX
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#endif
+
+
+using namespace core;
+
+namespace
+{
+    /// upper bound on the number of directories being read at the same time.
+    /// Beyond this, a spinning disk starts seeking more than it reads.
+    constexpr int MAX_WORKERS = 8;
+
+    /// in the order the view shows them.
+    void sortEntries(QList<DirEntry>& entries)
+    {
+        const auto names = entries
+            | std::views::transform(&DirEntry::name)
+            | std::ranges::to<QStringList>()
+            ;
+
+        const auto order = sortedOrder(collationKeys(names));
+
+        QList<DirEntry> sorted;
+        sorted.reserve(entries.size());
+
+        for (const auto i : order) {
+            sorted.push_back(std::move(entries[i]));
+        }
+        entries.swap(sorted);
+    }
+
+#if defined(Q_OS_UNIX) && defined(_DIRENT_HAVE_D_TYPE)
+    /// reads the directory with readdir(), which is backed by getdents, and
+    /// classifies the entries from d_type.  Only symbolic links, and entries on
+    /// filesystems that do not fill in d_type, cost an extra stat.
+    DirListing readDirectory(const QString& path)
+    {
+        DirListing result{.path = path, .entries = {}};
+
+        auto* dir = opendir(QFile::encodeName(path).constData());
+        if (dir == nullptr) {
+            return result;
+        }
+        const auto fd = dirfd(dir);
+
+        while (const auto* ent = readdir(dir)) {
+            const auto* name = ent->d_name;
+
+            /// hidden entries are skipped to match the filter of the model.
+            if (name[0] == '.') {
+                continue;
+            }
+
+            auto entry = DirEntry{.name = QFile::decodeName(name)};
+            struct stat st{};
+
+            switch (ent->d_type) {
+                case DT_DIR:
+                    entry.isDir = true;
+                    break;
+
+                case DT_LNK:
+                    entry.isLink = true;
+                    entry.isDir  = fstatat(fd, name, &st, 0) == 0 && S_ISDIR(st.st_mode);
+                    break;
+
+                case DT_UNKNOWN:
+                    if (fstatat(fd, name, &st, AT_SYMLINK_NOFOLLOW) == 0) {
+                        entry.isLink = S_ISLNK(st.st_mode);
+                        entry.isDir  = entry.isLink
+                            ? fstatat(fd, name, &st, 0) == 0 && S_ISDIR(st.st_mode)
+                            : S_ISDIR(st.st_mode);
+                    }
+                    break;
+
+                default:
+                    break;
+            }
+
+            result.entries.push_back(std::move(entry));
+        }
+
+        closedir(dir);
+
+        sortEntries(result.entries);
+
+        return result;
+    }
+#else
+    DirListing readDirectory(const QString& path)
+    {
+        DirListing result{.path = path, .entries = {}};
+
+        auto it = QDirIterator(path, QDir::AllEntries | QDir::NoDotAndDotDot | QDir::System);
+
+        while (it.hasNext()) {
+            const auto info = it.nextFileInfo();
+            result.entries.push_back({.name = info.fileName(), .isDir = info.isDir(), .isLink = info.isSymLink()});
+        }
+
+        sortEntries(result.entries);
+
+        return result;
+    }
+#endif
+}
+
+/// the queue, and what the workers have listed; the workers hold on to it,
+/// as they do to the Receiver.
+struct ListingScheduler::Shared
+{
+    explicit Shared(std::shared_ptr<Receiver<ListingScheduler>> receiver)
+        : receiver(std::move(receiver))
+    {
+    }
+
+    void work();
+
+    const std::shared_ptr<Receiver<ListingScheduler>> receiver;
+    QMutex mutex;
+    ListingQueue queue;
+    QList<DirListing> results;
+    int activeWorkers{0};
+    bool stopping{false};
+};
+
+void ListingScheduler::Shared::work()
+{
+    forever {
+        QString path;
+        {
+            QMutexLocker locker(&mutex);
+
+            path = queue.pop();
+
+            if (path.isEmpty() || stopping) {
+                --activeWorkers;
+                return;
+            }
+        }
+
+        auto listing = readDirectory(path);
+
+        QMutexLocker locker(&mutex);
+        queue.done(path);
+
+        if (stopping) {
+            continue;
+        }
+
+        const auto first = results.empty();
+        results.push_back(std::move(listing));
+
+        if (first) {
+            receiver->post([](ListingScheduler* s) { s->deliver(); });
+        }
+    }
+}
+
+ListingScheduler::ListingScheduler(QObject* parent)
+    : QObject(parent)
+    , _receiver(std::make_shared<Receiver<ListingScheduler>>(this))
+    , _shared(std::make_shared<Shared>(_receiver))
+{
+    _pool = new QThreadPool();
+    _pool->setMaxThreadCount(qBound(2, QThread::idealThreadCount(), MAX_WORKERS));
+    _pool->setObjectName("surkl-listing-pool");
+}
+
+ListingScheduler::~ListingScheduler()
+{
+    {
+        QMutexLocker locker(&_shared->mutex);
+        _shared->stopping = true;
+        _shared->queue.clear();
+    }
+    _receiver->detach();
+
+    if (_pool->waitForDone(250)) {
+        delete _pool;
+    }
+}
+
+/// schedules path to be listed.  If path is already waiting in the queue, then
+/// its priority is raised to priority; lowering the priority has no effect.
+void ListingScheduler::schedule(const QString& path, Priority priority)
+{
+    {
+        QMutexLocker locker(&_shared->mutex);
+
+        if (!_shared->queue.push(path, priority)) {
+            return;
+        }
+    }
+
+    startWorkers();
+}
+
+void ListingScheduler::startWorkers()
+{
+    QMutexLocker locker(&_shared->mutex);
+
+    /// one worker per queued request, up to the size of the pool.  Workers
+    /// keep pulling from the shared queue until it is empty, so a slow
+    /// directory only holds up the worker that is reading it.
+    while (_shared->activeWorkers < _pool->maxThreadCount() && _shared->queue.size() > _shared->activeWorkers) {
+        ++_shared->activeWorkers;
+        _pool->start([shared = _shared] { shared->work(); });
+    }
+}
+
+void ListingScheduler::deliver()
+{
+    QList<DirListing> batch;
+    {
+        QMutexLocker locker(&_shared->mutex);
+        batch.swap(_shared->results);
+    }
+
+    if (!batch.empty()) {
+        emit listed(batch);
+    }
+}
+
+/// false if path is being listed, or is queued with priority or higher.
+bool ListingQueue::push(const QString& path, ListingScheduler::Priority priority)
+{
+    if (_inFlight.contains(path)) {
+        return false;
+    }
+
+    if (auto found = _queued.find(path); found != _queued.end()) {
+        if (found.value() >= priority) {
+            return false;
+        }
+        /// the old entry stays in the heap and is skipped when popped.
+        found.value() = priority;
+    } else {
+        _queued.insert(path, priority);
+    }
+
+    _heap.push({priority, _seq++, path});
+
+    return true;
+}
+
+/// the next path to list, or an empty one if there is none.
+QString ListingQueue::pop()
+{
+    while (!_heap.empty()) {
+        auto top = _heap.top();
+        _heap.pop();
+
+        /// skip entries whose priority was raised after they were queued.
+        if (auto found = _queued.find(top.path); found != _queued.end() && found.value() == top.priority) {
+            _queued.erase(found);
+            _inFlight.insert(top.path);
+            return top.path;
+        }
+    }
+
+    return {};
+}
+
+void ListingQueue::done(const QString& path)
+{
+    _inFlight.remove(path);
+}
+
+/// what is being listed is still done() with.
+void ListingQueue::clear()
+{
+    _heap = {};
+    _queued.clear();
+}
+
+/// the paths that are queued, not those being listed.
+qsizetype ListingQueue::size() const
+{
+    return _queued.size();
+}
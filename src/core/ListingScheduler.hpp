@@ -0,0 +1,114 @@
+/// Copyright (C) 2025 Arlen Avakian
+/// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include "Receiver.hpp"
+
+#include <QHash>
+#include <QObject>
+#include <QSet>
+
+#include <memory>
+#include <queue>
+#include <vector>
+
+
+class QThreadPool;
+
+namespace core
+{
+    /// classified from d_type when the directory is read; symbolic links are
+    /// classified by their target.
+    struct DirEntry
+    {
+        QString name;
+        bool isDir{false};
+        bool isLink{false};
+    };
+
+    struct DirListing
+    {
+        QString path;
+        QList<DirEntry> entries; /// sorted naturally, as in the view
+    };
+
+    /// Lists directories on a small pool of worker threads.
+    ///
+    /// QFileSystemModel lists every directory through a single gatherer
+    /// thread, so requesting many directories at once (e.g., restoring a
+    /// session) costs the sum of all the listings.  The scheduler reads the
+    /// directories in parallel, highest priority first, and delivers the
+    /// finished listings in batches on the GUI thread.
+    ///
+    /// The model can't be handed a listing, and still reads each directory
+    /// itself, one at a time.  What the listing here buys is the type of
+    /// every entry from d_type, without a stat, so that the nodes the model's
+    /// rows turn into can be classified without asking the model.
+    class ListingScheduler final : public QObject
+    {
+        Q_OBJECT
+
+    signals:
+        void listed(const QList<core::DirListing>& batch);
+
+    public:
+        enum Priority
+        {
+            LowPriority = 0,     /// off-screen
+            NormalPriority,      /// visible in at least one view
+            HighPriority         /// selected, or explicitly requested by the user
+        };
+
+        explicit ListingScheduler(QObject* parent = nullptr);
+        ~ListingScheduler() override;
+
+        void schedule(const QString& path, Priority priority);
+
+    private:
+        struct Shared;
+
+        void startWorkers();
+        void deliver();
+
+        QThreadPool* _pool{nullptr};
+        std::shared_ptr<Receiver<ListingScheduler>> _receiver;
+        std::shared_ptr<Shared> _shared;
+    };
+
+    /// The requests of a ListingScheduler: the highest priority first, and
+    /// the oldest first among equal priorities.  A path is queued once, and
+    /// not at all while it is being listed, i.e., between pop() and done().
+    /// It isn't thread-safe; the scheduler guards it with its mutex.
+    class ListingQueue
+    {
+    public:
+        bool push(const QString& path, ListingScheduler::Priority priority);
+        [[nodiscard]] QString pop();
+        void done(const QString& path);
+        void clear();
+
+        [[nodiscard]] qsizetype size() const;
+
+    private:
+        struct Request
+        {
+            int priority;
+            quint64 seq;
+            QString path;
+
+            /// std::priority_queue is a max-heap; among equal priorities the
+            /// oldest request comes first.
+            bool operator<(const Request& other) const
+            {
+                return priority < other.priority
+                    || (priority == other.priority && seq > other.seq);
+            }
+        };
+
+        std::priority_queue<Request, std::vector<Request>> _heap;
+        QHash<QString, int> _queued;  /// path -> highest requested priority
+        QSet<QString> _inFlight;
+        quint64 _seq{0};
+    };
+}
@@ -0,0 +1,280 @@
+/// Copyright (C) 2025 Arlen Avakian
+/// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "MetadataCache.hpp"
+#include "paths.hpp"
+
+#include <QDir>
+
+
+using namespace core;
+
+namespace
+{
+    /// the name of the root is the root itself, as in the model.
+    QString nameOf(const QString& path)
+    {
+        const auto sep = path.lastIndexOf(QDir::separator());
+
+        return sep == -1 || sep == path.size() - 1 ? path : path.sliced(sep + 1);
+    }
+}
+
+MetadataCache::MetadataCache()
+{
+    /// PathId 0
+    _paths.push_back(QString());
+    _names.push_back(QString());
+    _generations.push_back(0);
+}
+
+PathId MetadataCache::intern(const QString& path)
+{
+    if (path.isEmpty()) {
+        return 0;
+    }
+
+    if (const auto found = _ids.constFind(path); found != _ids.cend()) {
+        return found.value();
+    }
+
+    return add(path, nameOf(path));
+}
+
+/// a new id for path, or an evicted one, which keeps its generation.
+PathId MetadataCache::add(const QString& path, const QString& name)
+{
+    PathId id{0};
+
+    if (_free.empty()) {
+        id = static_cast<PathId>(_paths.size());
+        _paths.push_back(path);
+        _names.push_back(name);
+        _generations.push_back(0);
+    } else {
+        id = _free.takeLast();
+        _paths[id] = path;
+        _names[id] = name;
+    }
+    _ids.insert(path, id);
+
+    return id;
+}
+
+NodeHandle MetadataCache::handle(PathId id) const
+{
+    Q_ASSERT(static_cast<qsizetype>(id) < _generations.size());
+
+    return {.id = id, .generation = _generations[id]};
+}
+
+bool MetadataCache::isCurrent(const NodeHandle& handle) const
+{
+    return !handle.isNull()
+        && static_cast<qsizetype>(handle.id) < _generations.size()
+        && _generations[handle.id] == handle.generation;
+}
+
+PathId MetadataCache::find(const QString& path) const
+{
+    return _ids.value(path, 0);
+}
+
+QString MetadataCache::path(PathId id) const
+{
+    Q_ASSERT(static_cast<qsizetype>(id) < _paths.size());
+
+    return _paths[id];
+}
+
+QString MetadataCache::name(PathId id) const
+{
+    Q_ASSERT(static_cast<qsizetype>(id) < _names.size());
+
+    return _names[id];
+}
+
+const CachedEntry* MetadataCache::entry(PathId id) const
+{
+    const auto found = _entries.constFind(id);
+
+    return found != _entries.cend() ? &found.value() : nullptr;
+}
+
+/// nullptr until the fetcher has delivered, and after a change.
+const FileMetadata* MetadataCache::metadata(PathId id) const
+{
+    const auto* e = entry(id);
+
+    return e != nullptr && e->fetched ? &e->metadata : nullptr;
+}
+
+/// classifies all the entries of a listing; their metadata is left as is.
+void MetadataCache::insert(const DirListing& listing)
+{
+    const auto added = qMax<qsizetype>(0, listing.entries.size() - _free.size());
+    _paths.reserve(_paths.size() + added);
+    _names.reserve(_names.size() + added);
+    _generations.reserve(_generations.size() + added);
+
+    for (const auto& dirEntry : listing.entries) {
+        const auto path = joinPath(listing.path, dirEntry.name);
+        auto id         = find(path);
+
+        if (id == 0) {
+            id = add(path, dirEntry.name);
+        }
+
+        auto& e      = _entries[id];
+        e.classified = true;
+        e.listed     = true;
+        e.isDir      = dirEntry.isDir;
+        e.isLink     = dirEntry.isLink;
+    }
+}
+
+/// returns the id of metadata.path.
+PathId MetadataCache::update(const FileMetadata& metadata)
+{
+    const auto id = intern(metadata.path);
+    auto& e       = _entries[id];
+
+    /// a plain request doesn't count entries; keep the count from before.
+    const auto entryCount = metadata.entryCount < 0 && e.fetched && e.metadata.status == FileMetadata::Ok
+        ? e.metadata.entryCount
+        : metadata.entryCount;
+
+    e.metadata            = metadata;
+    e.metadata.path       = path(id);
+    e.metadata.entryCount = entryCount;
+    e.fetched             = true;
+
+    /// what a listing said stands; the fetcher classifies only the rest.
+    if (metadata.status == FileMetadata::Ok && !e.listed) {
+        e.classified = true;
+        e.isDir      = metadata.isDir;
+        e.isLink     = metadata.isLink;
+    }
+
+    return id;
+}
+
+/// the entry has changed on disk; its metadata has to be fetched again.
+void MetadataCache::invalidate(PathId id)
+{
+    if (const auto found = _entries.find(id); found != _entries.end()) {
+        found->fetched  = false;
+        found->metadata = FileMetadata();
+    }
+}
+
+/// the entry is gone from the model, and with it everything under it;
+/// handles made before now are stale.  A removed entry may come back as
+/// something of a different type; it is unclassified until it is listed,
+/// or its metadata is fetched, again.
+void MetadataCache::remove(PathId id)
+{
+    remove(QList<PathId>{id});
+}
+
+/// removes the entries of ids, and everything under them, in one pass over
+/// the interned paths; the model removes rows a range at a time.
+void MetadataCache::remove(const QList<PathId>& ids)
+{
+    QSet<QStringView> dirs;
+    QStringView common;  /// what the paths of dirs start with
+
+    for (const auto id : ids) {
+        if (id == 0) {
+            continue;
+        }
+
+        const auto* e     = entry(id);
+        const auto isFile = e != nullptr && e->classified && !e->isDir;
+
+        _entries.remove(id);
+        ++_generations[id];
+
+        if (isFile) {
+            continue;
+        }
+
+        const auto dir = QStringView(_paths[id]);
+        if (dirs.empty()) {
+            common = dir;
+        } else {
+            qsizetype n = 0;
+            while (n < common.size() && n < dir.size() && common[n] == dir[n]) {
+                ++n;
+            }
+            common = common.first(n);
+        }
+        dirs.insert(dir);
+    }
+
+    if (dirs.empty()) {
+        return;
+    }
+
+    /// a path is under a removed directory if one of its ancestors is.
+    for (auto it = _ids.cbegin(); it != _ids.cend(); ++it) {
+        const auto path = QStringView(it.key());
+
+        if (!path.startsWith(common)) {
+            continue;
+        }
+
+        auto sep = path.lastIndexOf(QDir::separator());
+
+        while (sep >= 0) {
+            /// the root keeps its separator.
+            if (dirs.contains(path.first(qMax<qsizetype>(sep, 1)))) {
+                const auto child = it.value();
+                _entries.remove(child);
+                ++_generations[child];
+                break;
+            }
+            sep = sep > 0 ? path.lastIndexOf(QDir::separator(), sep - 1) : -1;
+        }
+    }
+}
+
+/// drops the paths that aren't in live, along with what a listing said
+/// about them and their metadata; the fetcher is asked again once a node
+/// shows them.  Handles of them are stale from
+/// now on.  Returns the ids dropped.
+QList<PathId> MetadataCache::evict(const QSet<PathId>& live)
+{
+    QList<PathId> evicted;
+
+    for (auto it = _ids.begin(); it != _ids.end();) {
+        const auto id = it.value();
+
+        if (live.contains(id)) {
+            ++it;
+            continue;
+        }
+
+        _entries.remove(id);
+        _paths[id] = QString();
+        _names[id] = QString();
+        ++_generations[id];
+
+        _free.push_back(id);
+        evicted.push_back(id);
+        it = _ids.erase(it);
+    }
+
+    return evicted;
+}
+
+qsizetype MetadataCache::size() const
+{
+    return _entries.size();
+}
+
+/// the number of paths held, with or without an entry.
+qsizetype MetadataCache::interned() const
+{
+    return _ids.size();
+}
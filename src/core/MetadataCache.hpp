@@ -0,0 +1,96 @@
+/// Copyright (C) 2025 Arlen Avakian
+/// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include "ListingScheduler.hpp"
+#include "MetadataFetcher.hpp"
+
+#include <QHash>
+#include <QList>
+#include <QSet>
+
+
+namespace core
+{
+    /// a path, interned by MetadataCache; 0 is no path.  An id is reused only
+    /// once it has been evicted, and then with a newer generation.
+    using PathId = quint32;
+
+    /// a path as it was when the handle was made: an entry removed from the
+    /// model and made again has the same id, but a newer generation.  Unlike
+    /// a QPersistentModelIndex, it costs the models nothing to keep.
+    struct NodeHandle
+    {
+        PathId id{0};
+        quint32 generation{0};
+
+        [[nodiscard]] bool isNull() const { return id == 0; }
+
+        friend bool operator==(const NodeHandle&, const NodeHandle&) = default;
+        friend size_t qHash(const NodeHandle& handle, size_t seed = 0) noexcept
+        {
+            return qHashMulti(seed, handle.id, handle.generation);
+        }
+    };
+
+    struct CachedEntry
+    {
+        bool classified{false};  /// isDir and isLink are known
+        bool listed{false};      /// its parent went through the lister
+        bool isDir{false};
+        bool isLink{false};
+        bool fetched{false};     /// metadata is what the fetcher found
+        FileMetadata metadata;
+    };
+
+    /// What the scene knows about the entries of the filesystem, in one place.
+    ///
+    /// Every path the scene deals with is interned once, together with its
+    /// name, and is referred to by its PathId from then on; nodes, stats and
+    /// storage share the same strings instead of asking the model to build
+    /// them again.  The type of an entry is filled in, a directory at a time,
+    /// when the lister reads its parent, or else when the fetcher delivers
+    /// its metadata; size and mtime when the fetcher delivers them.  Changes seen by the model's watcher invalidate the
+    /// metadata, not the path.
+    ///
+    /// Interned paths are kept after their entry is gone, so that a PathId
+    /// held by a node stays valid.  They are dropped, with their metadata, only
+    /// by evict(), which the owner calls with the ids it still holds.
+    class MetadataCache
+    {
+    public:
+        MetadataCache();
+
+        [[nodiscard]] PathId intern(const QString& path);
+        [[nodiscard]] PathId find(const QString& path) const;
+        [[nodiscard]] QString path(PathId id) const;
+        [[nodiscard]] QString name(PathId id) const;
+        [[nodiscard]] NodeHandle handle(PathId id) const;
+        [[nodiscard]] bool isCurrent(const NodeHandle& handle) const;
+
+        [[nodiscard]] const CachedEntry* entry(PathId id) const;
+        [[nodiscard]] const FileMetadata* metadata(PathId id) const;
+
+        void insert(const DirListing& listing);
+        PathId update(const FileMetadata& metadata);
+        void invalidate(PathId id);
+        void remove(PathId id);
+        void remove(const QList<PathId>& ids);
+
+        QList<PathId> evict(const QSet<PathId>& live);
+
+        [[nodiscard]] qsizetype size() const;
+        [[nodiscard]] qsizetype interned() const;
+
+    private:
+        PathId add(const QString& path, const QString& name);
+
+        QList<QString> _paths;
+        QList<QString> _names;
+        QList<quint32> _generations;
+        QHash<QString, PathId> _ids;
+        QHash<PathId, CachedEntry> _entries;
+        QList<PathId> _free;  /// evicted, and not reused yet
+    };
+}
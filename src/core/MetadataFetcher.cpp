@@ -0,0 +1,494 @@
+/// Copyright (C) 2025 Arlen Avakian
+/// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "MetadataFetcher.hpp"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QThread>
+#include <QThreadPool>
+#include <QTimer>
+
+#include <ranges>
+
+#ifdef Q_OS_LINUX
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#endif
+
+
+using namespace core;
+
+namespace
+{
+    constexpr qsizetype BATCH_SIZE = 64;
+
+    /// at most this many batches of the same mount are being fetched at once.
+    constexpr int MAX_TASKS_PER_MOUNT = 2;
+
+    /// at most this many workers stuck on mounts that didn't answer are made
+    /// up for with more threads; past that, no mount is probed until some of
+    /// them come back.
+    constexpr int MAX_STUCK = 4;
+
+    /// how long the list of mounts is trusted before it is read again.
+    constexpr int MOUNTS_LIFETIME = 10000;
+
+    bool isNetworkFs(const QString& fsType)
+    {
+        static const auto types = QSet<QString>
+            {
+                "nfs", "nfs4", "cifs", "smb3", "smbfs", "9p", "afs", "ceph", "glusterfs", "davfs"
+            };
+
+        /// sshfs, rclone, and friends all come through FUSE.
+        return types.contains(fsType) || fsType.startsWith("fuse.");
+    }
+
+#ifdef Q_OS_LINUX
+    /// mountinfo escapes space, tab, newline, and backslash as octal.
+    QString unescapeMountPath(QByteArray field)
+    {
+        field
+            .replace("\\040", " ")
+            .replace("\\011", "\t")
+            .replace("\\012", "\n")
+            .replace("\\134", "\\");
+
+        return QFile::decodeName(field);
+    }
+
+    /// counts the entries of the directory, skipping the hidden ones to match
+    /// the filter of the model.  An unreadable directory has no entries.
+    qint64 countDirEntries(const QByteArray& name)
+    {
+        auto* dir = opendir(name.constData());
+        if (dir == nullptr) {
+            return 0;
+        }
+
+        qint64 result = 0;
+        while (const auto* ent = readdir(dir)) {
+            if (ent->d_name[0] != '.') {
+                ++result;
+            }
+        }
+        closedir(dir);
+
+        return result;
+    }
+#endif
+}
+
+////////////////////
+/// PosixBackend ///
+////////////////////
+
+#ifdef Q_OS_LINUX
+FileMetadata PosixBackend::stat(const QString& path, bool countEntries)
+{
+    FileMetadata result{.path = path};
+
+    const auto name = QFile::encodeName(path);
+    struct statx stx{};
+
+    /// AT_STATX_DONT_SYNC: whatever the kernel has cached is good enough
+    /// for drawing a size indicator; don't make network filesystems
+    /// revalidate.
+    if (statx(AT_FDCWD, name.constData(), AT_SYMLINK_NOFOLLOW | AT_STATX_DONT_SYNC,
+            STATX_TYPE | STATX_SIZE | STATX_MTIME, &stx) != 0) {
+        return result;
+    }
+
+    if (S_ISLNK(stx.stx_mode)) {
+        result.isLink     = true;
+        result.linkTarget = QFile::symLinkTarget(path);
+
+        /// the size of a link is the size of its target.
+        if (statx(AT_FDCWD, name.constData(), AT_STATX_DONT_SYNC, STATX_TYPE | STATX_SIZE | STATX_MTIME, &stx) != 0) {
+            result.status = FileMetadata::Ok;
+            return result;
+        }
+    }
+
+    result.size   = static_cast<qint64>(stx.stx_size);
+    result.mtime  = static_cast<qint64>(stx.stx_mtime.tv_sec) * 1'000'000'000 + stx.stx_mtime.tv_nsec;
+    result.status = FileMetadata::Ok;
+    result.isDir  = S_ISDIR(stx.stx_mode);
+
+    if (countEntries && S_ISDIR(stx.stx_mode)) {
+        result.entryCount = countDirEntries(name);
+    }
+
+    return result;
+}
+
+QList<Mount> PosixBackend::mounts()
+{
+    QList<Mount> result;
+
+    /// 36 35 98:0 /mnt1 /mnt/parent rw,noatime master:1 - ext3 /dev/root rw
+    ///             (4)      (5)                         (sep)  (sep + 1)
+    QFile file("/proc/self/mountinfo");
+    if (file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        while (!file.atEnd()) {
+            const auto fields = file.readLine().trimmed().split(' ');
+            const auto sep    = fields.indexOf("-");
+
+            if (sep > 4 && sep + 1 < fields.size()) {
+                result.push_back({.path = unescapeMountPath(fields[4]), .fsType = QString::fromLatin1(fields[sep + 1])});
+            }
+        }
+    }
+
+    if (result.empty()) {
+        result.push_back({.path = QDir::rootPath(), .fsType = {}});
+    }
+
+    return result;
+}
+#else
+FileMetadata PosixBackend::stat(const QString& path, bool countEntries)
+{
+    const auto info = QFileInfo(path);
+
+    return
+        {
+            .path       = path,
+            .size       = info.size(),
+            .mtime      = info.lastModified().toMSecsSinceEpoch() * 1'000'000,
+            .entryCount = countEntries && info.isDir()
+                ? QDir(path).count()
+                : -1,
+            .linkTarget = info.isSymLink() ? info.symLinkTarget() : QString(),
+            .status     = info.exists() || info.isSymLink() ? FileMetadata::Ok : FileMetadata::Failed,
+            .isDir      = info.isDir(),
+            .isLink     = info.isSymLink()
+        };
+}
+
+QList<Mount> PosixBackend::mounts()
+{
+    return {{.path = QDir::rootPath(), .fsType = {}}};
+}
+#endif
+
+///////////////////////
+/// MetadataFetcher ///
+///////////////////////
+
+struct MetadataFetcher::Shared
+{
+    Shared(std::unique_ptr<FsBackend> backend, std::shared_ptr<Receiver<MetadataFetcher>> receiver)
+        : backend(std::move(backend))
+        , receiver(std::move(receiver))
+    {
+    }
+
+    const std::unique_ptr<FsBackend> backend;
+    const std::shared_ptr<Receiver<MetadataFetcher>> receiver;
+};
+
+MetadataFetcher::MetadataFetcher(QObject* parent)
+    : MetadataFetcher(std::make_unique<PosixBackend>(), parent)
+{
+}
+
+MetadataFetcher::MetadataFetcher(std::unique_ptr<FsBackend> backend, QObject* parent)
+    : QObject(parent)
+    , _receiver(std::make_shared<Receiver<MetadataFetcher>>(this))
+    , _shared(std::make_shared<Shared>(std::move(backend), _receiver))
+{
+    /// not a child of the fetcher: a worker stuck on a hung mount must not
+    /// hold up the destruction of the fetcher, and with it, the shutdown.
+    _pool = new QThreadPool();
+    _threads = qMax(6, QThread::idealThreadCount());
+    _pool->setMaxThreadCount(_threads);
+    _pool->setObjectName("surkl-metadata-pool");
+
+    _timer = new QTimer(this);
+    _timer->setSingleShot(true);
+    _timer->setInterval(0);
+
+    connect(_timer, &QTimer::timeout, this, qOverload<>(&MetadataFetcher::dispatch));
+}
+
+MetadataFetcher::~MetadataFetcher()
+{
+    _receiver->detach();
+
+    _pool->clear();
+
+    if (_pool->waitForDone(250)) {
+        delete _pool;
+    }
+}
+
+void MetadataFetcher::request(const QString& path, bool countEntries)
+{
+    if (auto found = _requested.find(path); found != _requested.end()) {
+        if (found.value() || !countEntries) {
+            return;
+        }
+        found.value() = true;
+    } else {
+        _requested.insert(path, countEntries);
+    }
+
+    if (auto& state = stateOf(mountOf(path));
+        state.breaker == MountState::Open && !state.openUntil.hasExpired()) {
+        reject(path);
+    } else {
+        state.pending.push_back({path, countEntries});
+    }
+
+    if (!_timer->isActive()) {
+        _timer->start();
+    }
+}
+
+/// returns false while the circuit breaker of the mount of path is open.
+bool MetadataFetcher::isReachable(const QString& path)
+{
+    const auto& state = stateOf(mountOf(path));
+
+    return state.breaker != MountState::Open || state.openUntil.hasExpired();
+}
+
+QString MetadataFetcher::mountOf(const QString& path)
+{
+    if (_mountsExpiry.hasExpired()) {
+        refreshMounts();
+    }
+
+    const auto found = std::ranges::find_if(_mounts, [&path](const Mount& m)
+    {
+        return m.path == QDir::rootPath()
+            || path == m.path
+            || (path.startsWith(m.path) && path.at(m.path.size()) == '/');
+    });
+
+    return found != _mounts.cend() ? found->path : QDir::rootPath();
+}
+
+void MetadataFetcher::setTimeout(const QString& mount, int msec)
+{
+    _timeouts.insert(mount, msec);
+
+    if (auto found = _states.find(mount); found != _states.end()) {
+        found->timeout = msec;
+    }
+}
+
+void MetadataFetcher::setCooldown(int msec)
+{
+    _cooldown = msec;
+}
+
+void MetadataFetcher::dispatch()
+{
+    for (auto it = _states.begin(); it != _states.end(); ++it) {
+        dispatch(it.key(), it.value());
+    }
+
+    if (!_rejected.empty()) {
+        QList<FileMetadata> batch;
+        batch.swap(_rejected);
+
+        emit fetched(batch);
+    }
+}
+
+void MetadataFetcher::dispatch(const QString& mount, MountState& state)
+{
+    if (state.breaker == MountState::Open) {
+        if (state.pending.empty()) {
+            return;
+        }
+
+        if (state.openUntil.hasExpired() && state.inFlight == 0 && _stuck < MAX_STUCK) {
+            /// the cool-down has passed; the next batch is a probe.
+            state.breaker = MountState::HalfOpen;
+        } else {
+            /// the workers that timed out are still stuck, so the mount hasn't
+            /// come back, or too many workers are stuck elsewhere to risk
+            /// another; no point in probing it.
+            if (state.openUntil.hasExpired()) {
+                trip(mount, state);
+            }
+
+            for (const auto& path : state.pending | std::views::keys) {
+                reject(path);
+            }
+            state.pending.clear();
+
+            return;
+        }
+    }
+
+    const auto maxTasks = state.breaker == MountState::HalfOpen ? 1 : MAX_TASKS_PER_MOUNT;
+
+    while (!state.pending.empty() && state.inFlight < maxTasks) {
+        const auto n = qMin(BATCH_SIZE, state.pending.size());
+        auto batch   = state.pending.first(n);
+        state.pending.remove(0, n);
+
+        const auto id = _nextTask++;
+        auto& task    = _tasks[id];
+        task.mount    = mount;
+        for (const auto& path : batch | std::views::keys) {
+            task.paths.push_back(path);
+        }
+        ++state.inFlight;
+
+        _pool->start([shared = _shared, id, batch = std::move(batch)]
+        {
+            /// the timeout runs from here, not from when it was queued behind
+            /// the batches of other mounts.
+            shared->receiver->post([id](MetadataFetcher* e) { e->onStarted(id); });
+
+            QList<FileMetadata> results;
+            results.reserve(batch.size());
+
+            for (const auto& [path, count] : batch) {
+                results.push_back(shared->backend->stat(path, count));
+            }
+
+            shared->receiver->post([id, results = std::move(results)](MetadataFetcher* e)
+            {
+                e->onFinished(id, results);
+            });
+        });
+    }
+}
+
+void MetadataFetcher::onStarted(quint64 id)
+{
+    if (const auto found = _tasks.constFind(id); found != _tasks.cend()) {
+        QTimer::singleShot(stateOf(found->mount).timeout, this, [this, id] { onTimeout(id); });
+    }
+}
+
+void MetadataFetcher::onFinished(quint64 id, const QList<FileMetadata>& results)
+{
+    const auto task = _tasks.take(id);
+    auto& state     = stateOf(task.mount);
+
+    --state.inFlight;
+
+    if (task.timedOut) {
+        --_stuck;
+        resizePool();
+    }
+
+    /// a batch that made it in time closes the breaker.  The late results of
+    /// a timed-out batch are still good and are delivered, but the breaker
+    /// stays open until its cool-down has passed.
+    if (!task.timedOut) {
+        state.failures = 0;
+        state.breaker  = MountState::Closed;
+
+        for (const auto& r : results) {
+            _requested.remove(r.path);
+        }
+    }
+
+    if (!_timer->isActive()) {
+        _timer->start();
+    }
+
+    emit fetched(results);
+}
+
+void MetadataFetcher::onTimeout(quint64 id)
+{
+    auto found = _tasks.find(id);
+    if (found == _tasks.end() || found->timedOut) {
+        return;
+    }
+    found->timedOut = true;
+
+    const auto paths = found->paths;
+    auto& state      = stateOf(found->mount);
+
+    trip(found->mount, state);
+
+    ++_stuck;
+    resizePool();
+
+    QList<FileMetadata> results;
+    results.reserve(paths.size());
+
+    for (const auto& path : paths) {
+        _requested.remove(path);
+        results.push_back({.path = path, .status = FileMetadata::Unreachable});
+    }
+
+    for (const auto& path : state.pending | std::views::keys) {
+        reject(path);
+    }
+    state.pending.clear();
+
+    if (!_timer->isActive()) {
+        _timer->start();
+    }
+
+    emit fetched(results);
+}
+
+void MetadataFetcher::reject(const QString& path)
+{
+    _requested.remove(path);
+    _rejected.push_back({.path = path, .status = FileMetadata::Unreachable});
+}
+
+/// opens the breaker.  Each consecutive failure doubles the cool-down, and
+/// only the last one says when it has passed.
+void MetadataFetcher::trip(const QString& mount, MountState& state)
+{
+    ++state.failures;
+
+    const auto cooldown = qMin<qint64>(MAX_COOLDOWN, qint64(_cooldown) << qMin(state.failures - 1, 16));
+
+    state.breaker   = MountState::Open;
+    state.openUntil = QDeadlineTimer(cooldown);
+
+    QTimer::singleShot(static_cast<int>(cooldown), this, [this, mount]
+    {
+        if (const auto& current = stateOf(mount); current.breaker == MountState::Open && current.openUntil.hasExpired()) {
+            emit reachable(mount);
+        }
+    });
+}
+
+/// a worker stuck on a mount that didn't answer is made up for with another
+/// thread, up to MAX_STUCK, so that the other mounts keep theirs.
+void MetadataFetcher::resizePool()
+{
+    _pool->setMaxThreadCount(_threads + qMin(_stuck, MAX_STUCK));
+}
+
+void MetadataFetcher::refreshMounts()
+{
+    _mounts = _shared->backend->mounts();
+    std::ranges::sort(_mounts, std::ranges::greater(), [](const Mount& m) { return m.path.size(); });
+
+    _mountsExpiry = QDeadlineTimer(MOUNTS_LIFETIME);
+}
+
+MetadataFetcher::MountState& MetadataFetcher::stateOf(const QString& mount)
+{
+    if (auto found = _states.find(mount); found != _states.end()) {
+        return found.value();
+    }
+
+    const auto fsType = std::ranges::find(_mounts, mount, &Mount::path);
+    const auto remote = fsType != _mounts.cend() && isNetworkFs(fsType->fsType);
+
+    auto& state   = _states[mount];
+    state.timeout = _timeouts.value(mount, remote ? NETWORK_TIMEOUT : LOCAL_TIMEOUT);
+
+    return state;
+}
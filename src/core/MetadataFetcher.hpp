@@ -0,0 +1,159 @@
+/// Copyright (C) 2025 Arlen Avakian
+/// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include "Receiver.hpp"
+
+#include <QDeadlineTimer>
+#include <QHash>
+#include <QObject>
+#include <QSet>
+
+#include <memory>
+
+
+class QThreadPool;
+class QTimer;
+
+namespace core
+{
+    struct FileMetadata
+    {
+        enum Status
+        {
+            Ok = 0,
+            Failed,      /// the file is gone, or can't be stat'ed
+            Unreachable  /// the mount did not answer in time
+        };
+
+        QString path;
+        qint64 size{0};
+        qint64 mtime{-1};      /// in nanoseconds
+        qint64 entryCount{-1}; /// only for directories, and only if asked for
+        QString linkTarget;
+        Status status{Failed};
+        bool isDir{false};     /// links are classified by their target
+        bool isLink{false};
+    };
+
+    struct Mount
+    {
+        QString path;
+        QString fsType;
+    };
+
+    /// All filesystem metadata access of MetadataFetcher goes through a
+    /// backend, so that tests can stand in for a slow or hung filesystem.
+    /// stat() is called from the worker threads and may block; mounts() is
+    /// called from the GUI thread and must not.
+    class FsBackend
+    {
+    public:
+        virtual ~FsBackend() = default;
+        virtual FileMetadata stat(const QString& path, bool countEntries) = 0;
+        virtual QList<Mount> mounts() = 0;
+    };
+
+    class PosixBackend final : public FsBackend
+    {
+    public:
+        FileMetadata stat(const QString& path, bool countEntries) override;
+        QList<Mount> mounts() override;
+    };
+
+    /// Fetches file metadata off the GUI thread.
+    ///
+    /// Requests made during the same pass of the event loop (e.g., while the
+    /// views are painting) are collected into batches, one set per mount.
+    /// A mount gets at most a couple of worker threads, so a hung mount can't
+    /// starve the others.  If a batch doesn't finish within the timeout of its
+    /// mount, counted from when a worker starts on it, its paths are reported
+    /// as Unreachable and the mount's circuit breaker opens: requests for that
+    /// mount are answered with Unreachable, without touching the disk, until
+    /// the cool-down has passed.  Then a single batch is let through to probe
+    /// the mount.  The workers stuck on mounts that didn't answer are made up
+    /// for with more threads, up to a few; past that, no mount is probed.
+    ///
+    /// Results, including the rejected ones, are always delivered with
+    /// fetched() from the event loop, never from within request().  Once the
+    /// cool-down of a mount has passed, reachable() says so, so that what was
+    /// given up on can be asked for again.
+    class MetadataFetcher final : public QObject
+    {
+        Q_OBJECT
+
+    signals:
+        void fetched(const QList<core::FileMetadata>& batch);
+        void reachable(const QString& mount);
+
+    public:
+        static constexpr int LOCAL_TIMEOUT   = 2000;
+        static constexpr int NETWORK_TIMEOUT = 5000;
+        static constexpr int COOLDOWN        = 15000;
+        static constexpr int MAX_COOLDOWN    = 5 * 60 * 1000;
+
+        explicit MetadataFetcher(QObject* parent = nullptr);
+        explicit MetadataFetcher(std::unique_ptr<FsBackend> backend, QObject* parent = nullptr);
+        ~MetadataFetcher() override;
+
+        void request(const QString& path, bool countEntries = false);
+        [[nodiscard]] bool isReachable(const QString& path);
+        [[nodiscard]] QString mountOf(const QString& path);
+
+        void setTimeout(const QString& mount, int msec);
+        void setCooldown(int msec);
+
+    private:
+        struct MountState
+        {
+            enum Breaker { Closed, Open, HalfOpen };
+
+            int timeout{LOCAL_TIMEOUT};
+            int inFlight{0};
+            int failures{0};
+            Breaker breaker{Closed};
+            QDeadlineTimer openUntil;
+            QList<std::pair<QString, bool>> pending;
+        };
+
+        struct Task
+        {
+            QString mount;
+            QStringList paths;
+            bool timedOut{false};
+        };
+
+        void dispatch();
+        void dispatch(const QString& mount, MountState& state);
+        void onStarted(quint64 id);
+        void onFinished(quint64 id, const QList<FileMetadata>& results);
+        void onTimeout(quint64 id);
+        void reject(const QString& path);
+        void trip(const QString& mount, MountState& state);
+        void resizePool();
+        void refreshMounts();
+        MountState& stateOf(const QString& mount);
+
+        /// what the worker threads hold on to; it may outlive the fetcher if a
+        /// worker is stuck on a hung mount.
+        struct Shared;
+        std::shared_ptr<Receiver<MetadataFetcher>> _receiver;
+        std::shared_ptr<Shared> _shared;
+        QThreadPool* _pool{nullptr};
+        QTimer* _timer{nullptr};
+        int _threads{0};
+        int _stuck{0};  /// workers still on a batch that timed out
+
+        QList<Mount> _mounts; /// longest path first
+        QDeadlineTimer _mountsExpiry;
+        QHash<QString, MountState> _states;
+        QHash<QString, int> _timeouts;
+        int _cooldown{COOLDOWN};
+
+        QHash<quint64, Task> _tasks;
+        quint64 _nextTask{0};
+        QHash<QString, bool> _requested; /// path -> countEntries; pending or being fetched
+        QList<FileMetadata> _rejected;
+    };
+}
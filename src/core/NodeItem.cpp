@@ -3,10 +3,10 @@
 
 #include "NodeItem.hpp"
 #include "FileSystemScene.hpp"
+#include "MetadataFetcher.hpp"
 #include "SceneStorage.hpp"
 #include "SessionManager.hpp"
 #include "layout.hpp"
-#include "gui/theme/theme.hpp"
 
 #include <QDir>
 #include <QGraphicsScene>
@@ -20,6 +20,7 @@
 #include <ranges>
 #include <stack>
 #include <unordered_set>
+#include <utility>
 
 
 using namespace core;
@@ -32,6 +33,16 @@ namespace
         return qgraphicsitem_cast<const RootItem*>(node) != nullptr;
     }
 
+    /// moves a subtree as one, through its own position, while it's dragged.
+    class DragGroupItem final : public QGraphicsItem
+    {
+    public:
+        DragGroupItem() { setFlag(ItemHasNoContents); }
+
+        [[nodiscard]] QRectF boundingRect() const override { return {}; }
+        void paint(QPainter*, const QStyleOptionGraphicsItem*, QWidget*) override {}
+    };
+
     /// TODO rename
     std::vector<std::pair<QGraphicsItem*, QPointF>> getAncestorPos(const NodeItem* node)
     {
@@ -140,12 +151,29 @@ namespace
         return path;
     }
 
+    /// an arc around center that goes clockwise from the top; a full circle
+    /// is 1 TiB.
+    void paintDiskUsage(QPainter* p, const NodeItem* node, const QPointF& center, qreal radius,
+        const QPen& pen)
+    {
+        constexpr auto FULL_CIRCLE_L2 = 40.0;
+
+        auto ok = false;
+        if (const auto sizel2 = node->data(NodeItem::DiskUsageKey).toDouble(&ok); ok && sizel2 > 0.0) {
+            const auto span = qRound(qMin(sizel2 / FULL_CIRCLE_L2, 1.0) * -360 * 16);
+
+            p->setPen(pen);
+            p->setBrush(Qt::NoBrush);
+            p->drawArc(QRectF(center.x() - radius, center.y() - radius, radius * 2, radius * 2), 90 * 16, span);
+        }
+    }
+
     void paintClosedFolder(QPainter* p, const QStyleOptionGraphicsItem *option, const NodeItem* node)
     {
         Q_ASSERT(node->isClosed());
         Q_ASSERT(node->shape().elementCount() == 4);
 
-        const auto* tm = SessionManager::tm();
+        const auto& rc = SessionManager::rc();
 
         const auto rec    = node->boundingRect();
         const auto center = rec.center();
@@ -157,32 +185,29 @@ namespace
                                         << center
                                         << shape.elementAt(2);
 
-        const auto color1 = node->isSelected() || (option->state & QStyle::State_MouseOver)
-            ? tm->closedNodeMidlightColor()
-            : tm->closedNodeColor();
-        const auto color2 = node->isSelected() || (option->state & QStyle::State_MouseOver)
-            ? tm->closedNodeMidlightColor()
-            : tm->closedNodeMidarkColor();
+        const auto hover = node->isSelected() || (option->state & QStyle::State_MouseOver);
 
-        p->setBrush(tm->closedNodeDarkColor());
+        p->setBrush(rc.closedNodeBody);
         p->setPen(Qt::NoPen);
         p->drawPath(shape);
 
         p->setBrush(Qt::NoBrush);
-        p->setPen(QPen(color2, 2));
+        p->setPen(hover ? rc.closedNodeSpineHover : rc.closedNodeSpine);
         p->drawLine(QLineF(spine.pointAt(0.1), spine.pointAt(0.5)));
 
-        p->setBrush(tm->closedNodeDarkColor());
+        p->setBrush(rc.closedNodeBody);
         constexpr auto rec2 = QRectF(-6, -6, 12, 12);
         p->drawEllipse(rec2);
 
         p->setPen(Qt::NoPen);
-        p->setBrush(color1);
+        p->setBrush(hover ? rc.closedNodeHover : rc.closedNode);
         p->drawPolygon(tri);
 
+        paintDiskUsage(p, node, rec2.center(), 3.5, hover ? rc.closedNodeUsageHover : rc.closedNodeUsage);
+
         if (node->isLink()) {
             p->setBrush(Qt::NoBrush);
-            p->setPen(QPen(tm->closedNodeMidlightColor(), 1, Qt::DotLine));
+            p->setPen(rc.closedNodeLink);
             shape.closeSubpath();
             p->drawPath(shape);
         }
@@ -190,12 +215,17 @@ namespace
 
     void paintFile(QPainter* p, const QStyleOptionGraphicsItem *option, const NodeItem* node)
     {
-        const auto* tm   = SessionManager::tm();
+        const auto& rc   = SessionManager::rc();
         const auto shape = node->shape();
         const auto axis  = QLineF(shape.elementAt(2), shape.elementAt(0));
 
+        /// files of a known type get the tint of their category on the spine
+        /// and the outline.
+        const auto category = static_cast<std::size_t>(qBound(0, node->data(NodeItem::FileCategoryKey).toInt(),
+            FileCategoryCount - 1));
+
         /// 1. draw spine
-        p->setPen(QPen(tm->fileNodeDarkColor(), 4, Qt::SolidLine, Qt::SquareCap));
+        p->setPen(rc.fileSpine[category]);
         p->setBrush(Qt::NoBrush);
         auto spine = axis;
         spine.setLength(spine.length() + 2);
@@ -203,19 +233,45 @@ namespace
         p->drawLine(spine);
 
         /// 2. draw body
-        p->setBrush(tm->fileNodeDarkColor());
-        auto sizeColor = tm->fileNodeLightColor();
+        const auto selected = static_cast<bool>(option->state & QStyle::State_Selected);
 
-        if (option->state & QStyle::State_Selected) {
-            p->setBrush(tm->fileNodeMidlightColor());
-            sizeColor = tm->fileNodeDarkColor();
+        if (selected) {
+            p->setBrush(rc.fileBodySelected);
         } else if (option->state & QStyle::State_MouseOver) {
-            p->setBrush(tm->fileNodeMidarkColor());
+            p->setBrush(rc.fileBodyHover);
+        } else {
+            p->setBrush(rc.fileBody);
         }
-        p->setPen(node->isLink() ? QPen(tm->fileNodeMidlightColor(), 1, Qt::DotLine) : Qt::NoPen);
+        p->setPen(node->isLink() ? rc.fileLinkOutline[category] : rc.fileOutline[category]);
         p->drawPath(shape);
 
-        /// 3. draw file size indicator
+        /// 3. draw the thumbnail in place of the size indicator; not asked
+        /// for while the node is too small on screen to tell what it shows.
+        constexpr auto THUMBNAIL_MIN_LOD = 0.5;
+
+        if (option->levelOfDetailFromTransform(p->worldTransform()) >= THUMBNAIL_MIN_LOD) {
+            if (const auto* pixmap = SessionManager::scene()->thumbnail(node->pathId())) {
+                const auto bounds = shape.boundingRect();
+                auto target       = QRectF(QPointF(), pixmap->size().scaled(bounds.size().toSize(),
+                    Qt::KeepAspectRatioByExpanding));
+                target.moveCenter(bounds.center());
+
+                p->save();
+                p->setClipPath(shape, Qt::IntersectClip);
+                p->setRenderHint(QPainter::SmoothPixmapTransform);
+                p->drawPixmap(target, *pixmap, pixmap->rect());
+                p->restore();
+
+                if (option->state & (QStyle::State_Selected | QStyle::State_MouseOver)) {
+                    p->setPen(rc.fileThumbnailFrame);
+                    p->setBrush(Qt::NoBrush);
+                    p->drawPath(shape);
+                }
+                return;
+            }
+        }
+
+        /// 4. draw file size indicator
         const auto axisLen = 1.0 / axis.length();
 
         const auto lhs = QLineF(shape.elementAt(2), shape.elementAt(1)).normalVector().unitVector();
@@ -238,7 +294,7 @@ namespace
                 path.lineTo(p1);
                 path.lineTo(p1 + rhsDxy * (i+1.5));
 
-                p->setPen(QPen(sizeColor, i+1, Qt::SolidLine, Qt::SquareCap, Qt::BevelJoin));
+                p->setPen(rc.fileSizePen(selected, i+1));
                 p->drawPath(path);
 
                 t += (i+4) * axisLen;
@@ -250,7 +306,7 @@ namespace
                 path.lineTo(p1);
                 path.lineTo(p1 + rhsDxy * (full+1.5) * rem);
 
-                p->setPen(QPen(sizeColor, full+1, Qt::SolidLine, Qt::SquareCap, Qt::BevelJoin));
+                p->setPen(rc.fileSizePen(selected, full+1));
                 p->drawPath(path);
             }
         }
@@ -313,11 +369,11 @@ void RootItem::paint(QPainter *p, const QStyleOptionGraphicsItem *option, QWidge
     Q_UNUSED(option)
     Q_UNUSED(widget);
 
-    const auto* tm = SessionManager::tm();
+    const auto& rc = SessionManager::rc();
 
     p->setRenderHint(QPainter::Antialiasing);
-    p->setPen(QPen(tm->closedNodeDarkColor(), 5));
-    p->setBrush(tm->closedNodeColor());
+    p->setPen(rc.rootRim);
+    p->setBrush(rc.closedNode);
     p->drawEllipse(boundingRect().adjusted(5, 5, -5, -5));
 }
 
@@ -351,11 +407,11 @@ void KnotItem::paint(QPainter *p, const QStyleOptionGraphicsItem *option, QWidge
     Q_UNUSED(option)
     Q_UNUSED(widget);
 
-    const auto* tm = SessionManager::tm();
+    const auto& rc = SessionManager::rc();
 
     p->setRenderHint(QPainter::Antialiasing);
     p->setPen(Qt::NoPen);
-    p->setBrush(tm->openNodeColor());
+    p->setBrush(rc.openNode);
     p->drawEllipse(boundingRect());
 }
 
@@ -407,25 +463,30 @@ void NodeItem::createChildNodes()
 {
     Q_ASSERT(parentEdge());
     Q_ASSERT(knot());
-    Q_ASSERT(_index.isValid());
 
-    const auto* model = _index.model();
-    const auto count  = std::min(NODE_CHILD_COUNT, model->rowCount(_index));
+    const auto parent = index();
+    Q_ASSERT(parent.isValid());
+
+    const auto* model = parent.model();
+    const auto count  = std::min(NODE_CHILD_COUNT, model->rowCount(parent));
     const auto sides  = count
         + 1  // for parentEdge()
         + 1; // for knot()
 
+    auto* fs = fsScene();
+
     QList<NodeData> data;
 
     for (const auto i : std::views::iota(0, count)) {
-        const auto index = model->index(i, 0, _index);
+        const auto index = model->index(i, 0, parent);
         const auto norm  = getNgonSideNorm(i, sides);
 
         auto nodeLine = QLineF(pos(), pos() + QPointF(norm.dx(), norm.dy()));
         nodeLine.setLength(NODE_DEFAULT_LENGTH);
 
         data.push_back(
-            { .index    = index,
+            { .handle   = fs->handle(index),
+              .row      = i,
               .type     = NodeType::ClosedNode,  /// check for LinkNode???
               .firstRow = 0,
               .pos      = nodeLine.p2(),
@@ -440,17 +501,28 @@ void NodeItem::createChildNodes(QList<NodeData>& data)
 {
     Q_ASSERT(scene());
     Q_ASSERT(_childEdges.empty());
-    Q_ASSERT(_index.isValid());
     Q_ASSERT(_extra == nullptr);
     Q_ASSERT(!_nodeFlags.testAnyFlag(FileNode));
 
     _knot->show();
     setNodeFlags((_nodeFlags & NodeFlags(LinkNode)) | NodeFlags(OpenNode));
 
-    const auto count = std::min(NODE_CHILD_COUNT, _index.model()->rowCount(_index));
+    auto* fs          = fsScene();
+    const auto parent = index();
+    Q_ASSERT(parent.isValid());
+    const auto count  = std::min(NODE_CHILD_COUNT, parent.model()->rowCount(parent));
 
     for (auto& d : data | views::take(count)) {
-        d.edge = createNode(d.index, this);
+        /// the row is only a hint; the handle decides.
+        auto index = parent.model()->index(d.row, 0, parent);
+        if (fs->handle(index) != d.handle) {
+            index = fs->resolve(d.handle);
+        }
+        if (!index.isValid()) {
+            continue;
+        }
+
+        d.edge = createNode(index, this);
         scene()->addItem(d.edge->target());
         scene()->addItem(d.edge);
         asNodeItem(d.edge->target())->_length = d.length;
@@ -460,7 +532,7 @@ void NodeItem::createChildNodes(QList<NodeData>& data)
     }
 
     for (const auto& d : data) {
-        _childLengths.insert(d.index, d.length);
+        _childLengths.insert(d.handle, d.length);
     }
 
     updateFirstRow();
@@ -480,7 +552,8 @@ void NodeItem::onRowsInserted(int start, int end)
         return;
     }
 
-    const auto rowCount = std::min(NODE_CHILD_COUNT, _index.model()->rowCount(_index));
+    const auto parent   = index();
+    const auto rowCount = std::min(NODE_CHILD_COUNT, parent.model()->rowCount(parent));
 
     if (const int growth = rowCount - _childEdges.size(); growth > 0) {
         NodeVector nodes;
@@ -554,7 +627,8 @@ void NodeItem::onRowsRemoved(int start, int end)
 
     auto targetNodes = _childEdges | asTargetNode;
 
-    const auto ghostNodes = static_cast<int>(_childEdges.size()) - _index.model()->rowCount(_index);
+    const auto parent     = index();
+    const auto ghostNodes = static_cast<int>(_childEdges.size()) - parent.model()->rowCount(parent);
 
     /// 2. destroy excess nodes.
     if (EdgeDeque edges; ghostNodes > 0) {
@@ -586,13 +660,13 @@ void NodeItem::onRowsRemoved(int start, int end)
 
     auto availableNodes = _childEdges | asFilesOrClosedTargetNodes;
     auto availableIndices = availableNodes | asIndex;
-    if (ranges::all_of(availableIndices, &QPersistentModelIndex::isValid)) {
+    if (ranges::all_of(availableIndices, &QModelIndex::isValid)) {
         return;
     }
 
     if (const auto count = ranges::distance(availableIndices); count > 0) {
-        auto startIndex = _index.model()->sibling(0, 0, _index);
-        if (auto betterStart = ranges::find_if(availableIndices, &QPersistentModelIndex::isValid);
+        auto startIndex = parent.model()->sibling(0, 0, parent);
+        if (auto betterStart = ranges::find_if(availableIndices, &QModelIndex::isValid);
             betterStart != availableIndices.end()) {
             startIndex = *betterStart;
         }
@@ -626,8 +700,9 @@ void NodeItem::onRowsAboutToBeRemoved(int start, int end)
     EdgeDeque edges;
 
     for (auto* node : targetNodes) {
-        Q_ASSERT(node->index().isValid());
-        if (const auto row = node->index().row(); row >= start && row <= end) {
+        const auto index = node->index();
+        Q_ASSERT(index.isValid());
+        if (const auto row = index.row(); row >= start && row <= end) {
             if (node->isDir() && !node->isClosed()) {
                 node->close();
             }
@@ -636,33 +711,163 @@ void NodeItem::onRowsAboutToBeRemoved(int start, int end)
     }
 }
 
+/// the metadata is not known yet; it is requested the first time the node is
+/// painted (see paint()).
 void NodeItem::setIndex(const QPersistentModelIndex& index)
 {
     Q_ASSERT(index.isValid());
 
-    _index = index;
+    auto* scene = SessionManager::scene();
+
+    setHandle(scene->handle(index));
+    _nodeFlags = scene->classify(_handle.id);
+
+    setData(FileSizeKey, QVariant());
+    setData(MetadataStateKey, QVariant());
+    setData(DiskUsageKey, QVariant());
+    setData(DuplicateGroupKey, scene->duplicateGroup(_handle.id));
+    if (isPending()) {
+        scene->requestClassification(_handle.id);
+    } else if (isFile()) {
+        scene->requestFileCategory(_handle.id);
+    }
+    setData(FileCategoryKey, isFile() && !isPending() ? scene->fileCategory(_handle.id) : OtherFile);
+    setData(GitStateKey, scene->gitState(_handle.id));
+    setToolTip(QString());
+}
 
-    if (SessionManager::scene()->isDir(index)) {
-        _nodeFlags = NodeType::ClosedNode;
+/// the scene didn't know the type of the entry when the node was given its
+/// index; once a listing or the fetcher has told it, the node takes it on.
+void NodeItem::reclassify()
+{
+    if (!isPending()) {
+        return;
+    }
+
+    auto* scene      = fsScene();
+    const auto flags = scene->classify(_handle.id);
+
+    if (flags.testAnyFlag(PendingNode)) {
+        return;
+    }
+
+    setNodeFlags(flags);
+
+    if (isFile()) {
+        scene->requestFileCategory(_handle.id);
+        setData(FileCategoryKey, scene->fileCategory(_handle.id));
+    }
+
+    update();
+}
+
+/// the scene doesn't know the type of the entry yet; the flags the node was
+/// saved with stand in until it does (see reclassify()).
+void NodeItem::restoreNodeFlags(NodeFlags saved)
+{
+    if (isPending()) {
+        const auto type = saved.testAnyFlag(FileNode) ? FileNode : ClosedNode;
+        setNodeFlags(NodeFlags(type) | (saved & NodeFlags(LinkNode)) | NodeFlags(PendingNode));
+    }
+}
+
+/// the index of the entry the handle is of, as the scene shows it now; none
+/// once the entry is gone, or hidden.
+QModelIndex NodeItem::index() const
+{
+    return SessionManager::scene()->resolve(_handle);
+}
+
+/// the scene finds the node by the path of handle from now on; a node is
+/// given its handle before it is added to the scene.
+void NodeItem::setHandle(const NodeHandle& handle)
+{
+    auto* scene = SessionManager::scene();
+
+    if (!_handle.isNull()) {
+        scene->forgetNode(this);
+    }
+    _handle = handle;
+    if (!_handle.isNull()) {
+        scene->noteNode(this);
+    }
+}
+
+void NodeItem::setMetadata(const FileMetadata& metadata)
+{
+    /// an unreachable node keeps whatever it showed before.
+    if (metadata.status == FileMetadata::Unreachable) {
+        setData(MetadataStateKey, MetadataUnreachable);
     } else {
-        _nodeFlags = NodeType::FileNode;
-        const auto size = SessionManager::scene()->fileSize(_index);
-        setData(FileSizeKey, size > 0 ? std::log2(size) : 0.0);
+        setData(MetadataStateKey, MetadataReady);
+        setData(FileSizeKey, metadata.size > 0 ? std::log2(metadata.size) : 0.0);
+
+        if (isLink()) {
+            setToolTip(metadata.linkTarget);
+        }
     }
 
-    if (SessionManager::scene()->isLink(index)) {
-        _nodeFlags |= NodeType::LinkNode;
+    update();
+}
+
+/// the mount didn't answer before, and may now; the metadata is requested
+/// again the next time the node is painted.
+void NodeItem::retryMetadata()
+{
+    if (data(MetadataStateKey).toInt() == MetadataUnreachable) {
+        setData(MetadataStateKey, QVariant());
+        update();
+    }
+}
+
+/// size is the recursive size of the folder, as found by DiskUsage.
+void NodeItem::setDiskUsage(qint64 size)
+{
+    setData(DiskUsageKey, size > 0 ? std::log2(size) : 0.0);
+
+    update();
+}
+
+/// group is what FileSystemScene::duplicateGroup() returns; 0 is none.
+void NodeItem::setDuplicateGroup(int group)
+{
+    if (data(DuplicateGroupKey).toInt() != group) {
+        setData(DuplicateGroupKey, group);
+        update();
+    }
+}
+
+/// category is what FileSystemScene::fileCategory() returns.
+void NodeItem::setFileCategory(int category)
+{
+    if (data(FileCategoryKey).toInt() != category) {
+        setData(FileCategoryKey, category);
+        update();
+    }
+}
+
+/// state is what FileSystemScene::gitState() returns.
+void NodeItem::setGitState(int state)
+{
+    if (data(GitStateKey).toInt() != state) {
+        setData(GitStateKey, state);
+        update();
     }
 }
 
 QString NodeItem::name() const
 {
-    Q_ASSERT(_index.isValid());
+    Q_ASSERT(_handle.id != 0);
+
+    return SessionManager::scene()->name(_handle.id);
+}
 
-    const auto datum = _index.data();
-    Q_ASSERT(datum.isValid());
+/// the interned path; no need to build it again from the model.
+QString NodeItem::path() const
+{
+    Q_ASSERT(_handle.id != 0);
 
-    return datum.toString();
+    return SessionManager::scene()->path(_handle.id);
 }
 
 QRectF NodeItem::boundingRect() const
@@ -716,29 +921,49 @@ bool NodeItem::hasOpenOrHalfClosedChild() const
 
 void NodeItem::paint(QPainter *p, const QStyleOptionGraphicsItem *option, QWidget *widget)
 {
-    Q_UNUSED(option);
     Q_UNUSED(widget);
 
-    const auto* tm  = SessionManager::tm();
+    if (!data(MetadataStateKey).isValid()) {
+        setData(MetadataStateKey, MetadataPending);
+        fsScene()->requestMetadata(this);
+    }
+
+    /// a recursive scan for every closed folder in view would be too much
+    /// while zoomed out; only those that can show their size are scanned.
+    constexpr auto DISK_USAGE_MIN_LOD = 0.5;
+
+    if (isClosed() && !data(DiskUsageAskedKey).toBool()
+            && option->levelOfDetailFromTransform(p->worldTransform()) >= DISK_USAGE_MIN_LOD) {
+        fsScene()->requestDiskUsage(this);
+    }
+
+    const auto& rc  = SessionManager::rc();
     const auto& rec = boundingRect();
     p->setRenderHint(QPainter::Antialiasing);
-    p->setBrush(isSelected() || (option->state & QStyle::State_MouseOver) ?
-        tm->openNodeMidlightColor() : tm->openNodeColor());
+
+    /// what git ignores fades into the background.
+    const auto gitState = data(GitStateKey).toInt();
+    if (gitState == GitIgnored) {
+        p->setOpacity(p->opacity() * 0.4);
+    }
+
+    p->setBrush(isSelected() || (option->state & QStyle::State_MouseOver) ? rc.openNodeHover : rc.openNode);
 
     qreal radius = 0;
     if (isFile()) {
         paintFile(p, option, this);
     } else if (isOpen()) {
         radius = rec.width() * 0.5 - NODE_OPEN_PEN_WIDTH * 0.5;
-        p->setPen(QPen(tm->openNodeLightColor(), NODE_OPEN_PEN_WIDTH, Qt::SolidLine));
+        p->setPen(rc.openNodeRim);
         p->drawEllipse(rec.center(), radius, radius);
+        paintDiskUsage(p, this, rec.center(), radius - NODE_OPEN_PEN_WIDTH * 1.5, rc.openNodeUsage);
     } else if (isClosed()) {
         paintClosedFolder(p, option, this);
     } else if (isHalfClosed()) {
         radius = rec.width() * 0.5 - NODE_HALF_CLOSED_PEN_WIDTH * 0.5;
-        p->setPen(QPen(tm->closedNodeDarkColor(), NODE_HALF_CLOSED_PEN_WIDTH, Qt::SolidLine));
+        p->setPen(rc.halfClosedNodeRim);
         p->drawEllipse(rec.center(), radius, radius);
-        p->setPen(QPen(tm->openNodeLightColor(), NODE_HALF_CLOSED_PEN_WIDTH, Qt::SolidLine));
+        p->setPen(rc.halfClosedNodeArc);
         p->setBrush(Qt::NoBrush);
         /// draw a 20 degree arc indicator for every child edge that is visible.
         auto rec2 = QRectF(0, 0, radius * 2, radius * 2);
@@ -751,6 +976,27 @@ void NodeItem::paint(QPainter *p, const QStyleOptionGraphicsItem *option, QWidge
             }
         }
     }
+    if (data(DuplicateGroupKey).toInt() > 0) {
+        /// a solid ring around files that have the same contents as others.
+        p->setPen(rc.duplicateRing);
+        p->setBrush(Qt::NoBrush);
+        p->drawEllipse(rec.adjusted(1, 1, -1, -1));
+    }
+    if (gitState == GitModified || gitState == GitUntracked) {
+        /// a dot at the top right; filled if modified, hollow if untracked.
+        constexpr qreal GIT_DOT_RADIUS = 3.5;
+        const auto center = rec.topRight() + QPointF(-GIT_DOT_RADIUS, GIT_DOT_RADIUS);
+
+        p->setPen(rc.gitDot);
+        p->setBrush(gitState == GitModified ? rc.gitModified : QBrush(Qt::NoBrush));
+        p->drawEllipse(center, GIT_DOT_RADIUS, GIT_DOT_RADIUS);
+    }
+    if (data(MetadataStateKey).toInt() == MetadataUnreachable) {
+        /// a dashed ring around nodes on a mount that did not answer.
+        p->setPen(rc.unreachableRing);
+        p->setBrush(Qt::NoBrush);
+        p->drawEllipse(rec.adjusted(1, 1, -1, -1));
+    }
     if (auto *pr = asNodeItem(parentEdge()->source()); pr && pr->isHalfClosed()) {
         /// need to update the half-closed parent to avoid tearing of the
         /// 20-degree arc. A node can be Open, Closed, or Half-Closed and have
@@ -813,7 +1059,7 @@ void NodeItem::closeOrHalfClose(bool forceClose)
 
 void NodeItem::open()
 {
-    Q_ASSERT(fsScene()->isDir(_index));
+    Q_ASSERT(isPending() || fsScene()->isDir(index()));
     Q_ASSERT(!_nodeFlags.testAnyFlag(FileNode));
 
     if (isClosed()) {
@@ -822,10 +1068,10 @@ void NodeItem::open()
         createChildNodes();
         spread();
         adjustAllEdges(this);
-        fsScene()->fetchMore(_index);
+        fsScene()->fetchMore(index());
 
         Q_ASSERT(std::ranges::all_of(_childEdges | asTargetNodeIndex,
-            &QPersistentModelIndex::isValid));
+            &QModelIndex::isValid));
 
     } else if (isHalfClosed()) {
         setNodeFlags((_nodeFlags & NodeFlags(LinkNode)) | NodeFlags(OpenNode));
@@ -850,23 +1096,68 @@ void NodeItem::rotate(Rotation rot)
     }
 }
 
-void NodeItem::rotatePage(Rotation rot)
+/// rotates by rows, and by pages times the number of rows shown, in a
+/// single step: jumps to one row short of where the rotation ends, and
+/// animates only the last rotation, as seekTo() does.  Positive is CW.  The
+/// rows and files are reassigned, and saved, once, however far it goes.
+/// Returns false, without doing anything, while the node is still rotating.
+bool NodeItem::rotateBy(int rows, int pages)
 {
     if (!isOpen()) {
-        return;
+        return true;
+    }
+    if (animator->isAnimating(this)) {
+        return false;
     }
 
-    auto availableNodes = _childEdges | asFilesOrClosedTargetNodes;
-    const auto pageSize = ranges::distance(availableNodes);
+    auto availableRows = _childEdges
+        | asFilesOrClosedTargetNodes
+        | asIndexRow
+        ;
+
+    const auto pageSize = static_cast<int>(ranges::distance(availableRows));
+    const auto steps    = rows + pages * pageSize;
 
-    if (pageSize > 0) {
-        animator->animatePageRotation(this, rot, pageSize);
+    if (pageSize == 0 || steps == 0) {
+        return true;
     }
+
+    if (qAbs(steps) > 1) {
+        const auto openOrHalfClosedRows = _childEdges
+            | asNotClosedTargetNodes
+            | asIndexRow
+            | ranges::to<std::unordered_set>()
+            ;
+
+        const auto parent   = index();
+        const auto rowCount = parent.model()->rowCount(parent);
+        const auto inc      = steps > 0 ? 1 : -1;
+        auto row            = *availableRows.begin();
+
+        for (auto left = qAbs(steps) - 1; left > 0 && row + inc >= 0 && row + inc < rowCount; ) {
+            row += inc;
+            if (!openOrHalfClosedRows.contains(row)) {
+                --left;
+            }
+        }
+
+        skipTo(row);
+    }
+
+    animator->animateRotation(this, steps > 0 ? Rotation::CW : Rotation::CCW);
+
+    return true;
+}
+
+bool NodeItem::isRotating() const
+{
+    return animator->isAnimating(this);
 }
 
 void NodeItem::skipTo(int row)
 {
-    const auto rowCount = _index.model()->rowCount(_index);
+    const auto parent   = index();
+    const auto rowCount = parent.model()->rowCount(parent);
 
     Q_ASSERT(std::ssize(_childEdges) <= rowCount);
 
@@ -877,7 +1168,7 @@ void NodeItem::skipTo(int row)
         return;
     }
 
-    auto target = _index.model()->index(row, 0, _index);
+    auto target = parent.model()->index(row, 0, parent);
 
     if (!target.isValid()) {
         return;
@@ -903,7 +1194,7 @@ void NodeItem::skipTo(int row)
         target = target.sibling(target.row() + 1, 0);
     } while (std::ssize(newIndices) < rows);
 
-    target = _index.model()->index(row - 1, 0, _index);
+    target = parent.model()->index(row - 1, 0, parent);
 
     while (std::ssize(newIndices) < rows) {
         if (!target.isValid()) { break; }
@@ -927,13 +1218,44 @@ void NodeItem::skipTo(int row)
     updateFirstRow();
 }
 
+/// brings row into view in a single step: jumps to the row before it, and
+/// animates only the last rotation.  Returns false, without doing anything,
+/// while the node is still rotating.
+bool NodeItem::seekTo(int row)
+{
+    if (!isOpen()) {
+        return true;
+    }
+    if (animator->isAnimating(this)) {
+        return false;
+    }
+
+    auto rows = _childEdges
+        | asFilesOrClosedTargetNodes
+        | asIndexRow
+        ;
+
+    if (ranges::find(rows, row) != ranges::end(rows)) {
+        return true;
+    }
+
+    if (row > 0) {
+        skipTo(row - 1);
+        rotate(Rotation::CW);
+    } else {
+        skipTo(row);
+    }
+
+    return true;
+}
+
 void NodeItem::grow(float amount)
 {
     if (isClosed() || isFile()) {
         const auto newLen = _length + amount;
         _length = qBound(NODE_MIN_LENGTH, newLen, NODE_MAX_LENGTH);
         if (auto* pn = asNodeItem(parentEdge()->source()); pn) {
-            pn->_childLengths[index()] = _length;
+            pn->_childLengths[_handle] = _length;
             pn->spread();
         }
     }
@@ -944,15 +1266,15 @@ void NodeItem::growChildren(float amount)
     for (auto* node : _childEdges | asFilesOrClosedTargetNodes) {
         const auto newLen = node->_length + amount;
         node->_length = qBound(NODE_MIN_LENGTH, newLen, NODE_MAX_LENGTH);
-        _childLengths[node->index()] = node->_length;
+        _childLengths[node->_handle] = node->_length;
     }
 
     spread();
 }
 
-float NodeItem::childLength(const QPersistentModelIndex& index) const
+float NodeItem::childLength(const NodeHandle& handle) const
 {
-    return _childLengths.value(index, NODE_DEFAULT_LENGTH);
+    return _childLengths.value(handle, NODE_DEFAULT_LENGTH);
 }
 
 QVariant NodeItem::itemChange(GraphicsItemChange change, const QVariant &value)
@@ -961,15 +1283,40 @@ QVariant NodeItem::itemChange(GraphicsItemChange change, const QVariant &value)
         case ItemScenePositionHasChanged:
             adjustAllEdges(this);
             SessionManager::ss()->saveNode(this);
+            fsScene()->keepInSceneRect(value.toPointF());
             break;
 
         case ItemSelectedChange:
             Q_ASSERT(value.canConvert<bool>());
             if (value.toBool()) { setZValue(1); } else { setZValue(0); }
 
-            if (isFile()) {
-                const auto size = fsScene()->fileSize(_index);
-                setData(FileSizeKey, size > 0 ? std::log2(size) : 0.0);
+            /// the watcher drops the metadata of a file that changed; fetch it
+            /// again if that happened since it was painted.
+            if (isFile() && value.toBool() && fsScene()->metadata(_handle.id) == nullptr) {
+                fsScene()->requestMetadata(this);
+            }
+            if (isClosed() && value.toBool() && !data(DiskUsageAskedKey).toBool()) {
+                fsScene()->requestDiskUsage(this);
+            }
+            break;
+
+        case ItemSelectedHasChanged:
+            if (auto* fs = fsScene()) {
+                fs->noteSelected(this, value.toBool());
+            }
+            break;
+
+        case ItemSceneChange:
+            /// a selected item that is removed isn't told it was deselected.
+            if (value.value<QGraphicsScene*>() == nullptr && scene() != nullptr) {
+                if (auto* fs = fsScene()) {
+                    fs->noteSelected(this, false);
+                    fs->forgetNode(this);
+                    fs->fitSceneRectLater();
+                }
+                animator->dropFromLayout(this);
+            } else if (auto* fs = qobject_cast<FileSystemScene*>(value.value<QGraphicsScene*>()); fs && !_handle.isNull()) {
+                fs->noteNode(this);
             }
             break;
 
@@ -986,10 +1333,13 @@ void NodeItem::mouseReleaseEvent(QGraphicsSceneMouseEvent *event)
         if (!_ancestorPos.empty()) {
             _ancestorPos.clear();
         }
+        if (_dragGroup != nullptr) {
+            endSubtreeDrag();
+        }
         if (isClosed() || isFile()) {
             _length = QLineF(parentEdge()->source()->pos(), parentEdge()->target()->pos()).length();
             if (auto* parent = asNodeItem(parentEdge()->source()); parent) {
-                parent->_childLengths[index()] = _length;
+                parent->_childLengths[_handle] = _length;
             }
         }
     }
@@ -999,9 +1349,21 @@ void NodeItem::mouseReleaseEvent(QGraphicsSceneMouseEvent *event)
 
 void NodeItem::mouseMoveEvent(QGraphicsSceneMouseEvent *event)
 {
-    const auto selects = scene()->selectedItems();
+    /// with Alt and Shift held, an open node is dragged with everything under
+    /// it as one group; nothing is spread, adjusted or saved until it is
+    /// dropped.  Alt alone zooms the view.
+    if (_dragGroup != nullptr
+        || (event->modifiers() == (Qt::AltModifier | Qt::ShiftModifier) && (isOpen() || isHalfClosed()))) {
+        if (_dragGroup == nullptr) {
+            beginSubtreeDrag();
+        }
+        _dragGroup->moveBy(event->scenePos().x() - event->lastScenePos().x(),
+            event->scenePos().y() - event->lastScenePos().y());
+        _parentEdge->adjust();
+        return;
+    }
 
-    if (selects.indexOf(this) != -1) {
+    if (isSelected()) {
         if (event->modifiers() & Qt::ShiftModifier) {
             if (_ancestorPos.empty()) {
                 _ancestorPos = getAncestorPos(this);
@@ -1032,10 +1394,7 @@ void NodeItem::mouseMoveEvent(QGraphicsSceneMouseEvent *event)
             /// spread this NodeItem and all the other NodeItems that are
             /// selected.  More than one nodeItem can be selected and moved,
             /// but the other ones do not recieve this event.
-            auto selectedNodes = scene()->selectedItems()
-                | views::transform(&asNodeItem)
-                | views::filter([](const NodeItem* item) { return item != nullptr; })
-                ;
+            const auto selectedNodes = fsScene()->selection().nodes();
 
             /// 1. spread the parent node(s).
             for (auto* selected : selectedNodes) {
@@ -1060,6 +1419,24 @@ void NodeItem::mouseMoveEvent(QGraphicsSceneMouseEvent *event)
     QGraphicsItem::mouseMoveEvent(event);
 }
 
+void NodeItem::hoverEnterEvent(QGraphicsSceneHoverEvent *event)
+{
+    if (isFile() && index().isValid()) {
+        fsScene()->beginPreview(this);
+    }
+
+    QGraphicsItem::hoverEnterEvent(event);
+}
+
+void NodeItem::hoverLeaveEvent(QGraphicsSceneHoverEvent *event)
+{
+    if (isFile()) {
+        fsScene()->endPreview(this);
+    }
+
+    QGraphicsItem::hoverLeaveEvent(event);
+}
+
 void NodeItem::setNodeFlags(const NodeFlags flags)
 {
     if (_nodeFlags != flags) {
@@ -1186,12 +1563,12 @@ void NodeItem::repositionAfterClose(EdgeItem* closed)
         | asTargetNode | asIndexRow
         | ranges::to<std::unordered_set>();
 
-    auto isGap = [](const QPersistentModelIndex& lhs, const QPersistentModelIndex& rhs)
+    auto isGap = [](const QModelIndex& lhs, const QModelIndex& rhs)
         { return lhs.row() + 1 < rhs.row(); };
     const auto first = fileOrClosedIndices.begin();
     const auto last  = fileOrClosedIndices.end() - 1;
 
-    auto assignIndex = [](EdgeItem* edge, const QPersistentModelIndex& index) {
+    auto assignIndex = [](EdgeItem* edge, const QModelIndex& index) {
         asNodeItem(edge->target())->setIndex(index);
         edge->setText(asNodeItem(edge->target())->name());
     };
@@ -1312,7 +1689,7 @@ InternalRotationAnimationData NodeItem::doInternalRotation(Rotation rot)
     if (auto found = ranges::find(_childEdges, insertPos); found != _childEdges.end()) {
         _extra->target()->setPos((*found)->target()->scenePos());
         if (auto* node = asNodeItem(_extra->target()); node) {
-            node->_length = childLength(node->index());
+            node->_length = childLength(node->_handle);
             toGrowLen = node->_length;
         }
         toGrow = _extra;
@@ -1326,7 +1703,7 @@ InternalRotationAnimationData NodeItem::doInternalRotation(Rotation rot)
         _extra = *found;
         auto* extraNode = asNodeItem(_extra->target());
         toShrinkLen = extraNode->length();
-        extraNode->_index = QModelIndex();
+        extraNode->setHandle({});
         _childEdges.erase(found);
         toShrink = _extra;
     } else { Q_ASSERT(false); }
@@ -1395,6 +1772,77 @@ void NodeItem::spread(const NodeItem* child)
     }
 }
 
+/// this node, the nodes under it, and the edges between them.
+QList<QGraphicsItem*> NodeItem::subtree()
+{
+    QList<QGraphicsItem*> result{this};
+
+    for (qsizetype i = 0; i < result.size(); ++i) {
+        auto* node = asNodeItem(result[i]);
+        if (node == nullptr) {
+            continue;
+        }
+        for (auto* edge : node->_childEdges) {
+            result.push_back(edge);
+            result.push_back(edge->target());
+        }
+        if (node->_extra) {
+            result.push_back(node->_extra);
+            result.push_back(node->_extra->target());
+        }
+    }
+
+    return result;
+}
+
+/// the subtree is put under one parent, which the drag moves.  The nodes
+/// stop sending scene position changes meanwhile; the edges between them
+/// move with them and don't need to be adjusted, only the parent edge does.
+void NodeItem::beginSubtreeDrag()
+{
+    Q_ASSERT(_dragGroup == nullptr);
+
+    animator->finishLayout();
+
+    _dragGroup = new DragGroupItem();
+    scene()->addItem(_dragGroup);
+
+    for (const auto items = subtree(); auto* item : items) {
+        if (auto* node = asNodeItem(item)) {
+            animator->clearAnimations(node);
+            node->setFlag(ItemSendsScenePositionChanges, false);
+        }
+        item->setParentItem(_dragGroup);
+    }
+}
+
+/// lays the subtree down where it was dropped, and saves it in one go.
+void NodeItem::endSubtreeDrag()
+{
+    Q_ASSERT(_dragGroup != nullptr);
+
+    const auto offset = _dragGroup->pos();
+
+    QList<const NodeItem*> moved;
+
+    for (const auto items = _dragGroup->childItems(); auto* item : items) {
+        item->setParentItem(nullptr);
+        item->setPos(item->pos() + offset);
+        if (auto* node = asNodeItem(item)) {
+            node->setFlag(ItemSendsScenePositionChanges, true);
+            fsScene()->keepInSceneRect(node->scenePos());
+            moved.push_back(node);
+        }
+    }
+
+    scene()->removeItem(_dragGroup);
+    delete _dragGroup;
+    _dragGroup = nullptr;
+
+    _parentEdge->adjust();
+    SessionManager::ss()->saveMovedNodes(moved);
+}
+
 void NodeItem::relayoutParent() const
 {
     if (auto* parentNode = asNodeItem(_parentEdge->source())) {
@@ -1445,6 +1893,14 @@ void core::updateAllChildNodes(const NodeItem* node)
     }
 }
 
+/// moves the nodes of data, each with its edges, from their old position
+/// to their new one; a layout that is still being animated is finished
+/// first.
+void core::animateLayout(const SpreadAnimationData& data)
+{
+    animator->animateLayout(data);
+}
+
 /// only used on closed nodes, but can be made more general if needed.
 void core::setAllEdgeState(const NodeItem* node, EdgeItem::State state)
 {
@@ -1467,19 +1923,6 @@ void Animator::animateRotation(NodeItem* node, Rotation rot)
     startAnimation(node);
 }
 
-void Animator::animatePageRotation(NodeItem* node, Rotation rot, int page)
-{
-    auto* seq = getSeq(node);
-
-    for (int i = 0; i< page; ++i) {
-        auto* anim = createVariantAnimation(25);
-        addRotation(node, rot, anim);
-        seq->addAnimation(anim);
-    }
-    fastforward(seq);
-    startAnimation(node);
-}
-
 void Animator::animateRelayout(NodeItem* node, EdgeItem* closedEdge)
 {
     auto* seq  = getSeq(node);
@@ -1514,6 +1957,13 @@ void Animator::clearAnimations(NodeItem* node)
     }
 }
 
+bool Animator::isAnimating(const NodeItem* node) const
+{
+    const auto found = _seqs.find(node);
+
+    return found != _seqs.end() && found->second->state() == QAbstractAnimation::Running;
+}
+
 void Animator::startAnimation(const NodeItem* node)
 {
     Q_ASSERT(_seqs.contains(node));
@@ -1632,6 +2082,79 @@ void Animator::startRelayout(NodeItem *node, EdgeItem *closedEdge, QVariantAnima
     _animData.emplace(va, QVariant::fromValue(data));
 }
 
+/// the nodes don't send scene position changes while they move, so that
+/// they are saved, and the scene rect grown, once at the end.
+void Animator::animateLayout(const SpreadAnimationData& data)
+{
+    finishLayout();
+
+    if (data.movement.empty()) {
+        return;
+    }
+
+    _layoutData = data;
+
+    for (auto* item : _layoutData.movement.keys()) {
+        item->setFlag(QGraphicsItem::ItemSendsScenePositionChanges, false);
+    }
+
+    _layout = createVariantAnimation(400);
+
+    connect(_layout, &QVariantAnimation::valueChanged,
+    [this] (const QVariant& value)
+    {
+        auto ok      = false;
+        const auto t = value.toReal(&ok); Q_ASSERT(ok);
+
+        for (QHashIterator it(_layoutData.movement); it.hasNext(); ) {
+            it.next();
+            it.key()->setPos(QLineF(it.value().oldPos, it.value().newPos).pointAt(t));
+        }
+        for (auto* item : _layoutData.movement.keys()) {
+            adjustAllEdges(asNodeItem(item));
+        }
+    });
+
+    connect(_layout, &QAbstractAnimation::finished, this, &Animator::finishLayout);
+
+    _layout->start();
+}
+
+void Animator::finishLayout()
+{
+    if (_layout == nullptr) {
+        return;
+    }
+
+    auto* va = std::exchange(_layout, nullptr);
+    disconnect(va, nullptr, this, nullptr);
+    va->stop();
+    va->deleteLater();
+
+    QList<const NodeItem*> moved;
+
+    for (QHashIterator it(_layoutData.movement); it.hasNext(); ) {
+        it.next();
+        auto* node = asNodeItem(it.key());
+        node->setPos(it.value().newPos);
+        node->setFlag(QGraphicsItem::ItemSendsScenePositionChanges, true);
+        moved.push_back(node);
+    }
+    for (const auto* node : moved) {
+        adjustAllEdges(node);
+        node->fsScene()->keepInSceneRect(node->scenePos());
+    }
+    _layoutData = {};
+
+    SessionManager::ss()->saveMovedNodes(moved);
+}
+
+/// an item that leaves the scene isn't moved any further.
+void Animator::dropFromLayout(QGraphicsItem* item)
+{
+    _layoutData.movement.remove(item);
+}
+
 
 QSequentialAnimationGroup* Animator::getSeq(const NodeItem* node)
 {
@@ -4,6 +4,7 @@
 #pragma once
 
 #include "EdgeItem.hpp"
+#include "MetadataCache.hpp"
 
 #include <QGraphicsItem>
 #include <QPersistentModelIndex>
@@ -21,6 +22,7 @@ class QSequentialAnimationGroup;
 namespace  core
 {
     class FileSystemScene;
+    struct FileMetadata;
 
     enum class Rotation
     {
@@ -37,6 +39,9 @@ namespace  core
         DirNode        = HalfClosedNode | ClosedNode | OpenNode,
         FileNode       = 0x0010,
         LinkNode       = 0x0020,
+        /// the type of the entry isn't known yet; shown as a file until the
+        /// scene finds out (see FileSystemScene::classify()).
+        PendingNode    = 0x0040,
     };
 
     Q_DECLARE_FLAGS(NodeFlags, NodeType)
@@ -102,7 +107,8 @@ namespace  core
 
     struct NodeData
     {
-        QPersistentModelIndex index;
+        NodeHandle handle;
+        int row{-1};  /// as of when the data was sorted
         NodeType type;
         int firstRow;
         QPointF pos;
@@ -124,6 +130,9 @@ namespace  core
         static constexpr qreal NODE_CLOSED_PEN_WIDTH      = EDGE_WIDTH * GOLDEN;
         static constexpr qreal NODE_HALF_CLOSED_PEN_WIDTH = NODE_OPEN_PEN_WIDTH * (1.0 - GOLDEN*GOLDEN*GOLDEN);
 
+        /// makes the pens that are as wide as the above.
+        friend struct RenderContext;
+
     public:
         static constexpr int NODE_CHILD_COUNT      = 24;  /// fixed for now.
         static constexpr float NODE_MIN_LENGTH     = 128;
@@ -134,6 +143,19 @@ namespace  core
         enum
         {
             FileSizeKey = 0,
+            MetadataStateKey,
+            DiskUsageKey,        /// log2 of the recursive size of a folder
+            DuplicateGroupKey,   /// 1 + index of the group of duplicates a file is in
+            FileCategoryKey,     /// the FileCategory of a file, once classified
+            GitStateKey,         /// the GitState of the node
+            DiskUsageAskedKey    /// set once a closed folder was given to DiskUsage
+        };
+
+        enum MetadataState
+        {
+            MetadataPending = 0,  /// requested; nothing is drawn for it
+            MetadataReady,
+            MetadataUnreachable   /// the mount did not answer in time
         };
 
         enum { Type = UserType + 2 };
@@ -151,7 +173,18 @@ namespace  core
         void onRowsAboutToBeRemoved(int start, int end);
 
         void setIndex(const QPersistentModelIndex& index);
+        void reclassify();
+        void restoreNodeFlags(NodeFlags saved);
+        void setMetadata(const FileMetadata& metadata);
+        void retryMetadata();
+        void setDiskUsage(qint64 size);
+        void setDuplicateGroup(int group);
+        void setFileCategory(int category);
+        void setGitState(int state);
         [[nodiscard]] QString name() const;
+        [[nodiscard]] QString path() const;
+        [[nodiscard]] PathId pathId() const         { return _handle.id; }
+        [[nodiscard]] NodeHandle handle() const     { return _handle; }
         [[nodiscard]] QRectF boundingRect() const override;
         [[nodiscard]] QPainterPath shape() const override;
         [[nodiscard]] bool hasOpenOrHalfClosedChild() const;
@@ -162,6 +195,7 @@ namespace  core
         [[nodiscard]] bool isOpen() const           { return _nodeFlags.testAnyFlag(OpenNode); }
         [[nodiscard]] bool isHalfClosed() const     { return _nodeFlags.testAnyFlag(HalfClosedNode); }
         [[nodiscard]] bool isLink() const           { return _nodeFlags.testAnyFlag(LinkNode); }
+        [[nodiscard]] bool isPending() const        { return _nodeFlags.testAnyFlag(PendingNode); }
         [[nodiscard]] NodeFlags nodeFlags() const   { return _nodeFlags; }
         [[nodiscard]] bool hasChildren() const      { return !_childEdges.empty(); }
         [[nodiscard]] int type() const override     { return Type; }
@@ -170,8 +204,8 @@ namespace  core
         [[nodiscard]] int firstRow() const          { return _firstRow; }
         [[nodiscard]] float length() const          { return _length; }
 
-        [[nodiscard]] const QPersistentModelIndex& index() const { return _index; }
-        [[nodiscard]] const EdgeDeque& childEdges() const        { return _childEdges; }
+        [[nodiscard]] QModelIndex index() const;
+        [[nodiscard]] const EdgeDeque& childEdges() const { return _childEdges; }
 
         void paint(QPainter *p, const QStyleOptionGraphicsItem *option, QWidget *widget) override;
         void close();
@@ -179,20 +213,26 @@ namespace  core
         void closeOrHalfClose(bool forceClose = false);
         void open();
         void rotate(Rotation rot);
-        void rotatePage(Rotation rot);
+        bool rotateBy(int rows, int pages = 0);
+        [[nodiscard]] bool isRotating() const;
         void skipTo(int row);
+        bool seekTo(int row);
         void grow(float amount);
         void growChildren(float amount);
-        float childLength(const QPersistentModelIndex& index) const;
+        float childLength(const NodeHandle& handle) const;
+        [[nodiscard]] const QHash<NodeHandle, float>& childLengths() const { return _childLengths; }
 
     protected:
         QVariant itemChange(GraphicsItemChange change, const QVariant& value) override;
         void mouseReleaseEvent(QGraphicsSceneMouseEvent *event) override;
         void mouseMoveEvent(QGraphicsSceneMouseEvent *event) override;
+        void hoverEnterEvent(QGraphicsSceneHoverEvent *event) override;
+        void hoverLeaveEvent(QGraphicsSceneHoverEvent *event) override;
         void setNodeFlags(NodeFlags flags);
 
     private:
         FileSystemScene* fsScene() const;
+        void setHandle(const NodeHandle& handle);
         void destroyChildren();
         void updateFirstRow();
 
@@ -202,19 +242,25 @@ namespace  core
         void spread(const QPointF& dxy = QPointF(0, 0));
         void spread(const NodeItem* child);
 
+        [[nodiscard]] QList<QGraphicsItem*> subtree();
+        void beginSubtreeDrag();
+        void endSubtreeDrag();
+
         void relayoutParent() const;
 
         NodeFlags _nodeFlags{NodeType::ClosedNode};
         int _firstRow{-1};
         float _length{NODE_DEFAULT_LENGTH};
-        QPersistentModelIndex _index;
+        NodeHandle _handle;
         EdgeItem* _parentEdge{nullptr};
         KnotItem* _knot{nullptr};
         EdgeItem* _extra{nullptr};
         EdgeDeque _childEdges;
-        QHash<QPersistentModelIndex, float> _childLengths;
+        QHash<NodeHandle, float> _childLengths;
 
         inline static std::vector<std::pair<QGraphicsItem*, QPointF>> _ancestorPos;
+        /// the parent of a subtree while it is dragged as a whole.
+        inline static QGraphicsItem* _dragGroup{nullptr};
 
         friend class Animator;
     };
@@ -227,15 +273,20 @@ namespace  core
     void updateAllChildNodes(const NodeItem* node);
     void setAllEdgeState(const NodeItem* node, EdgeItem::State state);
     SpreadAnimationData spreadWithAnimation(const NodeItem* parent);
+    void animateLayout(const SpreadAnimationData& data);
 
 
     class Animator final : public QObject
     {
     public:
         void animateRotation(NodeItem* node, Rotation rot);
-        void animatePageRotation(NodeItem* node, Rotation rot, int page);
         void animateRelayout(NodeItem* node, EdgeItem* closedEdge);
         void clearAnimations(NodeItem* node);
+        [[nodiscard]] bool isAnimating(const NodeItem* node) const;
+
+        void animateLayout(const SpreadAnimationData& data);
+        void finishLayout();
+        void dropFromLayout(QGraphicsItem* item);
 
     private:
         void startAnimation(const NodeItem* node);
@@ -254,6 +305,11 @@ namespace  core
 
         std::unordered_map<const NodeItem*, QSequentialAnimationGroup*> _seqs;
         std::unordered_map<const QVariantAnimation*, QVariant> _animData;
+
+        /// the nodes moved by the last relaxation of the scene, if it is
+        /// still being animated.
+        QVariantAnimation* _layout{nullptr};
+        SpreadAnimationData _layoutData;
     };
 
 
@@ -296,7 +352,7 @@ namespace  core
     inline auto asIndex = std::views::transform(&NodeItem::index);
     inline auto asIndexRow
         = asIndex
-        | std::views::transform(&QPersistentModelIndex::row)
+        | std::views::transform(&QModelIndex::row)
         ;
 
     inline auto asTargetNodeIndex
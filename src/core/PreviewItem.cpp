@@ -0,0 +1,96 @@
+/// Copyright (C) 2025 Arlen Avakian
+/// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "PreviewItem.hpp"
+#include "Previewer.hpp"
+#include "SessionManager.hpp"
+
+#include <QFileInfo>
+#include <QFontDatabase>
+#include <QFontMetricsF>
+#include <QLocale>
+#include <QPainter>
+
+
+using namespace core;
+
+PreviewItem::PreviewItem()
+    : _font(QFontDatabase::systemFont(QFontDatabase::FixedFont))
+{
+    const auto fm = QFontMetricsF(_font);
+    _ascent       = fm.ascent();
+    _lineSpacing  = fm.lineSpacing();
+
+    setFlag(ItemIgnoresTransformations);
+    setAcceptedMouseButtons(Qt::NoButton);
+    setZValue(2);
+    hide();
+}
+
+void PreviewItem::setPreview(const Preview& preview)
+{
+    prepareGeometryChange();
+
+    const auto size = QLocale().formattedDataSize(preview.size);
+
+    if (!preview.error.isEmpty()) {
+        _title = QString("%1: %2").arg(QFileInfo(preview.path).fileName(), preview.error);
+    } else {
+        _title = QString("%1 — %2%3")
+            .arg(QFileInfo(preview.path).fileName())
+            .arg(size)
+            .arg(preview.binary ? ", binary" : "");
+    }
+
+    _lines = preview.lines;
+
+    if (preview.truncated) {
+        _lines.push_back(QString(QChar(0x22ef)));
+    } else if (_lines.empty() && preview.error.isEmpty()) {
+        _lines.push_back("(empty)");
+    }
+
+    const auto fm  = QFontMetricsF(_font);
+    auto width     = fm.horizontalAdvance(_title);
+
+    for (const auto& line : std::as_const(_lines)) {
+        width = qMax(width, fm.horizontalAdvance(line));
+    }
+
+    const auto height = _lineSpacing * (_lines.size() + 1) + MARGIN / 2;
+
+    _rect = QRectF(0, 0, width + 2 * MARGIN, height + 2 * MARGIN);
+}
+
+QRectF PreviewItem::boundingRect() const
+{
+    return _rect;
+}
+
+void PreviewItem::paint(QPainter* p, const QStyleOptionGraphicsItem* option, QWidget* widget)
+{
+    Q_UNUSED(option)
+    Q_UNUSED(widget)
+
+    const auto& rc = SessionManager::rc();
+
+    p->save();
+    p->setRenderHint(QPainter::Antialiasing);
+    p->setPen(rc.previewRim);
+    p->setBrush(rc.previewBody);
+    p->drawRoundedRect(_rect.adjusted(0.5, 0.5, -0.5, -0.5), RADIUS, RADIUS);
+
+    p->setFont(_font);
+    auto baseline = QPointF(MARGIN, MARGIN + _ascent);
+
+    p->setPen(rc.previewTitle);
+    p->drawText(baseline, _title);
+    baseline.ry() += _lineSpacing + MARGIN / 2;
+
+    p->setPen(rc.previewText);
+    for (const auto& line : std::as_const(_lines)) {
+        p->drawText(baseline, line);
+        baseline.ry() += _lineSpacing;
+    }
+    p->restore();
+}
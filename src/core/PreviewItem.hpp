@@ -0,0 +1,41 @@
+/// Copyright (C) 2025 Arlen Avakian
+/// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <QFont>
+#include <QGraphicsItem>
+
+
+namespace core
+{
+    struct Preview;
+
+    /// The preview of the file under the mouse, drawn next to its node at
+    /// the same size whatever the zoom.
+    class PreviewItem final : public QGraphicsItem
+    {
+        static constexpr qreal MARGIN = 8.0;
+        static constexpr qreal RADIUS = 6.0;
+
+    public:
+        enum { Type = UserType + 7 };
+
+        PreviewItem();
+
+        void setPreview(const Preview& preview);
+
+        [[nodiscard]] QRectF boundingRect() const override;
+        void paint(QPainter* p, const QStyleOptionGraphicsItem* option, QWidget* widget) override;
+
+        [[nodiscard]] int type() const override { return Type; }
+
+    private:
+        QFont _font;
+        qreal _ascent{0};
+        qreal _lineSpacing{0};
+        QString _title;
+        QStringList _lines;
+        QRectF _rect;
+    };
+}
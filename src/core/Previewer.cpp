@@ -0,0 +1,277 @@
+/// Copyright (C) 2025 Arlen Avakian
+/// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "Previewer.hpp"
+
+#include <QFile>
+#include <QRunnable>
+#include <QStringDecoder>
+#include <QThreadPool>
+
+#ifdef Q_OS_UNIX
+#include <cerrno>
+#include <cstring>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+using namespace core;
+
+namespace
+{
+    constexpr int CACHE_SIZE = 32;
+    constexpr int TAB_WIDTH  = 4;
+
+    /// NULs don't show up in text; a few control characters do, in old
+    /// files, but not one in ten.
+    bool looksBinary(QByteArrayView bytes)
+    {
+        if (bytes.contains('\0')) {
+            return true;
+        }
+
+        qsizetype control = 0;
+
+        for (const auto c : bytes) {
+            const auto u = static_cast<uchar>(c);
+            if (u < 0x20 && u != '\n' && u != '\r' && u != '\t' && u != '\f' && u != '\v' && u != '\b' && u != 0x1b) {
+                ++control;
+            } else if (u == 0x7f) {
+                ++control;
+            }
+        }
+
+        return control * 10 > bytes.size();
+    }
+
+    QString clipped(QString line)
+    {
+        if (line.size() > Previewer::MAX_COLUMNS) {
+            line.truncate(Previewer::MAX_COLUMNS - 1);
+            line.append(QChar(0x2026));
+        }
+
+        return line;
+    }
+
+    /// tabs expanded, and what's left of the control characters made
+    /// visible, so that every line is as wide as it looks.
+    QString printable(QStringView line)
+    {
+        QString result;
+        result.reserve(line.size());
+
+        if (line.endsWith(u'\r')) {
+            line.chop(1);
+        }
+
+        for (const auto c : line) {
+            if (c == '\t') {
+                result.append(QString(TAB_WIDTH - result.size() % TAB_WIDTH, ' '));
+            } else if (c.unicode() < 0x20 || c.unicode() == 0x7f) {
+                result.append(QChar(0x00b7));
+            } else {
+                result.append(c);
+            }
+
+            if (result.size() > Previewer::MAX_COLUMNS) {
+                break;
+            }
+        }
+
+        return clipped(std::move(result));
+    }
+
+    void previewText(Preview& preview, QByteArrayView bytes)
+    {
+        /// a character cut in two at the end of the window is left out
+        /// rather than taken for an error.
+        auto decoder = QStringDecoder(QStringDecoder::Utf8);
+        auto text    = QString(decoder.decode(bytes));
+
+        if (decoder.hasError()) {
+            text = QString::fromLatin1(bytes);
+        }
+
+        const auto lines = QStringView(text).split(u'\n');
+
+        for (const auto& line : lines) {
+            if (preview.lines.size() == Previewer::MAX_LINES) {
+                preview.truncated = true;
+                break;
+            }
+            preview.lines.push_back(printable(line));
+        }
+
+        /// a file that ends with a newline doesn't have an empty last line.
+        if (!preview.truncated && !preview.lines.empty() && preview.lines.back().isEmpty()) {
+            preview.lines.pop_back();
+        }
+    }
+
+    /// offset, sixteen bytes, and the same bytes as text.
+    void previewBinary(Preview& preview, QByteArrayView bytes)
+    {
+        constexpr qsizetype PER_LINE = 16;
+
+        const auto length = qMin<qsizetype>(bytes.size(), Previewer::HEX_BYTES);
+
+        for (qsizetype offset = 0; offset < length; offset += PER_LINE) {
+            const auto chunk = bytes.sliced(offset, qMin(PER_LINE, length - offset));
+
+            auto line = QString("%1 ").arg(offset, 8, 16, QChar('0'));
+            QString ascii;
+
+            for (qsizetype i = 0; i < PER_LINE; ++i) {
+                if (i == PER_LINE / 2) {
+                    line.append(' ');
+                }
+
+                if (i < chunk.size()) {
+                    const auto u = static_cast<uchar>(chunk[i]);
+                    line.append(QString(" %1").arg(uint(u), 2, 16, QChar('0')));
+                    ascii.append(u >= 0x20 && u < 0x7f ? QChar(u) : QChar('.'));
+                } else {
+                    line.append("   ");
+                }
+            }
+
+            preview.lines.push_back(line + "  |" + ascii + '|');
+        }
+    }
+}
+
+Previewer::Previewer(QObject* parent)
+    : QObject(parent)
+    , _previews(CACHE_SIZE)
+{
+    _receiver = std::make_shared<Receiver<Previewer>>(this);
+
+    _pool = new QThreadPool();
+    _pool->setMaxThreadCount(1);
+    _pool->setObjectName("surkl-preview-pool");
+}
+
+Previewer::~Previewer()
+{
+    _receiver->detach();
+    _pool->clear();
+
+    if (_pool->waitForDone(250)) {
+        delete _pool;
+    }
+}
+
+/// the preview of path, or nullptr, in which case it is made on the worker
+/// and ready() is emitted once it is, unless another was asked for since.
+const Preview* Previewer::preview(const QString& path)
+{
+    if (const auto* preview = _previews.object(path)) {
+        return preview;
+    }
+
+    if (_requested == path) {
+        return nullptr;
+    }
+
+    cancel();
+    _requested = path;
+
+    _pool->start([receiver = _receiver, path]
+    {
+        receiver->post([preview = make(path)](Previewer* engine) { engine->deliver(preview); });
+    });
+
+    return nullptr;
+}
+
+/// the preview asked for last isn't wanted anymore.  If it is being made,
+/// it is cached when done, but ready() isn't emitted.
+void Previewer::cancel()
+{
+    _pool->clear();
+    _requested.clear();
+}
+
+void Previewer::invalidate(const QString& path)
+{
+    _previews.remove(path);
+}
+
+/// runs on the worker, or anywhere; it blocks on at most WINDOW bytes.
+Preview Previewer::make(const QString& path)
+{
+    auto preview = Preview{.path = path};
+
+#ifdef Q_OS_UNIX
+    /// a FIFO, a terminal or a socket would block the worker in open() or
+    /// read() until someone writes to it, and the application on the worker
+    /// when it quits; only regular files are read, or what a link points to.
+    const auto encoded = QFile::encodeName(path);
+    struct stat st{};
+
+    if (lstat(encoded.constData(), &st) != 0 || (S_ISLNK(st.st_mode) && stat(encoded.constData(), &st) != 0)) {
+        preview.error = QString::fromLocal8Bit(std::strerror(errno));
+        return preview;
+    }
+    if (!S_ISREG(st.st_mode)) {
+        preview.error = QStringLiteral("not a regular file");
+        return preview;
+    }
+#endif
+
+    auto file = QFile(path);
+
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Unbuffered)) {
+        preview.error = file.errorString();
+        return preview;
+    }
+
+    preview.size = file.size();
+
+    /// read, not mapped: a file that shrinks while it is mapped faults on
+    /// the pages past its new end.  Files in /proc say they are empty, so
+    /// the whole window is asked for.
+    auto buffer = QByteArray(WINDOW, Qt::Uninitialized);
+    qint64 length = 0;
+
+#ifdef Q_OS_UNIX
+    while (length < WINDOW) {
+        const auto n = pread(file.handle(), buffer.data() + length, static_cast<size_t>(WINDOW - length), length);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            break;
+        }
+        length += n;
+    }
+#else
+    length = qMax<qint64>(0, file.read(buffer.data(), WINDOW));
+#endif
+    buffer.truncate(length);
+
+    const auto bytes  = QByteArrayView(buffer);
+    preview.truncated = bytes.size() < preview.size;
+    preview.binary    = looksBinary(bytes);
+
+    if (preview.binary) {
+        previewBinary(preview, bytes);
+        preview.truncated = bytes.size() > HEX_BYTES || preview.truncated;
+    } else {
+        previewText(preview, bytes);
+    }
+
+    return preview;
+}
+
+void Previewer::deliver(const Preview& preview)
+{
+    _previews.insert(preview.path, new Preview(preview));
+
+    if (preview.path == _requested) {
+        _requested.clear();
+        emit ready(preview.path);
+    }
+}
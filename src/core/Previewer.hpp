@@ -0,0 +1,72 @@
+/// Copyright (C) 2025 Arlen Avakian
+/// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include "Receiver.hpp"
+
+#include <QCache>
+#include <QObject>
+#include <QStringList>
+
+#include <memory>
+
+
+class QThreadPool;
+
+namespace core
+{
+    struct Preview
+    {
+        QString path;
+        QStringList lines;
+        QString error;
+        qint64 size{0};
+        bool binary{false};
+        bool truncated{false};  /// there is more than the lines show
+    };
+
+
+    /// A look at the beginning of a file, for the node under the mouse.
+    ///
+    /// Only the first WINDOW bytes are read, so a preview costs the same for
+    /// a note and for a disk image; what isn't a regular file is not read at
+    /// all.  The window is taken to be binary if it has a NUL, or too many
+    /// control characters, and is then shown as a hex dump of its first
+    /// bytes; otherwise as the first lines of text, without any
+    /// highlighting.
+    ///
+    /// There is one worker, and one request: asking for another preview, or
+    /// cancel(), drops the one that hasn't started.  Previews are kept in a
+    /// small LRU, so that going back and forth between nodes costs nothing.
+    class Previewer final : public QObject
+    {
+        Q_OBJECT
+
+    signals:
+        void ready(const QString& path);
+
+    public:
+        static constexpr qint64 WINDOW      = 16 * 1024;
+        static constexpr qint64 HEX_BYTES   = 256;
+        static constexpr int    MAX_LINES   = 24;
+        static constexpr int    MAX_COLUMNS = 96;
+
+        explicit Previewer(QObject* parent = nullptr);
+        ~Previewer() override;
+
+        [[nodiscard]] const Preview* preview(const QString& path);
+        void cancel();
+        void invalidate(const QString& path);
+
+        [[nodiscard]] static Preview make(const QString& path);
+
+    private:
+        void deliver(const Preview& preview);
+
+        QThreadPool* _pool{nullptr};
+        std::shared_ptr<Receiver<Previewer>> _receiver;
+        QCache<QString, Preview> _previews;
+        QString _requested;  /// the one preview that is wanted now
+    };
+}
@@ -0,0 +1,524 @@
+/// Copyright (C) 2025 Arlen Avakian
+/// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "Purger.hpp"
+#include "db/db.hpp"
+#include "db/stmt.hpp"
+#include "paths.hpp"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutex>
+#include <QSqlRecord>
+#include <QStandardPaths>
+#include <QThread>
+#include <QThreadPool>
+#include <QTimer>
+
+#include <atomic>
+#include <utility>
+#include <vector>
+
+#ifdef Q_OS_UNIX
+#include <cerrno>
+#include <cstring>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+using namespace core;
+
+namespace
+{
+    /// the worker pauses for PAUSE_MS after every BURST entries it removes.
+    constexpr qint64 BURST    = 512;
+    constexpr int    PAUSE_MS = 2;
+
+#ifdef Q_OS_UNIX
+    QString lastError()
+    {
+        return QString::fromLocal8Bit(std::strerror(errno));
+    }
+
+    bool deviceOf(const QString& path, quint64& device)
+    {
+        struct stat st{};
+
+        if (lstat(QFile::encodeName(path).constData(), &st) != 0) {
+            return false;
+        }
+        device = st.st_dev;
+
+        return true;
+    }
+
+    /// the topmost directory above path that is still on device.
+    QString mountPointOf(const QString& path, quint64 device)
+    {
+        auto dir = QFileInfo(path).absolutePath();
+
+        for (auto parentDevice = quint64{0};;) {
+            const auto parent = QFileInfo(dir).absolutePath();
+
+            if (parent == dir || !deviceOf(parent, parentDevice) || parentDevice != device) {
+                return dir;
+            }
+            dir = parent;
+        }
+    }
+
+    /// a directory of ours on device, made if need be.
+    bool makeStagingDir(const QString& dir, quint64 device)
+    {
+        const auto encoded = QFile::encodeName(dir);
+        struct stat st{};
+
+        if (lstat(encoded.constData(), &st) != 0) {
+            if (!QDir().mkpath(QFileInfo(dir).path())
+                    || mkdir(encoded.constData(), 0700) != 0
+                    || lstat(encoded.constData(), &st) != 0) {
+                return false;
+            }
+            if (st.st_dev != device) {
+                rmdir(encoded.constData());
+                return false;
+            }
+        }
+
+        return S_ISDIR(st.st_mode) && st.st_uid == getuid() && st.st_dev == device;
+    }
+
+    bool renameEntry(const QString& source, const QString& target)
+    {
+        return ::rename(QFile::encodeName(source).constData(), QFile::encodeName(target).constData()) == 0;
+    }
+#else
+    bool renameEntry(const QString& source, const QString& target)
+    {
+        return QDir().rename(source, target);
+    }
+#endif
+}
+
+struct Purger::Purge
+{
+    Purge(std::shared_ptr<Receiver<Purger>> receiver, quint64 generation, QStringList paths)
+        : receiver(std::move(receiver))
+        , generation(generation)
+        , paths(std::move(paths))
+    {
+    }
+
+    void run();
+    void removeTree(const QString& path);
+    void step();
+    void fail(const QString& error);
+
+    const std::shared_ptr<Receiver<Purger>> receiver;
+    const quint64 generation;
+    const QStringList paths;
+
+    std::atomic<qint64> removed{0};
+    std::atomic<qint64> failures{0};
+    std::atomic<bool> cancelled{false};
+
+    QMutex errorsMutex;
+    QStringList errors;
+    bool deliveryQueued{false};
+};
+
+void Purger::Purge::run()
+{
+    for (const auto& path : paths) {
+        if (cancelled) {
+            break;
+        }
+        removeTree(path);
+    }
+
+    receiver->post([g = generation](Purger* e) { e->finish(g); });
+}
+
+#ifdef Q_OS_UNIX
+/// depth first, without recursion; a directory is removed once it is empty.
+void Purger::Purge::removeTree(const QString& path)
+{
+    struct Entry
+    {
+        QByteArray path;
+        bool listed{false};
+    };
+
+    std::vector<Entry> stack{{.path = QFile::encodeName(path), .listed = false}};
+
+    while (!stack.empty() && !cancelled) {
+        if (stack.back().listed) {
+            if (rmdir(stack.back().path.constData()) == 0 || errno == ENOENT) {
+                step();
+            } else {
+                fail(QString("could not delete %1: %2").arg(QFile::decodeName(stack.back().path), lastError()));
+            }
+            stack.pop_back();
+            continue;
+        }
+
+        const auto current = stack.back().path;
+        struct stat st{};
+
+        /// already gone.
+        if (lstat(current.constData(), &st) != 0) {
+            stack.pop_back();
+            continue;
+        }
+
+        if (!S_ISDIR(st.st_mode)) {
+            if (unlink(current.constData()) == 0 || errno == ENOENT) {
+                step();
+            } else {
+                fail(QString("could not delete %1: %2").arg(QFile::decodeName(current), lastError()));
+            }
+            stack.pop_back();
+            continue;
+        }
+
+        auto* dir = opendir(current.constData());
+        if (dir == nullptr) {
+            fail(QString("could not delete %1: %2").arg(QFile::decodeName(current), lastError()));
+            stack.pop_back();
+            continue;
+        }
+        stack.back().listed = true;
+
+        while (const auto* ent = readdir(dir)) {
+            const auto* name = ent->d_name;
+
+            if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) {
+                continue;
+            }
+            stack.push_back({.path = current + '/' + name, .listed = false});
+        }
+
+        closedir(dir);
+    }
+}
+#else
+void Purger::Purge::removeTree(const QString& path)
+{
+    const auto info    = QFileInfo(path);
+    const auto removed = info.isDir() && !info.isSymLink()
+        ? QDir(path).removeRecursively()
+        : QFile::remove(path);
+
+    if (removed) {
+        step();
+    } else {
+        fail(QString("could not delete %1").arg(path));
+    }
+}
+#endif
+
+/// counts a removed entry, and gives the disk a break now and then.
+void Purger::Purge::step()
+{
+    if (++removed % BURST == 0) {
+        QThread::msleep(PAUSE_MS);
+    }
+}
+
+/// hands the error over to the GUI thread, in batches.
+void Purger::Purge::fail(const QString& error)
+{
+    ++failures;
+
+    QMutexLocker locker(&errorsMutex);
+
+    errors.push_back(error);
+
+    if (!deliveryQueued) {
+        deliveryQueued = true;
+        receiver->post([g = generation](Purger* e) { e->deliver(g); });
+    }
+}
+
+Purger::Purger(QObject* parent)
+    : QObject(parent)
+{
+    _receiver = std::make_shared<Receiver<Purger>>(this);
+
+    _pool = new QThreadPool();
+    _pool->setMaxThreadCount(1);
+    _pool->setThreadPriority(QThread::IdlePriority);
+    _pool->setObjectName("surkl-purge-pool");
+
+    _progressTimer = new QTimer(this);
+    _progressTimer->setInterval(100);
+
+    connect(_progressTimer, &QTimer::timeout, this, [this]
+    {
+        if (_purge) {
+            emit progress(_purge->removed);
+        }
+    });
+}
+
+/// what isn't purged by now is left in the staging directories for resume().
+Purger::~Purger()
+{
+    if (_purge) {
+        _purge->cancelled = true;
+    }
+    _receiver->detach();
+
+    if (_pool->waitForDone(250)) {
+        delete _pool;
+    }
+}
+
+void Purger::configure()
+{
+    createTable();
+
+    Q_ASSERT(core::db::doesTableExists(stmt::purge::STAGING_TABLE));
+}
+
+/// moves path out of the way, and queues it to be purged.  Returns false if
+/// there is no such entry.
+bool Purger::remove(const QString& path)
+{
+    const auto info = QFileInfo(path);
+
+    if (!info.exists() && !info.isSymLink()) {
+        return false;
+    }
+
+    auto target = path;
+
+    if (const auto dir = stagingDir(path); !dir.isEmpty() && !isWithin(dir, path)) {
+        auto staged = QString();
+        do {
+            staged = joinPath(dir, QString("%1-%2-%3")
+                .arg(QDateTime::currentMSecsSinceEpoch())
+                .arg(++_staged)
+                .arg(info.fileName()));
+        } while (QFileInfo(staged).exists() || QFileInfo(staged).isSymLink());
+
+        /// a mount point, or something else that can't be moved; it is
+        /// unlinked where it is.
+        if (renameEntry(path, staged)) {
+            target = staged;
+        }
+    }
+
+    _queue.push_back(target);
+
+    if (!_purge) {
+        startNext();
+    }
+
+    return true;
+}
+
+/// purges what the last session left in its staging directories.
+void Purger::resume()
+{
+    for (const auto& dir : loadStagingDirs()) {
+        auto device = quint64{0};
+#ifdef Q_OS_UNIX
+        if (!deviceOf(dir, device)) {
+            forgetStagingDir(dir);
+            continue;
+        }
+#endif
+        _stagingDirs.insert(device, dir);
+
+        const auto entries = QDir(dir).entryList(QDir::AllEntries | QDir::NoDotAndDotDot | QDir::System | QDir::Hidden);
+
+        for (const auto& name : entries) {
+            _queue.push_back(joinPath(dir, name));
+        }
+    }
+
+    if (_queue.empty()) {
+        tidy();
+    } else if (!_purge) {
+        startNext();
+    }
+}
+
+bool Purger::isRunning() const
+{
+    return _purge != nullptr;
+}
+
+/// the staging directory on the filesystem of path, or an empty string if
+/// none could be made.
+QString Purger::stagingDir(const QString& path)
+{
+#ifdef Q_OS_UNIX
+    auto device = quint64{0};
+
+    if (!deviceOf(path, device)) {
+        return {};
+    }
+
+    if (const auto found = _stagingDirs.constFind(device); found != _stagingDirs.cend()) {
+        return found.value();
+    }
+
+    const auto candidates = QStringList
+    {
+        joinPath(QStandardPaths::writableLocation(QStandardPaths::CacheLocation), "purge"),
+        joinPath(mountPointOf(path, device), QString(".surkl-purge-%1").arg(getuid())),
+    };
+
+    QString result;
+
+    for (const auto& dir : candidates) {
+        if (makeStagingDir(dir, device)) {
+            result = dir;
+            saveStagingDir(result);
+            break;
+        }
+    }
+    _stagingDirs.insert(device, result);
+
+    return result;
+#else
+    Q_UNUSED(path);
+
+    return {};
+#endif
+}
+
+void Purger::startNext()
+{
+    if (_purge || _queue.empty()) {
+        return;
+    }
+
+    _purge = std::make_shared<Purge>(_receiver, ++_generation, std::exchange(_queue, {}));
+    _pool->start([purge = _purge] { purge->run(); });
+
+    _progressTimer->start();
+}
+
+void Purger::deliver(quint64 generation)
+{
+    if (!_purge || _purge->generation != generation) {
+        return;
+    }
+
+    QStringList batch;
+    {
+        QMutexLocker locker(&_purge->errorsMutex);
+        batch.swap(_purge->errors);
+        _purge->deliveryQueued = false;
+    }
+
+    if (!batch.empty()) {
+        emit failed(batch);
+    }
+}
+
+void Purger::finish(quint64 generation)
+{
+    if (!_purge || _purge->generation != generation) {
+        return;
+    }
+
+    /// the last errors may have come after the last delivery.
+    deliver(generation);
+
+    _progressTimer->stop();
+
+    const auto removed  = _purge->removed.load();
+    const auto failures = _purge->failures.load();
+
+    _purge.reset();
+
+    emit progress(removed);
+    emit finished(removed, failures);
+
+    if (_queue.empty()) {
+        tidy();
+    } else {
+        startNext();
+    }
+}
+
+/// removes the staging directories that are empty; they are made again when
+/// needed.
+void Purger::tidy()
+{
+    for (auto it = _stagingDirs.begin(); it != _stagingDirs.end(); ) {
+        if (!it->isEmpty() && QDir().rmdir(it.value())) {
+            forgetStagingDir(it.value());
+            it = _stagingDirs.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+QStringList Purger::loadStagingDirs()
+{
+    QStringList result;
+
+    if (const auto db = db::get(); db.isOpen()) {
+        QSqlQuery q(db);
+        q.prepare(stmt::purge::SELECT_ALL_STAGINGS);
+
+        if (q.exec()) {
+            const auto pathIdx = q.record().indexOf(stmt::purge::STAGING_PATH);
+
+            while (q.next()) {
+                result.push_back(q.value(pathIdx).toString());
+            }
+        } else {
+            qWarning() << q.lastError();
+        }
+    }
+
+    return result;
+}
+
+void Purger::saveStagingDir(const QString& path)
+{
+    if (const auto db = db::get(); db.isOpen()) {
+        QSqlQuery q(db);
+        q.prepare(stmt::purge::INSERT_STAGING);
+        q.addBindValue(path);
+
+        if (!q.exec()) {
+            qWarning() << q.lastError();
+        }
+    }
+}
+
+void Purger::forgetStagingDir(const QString& path)
+{
+    if (const auto db = db::get(); db.isOpen()) {
+        QSqlQuery q(db);
+        q.prepare(stmt::purge::DELETE_STAGING);
+        q.addBindValue(path);
+
+        if (!q.exec()) {
+            qWarning() << q.lastError();
+        }
+    }
+}
+
+void Purger::createTable()
+{
+    if (const auto db = db::get(); db.isOpen()) {
+        QSqlQuery q(db);
+
+        if (!q.exec(stmt::purge::CREATE_STAGING_TABLE)) {
+            qWarning() << "failed to create purge staging table" << q.lastError();
+        }
+    }
+}
@@ -0,0 +1,79 @@
+/// Copyright (C) 2025 Arlen Avakian
+/// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include "Receiver.hpp"
+
+#include <QHash>
+#include <QObject>
+#include <QStringList>
+
+#include <memory>
+
+
+class QThreadPool;
+class QTimer;
+
+namespace core
+{
+    /// Deletes files and directory trees without making the GUI wait.
+    ///
+    /// remove() renames the entry into a staging directory on the same
+    /// filesystem, which is a single atomic step no matter how large the
+    /// tree is; the entry is gone from its directory at once.  A worker then
+    /// unlinks the staged entries in the background, at idle priority and in
+    /// short bursts, so that it doesn't starve the lister.
+    ///
+    /// The staging directories are kept in the PurgeStaging table until they
+    /// are empty; resume() purges what was left in them when the application
+    /// quit in the middle of a purge.  If no staging directory can be made on
+    /// the filesystem of an entry, the entry is unlinked where it is.
+    ///
+    /// remove() stats, makes the staging directory and renames on the
+    /// calling thread; the caller checks that the mount of the entry answers
+    /// (see MetadataFetcher::isReachable()) before it asks.
+    class Purger final : public QObject
+    {
+        Q_OBJECT
+
+    signals:
+        void progress(qint64 removed);
+        void failed(const QStringList& errors);
+        void finished(qint64 removed, qint64 failures);
+
+    public:
+        explicit Purger(QObject* parent = nullptr);
+        ~Purger() override;
+
+        static void configure();
+
+        bool remove(const QString& path);
+        void resume();
+        [[nodiscard]] bool isRunning() const;
+
+    private:
+        struct Purge;
+
+        QString stagingDir(const QString& path);
+        void startNext();
+        void deliver(quint64 generation);
+        void finish(quint64 generation);
+        void tidy();
+        static QStringList loadStagingDirs();
+        static void saveStagingDir(const QString& path);
+        static void forgetStagingDir(const QString& path);
+        static void createTable();
+
+        QThreadPool* _pool{nullptr};
+        std::shared_ptr<Receiver<Purger>> _receiver;
+        QTimer* _progressTimer{nullptr};
+        std::shared_ptr<Purge> _purge;
+        quint64 _generation{0};
+        quint64 _staged{0};
+        QStringList _queue;
+
+        /// by device; an empty path if none could be made on it.
+        QHash<quint64, QString> _stagingDirs;
+    };
+}
@@ -0,0 +1,55 @@
+/// Copyright (C) 2025 Arlen Avakian
+/// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <QMetaObject>
+#include <QMutex>
+
+
+namespace core
+{
+    /// The engine that the workers of an engine post their results to.
+    ///
+    /// An engine waits only briefly for its workers when it goes away; one
+    /// that is stuck on a mount that doesn't answer would otherwise hold up
+    /// the quit.  Such a worker keeps the pool, which is then not deleted,
+    /// and the threads end with the process.  The workers share this with the
+    /// engine instead of pointing at it, and whatever they post once the
+    /// engine detach()ed is dropped.
+    ///
+    /// Workers that produce many results collect them under a mutex, and only
+    /// the first of a batch posts the delivery; the ones that arrive before
+    /// the GUI thread gets to it ride along.
+    template <typename T>
+    class Receiver
+    {
+    public:
+        explicit Receiver(T* receiver)
+            : _receiver(receiver)
+        {
+        }
+
+        /// f is called with the receiver, queued on its thread.
+        template <typename F>
+        void post(F f)
+        {
+            QMutexLocker locker(&_mutex);
+
+            if (_receiver != nullptr) {
+                QMetaObject::invokeMethod(_receiver, [r = _receiver, f = std::move(f)] { f(r); }, Qt::QueuedConnection);
+            }
+        }
+
+        void detach()
+        {
+            QMutexLocker locker(&_mutex);
+
+            _receiver = nullptr;
+        }
+
+    private:
+        QMutex _mutex;
+        T* _receiver;
+    };
+}
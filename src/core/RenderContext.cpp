@@ -0,0 +1,92 @@
+/// Copyright (C) 2025 Arlen Avakian
+/// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "RenderContext.hpp"
+#include "NodeItem.hpp"
+#include "gui/theme/theme.hpp"
+
+
+using namespace core;
+
+const QPen& RenderContext::fileSizePen(bool selected, int width) const
+{
+    const auto& pens = selected ? fileSizeSelected : fileSize;
+
+    return pens[static_cast<std::size_t>(qBound(1, width, static_cast<int>(FILE_SIZE_PEN_COUNT))) - 1];
+}
+
+RenderContext RenderContext::make(const gui::theme::ThemeManager* tm)
+{
+    Q_ASSERT(tm);
+
+    constexpr auto EDGE_WIDTH        = NodeItem::EDGE_WIDTH;
+    constexpr auto OPEN_PEN_WIDTH    = NodeItem::NODE_OPEN_PEN_WIDTH;
+    constexpr auto HALF_CLOSED_WIDTH = NodeItem::NODE_HALF_CLOSED_PEN_WIDTH;
+
+    RenderContext rc;
+
+    rc.openNode          = tm->openNodeColor();
+    rc.openNodeHover     = tm->openNodeMidlightColor();
+    rc.openNodeRim       = QPen(tm->openNodeLightColor(), OPEN_PEN_WIDTH, Qt::SolidLine);
+    rc.openNodeUsage     = QPen(tm->openNodeLightColor(), 2, Qt::SolidLine, Qt::FlatCap);
+    rc.halfClosedNodeRim = QPen(tm->closedNodeDarkColor(), HALF_CLOSED_WIDTH, Qt::SolidLine);
+    rc.halfClosedNodeArc = QPen(tm->openNodeLightColor(), HALF_CLOSED_WIDTH, Qt::SolidLine);
+
+    rc.closedNode           = tm->closedNodeColor();
+    rc.closedNodeHover      = tm->closedNodeMidlightColor();
+    rc.closedNodeBody       = tm->closedNodeDarkColor();
+    rc.closedNodeSpine      = QPen(tm->closedNodeMidarkColor(), 2);
+    rc.closedNodeSpineHover = QPen(tm->closedNodeMidlightColor(), 2);
+    rc.closedNodeUsage      = QPen(tm->closedNodeMidarkColor(), 2, Qt::SolidLine, Qt::FlatCap);
+    rc.closedNodeUsageHover = QPen(tm->closedNodeMidlightColor(), 2, Qt::SolidLine, Qt::FlatCap);
+    rc.closedNodeLink       = QPen(tm->closedNodeMidlightColor(), 1, Qt::DotLine);
+    rc.rootRim              = QPen(tm->closedNodeDarkColor(), 5);
+
+    rc.fileBody         = tm->fileNodeDarkColor();
+    rc.fileBodyHover    = tm->fileNodeMidarkColor();
+    rc.fileBodySelected = tm->fileNodeMidlightColor();
+
+    /// files of a known type get the tint of their category on the spine
+    /// and the outline; the others have no outline.
+    for (std::size_t category = 0; category < FileCategoryCount; ++category) {
+        const auto known = category > OtherFile;
+        const auto& tint = known ? tm->fileTypeColor(category) : tm->fileNodeDarkColor();
+
+        rc.fileSpine[category]       = QPen(tint, 4, Qt::SolidLine, Qt::SquareCap);
+        rc.fileOutline[category]     = known ? QPen(tint, 1) : QPen(Qt::NoPen);
+        rc.fileLinkOutline[category] = QPen(known ? tint : tm->fileNodeMidlightColor(), 1, Qt::DotLine);
+    }
+
+    rc.fileThumbnailFrame = QPen(tm->fileNodeMidlightColor(), 1.5);
+
+    for (std::size_t i = 0; i < FILE_SIZE_PEN_COUNT; ++i) {
+        const auto width = static_cast<qreal>(i + 1);
+
+        rc.fileSize[i]         = QPen(tm->fileNodeLightColor(), width, Qt::SolidLine, Qt::SquareCap, Qt::BevelJoin);
+        rc.fileSizeSelected[i] = QPen(tm->fileNodeDarkColor(), width, Qt::SolidLine, Qt::SquareCap, Qt::BevelJoin);
+    }
+
+    rc.duplicateRing   = QPen(tm->fileNodeMidlightColor(), 1.5, Qt::SolidLine);
+    rc.gitDot          = QPen(tm->fileNodeLightColor(), 1.5);
+    rc.gitModified     = tm->fileNodeLightColor();
+    rc.unreachableRing = QPen(tm->closedNodeDarkColor(), 1, Qt::DashLine);
+
+    rc.edge         = QPen(tm->edgeColor(), EDGE_WIDTH, Qt::SolidLine, Qt::FlatCap);
+    rc.edgeHover    = QPen(tm->edgeMidlightColor(), EDGE_WIDTH, Qt::SolidLine, Qt::FlatCap);
+    rc.edgeSelected = QPen(tm->edgeLightColor(), EDGE_WIDTH, Qt::SolidLine, Qt::FlatCap);
+    rc.edgeTip      = QPen(tm->openNodeLightColor(), EDGE_WIDTH, Qt::SolidLine, Qt::FlatCap);
+    rc.edgeText     = QPen(tm->edgeTextColor());
+    rc.edgeFont     = QFont("Adwaita Sans", 9);
+
+    rc.buttonRim       = QPen(tm->sceneLightColor(), 2);
+    rc.buttonBody      = tm->sceneDarkColor();
+    rc.buttonCountdown = QPen(tm->sceneDarkColor(), 2, Qt::DotLine);
+    rc.buttonText      = QPen(tm->sceneLightColor(), 1);
+
+    rc.previewRim   = QPen(tm->fileNodeMidlightColor(), 1);
+    rc.previewBody  = tm->fileNodeDarkColor();
+    rc.previewTitle = QPen(tm->fileNodeMidlightColor());
+    rc.previewText  = QPen(tm->fileNodeLightColor());
+
+    return rc;
+}
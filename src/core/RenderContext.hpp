@@ -0,0 +1,99 @@
+/// Copyright (C) 2025 Arlen Avakian
+/// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include "FileTypes.hpp"
+
+#include <QBrush>
+#include <QFont>
+#include <QPen>
+
+#include <array>
+
+
+namespace gui::theme
+{
+    class ThemeManager;
+}
+
+namespace core
+{
+    /// The pens, brushes and fonts the scene items paint with, made from the
+    /// active palette.
+    ///
+    /// It is made once, and again only when the theme changes, so that a
+    /// paint() doesn't look up the ThemeManager or build anything; a frame
+    /// with thousands of nodes would otherwise make thousands of pens.  What
+    /// depends on the state of an item (selected, hovered, its file type)
+    /// is made for every state up front.
+    struct RenderContext
+    {
+        /// a file of 2^(10 * n) bytes has n marks, the last one n pixels
+        /// wide; 2^80 is out of reach.
+        static constexpr std::size_t FILE_SIZE_PEN_COUNT = 8;
+
+        using CategoryPens = std::array<QPen, FileCategoryCount>;
+        using SizePens     = std::array<QPen, FILE_SIZE_PEN_COUNT>;
+
+        /// open and half-closed nodes, and the knot
+        QBrush openNode;
+        QBrush openNodeHover;
+        QPen openNodeRim;
+        QPen openNodeUsage;
+        QPen halfClosedNodeRim;
+        QPen halfClosedNodeArc;
+
+        /// closed folders, and the root
+        QBrush closedNode;
+        QBrush closedNodeHover;
+        QBrush closedNodeBody;
+        QPen closedNodeSpine;
+        QPen closedNodeSpineHover;
+        QPen closedNodeUsage;
+        QPen closedNodeUsageHover;
+        QPen closedNodeLink;
+        QPen rootRim;
+
+        /// files
+        QBrush fileBody;
+        QBrush fileBodyHover;
+        QBrush fileBodySelected;
+        CategoryPens fileSpine;
+        CategoryPens fileOutline;
+        CategoryPens fileLinkOutline;
+        QPen fileThumbnailFrame;
+        SizePens fileSize;
+        SizePens fileSizeSelected;
+
+        /// marks on any node
+        QPen duplicateRing;
+        QPen gitDot;
+        QBrush gitModified;
+        QPen unreachableRing;
+
+        /// edges
+        QPen edge;
+        QPen edgeHover;
+        QPen edgeSelected;
+        QPen edgeTip;
+        QPen edgeText;
+        QFont edgeFont;
+
+        /// scene buttons
+        QPen buttonRim;
+        QBrush buttonBody;
+        QPen buttonCountdown;
+        QPen buttonText;
+
+        /// the preview of the file under the mouse
+        QPen previewRim;
+        QBrush previewBody;
+        QPen previewTitle;
+        QPen previewText;
+
+        [[nodiscard]] const QPen& fileSizePen(bool selected, int width) const;
+
+        [[nodiscard]] static RenderContext make(const gui::theme::ThemeManager* tm);
+    };
+}
@@ -0,0 +1,38 @@
+/// Copyright (C) 2025 Arlen Avakian
+/// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "SceneSelection.hpp"
+#include "BookmarkItem.hpp"
+#include "EdgeItem.hpp"
+#include "NodeItem.hpp"
+
+
+using namespace core;
+
+namespace
+{
+    template <class T>
+    void toggle(QSet<T*>& set, T* item, bool selected)
+    {
+        if (selected) {
+            set.insert(item);
+        } else {
+            set.remove(item);
+        }
+    }
+}
+
+/// called by an item once it is selected or deselected, and, as deselected,
+/// when it leaves the scene.
+void SceneSelection::note(QGraphicsItem* item, bool selected)
+{
+    Q_ASSERT(item);
+
+    if (auto* node = qgraphicsitem_cast<NodeItem*>(item)) {
+        toggle(_nodes, node, selected);
+    } else if (auto* edge = qgraphicsitem_cast<EdgeItem*>(item)) {
+        toggle(_edges, edge, selected);
+    } else if (auto* bookmark = qgraphicsitem_cast<SceneBookmarkItem*>(item)) {
+        toggle(_bookmarks, bookmark, selected);
+    }
+}
@@ -0,0 +1,40 @@
+/// Copyright (C) 2025 Arlen Avakian
+/// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <QSet>
+
+
+class QGraphicsItem;
+
+namespace core
+{
+    class EdgeItem;
+    class NodeItem;
+    class SceneBookmarkItem;
+
+    /// The selected items of the scene, by type.
+    ///
+    /// QGraphicsScene::selectedItems() builds a list of the whole selection
+    /// every time, and every handler then filters it for the type it wants;
+    /// with a rubber band over thousands of nodes, each mouse move did that
+    /// several times over.  These sets are kept up to date by the items
+    /// themselves, as they are selected, deselected or removed from the
+    /// scene, so keeping them costs as much as the change does.
+    class SceneSelection
+    {
+    public:
+        void note(QGraphicsItem* item, bool selected);
+
+        [[nodiscard]] const QSet<NodeItem*>& nodes() const { return _nodes; }
+        [[nodiscard]] const QSet<EdgeItem*>& edges() const { return _edges; }
+        [[nodiscard]] const QSet<SceneBookmarkItem*>& bookmarks() const { return _bookmarks; }
+        [[nodiscard]] bool empty() const { return _nodes.empty() && _edges.empty() && _bookmarks.empty(); }
+
+    private:
+        QSet<NodeItem*> _nodes;
+        QSet<EdgeItem*> _edges;
+        QSet<SceneBookmarkItem*> _bookmarks;
+    };
+}
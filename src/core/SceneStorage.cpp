@@ -9,6 +9,7 @@
 #include "db/stmt.hpp"
 
 #include <QDir>
+#include <QSet>
 #include <QSqlRecord>
 #include <QTimer>
 
@@ -23,13 +24,13 @@ namespace
 
         const auto isFirstRow = [firstRow](const NodeData& nd) -> bool
         {
-            return nd.index.row() == firstRow;
+            return nd.row == firstRow;
         };
 
         if (firstRow != -1) {
             if (auto found = ranges::find_if(data, isFirstRow); found != data.end()) {
                 QList<NodeData> r, e;
-                while (data.first().index.row() != firstRow) {
+                while (data.first().row != firstRow) {
                     const auto first = data.takeFirst();
                     if  (NodeFlags(first.type).testAnyFlag(NodeType::OpenNode)
                             || NodeFlags(first.type).testAnyFlag(NodeType::HalfClosedNode)) {
@@ -98,6 +99,29 @@ void SceneStorage::saveNode(const NodeItem *node)
     _timer->start(125);
 }
 
+/// the nodes of a subtree that was dragged as a whole are written at once,
+/// in one transaction; what was queued for them before the drag is stale.
+void SceneStorage::saveMovedNodes(const QList<const NodeItem*>& nodes)
+{
+    if (!_enabled || nodes.empty()) {
+        return;
+    }
+
+    const auto ids = nodes
+        | std::views::transform(&NodeItem::path)
+        | std::ranges::to<QSet<QString>>()
+        ;
+
+    _queue.removeIf([&ids](const QVariant& var)
+    {
+        const auto sd = var.value<StorageData>();
+
+        return sd.op == StorageData::SaveOp && ids.contains(sd.id);
+    });
+
+    saveNodes(nodes);
+}
+
 void SceneStorage::saveScene() const
 {
     const auto toBeSaved = _scene->items()
@@ -128,29 +152,33 @@ void SceneStorage::loadScene(FileSystemScene* scene)
         return;
     }
 
-    auto sortByRows = [](QList<NodeData>& data) {
-        std::ranges::sort(data, [](const NodeData& a, const NodeData& b) {
-            return a.index.row() < b.index.row();
-        });
+    /// the handles are resolved once, right before the children of a node
+    /// are made; entries removed since the scene was saved are dropped.
+    auto sortByRows = [scene](QList<NodeData>& data) {
+        for (auto& nd : data) {
+            nd.row = scene->resolve(nd.handle).row();
+        }
+        data.removeIf([](const NodeData& nd) { return nd.row == -1; });
+        std::ranges::sort(data, {}, &NodeData::row);
     };
 
     QList<NodeData> S;
-    if (G.contains(QPersistentModelIndex())) {
+    if (G.contains(NodeHandle())) {
         /// This assumes we have only a single root node ("/").
 
-        auto& Ms = G[QPersistentModelIndex()];
+        auto& Ms = G[NodeHandle()];
         sortByRows(Ms);
         Q_ASSERT(Ms.size() == 1);
 
         for (auto& m : Ms) {
-            Q_ASSERT(m.index.isValid());
-            m.edge = NodeItem::createRootNode(m.index);
+            m.edge = NodeItem::createRootNode(scene->resolve(m.handle));
             scene->addItem(m.edge->source());
             scene->addItem(m.edge->target());
             scene->addItem(m.edge);
             m.edge->target()->setPos(m.pos);
             m.edge->adjust();
-            scene->fetchMore(m.index);
+            const auto* rootNode = asNodeItem(m.edge->target());
+            scene->fetchMore(rootNode->index(), scene->listingPriority(rootNode));
             if (!NodeFlags(m.type).testAnyFlag(NodeType::ClosedNode)) {
                 S.push_back(m);
             }
@@ -174,18 +202,22 @@ void SceneStorage::loadScene(FileSystemScene* scene)
 
         auto* parentNode = asNodeItem(parent.edge->target());
 
-        /// if graph does not contain parent.index, then parent is a closed (leaf) node.
-        if (G.contains(parent.index)) {
-            auto& childNodeData = G[parent.index];
+        /// if graph does not contain parent.handle, then parent is a closed (leaf) node.
+        if (G.contains(parent.handle)) {
+            auto& childNodeData = G[parent.handle];
             if (!childNodeData.empty()) {
                 sortByRows(childNodeData);
                 skipToFirstRow(childNodeData, parent.firstRow);
                 parentNode->createChildNodes(childNodeData);
                 parent.edge->adjust();
-                scene->fetchMore(parent.index);
+                /// only queues the listing; all the directories of the session
+                /// are read in parallel while the nodes are being created.
+                scene->fetchMore(parentNode->index(), scene->listingPriority(parentNode));
             }
             for (const auto& nd : childNodeData) {
                 if (nd.edge) {
+                    /// the folder may not be listed yet.
+                    asNodeItem(nd.edge->target())->restoreNodeFlags(NodeFlags(nd.type));
                     S.push_back(nd);
                 } else {
                     /// TODO: nd can be removed from DB.
@@ -238,7 +270,7 @@ void SceneStorage::saveNodes(const QList<const NodeItem*>& nodes) const
             Q_ASSERT(node != nullptr);
             Q_ASSERT(node->parentEdge());
             if (node->index().isValid()) {
-                q.addBindValue(_scene->filePath(node->index()));
+                q.addBindValue(node->path());
                 q.addBindValue(static_cast<int>(node->nodeFlags()));
                 const auto pos = node->scenePos();
                 q.addBindValue(pos.x());
@@ -255,7 +287,7 @@ void SceneStorage::saveNodes(const QList<const NodeItem*>& nodes) const
 
         for (auto* node : nodes) {
             if (node->index().isValid()) {
-                q.addBindValue(_scene->filePath(node->index()));
+                q.addBindValue(node->path());
                 q.addBindValue(node->firstRow());
                 /// TODO: q.addBindValue(node->rotation());
                 q.addBindValue(0.0); // set angle of rotation to zero for now.
@@ -277,7 +309,7 @@ StorageData SceneStorage::getStorageData(const NodeItem* node, StorageData::Oper
     return
         {
             .op       = op,
-            .id       = _scene->filePath(node->index()),
+            .id       = node->path(),
             .nodeType = static_cast<int>(node->nodeFlags()),
             .firstRow = node->firstRow(),
             .pos      = node->scenePos(),
@@ -364,7 +396,10 @@ void SceneStorage::createTable()
     }
 }
 
-QHash<QPersistentModelIndex, QList<NodeData>> SceneStorage::readTable(const FileSystemScene* scene)
+/// nodes by the handle of their parent; the root is under the null handle.
+/// Only handles are kept, so reading a large scene doesn't leave the model
+/// with a persistent index per stored node to update.
+QHash<NodeHandle, QList<NodeData>> SceneStorage::readTable(FileSystemScene* scene)
 {
     const auto db = db::get();
 
@@ -381,7 +416,7 @@ QHash<QPersistentModelIndex, QList<NodeData>> SceneStorage::readTable(const File
     QSqlQuery q(db);
 
     q.prepare(stmt::scene::SELECT_ALL_NODES_DIR_ATTRS);
-    QHash<QPersistentModelIndex, Attribute> attributes;
+    QHash<NodeHandle, Attribute> attributes;
 
     if (q.exec()) {
         const auto rec    = q.record();
@@ -391,25 +426,19 @@ QHash<QPersistentModelIndex, QList<NodeData>> SceneStorage::readTable(const File
         auto ok = false;
 
         while (q.next()) {
-            const auto path  = q.value(idIdx).toString();
-            const auto index = scene->index(path);
-            const auto row   = q.value(rowIdx).toInt(&ok);   Q_ASSERT(ok);
-            const auto rot   = q.value(rotIdx).toReal(&ok);  Q_ASSERT(ok);
+            const auto path   = q.value(idIdx).toString();
+            const auto handle = scene->handle(scene->index(path));
+            const auto row    = q.value(rowIdx).toInt(&ok);   Q_ASSERT(ok);
+            const auto rot    = q.value(rotIdx).toReal(&ok);  Q_ASSERT(ok);
 
-            if (index.isValid()) {
-                /// QModelIndex and QPersistentModelIndex behave differently
-                /// when it comes to uniqueness.
-                /// QModelIndex: two link directories pointing to the same directory are considered the same.
-                /// QPersistentModelIndex: "" not the same.
-                Q_ASSERT(!attributes.contains(index));
-
-                attributes[index] = {row, rot};
+            if (!handle.isNull()) {
+                attributes[handle] = {row, rot};
             }
         }
     }
 
     q.prepare(stmt::scene::SELECT_ALL_NODES);
-    QHash<QPersistentModelIndex, QList<NodeData>> graph;
+    QHash<NodeHandle, QList<NodeData>> graph;
 
     if (q.exec()) {
         const auto rec     = q.record();
@@ -429,9 +458,10 @@ QHash<QPersistentModelIndex, QList<NodeData>> SceneStorage::readTable(const File
             const auto len   = q.value(lenIdx).toReal(&ok);  Q_ASSERT(ok);
 
             if (index.isValid()) {
+                const auto handle = scene->handle(index);
                 auto nd = NodeData
                     {
-                        .index    = index,
+                        .handle   = handle,
                         .type     = type,
                         .firstRow = 0,
                         .pos      = QPointF(x, y),
@@ -439,17 +469,13 @@ QHash<QPersistentModelIndex, QList<NodeData>> SceneStorage::readTable(const File
                         .rotation = 0
                     };
 
-                if (attributes.contains(index)) {
-                    const auto [row, rot] = attributes[index];
+                if (attributes.contains(handle)) {
+                    const auto [row, rot] = attributes[handle];
                     nd.firstRow = row;
                     nd.rotation = rot;
                 }
 
-                if (index.isValid()) {
-                    graph[index.parent()].push_back(nd);
-                } else {
-                    qWarning() << "read invalid index!";
-                }
+                graph[scene->handle(index.parent())].push_back(nd);
             }
         }
     }
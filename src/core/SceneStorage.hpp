@@ -15,6 +15,7 @@ namespace core
     class NodeItem;
     class FileSystemScene;
     class NodeData;
+    struct NodeHandle;
 
     struct StorageData
     {
@@ -47,6 +48,7 @@ namespace core
         void deleteNode(const NodeItem* node);
 
         void saveNode(const NodeItem* node);
+        void saveMovedNodes(const QList<const NodeItem*>& nodes);
 
         void saveScene() const;
 
@@ -66,7 +68,7 @@ namespace core
 
         static void createTable();
 
-        static QHash<QPersistentModelIndex, QList<NodeData>> readTable(const FileSystemScene* scene);
+        static QHash<NodeHandle, QList<NodeData>> readTable(FileSystemScene* scene);
 
         bool _enabled{false};
         FileSystemScene* _scene{nullptr};
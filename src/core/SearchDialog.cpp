@@ -0,0 +1,95 @@
+/// Copyright (C) 2025 Arlen Avakian
+/// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "SearchDialog.hpp"
+#include "FileSystemScene.hpp"
+#include "SearchEngine.hpp"
+#include "SessionManager.hpp"
+
+#include <QDir>
+#include <QLabel>
+#include <QLineEdit>
+#include <QListWidget>
+#include <QVBoxLayout>
+
+#include <ranges>
+
+
+using namespace core;
+
+namespace
+{
+    /// the list stops growing here; the count keeps going.
+    constexpr int MAX_LISTED_HITS = 10000;
+}
+
+SearchDialog::SearchDialog(const QString& root, QWidget* parent)
+    : QDialog(parent)
+    , _root(root)
+{
+    setAttribute(Qt::WA_DeleteOnClose);
+    setWindowTitle(tr("Search in %1").arg(root));
+    resize(640, 480);
+
+    _pattern = new QLineEdit(this);
+    _pattern->setPlaceholderText(tr("name, or a glob such as *.png"));
+    _hits    = new QListWidget(this);
+    _hits->setUniformItemSizes(true);
+    _status  = new QLabel(this);
+    _engine  = new SearchEngine(this);
+
+    auto* layout = new QVBoxLayout(this);
+    layout->addWidget(_pattern);
+    layout->addWidget(_hits);
+    layout->addWidget(_status);
+
+    connect(_pattern, &QLineEdit::returnPressed, this, [this]
+    {
+        if (const auto pattern = _pattern->text(); !pattern.isEmpty()) {
+            _hits->clear();
+            _status->setText(tr("Searching…"));
+            _engine->start(_root, pattern);
+        }
+    });
+
+    connect(_hits, &QListWidget::itemActivated, this, [this](const QListWidgetItem* item)
+    {
+        SessionManager::scene()->openTo(item->data(Qt::UserRole).toString());
+    });
+
+    connect(_engine, &SearchEngine::found, this, &SearchDialog::onFound);
+    connect(_engine, &SearchEngine::progress, this, &SearchDialog::onProgress);
+    connect(_engine, &SearchEngine::finished, this, [this](bool cancelled)
+    {
+        _status->setText(_status->text() + (cancelled ? tr(" (cancelled)") : tr(" (done)")));
+    });
+}
+
+/// Escape cancels a running search first, and closes the dialog after.
+void SearchDialog::reject()
+{
+    if (_engine->isRunning()) {
+        _engine->cancel();
+        return;
+    }
+
+    QDialog::reject();
+}
+
+void SearchDialog::onFound(const QStringList& paths)
+{
+    const auto room = qMax(0, MAX_LISTED_HITS - _hits->count());
+    const auto dir  = QDir(_root);
+
+    _hits->setUpdatesEnabled(false);
+    for (const auto& path : paths | std::views::take(room)) {
+        auto* item = new QListWidgetItem(dir.relativeFilePath(path), _hits);
+        item->setData(Qt::UserRole, path);
+    }
+    _hits->setUpdatesEnabled(true);
+}
+
+void SearchDialog::onProgress(qint64 hits, qint64 dirs)
+{
+    _status->setText(tr("%1 hits in %2 folders").arg(hits).arg(dirs));
+}
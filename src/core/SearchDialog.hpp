@@ -0,0 +1,39 @@
+/// Copyright (C) 2025 Arlen Avakian
+/// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <QDialog>
+
+
+class QLabel;
+class QLineEdit;
+class QListWidget;
+
+namespace core
+{
+    class SearchEngine;
+
+    /// Searches the tree under root by name.  Activating a hit opens the scene
+    /// to it.
+    class SearchDialog final : public QDialog
+    {
+        Q_OBJECT
+
+    public:
+        explicit SearchDialog(const QString& root, QWidget* parent);
+
+    public slots:
+        void reject() override;
+
+    private:
+        void onFound(const QStringList& paths);
+        void onProgress(qint64 hits, qint64 dirs);
+
+        QString _root;
+        QLineEdit* _pattern{nullptr};
+        QListWidget* _hits{nullptr};
+        QLabel* _status{nullptr};
+        SearchEngine* _engine{nullptr};
+    };
+}
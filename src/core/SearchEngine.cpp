@@ -0,0 +1,266 @@
+/// Copyright (C) 2025 Arlen Avakian
+/// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "SearchEngine.hpp"
+#include "WorkQueue.hpp"
+#include "paths.hpp"
+
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QMutex>
+#include <QRegularExpression>
+#include <QStringMatcher>
+#include <QThread>
+#include <QThreadPool>
+#include <QTimer>
+
+#include <atomic>
+
+#ifdef Q_OS_UNIX
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#endif
+
+
+using namespace core;
+
+namespace
+{
+    /// upper bound on the number of directory readers.
+    constexpr int MAX_READERS = 8;
+
+    /// a reader hands its hits over after this many, or at the end of a
+    /// directory, whichever comes first.
+    constexpr qsizetype FLUSH_SIZE = 256;
+}
+
+struct SearchEngine::Search
+{
+    Search(std::shared_ptr<Receiver<SearchEngine>> receiver, quint64 generation, const QString& pattern)
+        : receiver(std::move(receiver))
+        , generation(generation)
+        , glob(pattern.contains(QRegularExpression("[*?\\[]")))
+        , regex(glob ? QRegularExpression::fromWildcard(pattern, Qt::CaseInsensitive) : QRegularExpression())
+        , matcher(pattern, Qt::CaseInsensitive)
+    {
+    }
+
+    [[nodiscard]] bool matches(const QString& name) const
+    {
+        return glob ? regex.match(name).hasMatch() : matcher.indexIn(name) != -1;
+    }
+
+    void work();
+    void read(const QString& dir, QStringList& found);
+    void flush(QStringList& found);
+
+    const std::shared_ptr<Receiver<SearchEngine>> receiver;
+    const quint64 generation;
+    const bool glob;
+    const QRegularExpression regex;
+    const QStringMatcher matcher;
+
+    WorkQueue<QString> queue;
+    std::atomic<qint64> dirs{0};
+    std::atomic<qint64> hits{0};
+    std::atomic<int> readers{0};
+    std::atomic<bool> cancelled{false};
+
+    QMutex resultsMutex;
+    QStringList results;
+    bool deliveryQueued{false};
+};
+
+void SearchEngine::Search::work()
+{
+    QStringList found;
+    QString dir;
+
+    while (queue.pop(dir)) {
+        read(dir, found);
+        ++dirs;
+
+        /// the subdirectories were pushed by read(), so the queue only runs
+        /// dry once the whole tree has been read.
+        queue.done();
+
+        if (!found.empty()) {
+            flush(found);
+        }
+    }
+
+    if (--readers == 0) {
+        receiver->post([g = generation](SearchEngine* e) { e->finish(g); });
+    }
+}
+
+#if defined(Q_OS_UNIX) && defined(_DIRENT_HAVE_D_TYPE)
+void SearchEngine::Search::read(const QString& dir, QStringList& found)
+{
+    auto* d = opendir(QFile::encodeName(dir).constData());
+    if (d == nullptr) {
+        return;
+    }
+    const auto fd = dirfd(d);
+
+    while (const auto* ent = readdir(d)) {
+        if (ent->d_name[0] == '.') {
+            continue;
+        }
+        if (cancelled) {
+            break;
+        }
+
+        const auto name = QFile::decodeName(ent->d_name);
+        auto isDir      = ent->d_type == DT_DIR;
+
+        if (ent->d_type == DT_UNKNOWN) {
+            struct stat st{};
+            isDir = fstatat(fd, ent->d_name, &st, AT_SYMLINK_NOFOLLOW) == 0 && S_ISDIR(st.st_mode);
+        }
+
+        if (matches(name)) {
+            found.push_back(joinPath(dir, name));
+            ++hits;
+
+            if (found.size() >= FLUSH_SIZE) {
+                flush(found);
+            }
+        }
+        if (isDir) {
+            queue.push(joinPath(dir, name));
+        }
+    }
+
+    closedir(d);
+}
+#else
+void SearchEngine::Search::read(const QString& dir, QStringList& found)
+{
+    auto it = QDirIterator(dir, QDir::AllEntries | QDir::NoDotAndDotDot | QDir::System);
+
+    while (it.hasNext() && !cancelled) {
+        const auto info = it.nextFileInfo();
+
+        if (matches(info.fileName())) {
+            found.push_back(info.filePath());
+            ++hits;
+        }
+        if (info.isDir() && !info.isSymLink()) {
+            queue.push(info.filePath());
+        }
+    }
+}
+#endif
+
+/// hands the hits over to the GUI thread.  The first hits of a batch schedule
+/// the delivery; the ones that arrive before the GUI thread gets to it ride
+/// along.
+void SearchEngine::Search::flush(QStringList& found)
+{
+    QMutexLocker locker(&resultsMutex);
+
+    results.append(std::move(found));
+    found.clear();
+
+    if (!deliveryQueued) {
+        deliveryQueued = true;
+        receiver->post([g = generation](SearchEngine* e) { e->deliver(g); });
+    }
+}
+
+SearchEngine::SearchEngine(QObject* parent)
+    : QObject(parent)
+{
+    _receiver = std::make_shared<Receiver<SearchEngine>>(this);
+
+    _pool = new QThreadPool();
+    _pool->setMaxThreadCount(qBound(2, QThread::idealThreadCount(), MAX_READERS));
+    _pool->setObjectName("surkl-search-pool");
+
+    _progressTimer = new QTimer(this);
+    _progressTimer->setInterval(100);
+
+    connect(_progressTimer, &QTimer::timeout, this, [this]
+    {
+        if (_search) {
+            emit progress(_search->hits, _search->dirs);
+        }
+    });
+}
+
+SearchEngine::~SearchEngine()
+{
+    cancel();
+    _receiver->detach();
+
+    if (_pool->waitForDone(250)) {
+        delete _pool;
+    }
+}
+
+/// starts searching root for pattern; a search that is still running is
+/// cancelled first.
+void SearchEngine::start(const QString& root, const QString& pattern)
+{
+    cancel();
+
+    const auto readers = _pool->maxThreadCount();
+
+    _search = std::make_shared<Search>(_receiver, ++_generation, pattern);
+    _search->readers = readers;
+    _search->queue.push(root);
+
+    for (int i = 0; i < readers; ++i) {
+        _pool->start([search = _search] { search->work(); });
+    }
+
+    _progressTimer->start();
+}
+
+void SearchEngine::cancel()
+{
+    if (_search) {
+        _search->cancelled = true;
+        _search->queue.cancel();
+    }
+}
+
+bool SearchEngine::isRunning() const
+{
+    return _search && _search->readers > 0;
+}
+
+void SearchEngine::deliver(quint64 generation)
+{
+    if (!_search || _search->generation != generation) {
+        return;
+    }
+
+    QStringList batch;
+    {
+        QMutexLocker locker(&_search->resultsMutex);
+        batch.swap(_search->results);
+        _search->deliveryQueued = false;
+    }
+
+    if (!batch.empty() && !_search->cancelled) {
+        emit found(batch);
+    }
+}
+
+void SearchEngine::finish(quint64 generation)
+{
+    if (!_search || _search->generation != generation) {
+        return;
+    }
+
+    /// the last hits may have been flushed after the last delivery.
+    deliver(generation);
+
+    _progressTimer->stop();
+    emit progress(_search->hits, _search->dirs);
+    emit finished(_search->cancelled);
+}
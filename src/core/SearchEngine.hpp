@@ -0,0 +1,60 @@
+/// Copyright (C) 2025 Arlen Avakian
+/// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include "Receiver.hpp"
+
+#include <QObject>
+#include <QStringList>
+
+#include <memory>
+
+
+class QThreadPool;
+class QTimer;
+
+namespace core
+{
+    /// Searches a directory tree for names matching a pattern.
+    ///
+    /// The tree is walked by a pool of directory readers that share one
+    /// stack of the directories left to read (see WorkQueue).  Each takes the
+    /// newest, so the walk goes depth first, and any idle reader picks up
+    /// what another has found, so a single deep subtree is still spread over
+    /// all of them.  Hits are delivered in batches on the GUI thread.
+    ///
+    /// A pattern with any of *?[ is a case-insensitive glob that has to match
+    /// the whole name; otherwise, it is a case-insensitive substring.  Hidden
+    /// entries are skipped, and symbolic links to directories are not
+    /// followed.
+    class SearchEngine final : public QObject
+    {
+        Q_OBJECT
+
+    signals:
+        void found(const QStringList& paths);
+        void progress(qint64 hits, qint64 dirs);
+        void finished(bool cancelled);
+
+    public:
+        explicit SearchEngine(QObject* parent = nullptr);
+        ~SearchEngine() override;
+
+        void start(const QString& root, const QString& pattern);
+        void cancel();
+        [[nodiscard]] bool isRunning() const;
+
+    private:
+        struct Search;
+
+        void deliver(quint64 generation);
+        void finish(quint64 generation);
+
+        QThreadPool* _pool{nullptr};
+        std::shared_ptr<Receiver<SearchEngine>> _receiver;
+        QTimer* _progressTimer{nullptr};
+        std::shared_ptr<Search> _search;
+        quint64 _generation{0};
+    };
+}
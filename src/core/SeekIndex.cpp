@@ -0,0 +1,65 @@
+/// Copyright (C) 2025 Arlen Avakian
+/// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "SeekIndex.hpp"
+
+#include <QModelIndex>
+
+#include <algorithm>
+#include <bit>
+#include <ranges>
+
+
+using namespace core;
+
+SeekIndex::SeekIndex(const QModelIndex& parent)
+{
+    Q_ASSERT(parent.isValid());
+
+    const auto* model = parent.model();
+    const auto rows   = model->rowCount(parent);
+
+    _entries.reserve(rows);
+
+    for (int row = 0; row < rows; ++row) {
+        _entries.push_back({.name = model->index(row, 0, parent).data().toString().toCaseFolded(), .row = row});
+    }
+
+    std::ranges::sort(_entries, {}, &Entry::name);
+
+    auto& rowsOf = _lowest.emplace_back();
+    rowsOf.reserve(rows);
+    for (const auto& entry : std::as_const(_entries)) {
+        rowsOf.push_back(entry.row);
+    }
+
+    for (qsizetype width = 2; width <= rows; width *= 2) {
+        const auto& prev = _lowest.back();
+        QList<int> next(rows - width + 1);
+
+        for (qsizetype i = 0; i < next.size(); ++i) {
+            next[i] = std::min(prev[i], prev[i + width / 2]);
+        }
+        _lowest.push_back(std::move(next));
+    }
+}
+
+int SeekIndex::find(const QString& prefix) const
+{
+    const auto folded = prefix.toCaseFolded();
+    const auto first  = std::ranges::lower_bound(_entries, folded, {}, &Entry::name);
+    const auto last   = std::ranges::partition_point(first, _entries.cend(),
+        [&folded](const Entry& entry) { return entry.name.startsWith(folded); });
+
+    if (first == last) {
+        return -1;
+    }
+
+    /// two runs of the same power-of-two length that cover [begin, end).
+    const auto begin = first - _entries.cbegin();
+    const auto end   = last - _entries.cbegin();
+    const auto level = std::bit_width(static_cast<quint64>(end - begin)) - 1;
+    const auto& rows = _lowest[level];
+
+    return std::min(rows[begin], rows[end - (qsizetype(1) << level)]);
+}
@@ -0,0 +1,44 @@
+/// Copyright (C) 2025 Arlen Avakian
+/// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <QList>
+#include <QString>
+
+
+class QModelIndex;
+
+namespace core
+{
+    /// The names of a directory, case-folded and sorted lexically, so that the
+    /// names starting with a prefix are a binary search away.  Of those, the
+    /// one in the lowest row is found, which is the first one shown: the rows
+    /// are in the natural order of the view, where "img2" comes before
+    /// "img10", so the names of a prefix aren't in row order.  A sparse table
+    /// of the lowest rows over every power-of-two run of names answers that
+    /// with two lookups, so a seek costs O(log n) however many names match.
+    /// Built once per directory and thrown away when its rows change.
+    class SeekIndex
+    {
+    public:
+        SeekIndex() = default;
+        explicit SeekIndex(const QModelIndex& parent);
+
+        /// returns the lowest row of a name that starts with prefix, ignoring
+        /// case; or -1 if there is none.
+        [[nodiscard]] int find(const QString& prefix) const;
+        [[nodiscard]] qsizetype size() const { return _entries.size(); }
+
+    private:
+        struct Entry
+        {
+            QString name;
+            int row;
+        };
+
+        QList<Entry> _entries;
+        /// _lowest[k][i] is the lowest row of _entries[i, i + 2^k).
+        QList<QList<int>> _lowest;
+    };
+}
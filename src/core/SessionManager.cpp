@@ -2,7 +2,9 @@
 /// SPDX-License-Identifier: GPL-3.0-or-later
 
 #include "SessionManager.hpp"
+#include "DiskUsage.hpp"
 #include "FileSystemScene.hpp"
+#include "Purger.hpp"
 #include "SceneStorage.hpp"
 #include "bookmark.hpp"
 #include "db/db.hpp"
@@ -19,6 +21,9 @@ using namespace core;
 namespace
 {
     constexpr auto OBJ_NAME = QLatin1StringView("surkl-session-manager");
+
+    /// paint() asks for the session, so it is found once and kept.
+    SessionManager* current = nullptr;
 }
 
 
@@ -31,6 +36,10 @@ SessionManager::SessionManager(QObject* parent)
 SessionManager::~SessionManager()
 {
     delete _mw;
+
+    if (current == this) {
+        current = nullptr;
+    }
 }
 
 BookmarkManager* SessionManager::bm()
@@ -68,9 +77,20 @@ gui::theme::ThemeManager* SessionManager::tm()
     return session()->_tm;
 }
 
+const RenderContext& SessionManager::rc()
+{
+    return session()->_rc;
+}
+
 void SessionManager::cleanup() const
 {
     BookmarkManager::saveToDatabase(_bm);
+    _us->flush();
+}
+
+void SessionManager::rebuildRenderContext()
+{
+    _rc = RenderContext::make(_tm);
 }
 
 void SessionManager::init()
@@ -79,10 +99,14 @@ void SessionManager::init()
 
     _tm = new gui::theme::ThemeManager(this);
     gui::theme::ThemeManager::configure(_tm);
+    rebuildRenderContext();
+    connect(_tm, &gui::theme::ThemeManager::themeChanged, this, &SessionManager::rebuildRenderContext);
 
     _bm = new BookmarkManager(this);
     BookmarkManager::configure(_bm);
 
+    DiskUsage::configure();
+    Purger::configure();
     _sc = new FileSystemScene(this);
 
     _ss = new SceneStorage(this);
@@ -99,6 +123,10 @@ void SessionManager::init()
 
 SessionManager* SessionManager::session()
 {
+    if (current != nullptr) {
+        return current;
+    }
+
     Q_ASSERT(qApp != nullptr);
 
     SessionManager* sm{nullptr};
@@ -106,6 +134,7 @@ SessionManager* SessionManager::session()
     if (sm = qApp->findChild<SessionManager*>(OBJ_NAME); sm == nullptr) {
         sm = new SessionManager(qApp);
         sm->setObjectName(OBJ_NAME);
+        current = sm;
         sm->init();
     }
 
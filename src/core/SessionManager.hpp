@@ -3,6 +3,8 @@
 
 #pragma once
 
+#include "RenderContext.hpp"
+
 #include <MainWindow.hpp>
 
 #include <QObject>
@@ -39,9 +41,11 @@ namespace core
         static gui::MainWindow* mw();
         static gui::UiStorage* us();
         static gui::theme::ThemeManager* tm();
+        static const RenderContext& rc();
 
     private slots:
         void cleanup() const;
+        void rebuildRenderContext();
 
     private:
         void init();
@@ -54,5 +58,6 @@ namespace core
         gui::MainWindow*          _mw{nullptr};
         gui::UiStorage*           _us{nullptr};
         gui::theme::ThemeManager* _tm{nullptr};
+        RenderContext             _rc;
     };
 }
@@ -0,0 +1,131 @@
+/// Copyright (C) 2025 Arlen Avakian
+/// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "SortProxyModel.hpp"
+#include "collation.hpp"
+
+
+using namespace core;
+
+namespace
+{
+    /// below this many inserted rows, keys are made on demand by lessThan().
+    constexpr int PRIME_THRESHOLD = 256;
+}
+
+SortProxyModel::SortProxyModel(QObject* parent)
+    : QSortFilterProxyModel(parent)
+{
+}
+
+void SortProxyModel::setSourceModel(QAbstractItemModel* model)
+{
+    if (auto* old = sourceModel()) {
+        disconnect(old, nullptr, this, nullptr);
+    }
+    _keys.clear();
+
+    /// connected before the base class connects its own slots, so the keys of
+    /// inserted rows are ready by the time the proxy sorts them in.
+    if (model != nullptr) {
+        connect(model, &QAbstractItemModel::rowsInserted, this, &SortProxyModel::onSourceRowsInserted);
+        connect(model, &QAbstractItemModel::rowsAboutToBeRemoved, this, &SortProxyModel::onSourceRowsAboutToBeRemoved);
+        connect(model, &QAbstractItemModel::dataChanged, this, &SortProxyModel::onSourceDataChanged);
+        connect(model, &QAbstractItemModel::modelReset, this, [this] { _keys.clear(); });
+    }
+
+    QSortFilterProxyModel::setSourceModel(model);
+}
+
+bool SortProxyModel::lessThan(const QModelIndex& lhs, const QModelIndex& rhs) const
+{
+    if (lhs.column() != 0 || rhs.column() != 0) {
+        return QSortFilterProxyModel::lessThan(lhs, rhs);
+    }
+    if (lhs.internalPointer() == nullptr || rhs.internalPointer() == nullptr) {
+        return collationKey(lhs.data(sortRole()).toString()) < collationKey(rhs.data(sortRole()).toString());
+    }
+
+    return keyOf(lhs) < keyOf(rhs);
+}
+
+void SortProxyModel::onSourceRowsInserted(const QModelIndex& parent, int start, int end)
+{
+    if (end - start + 1 < PRIME_THRESHOLD) {
+        return;
+    }
+
+    const auto* model = sourceModel();
+
+    QStringList names;
+    QList<const void*> ids;
+    names.reserve(end - start + 1);
+    ids.reserve(end - start + 1);
+
+    for (int row = start; row <= end; ++row) {
+        const auto index = model->index(row, 0, parent);
+        names.push_back(index.data(sortRole()).toString());
+        ids.push_back(index.internalPointer());
+    }
+
+    const auto keys = collationKeys(names);
+
+    for (qsizetype i = 0; i < ids.size(); ++i) {
+        if (ids[i] != nullptr) {
+            _keys.insert_or_assign(ids[i], keys[i]);
+        }
+    }
+}
+
+/// the nodes under a removed folder go with it, and their pointers may be
+/// reused for other entries.
+void SortProxyModel::onSourceRowsAboutToBeRemoved(const QModelIndex& parent, int start, int end)
+{
+    const auto* model = sourceModel();
+
+    for (int row = start; row <= end; ++row) {
+        forget(model->index(row, 0, parent));
+    }
+}
+
+/// a renamed entry gets a new key the next time it is compared; connected
+/// before the proxy, which sorts it in again.
+void SortProxyModel::onSourceDataChanged(const QModelIndex& topLeft, const QModelIndex& bottomRight)
+{
+    if (topLeft.column() != 0) {
+        return;
+    }
+
+    const auto* model = sourceModel();
+
+    for (int row = topLeft.row(); row <= bottomRight.row(); ++row) {
+        _keys.erase(model->index(row, 0, topLeft.parent()).internalPointer());
+    }
+}
+
+const QByteArray& SortProxyModel::keyOf(const QModelIndex& index) const
+{
+    auto found = _keys.find(index.internalPointer());
+
+    if (found == _keys.end()) {
+        found = _keys.emplace(index.internalPointer(), collationKey(index.data(sortRole()).toString())).first;
+    }
+
+    return found->second;
+}
+
+/// only what the model has loaded is walked; rowCount() doesn't fetch.
+void SortProxyModel::forget(const QModelIndex& index)
+{
+    if (_keys.empty()) {
+        return;
+    }
+
+    _keys.erase(index.internalPointer());
+
+    const auto* model = sourceModel();
+
+    for (int row = 0, count = model->rowCount(index); row < count; ++row) {
+        forget(model->index(row, 0, index));
+    }
+}
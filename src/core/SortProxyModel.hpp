@@ -0,0 +1,49 @@
+/// Copyright (C) 2025 Arlen Avakian
+/// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <QSortFilterProxyModel>
+
+#include <unordered_map>
+
+
+namespace core
+{
+    /// Sorts the names of the source model naturally (see collationKey()).
+    ///
+    /// The key of an entry is made once and cached by its source node, the
+    /// internal pointer of its index, which the model keeps for as long as
+    /// the entry exists.  Every comparison made by the proxy, whether sorting
+    /// a whole directory or finding the place of an inserted row, is then a
+    /// lookup by pointer and a byte compare; the name isn't looked at again
+    /// until the entry changes or goes away.  When many rows arrive at once
+    /// (e.g., a large directory is listed), their keys are made in parallel
+    /// before the proxy gets to sort them.  Models without internal pointers
+    /// aren't cached.
+    class SortProxyModel final : public QSortFilterProxyModel
+    {
+        Q_OBJECT
+
+    public:
+        explicit SortProxyModel(QObject* parent = nullptr);
+
+        void setSourceModel(QAbstractItemModel* model) override;
+
+    protected:
+        [[nodiscard]] bool lessThan(const QModelIndex& lhs, const QModelIndex& rhs) const override;
+
+    private slots:
+        void onSourceRowsInserted(const QModelIndex& parent, int start, int end);
+        void onSourceRowsAboutToBeRemoved(const QModelIndex& parent, int start, int end);
+        void onSourceDataChanged(const QModelIndex& topLeft, const QModelIndex& bottomRight);
+
+    private:
+        const QByteArray& keyOf(const QModelIndex& index) const;
+        void forget(const QModelIndex& index);
+
+        /// by source node.  Its elements stay put when it grows, so a key can
+        /// be compared by reference while the other one is made.
+        mutable std::unordered_map<const void*, QByteArray> _keys;
+    };
+}
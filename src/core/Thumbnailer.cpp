@@ -0,0 +1,339 @@
+/// Copyright (C) 2025 Arlen Avakian
+/// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "Thumbnailer.hpp"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QImageReader>
+#include <QMutex>
+#include <QRunnable>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QThread>
+#include <QThreadPool>
+#include <QTimer>
+#include <QUrl>
+
+
+using namespace core;
+using namespace Qt::Literals::StringLiterals;
+
+namespace
+{
+    /// upper bound on the number of images being decoded at the same time.
+    constexpr int MAX_DECODERS = 4;
+
+    constexpr qint64 DEFAULT_MEMORY_LIMIT = 64 * 1024 * 1024;
+
+    /// requests not asked for again within this long are dropped.
+    constexpr int SWEEP_INTERVAL = 500;
+
+    /// keys of the freedesktop thumbnail spec.
+    constexpr auto URI_KEY   = "Thumb::URI"_L1;
+    constexpr auto MTIME_KEY = "Thumb::MTime"_L1;
+    constexpr auto SIZE_KEY  = "Thumb::Size"_L1;
+
+    QString thumbnailsDir()
+    {
+        return QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) + "/thumbnails";
+    }
+
+    QString uriOf(const QString& path)
+    {
+        return QUrl::fromLocalFile(path).toString(QUrl::FullyEncoded);
+    }
+
+    QString nameOf(const QString& uri)
+    {
+        return QString::fromLatin1(QCryptographicHash::hash(uri.toUtf8(), QCryptographicHash::Md5).toHex()) + ".png";
+    }
+
+    /// the thumbnail in file, if it was made from this version of uri.
+    QImage readCached(const QString& file, const QString& uri, qint64 mtime)
+    {
+        auto reader = QImageReader(file, "png");
+
+        if (reader.text(URI_KEY) != uri || reader.text(MTIME_KEY) != QString::number(mtime)) {
+            return {};
+        }
+
+        return reader.read();
+    }
+
+    void writeCached(const QString& file, QImage image, const QString& uri, qint64 mtime, qint64 size)
+    {
+        const auto dir = QFileInfo(file).path();
+
+        if (!QDir().mkpath(dir)) {
+            return;
+        }
+        QFile::setPermissions(dir, QFileDevice::ReadOwner | QFileDevice::WriteOwner | QFileDevice::ExeOwner);
+
+        image.setText(URI_KEY, uri);
+        image.setText(MTIME_KEY, QString::number(mtime));
+        image.setText(SIZE_KEY, QString::number(size));
+
+        /// written next to it and renamed, so that no one reads half of it.
+        auto out = QSaveFile(file);
+
+        if (out.open(QIODevice::WriteOnly) && image.save(&out, "png") && out.commit()) {
+            QFile::setPermissions(file, QFileDevice::ReadOwner | QFileDevice::WriteOwner);
+        }
+    }
+
+    QImage decode(const QString& path)
+    {
+        auto reader = QImageReader(path);
+        reader.setAutoTransform(true);
+
+        if (const auto size = reader.size(); size.width() > Thumbnailer::SIZE || size.height() > Thumbnailer::SIZE) {
+            reader.setScaledSize(size.scaled(Thumbnailer::SIZE, Thumbnailer::SIZE, Qt::KeepAspectRatio));
+        }
+
+        auto image = reader.read();
+
+        /// for the formats that can't tell their size up front.
+        if (image.width() > Thumbnailer::SIZE || image.height() > Thumbnailer::SIZE) {
+            image = image.scaled(Thumbnailer::SIZE, Thumbnailer::SIZE, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+        }
+
+        return image;
+    }
+
+    /// runs on a worker: the cached thumbnail if it is current, or else a new
+    /// one, which is cached for next time.  Images that can't be decoded are
+    /// remembered in the fail directory, as the spec asks.
+    QImage load(const QString& path, bool video)
+    {
+        const auto info  = QFileInfo(path);
+        const auto mtime = info.lastModified().toSecsSinceEpoch();
+        const auto uri   = uriOf(info.absoluteFilePath());
+        const auto name  = nameOf(uri);
+        const auto dir   = thumbnailsDir();
+
+        if (auto image = readCached(dir + "/normal/" + name, uri, mtime); !image.isNull() || video) {
+            return image;
+        }
+
+        const auto failed = dir + "/fail/surkl/" + name;
+
+        if (QFileInfo::exists(failed) && !readCached(failed, uri, mtime).isNull()) {
+            return {};
+        }
+
+        const auto image = decode(path);
+
+        if (image.isNull()) {
+            auto marker = QImage(1, 1, QImage::Format_ARGB32);
+            marker.fill(Qt::transparent);
+            writeCached(failed, marker, uri, mtime, info.size());
+        } else if (!info.absoluteFilePath().startsWith(dir + '/')) {
+            /// thumbnails of thumbnails aren't worth keeping.
+            writeCached(dir + "/normal/" + name, image, uri, mtime, info.size());
+        }
+
+        return image;
+    }
+}
+
+struct Thumbnailer::Inbox
+{
+    struct Result
+    {
+        QString path;
+        QImage image;
+    };
+
+    QMutex mutex;
+    QList<Result> results;
+    bool deliveryQueued{false};
+};
+
+Thumbnailer::Thumbnailer(QObject* parent)
+    : QObject(parent)
+    , _receiver(std::make_shared<Receiver<Thumbnailer>>(this))
+    , _inbox(std::make_shared<Inbox>())
+{
+    _pool = new QThreadPool();
+    _pool->setMaxThreadCount(qBound(1, QThread::idealThreadCount() / 2, MAX_DECODERS));
+    _pool->setObjectName("surkl-thumbnail-pool");
+
+    _sweepTimer = new QTimer(this);
+    _sweepTimer->setInterval(SWEEP_INTERVAL);
+    connect(_sweepTimer, &QTimer::timeout, this, &Thumbnailer::sweep);
+
+    setMemoryLimit(DEFAULT_MEMORY_LIMIT);
+
+    for (const auto& format : QImageReader::supportedImageFormats()) {
+        _imageSuffixes.insert(QString::fromLatin1(format).toLower());
+    }
+    _videoSuffixes = {"mp4", "m4v", "mkv", "webm", "avi", "mov", "wmv", "mpg", "mpeg", "ogv", "3gp"};
+}
+
+/// the requests are owned here, not by the pool.  If a decoder is stuck on
+/// a file, the requests that were started are left to it, with the pool.
+Thumbnailer::~Thumbnailer()
+{
+    _receiver->detach();
+
+    for (auto it = _pending.begin(); it != _pending.end(); ) {
+        if (_pool->tryTake(it->runnable)) {
+            delete it->runnable;
+            it = _pending.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    if (_pool->waitForDone(250)) {
+        for (const auto& r : std::as_const(_pending)) {
+            delete r.runnable;
+        }
+        delete _pool;
+    }
+}
+
+bool Thumbnailer::canThumbnail(const QString& path) const
+{
+    const auto suffix = QFileInfo(path).suffix().toLower();
+
+    return _imageSuffixes.contains(suffix) || _videoSuffixes.contains(suffix);
+}
+
+/// the thumbnail of path, or nullptr if it isn't ready, or there is none.
+/// ready() is emitted once it is.
+const QPixmap* Thumbnailer::thumbnail(const QString& path)
+{
+    if (const auto* pixmap = _pixmaps.object(path)) {
+        return pixmap;
+    }
+
+    if (_failed.contains(path)) {
+        return nullptr;
+    }
+
+    if (const auto found = _pending.find(path); found != _pending.end()) {
+        found->wanted = true;
+        return nullptr;
+    }
+
+    const auto suffix = QFileInfo(path).suffix().toLower();
+
+    if (_imageSuffixes.contains(suffix)) {
+        request(path, false);
+    } else if (_videoSuffixes.contains(suffix)) {
+        request(path, true);
+    }
+
+    return nullptr;
+}
+
+const QPixmap* Thumbnailer::cached(const QString& path) const
+{
+    return _pixmaps.object(path);
+}
+
+/// path has changed; its thumbnail is made again the next time it is asked
+/// for.
+void Thumbnailer::invalidate(const QString& path)
+{
+    _pixmaps.remove(path);
+    _failed.remove(path);
+}
+
+void Thumbnailer::setMemoryLimit(qint64 bytes)
+{
+    _pixmaps.setMaxCost(static_cast<qsizetype>(bytes / 1024));
+}
+
+/// where the freedesktop cache keeps the thumbnail of path.
+QString Thumbnailer::cacheFilePath(const QString& path)
+{
+    return thumbnailsDir() + "/normal/" + nameOf(uriOf(QFileInfo(path).absoluteFilePath()));
+}
+
+/// newer requests go first; what the user is looking at now matters more
+/// than what they scrolled past.
+void Thumbnailer::request(const QString& path, bool video)
+{
+    auto* runnable = QRunnable::create([receiver = _receiver, inbox = _inbox, path, video]
+    {
+        auto image = load(path, video);
+
+        QMutexLocker locker(&inbox->mutex);
+
+        inbox->results.push_back({path, std::move(image)});
+
+        if (!inbox->deliveryQueued) {
+            inbox->deliveryQueued = true;
+            receiver->post([](Thumbnailer* e) { e->deliver(); });
+        }
+    });
+    runnable->setAutoDelete(false);
+
+    _pending.insert(path, {.runnable = runnable, .wanted = true});
+    _pool->start(runnable, ++_priority);
+
+    if (!_sweepTimer->isActive()) {
+        _sweepTimer->start();
+    }
+}
+
+/// drops the requests that weren't asked for since the last sweep, unless a
+/// worker has started on them.
+void Thumbnailer::sweep()
+{
+    QStringList swept;
+
+    for (auto it = _pending.begin(); it != _pending.end(); ) {
+        if (it->wanted) {
+            it->wanted = false;
+            ++it;
+        } else if (_pool->tryTake(it->runnable)) {
+            delete it->runnable;
+            swept.push_back(it.key());
+            it = _pending.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    if (_pending.empty()) {
+        _sweepTimer->stop();
+    }
+
+    if (!swept.empty()) {
+        emit dropped(swept);
+    }
+}
+
+void Thumbnailer::deliver()
+{
+    QList<Inbox::Result> batch;
+    {
+        QMutexLocker locker(&_inbox->mutex);
+        batch.swap(_inbox->results);
+        _inbox->deliveryQueued = false;
+    }
+
+    QStringList paths;
+    paths.reserve(batch.size());
+
+    for (auto& [path, image] : batch) {
+        /// the pool is done with it once it has run.
+        delete _pending.take(path).runnable;
+
+        if (image.isNull()) {
+            _failed.insert(path);
+        } else {
+            const auto cost = qMax<qsizetype>(1, image.sizeInBytes() / 1024);
+            _pixmaps.insert(path, new QPixmap(QPixmap::fromImage(std::move(image))), cost);
+        }
+        paths.push_back(path);
+    }
+
+    emit ready(paths);
+}
@@ -0,0 +1,91 @@
+/// Copyright (C) 2025 Arlen Avakian
+/// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include "Receiver.hpp"
+
+#include <QCache>
+#include <QHash>
+#include <QObject>
+#include <QPixmap>
+#include <QSet>
+
+#include <memory>
+
+
+class QRunnable;
+class QThreadPool;
+class QTimer;
+
+namespace core
+{
+    /// Thumbnails of images, and of videos that another application has
+    /// already made a thumbnail for.
+    ///
+    /// thumbnail() answers from memory, or queues a request and answers
+    /// nullptr; it is meant to be called from paint(), so that only what is
+    /// on screen is asked for.  Requests are decoded on a pool of workers,
+    /// the most recent first, and the ones that haven't been asked for again
+    /// within a sweep are dropped before a worker gets to them.  Since a view
+    /// doesn't repaint what hasn't changed, dropped() tells the owner to
+    /// repaint their nodes; the ones still on screen ask again, and those
+    /// that have scrolled off don't.
+    ///
+    /// Thumbnails are shared with other applications through the freedesktop
+    /// cache (~/.cache/thumbnails/normal), and are checked against the mtime
+    /// of the file.  Images are decoded at the size of the thumbnail with
+    /// QImageReader::setScaledSize, which for JPEG skips most of the work.
+    /// Videos aren't decoded here; a thumbnail in the cache is used if there
+    /// is one.  In memory, thumbnails are kept in an LRU bounded in bytes;
+    /// cached() answers from there only, for files on a mount that doesn't
+    /// answer.
+    class Thumbnailer final : public QObject
+    {
+        Q_OBJECT
+
+    signals:
+        void ready(const QStringList& paths);
+        void dropped(const QStringList& paths);
+
+    public:
+        /// the freedesktop "normal" size.
+        static constexpr int SIZE = 128;
+
+        explicit Thumbnailer(QObject* parent = nullptr);
+        ~Thumbnailer() override;
+
+        [[nodiscard]] bool canThumbnail(const QString& path) const;
+        [[nodiscard]] const QPixmap* thumbnail(const QString& path);
+        [[nodiscard]] const QPixmap* cached(const QString& path) const;
+        void invalidate(const QString& path);
+        void setMemoryLimit(qint64 bytes);
+
+        [[nodiscard]] static QString cacheFilePath(const QString& path);
+
+    private:
+        struct Inbox;
+        struct Request
+        {
+            QRunnable* runnable{nullptr};
+            bool wanted{true};  /// asked for since the last sweep
+        };
+
+        void request(const QString& path, bool video);
+        void sweep();
+        void deliver();
+
+        QThreadPool* _pool{nullptr};
+        QTimer* _sweepTimer{nullptr};
+        std::shared_ptr<Receiver<Thumbnailer>> _receiver;
+        std::shared_ptr<Inbox> _inbox;
+
+        QCache<QString, QPixmap> _pixmaps;  /// cost in KiB
+        QSet<QString> _failed;              /// not asked again until invalidated
+        QHash<QString, Request> _pending;
+        int _priority{0};
+
+        QSet<QString> _imageSuffixes;
+        QSet<QString> _videoSuffixes;
+    };
+}
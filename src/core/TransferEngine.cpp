@@ -0,0 +1,579 @@
+/// Copyright (C) 2025 Arlen Avakian
+/// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "TransferEngine.hpp"
+#include "paths.hpp"
+
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutex>
+#include <QThread>
+#include <QThreadPool>
+#include <QTimer>
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+#ifdef Q_OS_UNIX
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef Q_OS_LINUX
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#endif
+
+
+using namespace core;
+
+namespace
+{
+    /// copying is bound by the disks, not the CPU; a few files at a time keep
+    /// a fast disk busy without making a slow one seek.
+    constexpr int MAX_COPIERS = 4;
+
+    /// how much a copier copies between checks for cancellation.
+    constexpr qint64 CHUNK_SIZE = 8 * 1024 * 1024;
+
+    enum class RenameResult
+    {
+        Renamed,
+        CrossDevice,
+        Failed
+    };
+
+#ifdef Q_OS_UNIX
+    QString lastError()
+    {
+        return QString::fromLocal8Bit(std::strerror(errno));
+    }
+
+    RenameResult renameEntry(const QString& source, const QString& target, QString& error)
+    {
+        if (::rename(QFile::encodeName(source).constData(), QFile::encodeName(target).constData()) == 0) {
+            return RenameResult::Renamed;
+        }
+        if (errno == EXDEV) {
+            return RenameResult::CrossDevice;
+        }
+        error = lastError();
+
+        return RenameResult::Failed;
+    }
+#else
+    RenameResult renameEntry(const QString& source, const QString& target, QString& error)
+    {
+        Q_UNUSED(error);
+
+        /// can't tell why it failed; copying will tell.
+        return QDir().rename(source, target) ? RenameResult::Renamed : RenameResult::CrossDevice;
+    }
+#endif
+}
+
+struct TransferEngine::Job : std::enable_shared_from_this<Job>
+{
+    struct Item
+    {
+        enum Kind { File, Symlink };
+
+        QString source;
+        QString target;
+        qint64 size{0};
+        Kind kind{File};
+        qsizetype root{0};  /// index of the source it belongs to
+    };
+
+    Job(std::shared_ptr<Receiver<TransferEngine>> receiver, quint64 generation, Request request)
+        : receiver(std::move(receiver))
+        , generation(generation)
+        , request(std::move(request))
+        , copiedRoots(this->request.sources.size(), false)
+        , failedRoots(this->request.sources.size())
+    {
+    }
+
+    void run(QThreadPool* pool);
+    void plan(qsizetype root);
+    void collect(qsizetype root, const QFileInfo& info, const QString& target);
+    void work();
+    void leave();
+    bool copyFile(const Item& item);
+    bool copyLink(const Item& item);
+    void fail(qsizetype root, const QString& error);
+
+    const std::shared_ptr<Receiver<TransferEngine>> receiver;
+    const quint64 generation;
+    const Request request;
+
+    /// written while planning, and only read once the copiers start.
+    QList<Item> items;
+    std::vector<bool> copiedRoots;  /// rather than renamed
+
+    std::vector<std::atomic<bool>> failedRoots;
+    std::atomic<qint64> next{0};
+    std::atomic<qint64> bytesDone{0};
+    std::atomic<qint64> bytesTotal{0};
+    std::atomic<qint64> filesDone{0};
+    std::atomic<qint64> filesTotal{0};
+    std::atomic<qint64> skipped{0};
+    std::atomic<int> workers{0};
+    std::atomic<bool> cancelled{false};
+
+    QMutex errorsMutex;
+    QStringList errors;
+    bool deliveryQueued{false};
+};
+
+/// plans the whole transfer, then becomes one of its copiers.
+void TransferEngine::Job::run(QThreadPool* pool)
+{
+    for (qsizetype root = 0; root < request.sources.size() && !cancelled; ++root) {
+        plan(root);
+    }
+
+    const auto copiers = qBound<qsizetype>(1, items.size(), pool->maxThreadCount());
+    workers = static_cast<int>(copiers);
+
+    for (qsizetype i = 1; i < copiers; ++i) {
+        pool->start([job = shared_from_this()] { job->work(); });
+    }
+
+    work();
+}
+
+void TransferEngine::Job::plan(qsizetype root)
+{
+    const auto& source = request.sources[root];
+    const auto info    = QFileInfo(source);
+    const auto target  = joinPath(request.destination, info.fileName());
+    const auto isDir   = info.isDir() && !info.isSymLink();
+
+    if (!info.exists() && !info.isSymLink()) {
+        fail(root, QString("%1 no longer exists").arg(source));
+        return;
+    }
+    if (target == source) {
+        /// dropped onto its own folder.
+        ++skipped;
+        return;
+    }
+    if (isDir && request.mode != Link && isWithin(request.destination, source)) {
+        fail(root, QString("%1 can't go inside of itself").arg(info.fileName()));
+        return;
+    }
+    if (const auto existing = QFileInfo(target); existing.exists() || existing.isSymLink()) {
+        fail(root, QString("%1 already exists").arg(target));
+        return;
+    }
+
+    if (request.mode == Link) {
+        ++filesTotal;
+        if (QFile::link(source, target)) {
+            ++filesDone;
+        } else {
+            fail(root, QString("could not link %1").arg(target));
+        }
+        return;
+    }
+
+    if (request.mode == Move) {
+        QString error;
+        const auto result = renameEntry(source, target, error);
+
+        if (result == RenameResult::Renamed) {
+            ++filesTotal;
+            ++filesDone;
+            return;
+        }
+        if (result == RenameResult::Failed) {
+            fail(root, QString("could not move %1: %2").arg(info.fileName(), error));
+            return;
+        }
+    }
+
+    copiedRoots[root] = true;
+    collect(root, info, target);
+}
+
+/// creates the directories, parents first, and queues up everything else
+/// for the copiers.
+void TransferEngine::Job::collect(qsizetype root, const QFileInfo& info, const QString& target)
+{
+    const auto push = [this, root](const QFileInfo& from, const QString& to) -> bool
+    {
+        if (from.isSymLink()) {
+            items.push_back({.source = from.filePath(), .target = to, .size = 0, .kind = Item::Symlink, .root = root});
+        } else if (from.isFile()) {
+            items.push_back({.source = from.filePath(), .target = to, .size = from.size(), .kind = Item::File, .root = root});
+            bytesTotal += from.size();
+        } else {
+            return false;
+        }
+        ++filesTotal;
+
+        return true;
+    };
+
+    if (!info.isDir() || info.isSymLink()) {
+        if (!push(info, target)) {
+            fail(root, QString("skipped %1").arg(info.filePath()));
+        }
+        return;
+    }
+
+    std::vector<std::pair<QString, QString>> dirs{{info.filePath(), target}};
+
+    while (!dirs.empty() && !cancelled) {
+        const auto [from, to] = std::move(dirs.back());
+        dirs.pop_back();
+
+        if (!QDir().mkdir(to)) {
+            fail(root, QString("could not create %1").arg(to));
+            continue;
+        }
+
+        auto it = QDirIterator(from, QDir::AllEntries | QDir::NoDotAndDotDot | QDir::System | QDir::Hidden);
+
+        while (it.hasNext()) {
+            const auto child       = it.nextFileInfo();
+            const auto childTarget = joinPath(to, child.fileName());
+
+            if (child.isDir() && !child.isSymLink()) {
+                dirs.emplace_back(child.filePath(), childTarget);
+            } else if (!push(child, childTarget)) {
+                /// sockets, pipes and devices.
+                fail(root, QString("skipped %1").arg(child.filePath()));
+            }
+        }
+    }
+}
+
+void TransferEngine::Job::work()
+{
+    while (!cancelled) {
+        const auto i = next++;
+        if (i >= items.size()) {
+            break;
+        }
+
+        const auto& item = items[i];
+
+        if (item.kind == Item::File ? copyFile(item) : copyLink(item)) {
+            ++filesDone;
+        }
+    }
+
+    leave();
+}
+
+/// the last copier out removes the sources of the moves that had to be
+/// copied, unless some of their files could not be.
+void TransferEngine::Job::leave()
+{
+    if (--workers > 0) {
+        return;
+    }
+
+    if (request.mode == Move && !cancelled) {
+        for (qsizetype root = 0; root < request.sources.size(); ++root) {
+            if (!copiedRoots[root] || failedRoots[root]) {
+                continue;
+            }
+
+            const auto& source = request.sources[root];
+            const auto info    = QFileInfo(source);
+            const auto removed = info.isDir() && !info.isSymLink()
+                ? QDir(source).removeRecursively()
+                : QFile::remove(source);
+
+            if (!removed) {
+                fail(root, QString("copied, but could not remove %1").arg(source));
+            }
+        }
+    }
+
+    receiver->post([g = generation](TransferEngine* e) { e->finish(g); });
+}
+
+#ifdef Q_OS_LINUX
+bool TransferEngine::Job::copyFile(const Item& item)
+{
+    const auto in = ::open(QFile::encodeName(item.source).constData(), O_RDONLY | O_CLOEXEC);
+    if (in == -1) {
+        fail(item.root, QString("could not read %1: %2").arg(item.source, lastError()));
+        return false;
+    }
+
+    struct stat st{};
+    if (fstat(in, &st) != 0) {
+        fail(item.root, QString("could not read %1: %2").arg(item.source, lastError()));
+        ::close(in);
+        return false;
+    }
+
+    const auto out = ::open(QFile::encodeName(item.target).constData(),
+        O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, (st.st_mode & 07777) | S_IWUSR);
+    if (out == -1) {
+        fail(item.root, QString("could not create %1: %2").arg(item.target, lastError()));
+        ::close(in);
+        return false;
+    }
+
+    /// a reflink shares the blocks of the source, if the filesystem can.
+    auto ok = ioctl(out, FICLONE, in) == 0;
+
+    if (ok) {
+        bytesDone += st.st_size;
+    }
+
+    auto copied   = qint64{0};
+    auto inKernel = true;
+    QByteArray buffer;
+
+    while (!ok && !cancelled) {
+        ssize_t n = 0;
+
+        if (inKernel) {
+            n = copy_file_range(in, nullptr, out, nullptr, CHUNK_SIZE, 0);
+
+            /// not across these filesystems; fall back to read() and write().
+            if (n == -1 && copied == 0
+                    && (errno == EXDEV || errno == ENOSYS || errno == EINVAL || errno == EOPNOTSUPP)) {
+                inKernel = false;
+                continue;
+            }
+        } else {
+            if (buffer.isEmpty()) {
+                buffer.resize(1024 * 1024);
+            }
+
+            n = ::read(in, buffer.data(), buffer.size());
+
+            for (ssize_t written = 0; n > 0 && written < n; ) {
+                const auto w = ::write(out, buffer.constData() + written, n - written);
+                if (w == -1 && errno != EINTR) {
+                    n = -1;
+                    break;
+                }
+                written += qMax<ssize_t>(0, w);
+            }
+        }
+
+        if (n == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            fail(item.root, QString("could not copy %1: %2").arg(item.source, lastError()));
+            break;
+        }
+        if (n == 0) {
+            ok = true;
+            break;
+        }
+
+        copied    += n;
+        bytesDone += n;
+    }
+
+    if (ok) {
+        const struct timespec times[2] = {st.st_atim, st.st_mtim};
+        fchmod(out, st.st_mode & 07777);
+        futimens(out, times);
+    }
+
+    ::close(out);
+    ::close(in);
+
+    if (!ok) {
+        ::unlink(QFile::encodeName(item.target).constData());
+    }
+
+    return ok;
+}
+#else
+bool TransferEngine::Job::copyFile(const Item& item)
+{
+    if (!QFile::copy(item.source, item.target)) {
+        fail(item.root, QString("could not copy %1").arg(item.source));
+        return false;
+    }
+    bytesDone += item.size;
+
+    return true;
+}
+#endif
+
+#ifdef Q_OS_UNIX
+bool TransferEngine::Job::copyLink(const Item& item)
+{
+    const auto source = QFile::encodeName(item.source);
+
+    /// st_size is the length of the target, or 0 for some links in /proc; a
+    /// target that fills the buffer may have been cut short, or changed since
+    /// the lstat, and is read again with a larger one.
+    struct stat st{};
+    auto size = ::lstat(source.constData(), &st) == 0 && st.st_size > 0 ? st.st_size + 1 : qint64{256};
+    QByteArray link;
+    ssize_t n = -1;
+
+    for (;; size *= 2) {
+        link.resize(size);
+        n = ::readlink(source.constData(), link.data(), link.size());
+
+        if (n < link.size()) {
+            break;
+        }
+    }
+
+    if (n == -1 || symlink(link.first(n).constData(), QFile::encodeName(item.target).constData()) != 0) {
+        fail(item.root, QString("could not copy link %1: %2").arg(item.source, lastError()));
+        return false;
+    }
+
+    return true;
+}
+#else
+bool TransferEngine::Job::copyLink(const Item& item)
+{
+    if (!QFile::link(QFileInfo(item.source).symLinkTarget(), item.target)) {
+        fail(item.root, QString("could not copy link %1").arg(item.source));
+        return false;
+    }
+
+    return true;
+}
+#endif
+
+/// hands the error over to the GUI thread, in batches.
+void TransferEngine::Job::fail(qsizetype root, const QString& error)
+{
+    failedRoots[root] = true;
+
+    QMutexLocker locker(&errorsMutex);
+
+    errors.push_back(error);
+
+    if (!deliveryQueued) {
+        deliveryQueued = true;
+        receiver->post([g = generation](TransferEngine* e) { e->deliver(g); });
+    }
+}
+
+TransferEngine::TransferEngine(QObject* parent)
+    : QObject(parent)
+{
+    _receiver = std::make_shared<Receiver<TransferEngine>>(this);
+
+    _pool = new QThreadPool();
+    _pool->setMaxThreadCount(qBound(2, QThread::idealThreadCount(), MAX_COPIERS));
+    _pool->setObjectName("surkl-transfer-pool");
+
+    _progressTimer = new QTimer(this);
+    _progressTimer->setInterval(100);
+
+    connect(_progressTimer, &QTimer::timeout, this, [this]
+    {
+        if (_job) {
+            emit progress(_job->bytesDone, _job->bytesTotal, _job->filesDone, _job->filesTotal);
+        }
+    });
+}
+
+TransferEngine::~TransferEngine()
+{
+    cancel();
+    _receiver->detach();
+
+    if (_pool->waitForDone(250)) {
+        delete _pool;
+    }
+}
+
+/// transfers sources into the destination directory, keeping their names.
+void TransferEngine::start(const QStringList& sources, const QString& destination, Mode mode)
+{
+    _queue.push_back({.sources = sources, .destination = destination, .mode = mode});
+
+    if (!_job) {
+        startNext();
+    }
+}
+
+/// cancels the running transfer, and drops the queued ones.  Whatever was
+/// done stays done; the file being copied is removed.
+void TransferEngine::cancel()
+{
+    _queue.clear();
+
+    if (_job) {
+        _job->cancelled = true;
+    }
+}
+
+bool TransferEngine::isRunning() const
+{
+    return _job != nullptr;
+}
+
+void TransferEngine::startNext()
+{
+    if (_job || _queue.empty()) {
+        return;
+    }
+
+    _job = std::make_shared<Job>(_receiver, ++_generation, _queue.takeFirst());
+    _pool->start([job = _job, pool = _pool] { job->run(pool); });
+
+    _progressTimer->start();
+}
+
+void TransferEngine::deliver(quint64 generation)
+{
+    if (!_job || _job->generation != generation) {
+        return;
+    }
+
+    QStringList batch;
+    {
+        QMutexLocker locker(&_job->errorsMutex);
+        batch.swap(_job->errors);
+        _job->deliveryQueued = false;
+    }
+
+    if (!batch.empty()) {
+        emit failed(batch);
+    }
+}
+
+void TransferEngine::finish(quint64 generation)
+{
+    if (!_job || _job->generation != generation) {
+        return;
+    }
+
+    /// the last errors may have come after the last delivery.
+    deliver(generation);
+
+    _progressTimer->stop();
+    emit progress(_job->bytesDone, _job->bytesTotal, _job->filesDone, _job->filesTotal);
+
+    const auto failures = std::ranges::count_if(_job->failedRoots, [](const auto& failed) { return failed.load(); });
+    const auto done     = _job->request.sources.size() - failures - _job->skipped;
+
+    const auto mode      = _job->request.mode;
+    const auto cancelled = _job->cancelled.load();
+
+    _job.reset();
+
+    emit finished(mode, done, failures, cancelled);
+
+    startNext();
+}
@@ -0,0 +1,76 @@
+/// Copyright (C) 2025 Arlen Avakian
+/// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include "Receiver.hpp"
+
+#include <QObject>
+#include <QStringList>
+
+#include <memory>
+
+
+class QThreadPool;
+class QTimer;
+
+namespace core
+{
+    /// Copies, moves and links files and directory trees off the GUI thread.
+    ///
+    /// A transfer is first planned on a worker: directories are created,
+    /// moves within a filesystem are done with a single rename, and the files
+    /// to copy are collected.  The files are then copied by a pool of
+    /// workers, with a reflink if the filesystem can share the blocks, or
+    /// else with copy_file_range, which keeps the data in the kernel.  A move
+    /// across filesystems is a copy, and its sources are removed only if all
+    /// of their files were copied.
+    ///
+    /// Nothing is overwritten: a source whose target exists fails.  Progress
+    /// is reported every 100 ms, and errors in batches, on the GUI thread.
+    /// Transfers started while one is running are queued.
+    class TransferEngine final : public QObject
+    {
+        Q_OBJECT
+
+    signals:
+        void progress(qint64 bytesDone, qint64 bytesTotal, qint64 filesDone, qint64 filesTotal);
+        void failed(const QStringList& errors);
+        void finished(int mode, qint64 done, qint64 failures, bool cancelled);
+
+    public:
+        enum Mode
+        {
+            Copy = 0,
+            Move,
+            Link
+        };
+
+        explicit TransferEngine(QObject* parent = nullptr);
+        ~TransferEngine() override;
+
+        void start(const QStringList& sources, const QString& destination, Mode mode);
+        void cancel();
+        [[nodiscard]] bool isRunning() const;
+
+    private:
+        struct Job;
+        struct Request
+        {
+            QStringList sources;
+            QString destination;
+            Mode mode;
+        };
+
+        void startNext();
+        void deliver(quint64 generation);
+        void finish(quint64 generation);
+
+        QThreadPool* _pool{nullptr};
+        std::shared_ptr<Receiver<TransferEngine>> _receiver;
+        QTimer* _progressTimer{nullptr};
+        std::shared_ptr<Job> _job;
+        quint64 _generation{0};
+        QList<Request> _queue;
+    };
+}
@@ -0,0 +1,80 @@
+/// Copyright (C) 2025 Arlen Avakian
+/// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <QMutex>
+#include <QWaitCondition>
+
+#include <vector>
+
+
+namespace core
+{
+    /// The work of a walk over a tree, which the workers add to as they go:
+    /// the directories that are left to read.
+    ///
+    /// pop() takes the newest item, so the walk goes depth first, which keeps
+    /// the number of unfinished directories low.  While nothing is queued but
+    /// others are still working on an item, and may find more, it sleeps
+    /// until they push() or are done() with it.  It returns false once the
+    /// walk is over, with nothing queued and nothing being worked on, or once
+    /// it is cancelled.
+    template <typename T>
+    class WorkQueue
+    {
+    public:
+        void push(T item)
+        {
+            QMutexLocker locker(&_mutex);
+
+            _items.push_back(std::move(item));
+            _ready.wakeOne();
+        }
+
+        /// a worker that gets an item must call done() once it is through
+        /// with it.
+        [[nodiscard]] bool pop(T& item)
+        {
+            QMutexLocker locker(&_mutex);
+
+            while (_items.empty() && _busy > 0 && !_cancelled) {
+                _ready.wait(&_mutex);
+            }
+
+            if (_items.empty() || _cancelled) {
+                return false;
+            }
+
+            item = std::move(_items.back());
+            _items.pop_back();
+            ++_busy;
+
+            return true;
+        }
+
+        void done()
+        {
+            QMutexLocker locker(&_mutex);
+
+            if (--_busy == 0 && _items.empty()) {
+                _ready.wakeAll();
+            }
+        }
+
+        void cancel()
+        {
+            QMutexLocker locker(&_mutex);
+
+            _cancelled = true;
+            _ready.wakeAll();
+        }
+
+    private:
+        QMutex _mutex;
+        QWaitCondition _ready;
+        std::vector<T> _items;
+        qint64 _busy{0};
+        bool _cancelled{false};
+    };
+}
@@ -136,19 +136,17 @@ void SceneButton::paint(QPainter *painter, const QStyleOptionGraphicsItem *optio
     Q_UNUSED(option);
     Q_UNUSED(widget);
 
-    auto* tm = SessionManager::tm();
+    const auto& rc = SessionManager::rc();
 
     const auto rec = boundingRect();
     painter->setRenderHint(QPainter::Antialiasing);
-    painter->setPen(QPen(tm->sceneLightColor(), 2));
-    painter->setBrush(tm->sceneDarkColor());
+    painter->setPen(rc.buttonRim);
+    painter->setBrush(rc.buttonBody);
     painter->drawEllipse(rec.adjusted(1, 1, -1, -1));
 
     if (_timeline->state() == QTimeLine::Running) {
         painter->setBrush(Qt::NoBrush);
-        auto pen = QPen(tm->sceneDarkColor(), 2);
-        pen.setStyle(Qt::PenStyle::DotLine);
-        painter->setPen(pen);
+        painter->setPen(rc.buttonCountdown);
         painter->drawArc(rec.adjusted(1, 1, -1, -1), 0, _timeline->currentValue() * 360 * 16);
     }
 }
@@ -164,10 +162,8 @@ void AboutButton::paint(QPainter *painter, const QStyleOptionGraphicsItem *optio
 {
     SceneButton::paint(painter, option, widget);
 
-    auto* tm = SessionManager::tm();
-
     painter->setBrush(Qt::NoBrush);
-    painter->setPen(QPen(tm->sceneLightColor(), 1));
+    painter->setPen(SessionManager::rc().buttonText);
     painter->drawText(boundingRect(), Qt::AlignCenter, "i");
 }
 
@@ -196,10 +192,8 @@ void ThemeButton::paint(QPainter *painter, const QStyleOptionGraphicsItem *optio
 {
     SceneButton::paint(painter, option, widget);
 
-    auto* tm = SessionManager::tm();
-
     painter->setBrush(Qt::NoBrush);
-    painter->setPen(QPen(tm->sceneLightColor(), 1));
+    painter->setPen(SessionManager::rc().buttonText);
     painter->drawText(boundingRect(), Qt::AlignCenter, "TS");
 }
 
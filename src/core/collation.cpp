@@ -0,0 +1,164 @@
+/// Copyright (C) 2025 Arlen Avakian
+/// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "collation.hpp"
+
+#include <QSemaphore>
+#include <QThread>
+#include <QThreadPool>
+
+#include <algorithm>
+#include <numeric>
+
+
+namespace
+{
+    /// leads a run of digits in a key.  It is the byte of '0', so numbers sort
+    /// among the other characters as digits do.
+    constexpr char DIGITS_MARKER = '0';
+
+    bool isDigit(QChar c)
+    {
+        return c >= u'0' && c <= u'9';
+    }
+
+    int parts()
+    {
+        return qBound(2, QThread::idealThreadCount(), 16);
+    }
+
+    /// calls f(i) for every i in [0, n): f(0) on the calling thread, and the
+    /// rest on the global pool.  Returns once all of them have returned.
+    template <typename F>
+    void parallelFor(qsizetype n, F&& f)
+    {
+        QSemaphore done;
+
+        for (qsizetype i = 1; i < n; ++i) {
+            QThreadPool::globalInstance()->start([&f, &done, i]
+            {
+                f(i);
+                done.release();
+            });
+        }
+
+        if (n > 0) {
+            f(0);
+        }
+        done.acquire(static_cast<int>(qMax<qsizetype>(0, n - 1)));
+    }
+}
+
+QByteArray core::collationKey(QStringView name)
+{
+    const auto folded = name.toString().toCaseFolded();
+    const auto n      = folded.size();
+
+    QByteArray key;
+    key.reserve(n * 2 + 8);
+
+    for (qsizetype i = 0; i < n;) {
+        auto j = i;
+
+        if (isDigit(folded[i])) {
+            while (j < n && isDigit(folded[j])) {
+                ++j;
+            }
+
+            /// strip the leading zeros, but keep one digit for zero itself.
+            auto s = i;
+            while (s < j - 1 && folded[s] == u'0') {
+                ++s;
+            }
+
+            /// the longer number is the larger one; numbers of the same length
+            /// compare digit by digit.
+            const auto len = j - s;
+            key.append(DIGITS_MARKER);
+            key.append(static_cast<char>((len >> 8) & 0xff));
+            key.append(static_cast<char>(len & 0xff));
+
+            for (auto k = s; k < j; ++k) {
+                key.append(static_cast<char>(folded[k].unicode()));
+            }
+        } else {
+            while (j < n && !isDigit(folded[j])) {
+                ++j;
+            }
+
+            /// UTF-8 keeps the order of the code points.
+            key.append(QStringView(folded).sliced(i, j - i).toUtf8());
+        }
+
+        i = j;
+    }
+
+    /// the separator is smaller than any byte of the primary key, so a name
+    /// comes before the longer names it is a prefix of.
+    key.append('\0');
+    key.append(name.toUtf8());
+
+    return key;
+}
+
+QList<QByteArray> core::collationKeys(const QStringList& names)
+{
+    const auto n = names.size();
+    QList<QByteArray> keys(n);
+
+    if (n < PARALLEL_SORT_THRESHOLD) {
+        for (qsizetype i = 0; i < n; ++i) {
+            keys[i] = collationKey(names[i]);
+        }
+        return keys;
+    }
+
+    const auto chunk = (n + parts() - 1) / parts();
+
+    parallelFor((n + chunk - 1) / chunk, [&](qsizetype part)
+    {
+        for (auto i = part * chunk; i < qMin(n, (part + 1) * chunk); ++i) {
+            keys[i] = collationKey(names[i]);
+        }
+    });
+
+    return keys;
+}
+
+QList<qsizetype> core::sortedOrder(const QList<QByteArray>& keys)
+{
+    const auto n = keys.size();
+
+    QList<qsizetype> order(n);
+    std::iota(order.begin(), order.end(), 0);
+
+    const auto less = [&keys](qsizetype a, qsizetype b) { return keys[a] < keys[b]; };
+
+    if (n < PARALLEL_SORT_THRESHOLD) {
+        std::ranges::sort(order, less);
+        return order;
+    }
+
+    /// sort the chunks in parallel, then merge neighbouring runs pairwise,
+    /// each level in parallel, until a single run is left.
+    const auto chunk = (n + parts() - 1) / parts();
+    auto* first      = order.data();
+
+    parallelFor((n + chunk - 1) / chunk, [&](qsizetype part)
+    {
+        std::sort(first + part * chunk, first + qMin(n, (part + 1) * chunk), less);
+    });
+
+    for (auto width = chunk; width < n; width *= 2) {
+        parallelFor((n + 2 * width - 1) / (2 * width), [&](qsizetype pair)
+        {
+            const auto lo  = pair * 2 * width;
+            const auto mid = qMin(n, lo + width);
+            const auto hi  = qMin(n, lo + 2 * width);
+
+            std::inplace_merge(first + lo, first + mid, first + hi, less);
+        });
+    }
+
+    return order;
+}
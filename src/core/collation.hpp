@@ -0,0 +1,26 @@
+/// Copyright (C) 2025 Arlen Avakian
+/// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <QByteArray>
+#include <QList>
+#include <QStringList>
+
+
+namespace core
+{
+    /// below this many entries, keys are made and sorted on the calling thread.
+    constexpr qsizetype PARALLEL_SORT_THRESHOLD = 16384;
+
+    /// returns a key that orders names naturally when compared byte by byte:
+    /// case-insensitive, and with runs of digits compared by their value, so
+    /// "file2" comes before "file10".  Names that differ only in case or in
+    /// leading zeros still get distinct keys, ordered by the names themselves.
+    [[nodiscard]] QByteArray collationKey(QStringView name);
+
+    [[nodiscard]] QList<QByteArray> collationKeys(const QStringList& names);
+
+    /// returns the positions of keys in ascending order of the keys.
+    [[nodiscard]] QList<qsizetype> sortedOrder(const QList<QByteArray>& keys);
+}
@@ -0,0 +1,17 @@
+/// Copyright (C) 2025 Arlen Avakian
+/// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "paths.hpp"
+
+#include <QDir>
+
+
+QString core::joinPath(const QString& dir, const QString& name)
+{
+    return dir.endsWith(QDir::separator()) ? dir + name : dir + QDir::separator() + name;
+}
+
+bool core::isWithin(const QString& path, const QString& dir)
+{
+    return path == dir || path.startsWith(joinPath(dir, QString()));
+}
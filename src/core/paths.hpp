@@ -0,0 +1,16 @@
+/// Copyright (C) 2025 Arlen Avakian
+/// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <QString>
+
+
+namespace core
+{
+    /// dir and name, with a single separator between them.
+    [[nodiscard]] QString joinPath(const QString& dir, const QString& name);
+
+    /// true if path is dir, or is inside of it.
+    [[nodiscard]] bool isWithin(const QString& path, const QString& dir);
+}
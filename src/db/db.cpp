@@ -23,6 +23,8 @@ void db::init()
 
     auto db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
     db.setDatabaseName(databaseName);
+    /// DiskUsage writes from a worker, with a connection of its own.
+    db.setConnectOptions("QSQLITE_BUSY_TIMEOUT=1000");
 
     if (db.open()) {
         QSqlQuery q(db);
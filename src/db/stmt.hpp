@@ -133,6 +133,110 @@ namespace stmt::scene
             .arg(NODE_ID);
 }
 
+/// used in core/DiskUsage.cpp
+namespace stmt::du
+{
+    constexpr auto DISK_USAGE_TABLE = "DiskUsage"_L1;
+    constexpr auto DIR_PATH         = "path"_L1;
+    constexpr auto DIR_MTIME        = "mtime"_L1;       // nanoseconds since the epoch
+    constexpr auto DIR_SIZE         = "size"_L1;        // recursive
+    constexpr auto DIR_ENTRIES      = "entries"_L1;     // recursive
+    constexpr auto DIR_OWN_SIZE     = "own_size"_L1;    // of the entries that aren't directories
+    constexpr auto DIR_OWN_ENTRIES  = "own_entries"_L1;
+    constexpr auto DIR_SUBDIRS      = "subdirs"_L1;     // names, separated by '/'
+
+    constexpr auto CREATE_TABLE_TPL
+        = R"(CREATE TABLE IF NOT EXISTS %1
+             ( %2 TEXT PRIMARY KEY
+             , %3 INTEGER
+             , %4 INTEGER
+             , %5 INTEGER
+             , %6 INTEGER
+             , %7 INTEGER
+             , %8 TEXT)
+            )"_L1;
+
+    /// the path itself, and what sorts between the path with a separator
+    /// and the path with the character after it; the primary key serves both.
+    constexpr auto SELECT_DIR_TPL = "SELECT * FROM %1 WHERE %2=? OR (%2>? AND %2<?)"_L1;
+    constexpr auto SELECT_TPL     = "SELECT * FROM %1 WHERE %2=?"_L1;
+    /// the first path in a range, which a walk over the children of a path
+    /// skips through, a subtree at a time.
+    constexpr auto SELECT_FIRST_FROM_TPL  = "SELECT * FROM %1 WHERE %2>=? AND %2<? ORDER BY %2 LIMIT 1"_L1;
+    constexpr auto SELECT_FIRST_AFTER_TPL = "SELECT * FROM %1 WHERE %2>? AND %2<? ORDER BY %2 LIMIT 1"_L1;
+    constexpr auto INSERT_TPL     = "INSERT OR REPLACE INTO %1 ( %2, %3, %4, %5, %6, %7, %8 ) VALUES ( ?, ?, ?, ?, ?, ?, ? )"_L1;
+    /// the same range as SELECT_DIR_TPL; LIKE would take '_' and '%' in the
+    /// path as wildcards, and ignore case.
+    constexpr auto DELETE_DIR_TPL = "DELETE FROM %1 WHERE %2=? OR (%2>? AND %2<?)"_L1;
+
+    static const auto CREATE_DISK_USAGE_TABLE
+        = CREATE_TABLE_TPL.arg(DISK_USAGE_TABLE)
+            .arg(DIR_PATH)
+            .arg(DIR_MTIME)
+            .arg(DIR_SIZE)
+            .arg(DIR_ENTRIES)
+            .arg(DIR_OWN_SIZE)
+            .arg(DIR_OWN_ENTRIES)
+            .arg(DIR_SUBDIRS);
+
+    static const auto SELECT_USAGE
+        = SELECT_TPL.arg(DISK_USAGE_TABLE)
+            .arg(DIR_PATH);
+
+    static const auto SELECT_FIRST_USAGE_FROM
+        = SELECT_FIRST_FROM_TPL.arg(DISK_USAGE_TABLE)
+            .arg(DIR_PATH);
+
+    static const auto SELECT_FIRST_USAGE_AFTER
+        = SELECT_FIRST_AFTER_TPL.arg(DISK_USAGE_TABLE)
+            .arg(DIR_PATH);
+
+    static const auto SELECT_USAGES_BELOW
+        = SELECT_DIR_TPL.arg(DISK_USAGE_TABLE)
+            .arg(DIR_PATH);
+
+    static const auto INSERT_USAGE
+        = INSERT_TPL.arg(DISK_USAGE_TABLE)
+            .arg(DIR_PATH)
+            .arg(DIR_MTIME)
+            .arg(DIR_SIZE)
+            .arg(DIR_ENTRIES)
+            .arg(DIR_OWN_SIZE)
+            .arg(DIR_OWN_ENTRIES)
+            .arg(DIR_SUBDIRS);
+
+    static const auto DELETE_USAGE
+        = DELETE_DIR_TPL.arg(DISK_USAGE_TABLE)
+            .arg(DIR_PATH);
+}
+
+/// used in core/Purger.cpp
+namespace stmt::purge
+{
+    constexpr auto STAGING_TABLE = "PurgeStaging"_L1;
+    constexpr auto STAGING_PATH  = "path"_L1;
+
+    constexpr auto CREATE_TABLE_TPL = "CREATE TABLE IF NOT EXISTS %1 ( %2 TEXT PRIMARY KEY )"_L1;
+    constexpr auto SELECT_TPL       = "SELECT * FROM %1"_L1;
+    constexpr auto INSERT_TPL       = "INSERT OR REPLACE INTO %1 ( %2 ) VALUES ( ? )"_L1;
+    constexpr auto DELETE_TPL       = "DELETE FROM %1 WHERE %2=?"_L1;
+
+    static const auto CREATE_STAGING_TABLE
+        = CREATE_TABLE_TPL.arg(STAGING_TABLE)
+            .arg(STAGING_PATH);
+
+    static const auto SELECT_ALL_STAGINGS
+        = SELECT_TPL.arg(STAGING_TABLE);
+
+    static const auto INSERT_STAGING
+        = INSERT_TPL.arg(STAGING_TABLE)
+            .arg(STAGING_PATH);
+
+    static const auto DELETE_STAGING
+        = DELETE_TPL.arg(STAGING_TABLE)
+            .arg(STAGING_PATH);
+}
+
 /// used in gui/theme/theme.cpp
 namespace stmt::theme
 {
@@ -15,6 +15,7 @@
 #include <QCloseEvent>
 #include <QPushButton>
 #include <QVBoxLayout>
+#include <QWindow>
 
 #include <set>
 #include <stack>
@@ -296,6 +297,17 @@ void MainWindow::moveToNewMainWindow(window::Window *source)
     }
 }
 
+/// minimizing and restoring don't always hide and show the children, so
+/// the views are told here.
+void MainWindow::changeEvent(QEvent* event)
+{
+    QWidget::changeEvent(event);
+
+    if (event->type() == QEvent::WindowStateChange) {
+        view::GraphicsView::updateActivityOf(this);
+    }
+}
+
 void MainWindow::closeEvent(QCloseEvent *event)
 {
     QWidget::closeEvent(event);
@@ -315,6 +327,17 @@ void MainWindow::closeEvent(QCloseEvent *event)
     }
 }
 
+/// the platform window is exposed once it is mapped, and unexposed when it
+/// is minimized or, on some platforms, covered by other windows.
+bool MainWindow::eventFilter(QObject* watched, QEvent* event)
+{
+    if (watched == windowHandle() && event->type() == QEvent::Expose) {
+        view::GraphicsView::updateActivityOf(this);
+    }
+
+    return QWidget::eventFilter(watched, event);
+}
+
 void MainWindow::resizeEvent(QResizeEvent *event)
 {
     stateChanged(this);
@@ -325,6 +348,15 @@ void MainWindow::resizeEvent(QResizeEvent *event)
     QWidget::resizeEvent(event);
 }
 
+void MainWindow::showEvent(QShowEvent* event)
+{
+    QWidget::showEvent(event);
+
+    if (auto* handle = windowHandle()) {
+        handle->installEventFilter(this);
+    }
+}
+
 void MainWindow::deleteFromDb(qint32 idOfMainWindow)
 {
     const auto idsOfViewParents = findChildren<window::Window*>()
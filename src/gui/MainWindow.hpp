@@ -42,10 +42,16 @@ namespace gui
         [[nodiscard]] Splitter* splitter() const { return _splitter; }
 
     protected:
+        void changeEvent(QEvent* event) override;
+
         void closeEvent(QCloseEvent* event) override;
 
+        bool eventFilter(QObject* watched, QEvent* event) override;
+
         void resizeEvent(QResizeEvent *event) override;
 
+        void showEvent(QShowEvent* event) override;
+
     private slots:
         void deleteFromDb(qint32 idOfMainWindow);
 
@@ -12,6 +12,9 @@
 #include "window/Window.hpp"
 
 #include <QSqlRecord>
+#include <QTimer>
+
+#include <ranges>
 
 
 
@@ -38,29 +41,34 @@ namespace
 UiStorage::UiStorage(QObject* parent)
     : QObject(parent)
 {
+    _flushTimer = new QTimer(this);
+    _flushTimer->setSingleShot(true);
+    _flushTimer->setInterval(FLUSH_DELAY);
+    connect(_flushTimer, &QTimer::timeout, this, &UiStorage::flush);
+
     _saveViewConnection = connect
         ( this
         , qOverload<const view::GraphicsView*>(&UiStorage::stateChanged)
         , this
-        , &saveView);
+        , &UiStorage::saveView);
 
     _saveWindowConnection = connect
         ( this
         , qOverload<const window::Window*>(&UiStorage::stateChanged)
         , this
-        , &saveWindow);
+        , &UiStorage::saveWindow);
 
     _saveSplitterConnection = connect
         ( this
         , qOverload<const Splitter*>(&UiStorage::stateChanged)
         , this
-        , &saveSplitter);
+        , &UiStorage::saveSplitter);
 
     _saveMainWindowConnection = connect
         ( this
         , qOverload<const MainWindow*>(&UiStorage::stateChanged)
         , this
-        , &saveMainWindow);
+        , &UiStorage::saveMainWindow);
 }
 
 void UiStorage::configure()
@@ -297,23 +305,10 @@ void UiStorage::saveView(const view::GraphicsView* gv)
 
     if (const auto* va = qobject_cast<view::ViewArea*>(gv->parentWidget())) {
         if (const auto* window = qobject_cast<window::Window*>(va->parentWidget())) {
-            if (auto db = db::get(); db.isOpen()) {
-                QSqlQuery q(db);
-
-                const auto id    = window->widgetId();
-                const auto focus = gv->mapToScene(gv->rect().center());
-                const auto zoom  = gv->viewportTransform().m11();
-
-                if (!q.exec(QLatin1String("INSERT OR REPLACE INTO %1 VALUES (%2, %3, %4, %5)")
-                    .arg(storage::GRAPHICS_VIEWS_TABLE)
-                    .arg(id)
-                    .arg(focus.x())
-                    .arg(focus.y())
-                    .arg(zoom))) {
-
-                    qWarning() << db.lastError();
-                }
-            }
+            _pendingViews.insert(window->widgetId(), storage::View{
+                .focus = gv->mapToScene(gv->rect().center()),
+                .zoom  = gv->viewportTransform().m11()});
+            scheduleFlush();
         }
     }
 }
@@ -322,102 +317,165 @@ void UiStorage::saveWindow(const window::Window* win)
 {
     Q_ASSERT(win);
 
-    if (auto db = db::get(); db.isOpen()) {
-        QSqlQuery q(db);
+    _pendingWindows.insert(win->widgetId(), storage::Window{
+        .size = getWindowSize(win),
+        .type = win->areaWidget()->type()});
+    scheduleFlush();
+}
 
-        const auto id   = win->widgetId();
-        const auto size = getWindowSize(win);
-        const auto type = win->areaWidget()->type();
+void UiStorage::saveSplitter(const Splitter* splitter)
+{
+    Q_ASSERT(splitter);
 
-        if (!q.exec(QLatin1String("INSERT OR REPLACE INTO %1 VALUES (%2, %3, %4)")
-            .arg(storage::WINDOWS_TABLE)
-            .arg(id)
-            .arg(size)
-            .arg(type))) {
-            qWarning() << db.lastError();
+    const auto splitterOri = splitter->orientation();
+
+    auto state = storage::Splitter{
+        .size        = splitterOri == Qt::Horizontal ? splitter->height() : splitter->width(),
+        .orientation = splitterOri,
+        .widgets     = {}};
+
+    for (int i = 0; i < splitter->count(); ++i) {
+        auto* widget = splitter->widget(i);
+        qint32 widgetId = -1;
+        if (const auto* win = qobject_cast<window::Window*>(widget)) {
+            widgetId = win->widgetId();
+        } else if (const auto* sp = qobject_cast<Splitter*>(widget)) {
+            widgetId = sp->widgetId();
         }
+        Q_ASSERT(widgetId != -1);
+        state.widgets.insert({i, widgetId});
     }
+
+    _pendingSplitters.insert(splitter->widgetId(), std::move(state));
+    scheduleFlush();
 }
 
-void UiStorage::saveSplitter(const Splitter* splitter)
+void UiStorage::saveMainWindow(const MainWindow* mw)
 {
-    Q_ASSERT(splitter);
+    Q_ASSERT(mw);
 
-    if (auto db = db::get(); db.isOpen()) {
-        db.transaction();
-        QSqlQuery q(db);
+    _pendingMainWindows.insert(mw->widgetId(), storage::MainWindow{
+        .size = mw->size(),
+        .spId = mw->splitter()->widgetId()});
+    scheduleFlush();
+}
 
-        const auto splitterId  = splitter->widgetId();
-        const auto splitterOri = splitter->orientation();
+/// writes what changed since the last flush, in one transaction.
+void UiStorage::flush()
+{
+    _flushTimer->stop();
 
-        if (!q.exec(QLatin1String("INSERT OR REPLACE INTO %1 VALUES (%2, %3, %4)")
-            .arg(storage::SPLITTERS_TABLE)
-            .arg(splitterId)
-            .arg(splitterOri == Qt::Horizontal ? splitter->height() : splitter->width())
-            .arg(splitterOri))) {
+    if (_pendingViews.empty() && _pendingWindows.empty() && _pendingSplitters.empty()
+        && _pendingMainWindows.empty()) {
+        return;
+    }
+
+    auto db = db::get();
+
+    if (!db.isOpen()) {
+        discardPending();
+        return;
+    }
+
+    db.transaction();
+    QSqlQuery q(db);
+
+    q.prepare(QLatin1String("INSERT OR REPLACE INTO %1 VALUES (?, ?, ?, ?)").arg(storage::GRAPHICS_VIEWS_TABLE));
+
+    for (const auto& [id, view] : _pendingViews.asKeyValueRange()) {
+        q.addBindValue(id);
+        q.addBindValue(view.focus.x());
+        q.addBindValue(view.focus.y());
+        q.addBindValue(view.zoom);
+        if (!q.exec()) {
             qWarning() << db.lastError();
         }
+    }
 
-       q.prepare(QLatin1String(R"(INSERT OR REPLACE INTO %1 (%2, %3) VALUES(?, ?))")
-           .arg(storage::WIDGET_INDICES_TABLE)
-           .arg(storage::WIDGET_ID)
-           .arg(storage::WIDGET_INDEX));
-
-        QList<qint32> widgetIds;
-        for (int i = 0; i < splitter->count(); ++i) {
-            auto* widget = splitter->widget(i);
-            qint32 widgetId = -1;
-            if (const auto* win = qobject_cast<window::Window*>(widget)) {
-                widgetId = win->widgetId();
-            } else if (const auto* sp = qobject_cast<Splitter*>(widget)) {
-                widgetId = sp->widgetId();
-            }
-            Q_ASSERT(widgetId != -1);
-            widgetIds.push_back(widgetId);
+    q.prepare(QLatin1String("INSERT OR REPLACE INTO %1 VALUES (?, ?, ?)").arg(storage::WINDOWS_TABLE));
+
+    for (const auto& [id, win] : _pendingWindows.asKeyValueRange()) {
+        q.addBindValue(id);
+        q.addBindValue(win.size);
+        q.addBindValue(static_cast<int>(win.type));
+        if (!q.exec()) {
+            qWarning() << db.lastError();
+        }
+    }
+
+    q.prepare(QLatin1String("INSERT OR REPLACE INTO %1 VALUES (?, ?, ?)").arg(storage::SPLITTERS_TABLE));
+
+    for (const auto& [id, splitter] : _pendingSplitters.asKeyValueRange()) {
+        q.addBindValue(id);
+        q.addBindValue(splitter.size);
+        q.addBindValue(splitter.orientation);
+        if (!q.exec()) {
+            qWarning() << db.lastError();
+        }
+    }
+
+    q.prepare(QLatin1String(R"(INSERT OR REPLACE INTO %1 (%2, %3) VALUES(?, ?))")
+        .arg(storage::WIDGET_INDICES_TABLE)
+        .arg(storage::WIDGET_ID)
+        .arg(storage::WIDGET_INDEX));
+
+    for (const auto& splitter : std::as_const(_pendingSplitters)) {
+        for (const auto [index, widgetId] : splitter.widgets) {
             q.addBindValue(widgetId);
-            q.addBindValue(i);
+            q.addBindValue(index);
             if (!q.exec()) {
                 qWarning() << db.lastError();
             }
         }
+    }
 
-        q.prepare(QLatin1String(R"(INSERT OR REPLACE INTO %1 (%2, %3) VALUES(?, ?))")
-            .arg(storage::SPLITTER_WIDGETS_TABLE)
-            .arg(storage::WIDGET_ID)
-            .arg(storage::SPLITTER_ID));
+    q.prepare(QLatin1String(R"(INSERT OR REPLACE INTO %1 (%2, %3) VALUES(?, ?))")
+        .arg(storage::SPLITTER_WIDGETS_TABLE)
+        .arg(storage::WIDGET_ID)
+        .arg(storage::SPLITTER_ID));
 
-        for (const auto widgetId : widgetIds) {
+    for (const auto& [id, splitter] : _pendingSplitters.asKeyValueRange()) {
+        for (const auto widgetId : splitter.widgets | std::views::values) {
             q.addBindValue(widgetId);
-            q.addBindValue(splitterId);
+            q.addBindValue(id);
             if (!q.exec()) {
                 qWarning() << db.lastError();
             }
         }
+    }
 
-        db.commit();
+    q.prepare(QLatin1String("INSERT OR REPLACE INTO %1 VALUES (?, ?, ?, ?)").arg(storage::MAIN_WINDOWS_TABLE));
+
+    for (const auto& [id, mw] : _pendingMainWindows.asKeyValueRange()) {
+        q.addBindValue(id);
+        q.addBindValue(mw.size.width());
+        q.addBindValue(mw.size.height());
+        q.addBindValue(mw.spId);
+        if (!q.exec()) {
+            qWarning() << db.lastError();
+        }
     }
+
+    if (!db.commit()) {
+        qWarning() << db.lastError();
+    }
+
+    discardPending();
 }
 
-void UiStorage::saveMainWindow(const MainWindow* mw)
+void UiStorage::scheduleFlush()
 {
-    Q_ASSERT(mw);
-
-    if (auto db = db::get(); db.isOpen()) {
-        QSqlQuery q(db);
+    _flushTimer->start();
+}
 
-        const auto id   = mw->widgetId();
-        const auto size = mw->size();
-        const auto root = mw->splitter()->widgetId();
+void UiStorage::discardPending()
+{
+    _flushTimer->stop();
 
-        if (!q.exec(QString("INSERT OR REPLACE INTO %1 VALUES (%2, %3, %4, %5)")
-            .arg(storage::MAIN_WINDOWS_TABLE)
-            .arg(id)
-            .arg(size.width())
-            .arg(size.height())
-            .arg(root))) {
-            qWarning() << db.lastError();
-        }
-    }
+    _pendingViews.clear();
+    _pendingWindows.clear();
+    _pendingSplitters.clear();
+    _pendingMainWindows.clear();
 }
 
 void UiStorage::deleteView(qint32 parentId)
@@ -495,6 +553,8 @@ void UiStorage::clearTables()
 {
     using namespace gui::storage;
 
+    discardPending();
+
     if (auto db = db::get(); db.isOpen()) {
         db.transaction();
 
@@ -511,6 +571,8 @@ void UiStorage::clearTables()
 
 void UiStorage::deleteFrom(const QLatin1String& table, const QLatin1String& key, const QList<qint32>& values)
 {
+    flush();
+
     if (auto db = db::get(); db.isOpen()) {
         db.transaction();
         QSqlQuery q(db);
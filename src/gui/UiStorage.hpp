@@ -5,6 +5,7 @@
 
 #include "gui/window/AbstractWindowArea.hpp"
 
+#include <QHash>
 #include <QObject>
 #include <QPoint>
 
@@ -93,6 +94,8 @@ namespace gui::storage
 }
 
 
+class QTimer;
+
 namespace gui
 {
     class MainWindow;
@@ -103,6 +106,13 @@ namespace gui
         class GraphicsView;
     }
 
+    /// The layout of the windows, kept in the database.
+    ///
+    /// A change is only noted when it's reported, as the latest state of the
+    /// widget it's about, and all that changed is written in one transaction
+    /// once nothing has changed for FLUSH_DELAY, and when the application
+    /// quits; panning, zooming and resizing don't touch the database.
+    /// Deleting writes what's pending first, so rows don't come back.
     class UiStorage final : public QObject
     {
         Q_OBJECT
@@ -117,20 +127,24 @@ namespace gui
         void stateChanged(const MainWindow* mw);
 
     public:
+        static constexpr int FLUSH_DELAY = 500;
+
         explicit UiStorage(QObject* parent = nullptr);
 
         storage::UiState load();
 
         void configure();
 
+        void flush();
+
     private slots:
-        static void saveView(const view::GraphicsView* gv);
+        void saveView(const view::GraphicsView* gv);
 
-        static void saveWindow(const window::Window* win);
+        void saveWindow(const window::Window* win);
 
-        static void saveSplitter(const Splitter* splitter);
+        void saveSplitter(const Splitter* splitter);
 
-        static void saveMainWindow(const MainWindow* mw);
+        void saveMainWindow(const MainWindow* mw);
 
     public:
         void deleteView(qint32 parentId);
@@ -158,6 +172,17 @@ namespace gui
 
         static void readTable(storage::UiState& state);
 
+        void scheduleFlush();
+
+        void discardPending();
+
+        QTimer* _flushTimer{nullptr};
+
+        QHash<storage::WindowId, storage::View> _pendingViews;
+        QHash<storage::WindowId, storage::Window> _pendingWindows;
+        QHash<storage::SplitterId, storage::Splitter> _pendingSplitters;
+        QHash<storage::MainWindowId, storage::MainWindow> _pendingMainWindows;
+
         QMetaObject::Connection _saveViewConnection;
         QMetaObject::Connection _saveWindowConnection;
         QMetaObject::Connection _saveSplitterConnection;
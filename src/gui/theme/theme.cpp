@@ -11,6 +11,7 @@
 #include <QSqlRecord>
 #include <QStandardItemModel>
 
+#include <cmath>
 #include <ranges>
 #include <set>
 
@@ -107,6 +108,7 @@ void ThemeManager::configure(ThemeManager* tm)
     if (const auto active = tm->getActiveTheme().toStdString();
         palettes.contains(active) && colors.contains(active)) {
         tm->_active = colors[active];
+        tm->deriveFileTypeColors();
     }
 
     qApp->setPalette(tm->toQPalette());
@@ -142,6 +144,7 @@ ThemeManager::ThemeManager(QObject* parent)
 
     addPalette(factory(), "Monochrom");
     _active = factory();
+    deriveFileTypeColors();
 }
 
 
@@ -235,6 +238,7 @@ PaletteId ThemeManager::idFromPalette(const Palette& palette)
 void ThemeManager::setActivePalette(const Palette& palette)
 {
     _active = palette;
+    deriveFileTypeColors();
 
     qApp->setPalette(toQPalette());
 
@@ -471,4 +475,23 @@ QPalette ThemeManager::toQPalette() const
     result.setColor(QPalette::Highlight, sceneMidlightColor());
 
     return result;
-}
\ No newline at end of file
+}
+
+/// the first color, for files of no particular type, is the midlight of the
+/// file nodes; the others share its saturation and value, within bounds,
+/// with their hues spread evenly from its own, so that they fit the palette.
+void ThemeManager::deriveFileTypeColors()
+{
+    const auto& base = _active[NODE_FILE_MIDLIGHT_COLOR];
+
+    const auto hue = qMax(0.0f, base.hsvHueF());
+    const auto sat = qBound(0.3f, base.hsvSaturationF(), 0.7f);
+    const auto val = qBound(0.45f, base.valueF(), 0.85f);
+    const auto n   = static_cast<float>(FILE_TYPE_COLOR_COUNT - 1);
+
+    _fileTypeColors[0] = base;
+
+    for (std::size_t i = 1; i < FILE_TYPE_COLOR_COUNT; ++i) {
+        _fileTypeColors[i] = QColor::fromHsvF(std::fmod(hue + static_cast<float>(i - 1) / n, 1.0f), sat, val);
+    }
+}
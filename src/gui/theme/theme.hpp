@@ -108,6 +108,11 @@ namespace gui::theme
         PaletteIndexSize
     };
 
+    /// one per core::FileCategory.
+    constexpr std::size_t FILE_TYPE_COLOR_COUNT = 9;
+
+    using FileTypeColors = std::array<QColor, FILE_TYPE_COLOR_COUNT>;
+
     using PaletteId   = std::string;
     using PaletteName = std::string;
     using Palette     = std::array<QColor, PaletteIndexSize>;
@@ -250,6 +255,10 @@ namespace gui::theme
         const QColor& edgeTextColor() const
             { return _active[EDGE_TEXT_COLOR]; }
 
+        /// derived from the file node colors of the active palette.
+        const QColor& fileTypeColor(std::size_t category) const
+            { return _fileTypeColors[category < FILE_TYPE_COLOR_COUNT ? category : 0]; }
+
         QStandardItemModel* model() const { return _model; }
 
     public slots:
@@ -285,11 +294,14 @@ namespace gui::theme
 
         QPalette toQPalette() const;
 
+        void deriveFileTypeColors();
+
 
         lds::GoldenLds _golden;
         Palettes _palettes;
         Colors _colors;
         Palette _active;
+        FileTypeColors _fileTypeColors;
         const PaletteId _factoryId{idFromPalette(factory())};
 
         QStandardItemModel* _model{nullptr};
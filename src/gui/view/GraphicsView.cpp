@@ -7,8 +7,12 @@
 #include "core/FileSystemScene.hpp"
 
 #include <QMouseEvent>
+#include <QPainter>
 #include <QTimeLine>
+#include <QTimer>
 #include <QVariantAnimation>
+#include <QtMath>
+#include <QWindow>
 
 #include "SessionManager.hpp"
 #include "UiStorage.hpp"
@@ -43,15 +47,63 @@ GraphicsView::GraphicsView(core::FileSystemScene *scene, QWidget *parent)
     _timeline->setFrameRange(0, 36);
     _timeline->setEasingCurve(QEasingCurve::OutExpo);
 
+    _settleTimer = new QTimer(this);
+    _settleTimer->setSingleShot(true);
+    _settleTimer->setInterval(TRANSITION_SETTLE_DELAY);
+    connect(_settleTimer, &QTimer::timeout, this, [this] {
+        if (_timeline->state() != QTimeLine::Running) {
+            endTransition();
+        }
+    });
+
     setAcceptDrops(false);
 }
 
 void GraphicsView::focusOn(const QPointF& focus, qreal zoom)
 {
     scale(zoom, zoom);
+    /// the view is restored before the scene is loaded, and can't be
+    /// centered outside of the scene rect.
+    static_cast<core::FileSystemScene*>(scene())->keepInSceneRect(focus);
     centerOn(QPointF(focus.x(), focus.y()));
 }
 
+/// A view that can't be seen stops following the scene: the scene then
+/// skips it when it goes through the items that changed, so that a view
+/// that is hidden, minimized or covered costs nothing per frame.  It is
+/// repainted as a whole once it can be seen again.
+void GraphicsView::updateActivity()
+{
+    const auto active = canBeSeen();
+
+    if (active == _active) {
+        return;
+    }
+
+    _active = active;
+
+    if (_active) {
+        setViewportUpdateMode(_activeUpdateMode);
+        viewport()->update();
+    } else {
+        endTransition();
+        _activeUpdateMode = viewportUpdateMode();
+        setViewportUpdateMode(NoViewportUpdate);
+    }
+}
+
+/// for the containers, whose changes the views under them aren't told of.
+void GraphicsView::updateActivityOf(const QWidget* root)
+{
+    if (root == nullptr) {
+        return;
+    }
+
+    for (auto* view : root->findChildren<GraphicsView*>()) {
+        view->updateActivity();
+    }
+}
+
 void GraphicsView::requestSceneBookmark()
 {
     if (_bookmarkAnimation) {
@@ -166,9 +218,20 @@ void GraphicsView::mouseReleaseEvent(QMouseEvent *event)
     QGraphicsView::mouseReleaseEvent(event);
 }
 
+void GraphicsView::hideEvent(QHideEvent* event)
+{
+    QGraphicsView::hideEvent(event);
+
+    updateActivity();
+}
+
 void GraphicsView::paintEvent(QPaintEvent *event)
 {
-    QGraphicsView::paintEvent(event);
+    if (_snapshot.isNull()) {
+        QGraphicsView::paintEvent(event);
+    } else {
+        paintTransition(event);
+    }
 
     if (_bookmarkAnimation) {
         QPainter p(viewport());
@@ -184,9 +247,20 @@ void GraphicsView::resizeEvent(QResizeEvent* event)
     rec.moveTopRight(rect().topRight() + QPoint(-16, 16));
     _quadrantButton->setGeometry(rec);
 
+    endTransition();
+
+    updateActivity();
+
     emit stateChanged(this);
 }
 
+void GraphicsView::showEvent(QShowEvent* event)
+{
+    QGraphicsView::showEvent(event);
+
+    updateActivity();
+}
+
 void GraphicsView::configure()
 {
     setFrameShape(NoFrame);
@@ -207,6 +281,27 @@ void GraphicsView::configure()
     setProperty(MOUSE_LAST_POSITION_PROPERTY, QPoint(0, 0));
 }
 
+/// as far as the platform tells; not every one says when a window is
+/// covered by another.
+bool GraphicsView::canBeSeen() const
+{
+    if (!isVisible() || visibleRegion().isEmpty()) {
+        return false;
+    }
+
+    const auto* top = window();
+
+    if (top->isMinimized()) {
+        return false;
+    }
+
+    if (const auto* handle = top->windowHandle(); handle != nullptr && !handle->isExposed()) {
+        return false;
+    }
+
+    return true;
+}
+
 QPoint GraphicsView::mouseMoveVelocity() const
 {
     const auto last = property(MOUSE_LAST_POSITION_PROPERTY).toPoint();
@@ -246,9 +341,16 @@ void GraphicsView::scaleView(qreal factor)
 void GraphicsView::zoom()
 {
     const auto velocity = mouseMoveVelocity();
+    if (velocity.x() == 0) {
+        return;
+    }
+
+    beginTransition();
+    _settleTimer->start();
+
     if (velocity.x() > 0) {
         zoomIn();
-    } else if (velocity.x() < 0) {
+    } else {
         zoomOut();
     }
 }
@@ -335,6 +437,9 @@ void GraphicsView::centerTargetOn(const core::SceneBookmarkItem* bm, const QPoin
         return;
     }
 
+    /// the view can't be centered past the scene rect; it would stop short.
+    static_cast<core::FileSystemScene*>(scene())->keepInSceneRect(viewCenter + path.p2());
+
     if (_timeline->state() == QTimeLine::State::Running) {
         _timeline->stop();
         disconnect(_timeline, &QTimeLine::valueChanged, nullptr, nullptr);
@@ -347,12 +452,61 @@ void GraphicsView::centerTargetOn(const core::SceneBookmarkItem* bm, const QPoin
 
     connect(_timeline, &QTimeLine::finished, [this] {
         disconnect(_timeline, &QTimeLine::valueChanged, nullptr, nullptr);
+        if (!_settleTimer->isActive()) {
+            endTransition();
+        }
         emit stateChanged(this);
     });
 
+    beginTransition();
     _timeline->start();
 }
 
+/// Zooming and flying to a bookmark change the transform of the view on
+/// every mouse move or frame, and each change would render the whole scene
+/// again.  While they last, what the viewport showed when they began is
+/// moved and scaled along instead, and only what it doesn't cover is
+/// rendered; changes of items under it wait for the end.
+void GraphicsView::beginTransition()
+{
+    if (!_snapshot.isNull() || !_active) {
+        return;
+    }
+
+    _snapshot          = viewport()->grab();
+    _snapshotTransform = viewportTransform();
+}
+
+/// one sharp frame replaces the snapshot.
+void GraphicsView::endTransition()
+{
+    if (_snapshot.isNull()) {
+        return;
+    }
+
+    _snapshot = QPixmap();
+    viewport()->update();
+}
+
+void GraphicsView::paintTransition(QPaintEvent* event)
+{
+    const auto delta   = _snapshotTransform.inverted() * viewportTransform();
+    const auto covered = delta.mapRect(QRectF(QPointF(0, 0), _snapshot.deviceIndependentSize()));
+
+    /// the pixels the snapshot covers only in part are rendered too.
+    const auto inner = QRect(QPoint(qCeil(covered.left()), qCeil(covered.top())),
+        QPoint(qFloor(covered.right()) - 1, qFloor(covered.bottom()) - 1));
+
+    if (const auto exposed = event->region() - inner; !exposed.isEmpty()) {
+        auto exposedEvent = QPaintEvent(exposed);
+        QGraphicsView::paintEvent(&exposedEvent);
+    }
+
+    QPainter p(viewport());
+    p.setRenderHint(QPainter::SmoothPixmapTransform);
+    p.drawPixmap(covered, _snapshot, QRectF(_snapshot.rect()));
+}
+
 void GraphicsView::toggleQuadrantButton() const
 {
     if (const auto sbm = selectedSceneBookmarks(); sbm.size() == 1) {
@@ -364,13 +518,5 @@ void GraphicsView::toggleQuadrantButton() const
 
 QList<core::SceneBookmarkItem*> GraphicsView::selectedSceneBookmarks() const
 {
-    QList<core::SceneBookmarkItem*> result;
-
-    for (const auto selection = scene()->selectedItems(); auto* item : selection) {
-        if (auto* sbm = qgraphicsitem_cast<core::SceneBookmarkItem*>(item); sbm) {
-            result.push_back(sbm);
-        }
-    }
-
-    return result;
+    return qobject_cast<core::FileSystemScene*>(scene())->selection().bookmarks().values();
 }
\ No newline at end of file
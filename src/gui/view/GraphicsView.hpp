@@ -4,9 +4,11 @@
 #pragma once
 
 #include <QtWidgets/QGraphicsView>
+#include <QPixmap>
 
 
 class QTimeLine;
+class QTimer;
 class QVariantAnimation;
 
 namespace core
@@ -26,6 +28,9 @@ namespace gui::view
         constexpr static auto MOUSE_POSITION_PROPERTY = "MOUSE_POSITION_PROPERTY";
         constexpr static auto MOUSE_LAST_POSITION_PROPERTY = "MOUSE_LAST_POSITION_PROPERTY";
 
+        /// a zoom is over once the mouse rests this long.
+        constexpr static int TRANSITION_SETTLE_DELAY = 150;
+
     signals:
         void deletePressed();
         void sceneBookmarkRequested(const QPoint& pos, const QString& name);
@@ -35,6 +40,10 @@ namespace gui::view
         explicit GraphicsView(core::FileSystemScene* scene, QWidget* parent = nullptr);
         void focusOn(const QPointF& focus, qreal zoom);
 
+        [[nodiscard]] bool isActive() const { return _active; }
+        void updateActivity();
+        static void updateActivityOf(const QWidget* root);
+
     public slots:
         void requestSceneBookmark();
         void focusQuadrant1(); // top right
@@ -51,11 +60,14 @@ namespace gui::view
         void mouseMoveEvent(QMouseEvent* event) override;
         void mousePressEvent(QMouseEvent* event) override;
         void mouseReleaseEvent(QMouseEvent* event) override;
+        void hideEvent(QHideEvent* event) override;
         void paintEvent(QPaintEvent* event) override;
         void resizeEvent(QResizeEvent* event) override;
+        void showEvent(QShowEvent* event) override;
 
     private:
         void configure();
+        [[nodiscard]] bool canBeSeen() const;
 
         QPoint mouseMoveVelocity() const;
         QPoint mousePosition() const;
@@ -70,12 +82,23 @@ namespace gui::view
         void drawBookmarkingCursorAnimation(QPainter& p) const;
         void centerTargetOn(const core::SceneBookmarkItem* bm, const QPointF& target);
 
+        void beginTransition();
+        void endTransition();
+        void paintTransition(QPaintEvent* event);
+
         void toggleQuadrantButton() const;
         QList<core::SceneBookmarkItem*> selectedSceneBookmarks() const;
 
         QVariantAnimation* _bookmarkAnimation{nullptr};
         QuadrantButton* _quadrantButton{nullptr};
         QTimeLine* _timeline{nullptr};
+        QTimer* _settleTimer{nullptr};
         QLineF _zoomAnchor;
+
+        QPixmap _snapshot;              /// of the viewport, while zooming or flying
+        QTransform _snapshotTransform;  /// the viewport transform it was taken with
+
+        bool _active{true};
+        ViewportUpdateMode _activeUpdateMode{MinimalViewportUpdate};
     };
 }
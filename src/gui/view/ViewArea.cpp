@@ -24,6 +24,11 @@ ViewArea::ViewArea(core::FileSystemScene* scene, window::Window *parent)
     auto* allQuadShortcut = new QShortcut(QKeySequence(Qt::Key_5), view, view, &GraphicsView::focusAllQuadrants);
     auto* openShortcut    = new QShortcut(QKeySequence::Open, view, scene, &core::FileSystemScene::openSelectedNodes);
     auto* closeShortcut   = new QShortcut(QKeySequence::Close, view, scene, &core::FileSystemScene::closeSelectedNodes);
+    auto* searchShortcut  = new QShortcut(QKeySequence::Find, view, scene, &core::FileSystemScene::searchSelectedNode);
+    auto* dupesShortcut   = new QShortcut(QKeySequence(Qt::CTRL | Qt::SHIFT | Qt::Key_D), view, scene,
+        &core::FileSystemScene::findDuplicatesInSelectedNode);
+    auto* relaxShortcut   = new QShortcut(QKeySequence(Qt::CTRL | Qt::SHIFT | Qt::Key_L), view, scene,
+        &core::FileSystemScene::relaxLayout);
 
     const QKeySequence closeKeySeq = QKeySequence::Close;
     Q_ASSERT(closeKeySeq.count() > 0);
@@ -40,6 +45,9 @@ ViewArea::ViewArea(core::FileSystemScene* scene, window::Window *parent)
     allQuadShortcut->setContext(Qt::WidgetShortcut);
     openShortcut->setContext(Qt::WidgetShortcut);
     closeShortcut->setContext(Qt::WidgetShortcut);
+    searchShortcut->setContext(Qt::WidgetShortcut);
+    dupesShortcut->setContext(Qt::WidgetShortcut);
+    relaxShortcut->setContext(Qt::WidgetShortcut);
     halfCloseShortcut->setContext(Qt::WidgetShortcut);
 }
 
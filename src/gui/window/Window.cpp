@@ -311,7 +311,10 @@ void Window::setAreaWidget(AbstractWindowArea *widget)
 {
     Q_ASSERT(widget);
 
+    /// hidden at once, so that a view on its way out stops following the
+    /// scene before it is deleted.
     if (_areaWidget) {
+        _areaWidget->hide();
         _areaWidget->deleteLater();
     }
 
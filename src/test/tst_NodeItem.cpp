@@ -5,6 +5,7 @@
 #include "core/FileSystemScene.hpp"
 #include "core/NodeItem.hpp"
 #include "core/SceneStorage.hpp"
+#include "core/SeekIndex.hpp"
 #include "core/SessionManager.hpp"
 #include "db/db.hpp"
 
@@ -14,6 +15,7 @@
 
 #include <algorithm>
 #include <random>
+#include <tuple>
 #include <unordered_set>
 #include <vector>
 
@@ -280,6 +282,95 @@ void TestNodeItem::rotationOpenCloseSubdir()
     QCOMPARE(node->childEdges().size(), 0);
 }
 
+void TestNodeItem::seek()
+{
+    QFETCH_GLOBAL(QDir, testDir);
+
+    auto* node = nodeFromPath(_scene, testDir.path());
+
+    if (node->isClosed()) {
+        node->open();
+
+        /// wait for filesystem data to be fetched
+        QTest::qWait(25);
+    }
+
+    const auto index = core::SeekIndex(node->index());
+    QCOMPARE(index.size(), 50);
+    QCOMPARE(index.find("B"), -1);
+
+    const auto hasChild = [node](const QString& name)
+    {
+        return ranges::any_of(node->childEdges() | core::asTargetNode,
+            [&name](const core::NodeItem* child) { return child->name() == name; });
+    };
+
+    for (const auto& [prefix, name] : {pair{"a37", "A37"}, pair{"A4", "A40"}, pair{"a0", "A00"}, pair{"A49", "A49"}}) {
+        const auto row = index.find(prefix);
+        QVERIFY(row != -1);
+
+        /// refused while the previous seek is still rotating.
+        QTRY_VERIFY(node->seekTo(row));
+        QTRY_VERIFY(hasChild(name));
+
+        QCOMPARE(uniqueRowCount(node), node->childEdges().size());
+        QVERIFY(fileOrClosedDirAreSorted(node));
+        verifyNames(node, testDir);
+    }
+
+    node->close();
+}
+
+void TestNodeItem::rotateBy()
+{
+    QFETCH_GLOBAL(QDir, testDir);
+
+    auto* node = nodeFromPath(_scene, testDir.path());
+
+    if (node->isClosed()) {
+        node->open();
+
+        /// wait for filesystem data to be fetched
+        QTest::qWait(25);
+    }
+
+    const auto firstRow = [node]
+    {
+        auto rows = node->childEdges()
+            | core::asFilesOrClosedTargetNodes
+            | core::asIndexRow
+            ;
+
+        return *ranges::begin(rows);
+    };
+
+    const auto pageSize = static_cast<int>(ranges::distance(node->childEdges() | core::asFilesOrClosedTargetNodes));
+    const auto rowCount = node->index().model()->rowCount(node->index());
+
+    QTRY_VERIFY(node->seekTo(0));
+    QTRY_COMPARE(firstRow(), 0);
+
+    /// rows, pages, and where the first row ends up; past the last row the
+    /// last page is shown, and before the first the first page.
+    for (const auto& [rows, pages, expected] : {
+            tuple{10, 0, 10},
+            tuple{-4, 0, 6},
+            tuple{0, 1, qMin(6 + pageSize, rowCount - pageSize)},
+            tuple{-1000, 0, 0},
+            tuple{1, 0, 1}}) {
+        /// refused while the previous rotation is still going.
+        QTRY_VERIFY(node->rotateBy(rows, pages));
+        QTRY_VERIFY(!node->isRotating());
+        QCOMPARE(firstRow(), expected);
+
+        QCOMPARE(uniqueRowCount(node), node->childEdges().size());
+        QVERIFY(fileOrClosedDirAreSorted(node));
+        verifyNames(node, testDir);
+    }
+
+    node->close();
+}
+
 void TestNodeItem::verifyNames(core::NodeItem* node, const QDir& dir)
 {
     QCOMPARE(node->childEdges().empty(), dir.isEmpty());
@@ -32,6 +32,8 @@ private slots:
     void rotation();
     void rotationOpenCloseSubdir_data();
     void rotationOpenCloseSubdir();
+    void seek();
+    void rotateBy();
 
 private:
     void verifyNames(core::NodeItem* node, const QDir& dir);
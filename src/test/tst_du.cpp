@@ -0,0 +1,175 @@
+/// Copyright (C) 2025 Arlen Avakian
+/// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "tst_du.hpp"
+
+#include "core/DiskUsage.hpp"
+
+#include <QDir>
+#include <QFile>
+#include <QSignalSpy>
+#include <QTest>
+
+
+namespace
+{
+    constexpr int DEPTH  = 2;
+    constexpr int FANOUT = 3;
+
+    constexpr qint64 FILE_SIZE   = 100;
+    constexpr qint64 HIDDEN_SIZE = 10;
+
+    void writeFile(const QString& path, qint64 size)
+    {
+        auto file = QFile(path);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        QCOMPARE(file.write(QByteArray(size, 'x')), size);
+    }
+
+    /// FANOUT subdirectories per level, each with a file and a hidden file.
+    void makeTree(const QString& path, int depth)
+    {
+        QVERIFY(QDir().mkpath(path));
+
+        writeFile(path + "/a.bin", FILE_SIZE);
+        writeFile(path + "/.hidden", HIDDEN_SIZE);
+
+        if (depth > 0) {
+            for (int i = 0; i < FANOUT; ++i) {
+                makeTree(QString("%1/dir%2").arg(path).arg(i), depth - 1);
+            }
+        }
+    }
+
+    /// 1 + 3 + 9
+    constexpr qint64 DIR_COUNT = 13;
+
+    /// the two files of every directory, and every directory but the root.
+    constexpr qint64 ENTRY_COUNT = DIR_COUNT * 2 + DIR_COUNT - 1;
+    constexpr qint64 TOTAL_SIZE  = DIR_COUNT * (FILE_SIZE + HIDDEN_SIZE);
+}
+
+void TestDiskUsage::initTestCase()
+{
+    QVERIFY(_root.isValid());
+    makeTree(_root.path(), DEPTH);
+
+    _du = new core::DiskUsage();
+}
+
+void TestDiskUsage::cleanupTestCase()
+{
+    delete _du;
+}
+
+void TestDiskUsage::totals()
+{
+    QSignalSpy finished(_du, &core::DiskUsage::finished);
+    QSignalSpy scanned(_du, &core::DiskUsage::scanned);
+
+    QVERIFY(_du->usage(_root.path()) == nullptr);
+
+    _du->request(_root.path());
+
+    QVERIFY(finished.wait(10000));
+    QCOMPARE(finished.first().at(0).toString(), _root.path());
+    QCOMPARE(finished.first().at(1).toLongLong(), DIR_COUNT);
+    QVERIFY(!_du->isRunning());
+
+    qsizetype records = 0;
+    for (const auto& args : scanned) {
+        records += args.first().value<QList<core::DirUsage>>().size();
+    }
+    QCOMPARE(records, qsizetype(DIR_COUNT));
+
+    const auto* root = _du->usage(_root.path());
+    QVERIFY(root != nullptr);
+    QCOMPARE(root->size, TOTAL_SIZE);
+    QCOMPARE(root->entries, ENTRY_COUNT);
+    QCOMPARE(root->ownEntries, qint64(2 + FANOUT));
+    QCOMPARE(root->subdirs.size(), qsizetype(FANOUT));
+
+    const auto* leaf = _du->usage(_root.filePath("dir2/dir1"));
+    QVERIFY(leaf != nullptr);
+    QCOMPARE(leaf->size, FILE_SIZE + HIDDEN_SIZE);
+    QCOMPARE(leaf->entries, qint64(2));
+}
+
+void TestDiskUsage::freshIsNotScanned()
+{
+    QSignalSpy finished(_du, &core::DiskUsage::finished);
+
+    _du->request(_root.path());
+    _du->request(_root.filePath("dir0"));
+
+    QVERIFY(!_du->isRunning());
+    QVERIFY(!finished.wait(100));
+}
+
+void TestDiskUsage::incremental()
+{
+    QSignalSpy finished(_du, &core::DiskUsage::finished);
+
+    writeFile(_root.filePath("dir0/dir1/new.bin"), 1000);
+
+    /// as the scene does once the model sees the new file.
+    _du->invalidate(_root.filePath("dir0/dir1"));
+    _du->request(_root.path());
+
+    QVERIFY(finished.wait(10000));
+
+    /// the root and dir0 have the same mtime as before, and the rest is
+    /// fresh; only dir0/dir1 is read.
+    QCOMPARE(finished.first().at(1).toLongLong(), qint64(1));
+
+    QCOMPARE(_du->usage(_root.path())->size, TOTAL_SIZE + 1000);
+    QCOMPARE(_du->usage(_root.path())->entries, ENTRY_COUNT + 1);
+    QCOMPARE(_du->usage(_root.filePath("dir0"))->size, 4 * (FILE_SIZE + HIDDEN_SIZE) + 1000);
+    QCOMPARE(_du->usage(_root.filePath("dir1"))->size, 4 * (FILE_SIZE + HIDDEN_SIZE));
+}
+
+void TestDiskUsage::vanished()
+{
+    QSignalSpy finished(_du, &core::DiskUsage::finished);
+
+    QVERIFY(QDir(_root.filePath("dir1")).removeRecursively());
+
+    _du->invalidate(_root.path());
+    _du->request(_root.path());
+
+    QVERIFY(finished.wait(10000));
+    QCOMPARE(finished.first().at(1).toLongLong(), qint64(1));
+
+    QVERIFY(_du->usage(_root.filePath("dir1")) == nullptr);
+    QVERIFY(_du->usage(_root.filePath("dir1/dir0")) == nullptr);
+    QVERIFY(_du->usage(_root.filePath("dir0")) != nullptr);
+
+    QCOMPARE(_du->usage(_root.path())->size, TOTAL_SIZE + 1000 - 4 * (FILE_SIZE + HIDDEN_SIZE));
+    QCOMPARE(_du->usage(_root.path())->subdirs.size(), qsizetype(FANOUT - 1));
+}
+
+void TestDiskUsage::grownInPlace()
+{
+    QSignalSpy finished(_du, &core::DiskUsage::finished);
+
+    const auto before = _du->usage(_root.path())->size;
+
+    {
+        auto file = QFile(_root.filePath("dir0/a.bin"));
+        QVERIFY(file.open(QIODevice::Append));
+        QCOMPARE(file.write(QByteArray(50, 'x')), qint64(50));
+    }
+
+    /// dir0 has the same mtime as before; it is read only because the file
+    /// was invalidated.
+    _du->invalidate(_root.filePath("dir0/a.bin"));
+    _du->request(_root.path());
+
+    QVERIFY(finished.wait(10000));
+    QCOMPARE(finished.first().at(1).toLongLong(), qint64(1));
+
+    QCOMPARE(_du->usage(_root.path())->size, before + 50);
+    QCOMPARE(_du->usage(_root.filePath("dir0"))->size, 4 * (FILE_SIZE + HIDDEN_SIZE) + 1050);
+}
+
+QTEST_MAIN(TestDiskUsage)
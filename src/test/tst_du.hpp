@@ -0,0 +1,32 @@
+/// Copyright (C) 2025 Arlen Avakian
+/// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <QObject>
+#include <QTemporaryDir>
+
+
+namespace core
+{
+    class DiskUsage;
+}
+
+class TestDiskUsage final : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void totals();
+    void freshIsNotScanned();
+    void incremental();
+    void vanished();
+    void grownInPlace();
+
+private:
+    QTemporaryDir _root;
+    core::DiskUsage* _du{nullptr};
+};
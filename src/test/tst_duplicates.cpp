@@ -0,0 +1,132 @@
+/// Copyright (C) 2025 Arlen Avakian
+/// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "tst_duplicates.hpp"
+
+#include "core/DuplicateFinder.hpp"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSignalSpy>
+#include <QTest>
+
+#ifdef Q_OS_UNIX
+#include <unistd.h>
+#endif
+
+
+using core::DuplicateFinder;
+
+namespace
+{
+    constexpr qint64 LARGE = 100'000;
+
+    void writeFile(const QString& path, const QByteArray& data)
+    {
+        QVERIFY(QDir().mkpath(QFileInfo(path).path()));
+
+        auto file = QFile(path);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        QCOMPARE(file.write(data), data.size());
+    }
+
+    QByteArray pattern(qint64 size, char seed)
+    {
+        auto data = QByteArray(size, Qt::Uninitialized);
+        for (qint64 i = 0; i < size; ++i) {
+            data[i] = static_cast<char>(seed + i * 31);
+        }
+
+        return data;
+    }
+}
+
+void TestDuplicates::initTestCase()
+{
+    QVERIFY(_root.isValid());
+
+    const auto large   = pattern(LARGE, 1);
+    auto middle        = large;
+    middle[LARGE / 2] ^= 1;
+
+    /// 1. small, and the same.
+    writeFile(_root.filePath("a/small.txt"), "hello");
+    writeFile(_root.filePath("b/small.txt"), "hello");
+    writeFile(_root.filePath("b/c/copy.txt"), "hello");
+
+    /// same size, different contents.
+    writeFile(_root.filePath("a/other.txt"), "world");
+
+    /// 2. large, and the same.
+    writeFile(_root.filePath("a/large.bin"), large);
+    writeFile(_root.filePath("b/large.bin"), large);
+
+    /// same size and ends; differs in the middle only.
+    writeFile(_root.filePath("b/c/middle.bin"), middle);
+
+    /// hidden, empty, and hard linked ones don't count.
+    writeFile(_root.filePath(".hidden/small.txt"), "hello");
+    writeFile(_root.filePath("a/empty1"), QByteArray());
+    writeFile(_root.filePath("b/empty2"), QByteArray());
+    writeFile(_root.filePath("a/unique.bin"), pattern(LARGE, 7));
+#ifdef Q_OS_UNIX
+    QVERIFY(::link(QFile::encodeName(_root.filePath("a/unique.bin")).constData(),
+        QFile::encodeName(_root.filePath("b/unique.bin")).constData()) == 0);
+#endif
+
+    _finder = new DuplicateFinder();
+}
+
+void TestDuplicates::cleanupTestCase()
+{
+    delete _finder;
+}
+
+/// the reference values of XXH64, and the same value however the data is fed.
+void TestDuplicates::hash()
+{
+    QCOMPARE(DuplicateFinder::hash("", 0), 0xEF46DB3751D8E999ULL);
+    QCOMPARE(DuplicateFinder::hash("a", 1), 0xD24EC4F1A98C6E5BULL);
+    QCOMPARE(DuplicateFinder::hash("abc", 3), 0x44BC2CF5AD770999ULL);
+
+    const auto text = QByteArray("Nobody inspects the spammish repetition");
+    QCOMPARE(DuplicateFinder::hash(text.constData(), text.size()), 0xFBCEA83C8A378BF1ULL);
+}
+
+void TestDuplicates::groups()
+{
+    QSignalSpy found(_finder, &DuplicateFinder::found);
+    QSignalSpy finished(_finder, &DuplicateFinder::finished);
+
+    _finder->start(_root.path());
+
+    QVERIFY(finished.wait(10000));
+    QCOMPARE(finished.first().at(0).toBool(), false);
+    QCOMPARE(found.size(), 1);
+    QVERIFY(!_finder->isRunning());
+
+    const auto groups = found.first().at(0).value<QList<QStringList>>();
+    QCOMPARE(groups.size(), 2);
+
+    /// the one that wastes the most space first.
+    QCOMPARE(groups[0], QStringList({_root.filePath("a/large.bin"), _root.filePath("b/large.bin")}));
+    QCOMPARE(groups[1], QStringList({_root.filePath("a/small.txt"),
+                                     _root.filePath("b/c/copy.txt"),
+                                     _root.filePath("b/small.txt")}));
+}
+
+void TestDuplicates::cancel()
+{
+    QSignalSpy found(_finder, &DuplicateFinder::found);
+    QSignalSpy finished(_finder, &DuplicateFinder::finished);
+
+    _finder->start(_root.path());
+    _finder->cancel();
+
+    QVERIFY(finished.wait(10000));
+    QCOMPARE(finished.first().at(0).toBool(), true);
+    QVERIFY(found.empty());
+}
+
+QTEST_MAIN(TestDuplicates)
@@ -0,0 +1,30 @@
+/// Copyright (C) 2025 Arlen Avakian
+/// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <QObject>
+#include <QTemporaryDir>
+
+
+namespace core
+{
+    class DuplicateFinder;
+}
+
+class TestDuplicates final : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void hash();
+    void groups();
+    void cancel();
+
+private:
+    QTemporaryDir _root;
+    core::DuplicateFinder* _finder{nullptr};
+};
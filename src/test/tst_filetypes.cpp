@@ -0,0 +1,78 @@
+/// Copyright (C) 2025 Arlen Avakian
+/// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "tst_filetypes.hpp"
+
+#include "core/FileTypes.hpp"
+
+#include <QFile>
+#include <QSignalSpy>
+#include <QTest>
+
+
+using namespace core;
+
+namespace
+{
+    bool write(const QString& path, const QByteArray& data)
+    {
+        auto file = QFile(path);
+        return file.open(QIODevice::WriteOnly) && file.write(data) == data.size();
+    }
+
+    /// the signature of a PNG, and the start of its header chunk.
+    const auto PNG_MAGIC = QByteArray("\x89PNG\r\n\x1a\n\0\0\0\x0dIHDR", 16);
+}
+
+void TestFileTypes::initTestCase()
+{
+    QVERIFY(_root.isValid());
+}
+
+void TestFileTypes::byName()
+{
+    QCOMPARE(FileTypeClassifier::categoryOfName("notes.txt"), TextFile);
+    QCOMPARE(FileTypeClassifier::categoryOfName("main.cpp"), CodeFile);
+    QCOMPARE(FileTypeClassifier::categoryOfName("paper.pdf"), DocumentFile);
+    QCOMPARE(FileTypeClassifier::categoryOfName("photo.JPG"), ImageFile);
+    QCOMPARE(FileTypeClassifier::categoryOfName("song.flac"), AudioFile);
+    QCOMPARE(FileTypeClassifier::categoryOfName("clip.mkv"), VideoFile);
+    QCOMPARE(FileTypeClassifier::categoryOfName("backup.tar.gz"), ArchiveFile);
+    QCOMPARE(FileTypeClassifier::categoryOfName("report.docx"), DocumentFile);
+
+    /// nothing to go by; left for the contents.
+    QCOMPARE(FileTypeClassifier::categoryOfName("data.zzqq"), FileCategoryCount);
+}
+
+void TestFileTypes::byContents()
+{
+    const auto image = _root.filePath("image-without-suffix");
+    QVERIFY(write(image, PNG_MAGIC));
+    QCOMPARE(FileTypeClassifier::categoryOfContents(image), ImageFile);
+
+    const auto text = _root.filePath("text-without-suffix");
+    QVERIFY(write(text, "just some words\n"));
+    QCOMPARE(FileTypeClassifier::categoryOfContents(text), TextFile);
+}
+
+void TestFileTypes::classify()
+{
+    QVERIFY(write(_root.filePath("a.png"), {}));
+    QVERIFY(write(_root.filePath("b"), PNG_MAGIC));
+
+    auto classifier = FileTypeClassifier();
+    QSignalSpy classified(&classifier, &FileTypeClassifier::classified);
+
+    classifier.classify(_root.path(), {"a.png", "b"});
+    QVERIFY(classified.wait(10000));
+
+    const auto batch = classified.first().at(0).value<QList<FileType>>();
+    QCOMPARE(batch.size(), qsizetype(2));
+
+    for (const auto& [path, category] : batch) {
+        QVERIFY(path == _root.filePath("a.png") || path == _root.filePath("b"));
+        QCOMPARE(category, ImageFile);
+    }
+}
+
+QTEST_MAIN(TestFileTypes)
@@ -0,0 +1,23 @@
+/// Copyright (C) 2025 Arlen Avakian
+/// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <QObject>
+#include <QTemporaryDir>
+
+
+class TestFileTypes final : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void byName();
+    void byContents();
+    void classify();
+
+private:
+    QTemporaryDir _root;
+};
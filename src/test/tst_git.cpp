@@ -0,0 +1,264 @@
+/// Copyright (C) 2025 Arlen Avakian
+/// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "tst_git.hpp"
+
+#include "core/GitStatus.hpp"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QSignalSpy>
+#include <QTest>
+#include <QtEndian>
+
+#include <algorithm>
+
+#ifdef Q_OS_LINUX
+#include <sys/stat.h>
+#endif
+
+
+using namespace core;
+
+namespace
+{
+    bool write(const QString& path, const QByteArray& data)
+    {
+        auto file = QFile(path);
+        return file.open(QIODevice::WriteOnly) && file.write(data) == data.size();
+    }
+
+    void appendBe32(QByteArray& out, quint32 value)
+    {
+        char bytes[4];
+        qToBigEndian(value, bytes);
+        out.append(bytes, 4);
+    }
+
+    void appendBe16(QByteArray& out, quint16 value)
+    {
+        char bytes[2];
+        qToBigEndian(value, bytes);
+        out.append(bytes, 2);
+    }
+
+    QByteArray blobId(const QByteArray& contents)
+    {
+        return QCryptographicHash::hash("blob " + QByteArray::number(contents.size()) + '\0' + contents,
+            QCryptographicHash::Sha1);
+    }
+
+#ifdef Q_OS_LINUX
+    /// what `git add` would write for the files under root, version 2.
+    bool writeIndex(const QString& root, QStringList paths)
+    {
+        std::ranges::sort(paths);
+
+        QByteArray index("DIRC");
+        appendBe32(index, 2);
+        appendBe32(index, static_cast<quint32>(paths.size()));
+
+        for (const auto& path : paths) {
+            const auto file = root + '/' + path;
+            struct stat st{};
+
+            if (::lstat(QFile::encodeName(file).constData(), &st) != 0) {
+                return false;
+            }
+
+            auto f = QFile(file);
+            if (!f.open(QIODevice::ReadOnly)) {
+                return false;
+            }
+
+            const auto start = index.size();
+            const auto name  = path.toUtf8();
+
+            appendBe32(index, static_cast<quint32>(st.st_ctim.tv_sec));
+            appendBe32(index, static_cast<quint32>(st.st_ctim.tv_nsec));
+            appendBe32(index, static_cast<quint32>(st.st_mtim.tv_sec));
+            appendBe32(index, static_cast<quint32>(st.st_mtim.tv_nsec));
+            appendBe32(index, static_cast<quint32>(st.st_dev));
+            appendBe32(index, static_cast<quint32>(st.st_ino));
+            appendBe32(index, 0100644);
+            appendBe32(index, st.st_uid);
+            appendBe32(index, st.st_gid);
+            appendBe32(index, static_cast<quint32>(st.st_size));
+            index.append(blobId(f.readAll()));
+            appendBe16(index, static_cast<quint16>(name.size()));
+            index.append(name);
+
+            const auto length = ((index.size() - start) + 8) & ~qsizetype(7);
+            index.append(QByteArray(start + length - index.size(), '\0'));
+        }
+
+        index.append(QCryptographicHash::hash(index, QCryptographicHash::Sha1));
+
+        return write(root + "/.git/index", index);
+    }
+#endif
+}
+
+void TestGitStatus::initTestCase()
+{
+    QVERIFY(_root.isValid());
+}
+
+/// paths are prefix-compressed, and entries aren't padded.
+void TestGitStatus::readIndexV4()
+{
+    QByteArray index("DIRC");
+    appendBe32(index, 4);
+    appendBe32(index, 2);
+
+    auto entry = [&index](const QByteArray& path, quint8 strip, const QByteArray& suffix)
+    {
+        for (int i = 0; i < 10; ++i) {
+            appendBe32(index, i == 6 ? 0100644 : 0);
+        }
+        index.append(QByteArray(20, '\x11'));
+        appendBe16(index, static_cast<quint16>(path.size()));
+        index.append(static_cast<char>(strip));
+        index.append(suffix);
+        index.append('\0');
+    };
+    entry("a/b", 0, "a/b");
+    entry("a/cd", 1, "cd");
+    index.append(QByteArray(20, '\0'));
+
+    const auto file = _root.filePath("index-v4");
+    QVERIFY(write(file, index));
+
+    const auto entries = GitStatus::readIndex(file);
+    QVERIFY(entries.has_value());
+    QCOMPARE(entries->size(), qsizetype(2));
+    QCOMPARE(entries->at(0).path, QByteArray("a/b"));
+    QCOMPARE(entries->at(1).path, QByteArray("a/cd"));
+    QCOMPARE(entries->at(1).mode, quint32(0100644));
+
+    QVERIFY(write(file, "not an index"));
+    QVERIFY(!GitStatus::readIndex(file).has_value());
+}
+
+void TestGitStatus::states()
+{
+#ifndef Q_OS_LINUX
+    QSKIP("the status is only read on Linux");
+#else
+    const auto root = _root.filePath("tree");
+    QVERIFY(QDir().mkpath(root + "/.git"));
+    QVERIFY(QDir().mkpath(root + "/sub"));
+    QVERIFY(QDir().mkpath(root + "/dirty"));
+    QVERIFY(QDir().mkpath(root + "/build"));
+    QVERIFY(QDir().mkpath(root + "/fresh"));
+
+    QVERIFY(write(root + "/tracked.txt", "same\n"));
+    QVERIFY(write(root + "/changed.txt", "before\n"));
+    QVERIFY(write(root + "/sub/inner.txt", "inner\n"));
+    QVERIFY(write(root + "/dirty/file.txt", "short\n"));
+    QVERIFY(writeIndex(root, {"tracked.txt", "changed.txt", "sub/inner.txt", "dirty/file.txt"}));
+
+    /// same size, other contents: only the hash tells.
+    QVERIFY(write(root + "/changed.txt", "after!\n"));
+    QVERIFY(write(root + "/dirty/file.txt", "much longer now\n"));
+    QVERIFY(write(root + "/new.txt", "new\n"));
+    QVERIFY(write(root + "/app.log", "log\n"));
+    QVERIFY(write(root + "/build/out.o", "obj\n"));
+    QVERIFY(write(root + "/fresh/a.txt", "a\n"));
+    QVERIFY(write(root + "/.gitignore", "*.log\nbuild/\n"));
+
+    auto git = GitStatus();
+    QSignalSpy updated(&git, &GitStatus::updated);
+
+    QCOMPARE(git.state(root + "/tracked.txt"), NotInGit);
+
+    git.request(root + "/tracked.txt");
+    QVERIFY(updated.wait(10000));
+    QCOMPARE(updated.first().at(0).toStringList(), QStringList(root));
+
+    QCOMPARE(git.state(root + "/tracked.txt"), GitClean);
+    QCOMPARE(git.state(root + "/changed.txt"), GitModified);
+    QCOMPARE(git.state(root + "/new.txt"), GitUntracked);
+    QCOMPARE(git.state(root + "/app.log"), GitIgnored);
+    QCOMPARE(git.state(root + "/build"), GitIgnored);
+    QCOMPARE(git.state(root + "/fresh"), GitUntracked);
+    QCOMPARE(git.state(root + "/sub"), GitClean);
+    QCOMPARE(git.state(root + "/dirty"), GitModified);
+
+    git.request(root + "/build/out.o");
+    QVERIFY(updated.wait(10000));
+    QCOMPARE(git.state(root + "/build/out.o"), GitIgnored);
+
+    git.request(root + "/sub/inner.txt");
+    QVERIFY(updated.wait(10000));
+    QCOMPARE(git.state(root + "/sub/inner.txt"), GitClean);
+#endif
+}
+
+void TestGitStatus::invalidate()
+{
+#ifndef Q_OS_LINUX
+    QSKIP("the status is only read on Linux");
+#else
+    const auto root = _root.filePath("tree2");
+    QVERIFY(QDir().mkpath(root + "/.git"));
+    QVERIFY(QDir().mkpath(root + "/sub"));
+    QVERIFY(write(root + "/sub/file.txt", "one\n"));
+    QVERIFY(writeIndex(root, {"sub/file.txt"}));
+
+    auto git = GitStatus();
+
+    git.request(root + "/sub/file.txt");
+    git.request(root + "/sub");
+    QTRY_COMPARE_WITH_TIMEOUT(git.state(root + "/sub"), GitClean, 10000);
+    QTRY_COMPARE_WITH_TIMEOUT(git.state(root + "/sub/file.txt"), GitClean, 10000);
+
+    /// the folder above is looked at again too.
+    QVERIFY(write(root + "/sub/file.txt", "two and more\n"));
+    git.invalidate(root + "/sub");
+    QTRY_COMPARE_WITH_TIMEOUT(git.state(root + "/sub/file.txt"), GitModified, 10000);
+    QTRY_COMPARE_WITH_TIMEOUT(git.state(root + "/sub"), GitModified, 10000);
+#endif
+}
+
+/// a file changes deep down with no folder on the way changing; a change
+/// elsewhere in the work tree still finds it.
+void TestGitStatus::deepChange()
+{
+#ifndef Q_OS_LINUX
+    QSKIP("the status is only read on Linux");
+#else
+    const auto root = _root.filePath("tree3");
+    QVERIFY(QDir().mkpath(root + "/.git"));
+    QVERIFY(QDir().mkpath(root + "/sub/deep"));
+    QVERIFY(write(root + "/sub/deep/file.txt", "one\n"));
+    QVERIFY(writeIndex(root, {"sub/deep/file.txt"}));
+
+    auto git = GitStatus();
+
+    git.request(root + "/sub");
+    QTRY_COMPARE_WITH_TIMEOUT(git.state(root + "/sub"), GitClean, 10000);
+
+    QVERIFY(write(root + "/sub/deep/file.txt", "two and more\n"));
+    QVERIFY(write(root + "/other.txt", "other\n"));
+    git.invalidate(root);
+    QTRY_COMPARE_WITH_TIMEOUT(git.state(root + "/sub"), GitModified, 10000);
+#endif
+}
+
+void TestGitStatus::outsideWorkTree()
+{
+    const auto dir = _root.filePath("plain");
+    QVERIFY(QDir().mkpath(dir));
+    QVERIFY(write(dir + "/file.txt", "x\n"));
+
+    auto git = GitStatus();
+    QSignalSpy updated(&git, &GitStatus::updated);
+
+    git.request(dir + "/file.txt");
+    QVERIFY(updated.wait(10000));
+    QCOMPARE(git.state(dir + "/file.txt"), NotInGit);
+}
+
+QTEST_MAIN(TestGitStatus)
@@ -0,0 +1,25 @@
+/// Copyright (C) 2025 Arlen Avakian
+/// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <QObject>
+#include <QTemporaryDir>
+
+
+class TestGitStatus final : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void readIndexV4();
+    void states();
+    void invalidate();
+    void deepChange();
+    void outsideWorkTree();
+
+private:
+    QTemporaryDir _root;
+};
@@ -0,0 +1,112 @@
+/// Copyright (C) 2025 Arlen Avakian
+/// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "tst_listing.hpp"
+
+#include "core/ListingScheduler.hpp"
+
+#include <QDir>
+#include <QFile>
+#include <QSignalSpy>
+#include <QTest>
+
+
+using namespace core;
+
+void TestListing::initTestCase()
+{
+    QVERIFY(_root.isValid());
+}
+
+void TestListing::priorityOrder()
+{
+    auto queue = ListingQueue();
+
+    QVERIFY(queue.push("/low", ListingScheduler::LowPriority));
+    QVERIFY(queue.push("/normal-1", ListingScheduler::NormalPriority));
+    QVERIFY(queue.push("/high", ListingScheduler::HighPriority));
+    QVERIFY(queue.push("/normal-2", ListingScheduler::NormalPriority));
+    QCOMPARE(queue.size(), qsizetype(4));
+
+    /// the oldest first among equal priorities.
+    QCOMPARE(queue.pop(), "/high");
+    QCOMPARE(queue.pop(), "/normal-1");
+    QCOMPARE(queue.pop(), "/normal-2");
+    QCOMPARE(queue.pop(), "/low");
+    QCOMPARE(queue.pop(), QString());
+    QCOMPARE(queue.size(), qsizetype(0));
+}
+
+void TestListing::raisePriority()
+{
+    auto queue = ListingQueue();
+
+    QVERIFY(queue.push("/a", ListingScheduler::LowPriority));
+    QVERIFY(queue.push("/b", ListingScheduler::NormalPriority));
+
+    /// raised past /b, and queued once.
+    QVERIFY(queue.push("/a", ListingScheduler::HighPriority));
+    QCOMPARE(queue.size(), qsizetype(2));
+
+    /// lowering it has no effect.
+    QVERIFY(!queue.push("/a", ListingScheduler::LowPriority));
+    QVERIFY(!queue.push("/a", ListingScheduler::HighPriority));
+
+    QCOMPARE(queue.pop(), "/a");
+    QCOMPARE(queue.pop(), "/b");
+    QCOMPARE(queue.pop(), QString());
+}
+
+void TestListing::inFlight()
+{
+    auto queue = ListingQueue();
+
+    QVERIFY(queue.push("/a", ListingScheduler::NormalPriority));
+    QCOMPARE(queue.pop(), "/a");
+
+    /// being listed; not even a higher priority queues it again.
+    QVERIFY(!queue.push("/a", ListingScheduler::HighPriority));
+    QCOMPARE(queue.size(), qsizetype(0));
+
+    queue.done("/a");
+    QVERIFY(queue.push("/a", ListingScheduler::LowPriority));
+    QCOMPARE(queue.pop(), "/a");
+}
+
+void TestListing::listDirectory()
+{
+    const auto dir = _root.filePath("listed");
+    QVERIFY(QDir().mkpath(dir + "/sub"));
+    QVERIFY(QFile(dir + "/file.txt").open(QIODevice::WriteOnly));
+    QVERIFY(QFile(dir + "/.hidden").open(QIODevice::WriteOnly));
+    QVERIFY(QFile::link(dir + "/sub", dir + "/link"));
+
+    auto scheduler = ListingScheduler();
+    QSignalSpy listed(&scheduler, &ListingScheduler::listed);
+
+    scheduler.schedule(dir, ListingScheduler::HighPriority);
+    QVERIFY(listed.wait(10000));
+
+    const auto batch = listed.first().at(0).value<QList<DirListing>>();
+    QCOMPARE(batch.size(), qsizetype(1));
+    QCOMPARE(batch.first().path, dir);
+
+    /// sorted as the view shows them, without the hidden file.
+    const auto& entries = batch.first().entries;
+    QCOMPARE(entries.size(), qsizetype(3));
+
+    QCOMPARE(entries[0].name, "file.txt");
+    QVERIFY(!entries[0].isDir);
+    QVERIFY(!entries[0].isLink);
+
+    /// classified by its target.
+    QCOMPARE(entries[1].name, "link");
+    QVERIFY(entries[1].isDir);
+    QVERIFY(entries[1].isLink);
+
+    QCOMPARE(entries[2].name, "sub");
+    QVERIFY(entries[2].isDir);
+    QVERIFY(!entries[2].isLink);
+}
+
+QTEST_MAIN(TestListing)
@@ -0,0 +1,24 @@
+/// Copyright (C) 2025 Arlen Avakian
+/// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <QObject>
+#include <QTemporaryDir>
+
+
+class TestListing final : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void priorityOrder();
+    void raisePriority();
+    void inFlight();
+    void listDirectory();
+
+private:
+    QTemporaryDir _root;
+};
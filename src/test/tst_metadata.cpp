@@ -0,0 +1,286 @@
+/// Copyright (C) 2025 Arlen Avakian
+/// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "tst_metadata.hpp"
+
+#include "core/MetadataCache.hpp"
+
+#include <QDeadlineTimer>
+#include <QSignalSpy>
+#include <QTest>
+#include <QThread>
+
+#include <algorithm>
+#include <atomic>
+
+
+using namespace core;
+
+/// a filesystem with two mounts: "/" answers right away, and "/slow" takes
+/// latency milliseconds to answer each stat, or until it is released.
+class SlowBackend final : public FsBackend
+{
+public:
+    FileMetadata stat(const QString& path, bool countEntries) override
+    {
+        ++calls;
+
+        if (path.startsWith("/slow/")) {
+            for (auto deadline = QDeadlineTimer(latency.load()); !deadline.hasExpired() && !released; ) {
+                QThread::msleep(5);
+            }
+        }
+
+        return
+            {
+                .path       = path,
+                .size       = path.size(),
+                .entryCount = countEntries ? 1 : -1,
+                .linkTarget = {},
+                .status     = FileMetadata::Ok
+            };
+    }
+
+    QList<Mount> mounts() override
+    {
+        return {{.path = "/", .fsType = "ext4"}, {.path = "/slow", .fsType = "nfs4"}};
+    }
+
+    std::atomic<int> latency{0};
+    std::atomic<int> calls{0};
+    std::atomic<bool> released{false};
+};
+
+
+void TestMetadata::init()
+{
+    auto backend = std::make_unique<SlowBackend>();
+    _backend     = backend.get();
+    _fetcher     = new MetadataFetcher(std::move(backend));
+
+    _fetcher->setTimeout("/slow", 100);
+
+    connect(_fetcher, &MetadataFetcher::fetched, this, [this](const QList<FileMetadata>& batch)
+    {
+        _fetched.append(batch);
+    });
+}
+
+void TestMetadata::cleanup()
+{
+    _backend->released = true;
+
+    delete _fetcher;
+    _fetcher = nullptr;
+    _backend = nullptr;
+    _fetched.clear();
+}
+
+void TestMetadata::fastMount()
+{
+    QCOMPARE(_fetcher->mountOf("/fast/a"), QString("/"));
+    QCOMPARE(_fetcher->mountOf("/slow/a"), QString("/slow"));
+    QCOMPARE(_fetcher->mountOf("/slower/a"), QString("/"));
+
+    const auto result = fetch("/fast/a", 1000);
+
+    QCOMPARE(result.status, FileMetadata::Ok);
+    QCOMPARE(result.size, qint64(7));
+}
+
+void TestMetadata::slowMountTimesOut()
+{
+    _backend->latency = 2000;
+
+    const auto result = fetch("/slow/a", 1000);
+
+    QCOMPARE(result.status, FileMetadata::Unreachable);
+    QVERIFY(!_fetcher->isReachable("/slow/b"));
+    QVERIFY(_fetcher->isReachable("/fast/b"));
+}
+
+void TestMetadata::breakerStopsProbing()
+{
+    _backend->latency = 2000;
+
+    QCOMPARE(fetch("/slow/a", 1000).status, FileMetadata::Unreachable);
+
+    const int calls = _backend->calls.load();
+
+    /// answered without touching the backend.
+    for (const auto* path : {"/slow/b", "/slow/c", "/slow/d"}) {
+        QCOMPARE(fetch(path, 50).status, FileMetadata::Unreachable);
+    }
+    QCOMPARE(_backend->calls.load(), calls);
+}
+
+void TestMetadata::fastMountUnaffected()
+{
+    _backend->latency = 2000;
+
+    /// more slow requests than a mount is allowed workers for.
+    for (int i = 0; i < 300; ++i) {
+        _fetcher->request(QString("/slow/%1").arg(i));
+    }
+
+    QCOMPARE(fetch("/fast/a", 50).status, FileMetadata::Ok);
+}
+
+void TestMetadata::breakerRecovers()
+{
+    _backend->latency = 300;
+    _fetcher->setCooldown(500);
+
+    QSignalSpy reachable(_fetcher, &MetadataFetcher::reachable);
+
+    QCOMPARE(fetch("/slow/a", 1000).status, FileMetadata::Unreachable);
+    QVERIFY(!_fetcher->isReachable("/slow/a"));
+    QCOMPARE(reachable.count(), 0);
+
+    /// the mount comes back; the late answer of the stuck worker is still
+    /// delivered, and once the cool-down has passed, a probe gets through.
+    _backend->latency = 0;
+    QTRY_VERIFY_WITH_TIMEOUT(_fetcher->isReachable("/slow/a"), 1000);
+    QTRY_COMPARE_WITH_TIMEOUT(reachable.count(), 1, 1000);
+    QCOMPARE(reachable.first().at(0).toString(), QString("/slow"));
+
+    const auto result = fetch("/slow/b", 1000);
+
+    QCOMPARE(result.status, FileMetadata::Ok);
+    QVERIFY(_fetcher->isReachable("/slow/c"));
+}
+
+void TestMetadata::cache()
+{
+    auto cache = MetadataCache();
+
+    /// interning is stable, and the root is named after itself.
+    const auto root = cache.intern("/");
+    QVERIFY(root != 0);
+    QCOMPARE(cache.intern("/"), root);
+    QCOMPARE(cache.name(root), QString("/"));
+    QVERIFY(cache.entry(root) == nullptr);
+
+    /// a listing classifies its entries, without any metadata.
+    cache.insert({.path = "/", .entries = {{.name = "home", .isDir = true}, {.name = "vmlinuz", .isLink = true}}});
+
+    const auto home = cache.find("/home");
+    QVERIFY(home != 0);
+    QCOMPARE(cache.path(home), QString("/home"));
+    QCOMPARE(cache.name(home), QString("home"));
+    QVERIFY(cache.entry(home)->classified);
+    QVERIFY(cache.entry(home)->isDir);
+    QVERIFY(cache.entry(cache.find("/vmlinuz"))->isLink);
+    QVERIFY(cache.metadata(home) == nullptr);
+
+    /// a plain fetch keeps the entry count of an earlier one.
+    QCOMPARE(cache.update({.path = "/home", .size = 4096, .entryCount = 3, .status = FileMetadata::Ok}), home);
+    QCOMPARE(cache.update({.path = "/home", .size = 4096, .entryCount = -1, .status = FileMetadata::Ok}), home);
+    QCOMPARE(cache.metadata(home)->entryCount, qint64(3));
+    QVERIFY(cache.entry(home)->isDir);
+
+    /// an entry that wasn't listed is classified by its metadata.
+    const auto boot = cache.update({.path = "/boot", .status = FileMetadata::Ok, .isDir = true});
+    QVERIFY(cache.entry(boot)->classified);
+    QVERIFY(!cache.entry(boot)->listed);
+    QVERIFY(cache.entry(boot)->isDir);
+
+    /// a change drops the metadata, not the type.
+    cache.invalidate(home);
+    QVERIFY(cache.metadata(home) == nullptr);
+    QVERIFY(cache.entry(home)->classified);
+
+    /// a removed entry keeps its path, and the same id if it comes back.
+    const auto before    = cache.handle(home);
+    const auto inside    = cache.handle(cache.intern("/home/user"));
+    const auto alongside = cache.handle(cache.intern("/homework"));
+    QVERIFY(cache.isCurrent(before));
+
+    cache.remove(home);
+    QVERIFY(cache.entry(home) == nullptr);
+    QCOMPARE(cache.path(home), QString("/home"));
+    QCOMPARE(cache.intern("/home"), home);
+
+    /// but not the same generation; a handle made before is stale.
+    QVERIFY(!cache.isCurrent(before));
+    QVERIFY(cache.isCurrent(cache.handle(home)));
+    QCOMPARE(cache.handle(home).id, before.id);
+    QVERIFY(cache.handle(home) != before);
+    QVERIFY(!cache.isCurrent(NodeHandle()));
+
+    /// what was under it is gone too, and nothing else.
+    QVERIFY(!cache.isCurrent(inside));
+    QVERIFY(cache.isCurrent(alongside));
+
+    /// a range of rows goes at once, with what is under its folders.
+    cache.insert({.path = "/", .entries = {{.name = "opt", .isDir = true}, {.name = "srv", .isDir = true}, {.name = "initrd"}}});
+    const auto inOpt    = cache.handle(cache.intern("/opt/app"));
+    const auto inSrv    = cache.handle(cache.intern("/srv/www/index.html"));
+    const auto optional = cache.handle(cache.intern("/optional"));
+
+    cache.remove(QList<PathId>{cache.find("/opt"), cache.find("/srv"), cache.find("/initrd")});
+    QVERIFY(cache.entry(cache.find("/initrd")) == nullptr);
+    QVERIFY(!cache.isCurrent(inOpt));
+    QVERIFY(!cache.isCurrent(inSrv));
+    QVERIFY(cache.isCurrent(optional));
+    QVERIFY(cache.isCurrent(alongside));
+}
+
+void TestMetadata::cacheEviction()
+{
+    auto cache = MetadataCache();
+
+    cache.insert({.path = "/", .entries = {{.name = "home", .isDir = true}, {.name = "tmp", .isDir = true}}});
+    const auto home = cache.find("/home");
+    const auto tmp  = cache.find("/tmp");
+    const auto etc  = cache.intern("/etc");
+    QCOMPARE(cache.interned(), qsizetype(3));
+
+    /// what a node holds stays; metadata alone doesn't keep a path, it is
+    /// fetched again for the next node.
+    QCOMPARE(cache.update({.path = "/tmp", .status = FileMetadata::Ok}), tmp);
+    const auto stale = cache.handle(etc);
+
+    auto evicted = cache.evict({home});
+    std::ranges::sort(evicted);
+    QCOMPARE(evicted, (QList<PathId>{tmp, etc}));
+    QCOMPARE(cache.interned(), qsizetype(1));
+    QCOMPARE(cache.find("/home"), home);
+    QVERIFY(cache.entry(home)->classified);
+    QVERIFY(cache.metadata(tmp) == nullptr);
+    QCOMPARE(cache.find("/tmp"), PathId(0));
+    QCOMPARE(cache.find("/etc"), PathId(0));
+    QVERIFY(!cache.isCurrent(stale));
+
+    /// an evicted id is given to the next path, with a newer generation.
+    const auto usr = cache.intern("/usr");
+    QVERIFY(usr == tmp || usr == etc);
+    QCOMPARE(cache.path(usr), QString("/usr"));
+    QCOMPARE(cache.name(usr), QString("usr"));
+    QVERIFY(cache.isCurrent(cache.handle(usr)));
+    QVERIFY(cache.handle(usr).generation > 0);
+
+    /// a classified entry without a node is dropped; the model can tell.
+    QCOMPARE(cache.evict({usr}), QList<PathId>{home});
+    QVERIFY(cache.entry(home) == nullptr);
+    QCOMPARE(cache.size(), qsizetype(0));
+}
+
+/// requests path, and waits at most timeout milliseconds for its answer.
+FileMetadata TestMetadata::fetch(const QString& path, int timeout)
+{
+    const auto answered = [this, &path]
+    {
+        return std::ranges::find(_fetched, path, &FileMetadata::path) != _fetched.cend();
+    };
+
+    _fetcher->request(path);
+
+    if (!QTest::qWaitFor(answered, timeout)) {
+        return {.path = path};
+    }
+
+    return *std::ranges::find(_fetched, path, &FileMetadata::path);
+}
+
+QTEST_MAIN(TestMetadata)
@@ -0,0 +1,35 @@
+/// Copyright (C) 2025 Arlen Avakian
+/// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include "core/MetadataFetcher.hpp"
+
+#include <QObject>
+
+
+class SlowBackend;
+
+class TestMetadata final : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+
+    void fastMount();
+    void slowMountTimesOut();
+    void breakerStopsProbing();
+    void fastMountUnaffected();
+    void breakerRecovers();
+    void cache();
+    void cacheEviction();
+
+private:
+    [[nodiscard]] core::FileMetadata fetch(const QString& path, int timeout);
+
+    SlowBackend* _backend{nullptr};
+    core::MetadataFetcher* _fetcher{nullptr};
+    QList<core::FileMetadata> _fetched;
+};
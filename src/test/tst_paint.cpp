@@ -0,0 +1,91 @@
+/// Copyright (C) 2025 Arlen Avakian
+/// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "tst_paint.hpp"
+#include "core/FileSystemScene.hpp"
+#include "core/SceneStorage.hpp"
+#include "core/SessionManager.hpp"
+#include "db/db.hpp"
+
+#include <QDir>
+#include <QFile>
+#include <QImage>
+#include <QPainter>
+#include <QTest>
+
+
+using namespace core;
+
+namespace
+{
+    constexpr int FILE_COUNT = 20;
+    constexpr int DIR_COUNT  = 4;
+}
+
+void TestPaint::initTestCase()
+{
+    qApp->setProperty(db::DB_NAME, db::DB_CONFIG_TEST.databaseName);
+    qApp->setProperty(db::DB_CONNECTION_NAME, db::DB_CONFIG_TEST.connectionName);
+
+    if (auto dbFile = QFile(qApp->property(db::DB_NAME).toString()); dbFile.exists()) {
+        dbFile.remove();
+    }
+
+    QVERIFY(_root.isValid());
+
+    auto dir = QDir(_root.path());
+    for (int i = 0; i < DIR_COUNT; ++i) {
+        QVERIFY(dir.mkdir(QString("dir%1").arg(i)));
+    }
+    for (int i = 0; i < FILE_COUNT; ++i) {
+        auto file = QFile(dir.filePath(QString("file%1.txt").arg(i)));
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write(QByteArray(1 << (i % 16), 'x'));
+    }
+
+    _scene = SessionManager::scene();
+    _scene->setRootPath(_root.path());
+    SessionManager::ss()->loadScene(_scene);
+    _scene->openTo(_root.path());
+
+    /// wait for filesystem data to be fetched
+    QTest::qWait(100);
+    QVERIFY(_scene->items().size() > FILE_COUNT);
+}
+
+void TestPaint::cleanupTestCase()
+{
+    auto dbFile = QFile(qApp->property(db::DB_NAME).toString());
+
+    QVERIFY(dbFile.exists());
+    QVERIFY(dbFile.remove());
+}
+
+/// every item of the scene, zoomed out, at the scale of the scene, and
+/// zoomed in, where the items paint their details.  It uses only what the
+/// scene had before RenderContext, so the same file can be built against
+/// either side of it.
+void TestPaint::paintScene()
+{
+    QFETCH(qreal, scale);
+
+    const auto source = _scene->itemsBoundingRect();
+    auto image        = QImage((source.size() * scale).toSize(), QImage::Format_ARGB32_Premultiplied);
+
+    QBENCHMARK {
+        image.fill(Qt::transparent);
+        QPainter p(&image);
+        _scene->render(&p, QRectF(image.rect()), source);
+    }
+}
+
+void TestPaint::paintScene_data()
+{
+    QTest::addColumn<qreal>("scale");
+
+    QTest::newRow("0.25") << 0.25;
+    QTest::newRow("1")    << 1.0;
+    QTest::newRow("4")    << 4.0;
+}
+
+QTEST_MAIN(TestPaint)
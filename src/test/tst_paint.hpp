@@ -0,0 +1,31 @@
+/// Copyright (C) 2025 Arlen Avakian
+/// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <QObject>
+#include <QTemporaryDir>
+
+
+namespace core
+{
+    class FileSystemScene;
+}
+
+/// Benchmarks of painting; run with -tickcounter or -callgrind for numbers
+/// that can be compared across builds.
+class TestPaint final : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void paintScene();
+    void paintScene_data();
+
+private:
+    QTemporaryDir _root;
+    core::FileSystemScene* _scene{nullptr};
+};
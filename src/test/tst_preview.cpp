@@ -0,0 +1,134 @@
+/// Copyright (C) 2025 Arlen Avakian
+/// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "tst_preview.hpp"
+
+#include "core/Previewer.hpp"
+
+#include <QFile>
+#include <QSignalSpy>
+#include <QTest>
+
+#ifdef Q_OS_UNIX
+#include <sys/stat.h>
+#endif
+
+
+using core::Previewer;
+
+namespace
+{
+    bool write(const QString& path, const QByteArray& data)
+    {
+        auto file = QFile(path);
+        return file.open(QIODevice::WriteOnly) && file.write(data) == data.size();
+    }
+}
+
+void TestPreviewer::initTestCase()
+{
+    QVERIFY(_root.isValid());
+}
+
+void TestPreviewer::text()
+{
+    const auto path = _root.filePath("notes.txt");
+    QVERIFY(write(path, "first\r\n\tsecond\nthird\n"));
+
+    const auto preview = Previewer::make(path);
+
+    QVERIFY(!preview.binary);
+    QVERIFY(!preview.truncated);
+    QCOMPARE(preview.size, qint64(21));
+    QCOMPARE(preview.lines, QStringList({"first", "    second", "third"}));
+}
+
+void TestPreviewer::binary()
+{
+    const auto path = _root.filePath("data.bin");
+    QVERIFY(write(path, QByteArray("\x7f" "ELF\0\1\2\3", 8)));
+
+    const auto preview = Previewer::make(path);
+
+    QVERIFY(preview.binary);
+    QCOMPARE(preview.lines.size(), qsizetype(1));
+    QVERIFY(preview.lines.first().startsWith("00000000  7f 45 4c 46 00 01 02 03"));
+    QVERIFY(preview.lines.first().endsWith("|.ELF....|"));
+}
+
+/// a big file is looked at through the window only.
+void TestPreviewer::window()
+{
+    const auto path = _root.filePath("big.txt");
+    auto line = QByteArray(Previewer::MAX_COLUMNS * 2, 'x') + '\n';
+    QVERIFY(write(path, line.repeated(4096)));
+
+    const auto preview = Previewer::make(path);
+
+    QVERIFY(!preview.binary);
+    QVERIFY(preview.truncated);
+    QCOMPARE(preview.size, qint64(line.size()) * 4096);
+    QCOMPARE(preview.lines.size(), qsizetype(Previewer::MAX_LINES));
+    QCOMPARE(preview.lines.first().size(), qsizetype(Previewer::MAX_COLUMNS));
+}
+
+void TestPreviewer::empty()
+{
+    const auto path = _root.filePath("empty");
+    QVERIFY(write(path, {}));
+
+    const auto preview = Previewer::make(path);
+
+    QVERIFY(preview.error.isEmpty());
+    QVERIFY(preview.lines.empty());
+
+    QVERIFY(!Previewer::make(_root.filePath("missing")).error.isEmpty());
+}
+
+/// a FIFO nobody writes to would block open() for good.
+void TestPreviewer::notRegular()
+{
+#ifdef Q_OS_UNIX
+    const auto path = _root.filePath("fifo");
+    QCOMPARE(mkfifo(QFile::encodeName(path).constData(), 0600), 0);
+
+    const auto preview = Previewer::make(path);
+
+    QVERIFY(!preview.error.isEmpty());
+    QVERIFY(preview.lines.empty());
+
+    /// a link to a regular file is previewed as the file.
+    const auto target = _root.filePath("target.txt");
+    QVERIFY(write(target, "linked\n"));
+    QVERIFY(QFile::link(target, _root.filePath("link.txt")));
+    QCOMPARE(Previewer::make(_root.filePath("link.txt")).lines, QStringList("linked"));
+#else
+    QSKIP("FIFOs are a unix thing");
+#endif
+}
+
+void TestPreviewer::cached()
+{
+    const auto path = _root.filePath("cached.txt");
+    QVERIFY(write(path, "hello\n"));
+
+    auto previewer = Previewer();
+    QSignalSpy ready(&previewer, &Previewer::ready);
+
+    QVERIFY(previewer.preview(path) == nullptr);
+    QVERIFY(ready.wait(10000));
+    QCOMPARE(ready.first().at(0).toString(), path);
+
+    const auto* preview = previewer.preview(path);
+    QVERIFY(preview != nullptr);
+    QCOMPARE(preview->lines, QStringList("hello"));
+
+    /// cancelled before the worker is done: cached, but not announced.
+    previewer.invalidate(path);
+    QVERIFY(previewer.preview(path) == nullptr);
+    previewer.cancel();
+    QVERIFY(!ready.wait(500));
+    QCOMPARE(ready.size(), qsizetype(1));
+}
+
+QTEST_MAIN(TestPreviewer)
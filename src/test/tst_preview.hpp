@@ -0,0 +1,26 @@
+/// Copyright (C) 2025 Arlen Avakian
+/// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <QObject>
+#include <QTemporaryDir>
+
+
+class TestPreviewer final : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void text();
+    void binary();
+    void window();
+    void empty();
+    void notRegular();
+    void cached();
+
+private:
+    QTemporaryDir _root;
+};
@@ -0,0 +1,124 @@
+/// Copyright (C) 2025 Arlen Avakian
+/// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "tst_purge.hpp"
+
+#include "core/Purger.hpp"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSignalSpy>
+#include <QStandardPaths>
+#include <QTest>
+
+
+using core::Purger;
+
+namespace
+{
+    constexpr int FANOUT = 3;
+
+    void writeFile(const QString& path)
+    {
+        auto file = QFile(path);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        QCOMPARE(file.write("x"), qint64(1));
+    }
+
+    /// FANOUT subdirectories, each with a file and a hidden file, and a link
+    /// to the first of them.
+    void makeTree(const QString& path)
+    {
+        QVERIFY(QDir().mkpath(path));
+
+        for (int i = 0; i < FANOUT; ++i) {
+            const auto dir = QString("%1/dir%2").arg(path).arg(i);
+            QVERIFY(QDir().mkpath(dir));
+            writeFile(dir + "/a.txt");
+            writeFile(dir + "/.hidden");
+        }
+        QVERIFY(QFile::link(path + "/dir0", path + "/link"));
+    }
+
+    /// the tree, its subdirectories, their files and the link.
+    constexpr qint64 ENTRY_COUNT = 1 + FANOUT * 3 + 1;
+}
+
+/// the trash may be staged under the cache location; not the user's.
+void TestPurger::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+}
+
+void TestPurger::init()
+{
+    _root = new QTemporaryDir();
+    QVERIFY(_root->isValid());
+
+    makeTree(_root->filePath("tree"));
+
+    _purger = new Purger();
+}
+
+void TestPurger::cleanup()
+{
+    delete _purger;
+    delete _root;
+}
+
+void TestPurger::removeTree()
+{
+    QSignalSpy finished(_purger, &Purger::finished);
+    QSignalSpy failed(_purger, &Purger::failed);
+
+    const auto path = _root->filePath("tree");
+
+    QVERIFY(_purger->remove(path));
+
+    /// gone before the purge is done.
+    QVERIFY(!QFileInfo::exists(path));
+
+    QVERIFY(finished.wait(10000));
+    QVERIFY(!_purger->isRunning());
+    QVERIFY(failed.empty());
+    QCOMPARE(finished.first().at(0).toLongLong(), ENTRY_COUNT);
+    QCOMPARE(finished.first().at(1).toLongLong(), qint64(0));
+
+    /// nothing is left behind.
+    const auto left = QDir(_root->path()).entryList(QDir::AllEntries | QDir::NoDotAndDotDot | QDir::Hidden);
+    QVERIFY(left.empty());
+}
+
+void TestPurger::removeFile()
+{
+    QSignalSpy finished(_purger, &Purger::finished);
+
+    const auto link = _root->filePath("tree/link");
+    const auto file = _root->filePath("tree/dir1/a.txt");
+
+    QVERIFY(_purger->remove(link));
+    QVERIFY(_purger->remove(file));
+
+    QTRY_VERIFY_WITH_TIMEOUT(!_purger->isRunning(), 10000);
+
+    qint64 removed = 0;
+    for (const auto& args : finished) {
+        removed += args.at(0).toLongLong();
+    }
+    QCOMPARE(removed, qint64(2));
+
+    QVERIFY(!QFileInfo(link).isSymLink());
+    QVERIFY(!QFileInfo::exists(file));
+
+    /// not followed.
+    QVERIFY(QFileInfo::exists(_root->filePath("tree/dir0/a.txt")));
+}
+
+void TestPurger::missing()
+{
+    QVERIFY(!_purger->remove(_root->filePath("nothing")));
+    QVERIFY(!_purger->isRunning());
+}
+
+QTEST_MAIN(TestPurger)
@@ -0,0 +1,31 @@
+/// Copyright (C) 2025 Arlen Avakian
+/// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <QObject>
+#include <QTemporaryDir>
+
+
+namespace core
+{
+    class Purger;
+}
+
+class TestPurger final : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void init();
+    void cleanup();
+
+    void removeTree();
+    void removeFile();
+    void missing();
+
+private:
+    QTemporaryDir* _root{nullptr};
+    core::Purger* _purger{nullptr};
+};
@@ -0,0 +1,142 @@
+/// Copyright (C) 2025 Arlen Avakian
+/// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "tst_relax.hpp"
+
+#include "core/LayoutRelaxer.hpp"
+
+#include <QLineF>
+#include <QRandomGenerator>
+#include <QSignalSpy>
+#include <QTest>
+
+#include <cmath>
+
+
+using namespace core;
+
+namespace
+{
+    /// a pinned root with two large children on top of each other.
+    QList<LayoutBody> siblings()
+    {
+        return {
+            {.pos = {0, 0},    .radius = 50,  .parent = -1, .length = 0,   .pinned = true},
+            {.pos = {400, 0},  .radius = 150, .parent = 0,  .length = 400, .pinned = false},
+            {.pos = {400, 10}, .radius = 150, .parent = 0,  .length = 400, .pinned = false},
+        };
+    }
+
+    /// a random tree: the first bodies hang off the root, the rest off any
+    /// body before them, all at the same length.
+    QList<LayoutBody> randomTree(int count, qreal length)
+    {
+        auto* rng = QRandomGenerator::global();
+
+        QList<LayoutBody> bodies{{.pos = {0, 0}, .radius = 60, .parent = -1, .length = 0, .pinned = true}};
+
+        for (int i = 1; i < count; ++i) {
+            const auto parent = i < 10 ? 0 : static_cast<int>(rng->bounded(i));
+            const auto angle  = rng->bounded(2 * M_PI);
+            const auto pos    = bodies[parent].pos + QPointF(std::cos(angle), std::sin(angle)) * length;
+
+            bodies.push_back({.pos = pos, .radius = 40 + rng->bounded(100.0), .parent = parent, .length = length});
+        }
+
+        return bodies;
+    }
+
+    /// pairs that overlap, but for a body and its parent.
+    int overlaps(const QList<LayoutBody>& bodies, const QList<QPointF>& pos)
+    {
+        auto count = 0;
+
+        for (qsizetype i = 0; i < bodies.size(); ++i) {
+            for (qsizetype j = i + 1; j < bodies.size(); ++j) {
+                if (bodies[i].parent == j || bodies[j].parent == i) {
+                    continue;
+                }
+                if (QLineF(pos[i], pos[j]).length() < bodies[i].radius + bodies[j].radius) {
+                    ++count;
+                }
+            }
+        }
+
+        return count;
+    }
+}
+
+void TestRelax::siblingsSeparate()
+{
+    const auto bodies    = siblings();
+    const auto positions = LayoutRelaxer::solve(bodies);
+
+    QCOMPARE(positions.size(), bodies.size());
+    QVERIFY(QLineF(positions[1], positions[2]).length() >= bodies[1].radius + bodies[2].radius);
+}
+
+void TestRelax::pinnedStays()
+{
+    const auto bodies    = siblings();
+    const auto positions = LayoutRelaxer::solve(bodies);
+
+    QCOMPARE(positions[0], bodies[0].pos);
+}
+
+void TestRelax::lengthsKept()
+{
+    const auto bodies    = siblings();
+    const auto positions = LayoutRelaxer::solve(bodies);
+
+    for (qsizetype i = 1; i < bodies.size(); ++i) {
+        const auto length = QLineF(positions[0], positions[i]).length();
+        QVERIFY2(qAbs(length - bodies[i].length) < bodies[i].length * 0.1, qPrintable(QString::number(length)));
+    }
+}
+
+void TestRelax::manyBodies()
+{
+    const auto bodies = randomTree(500, 300);
+
+    auto before = QList<QPointF>();
+    for (const auto& body : bodies) {
+        before.push_back(body.pos);
+    }
+
+    const auto positions = LayoutRelaxer::solve(bodies);
+
+    QCOMPARE(positions.size(), bodies.size());
+    for (const auto& pos : positions) {
+        QVERIFY(std::isfinite(pos.x()) && std::isfinite(pos.y()));
+    }
+    QVERIFY(overlaps(bodies, positions) < overlaps(bodies, before) / 2);
+}
+
+void TestRelax::delivered()
+{
+    LayoutRelaxer relaxer;
+    QSignalSpy relaxed(&relaxer, &LayoutRelaxer::relaxed);
+
+    relaxer.relax(siblings());
+
+    QVERIFY(relaxed.wait(10000));
+    QCOMPARE(relaxed.count(), 1);
+    QCOMPARE(relaxed.first().at(0).value<QList<QPointF>>(), LayoutRelaxer::solve(siblings()));
+}
+
+/// only the last of several snapshots is delivered.
+void TestRelax::newerWins()
+{
+    LayoutRelaxer relaxer;
+    QSignalSpy relaxed(&relaxer, &LayoutRelaxer::relaxed);
+
+    relaxer.relax(randomTree(200, 300));
+    relaxer.relax(siblings());
+
+    QVERIFY(relaxed.wait(10000));
+    QTest::qWait(100);
+    QCOMPARE(relaxed.count(), 1);
+    QCOMPARE(relaxed.first().at(0).value<QList<QPointF>>().size(), siblings().size());
+}
+
+QTEST_MAIN(TestRelax)
@@ -0,0 +1,20 @@
+/// Copyright (C) 2025 Arlen Avakian
+/// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <QObject>
+
+
+class TestRelax final : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void siblingsSeparate();
+    void pinnedStays();
+    void lengthsKept();
+    void manyBodies();
+    void delivered();
+    void newerWins();
+};
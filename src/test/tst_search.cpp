@@ -0,0 +1,104 @@
+/// Copyright (C) 2025 Arlen Avakian
+/// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "tst_search.hpp"
+
+#include "core/SearchEngine.hpp"
+
+#include <QDir>
+#include <QFile>
+#include <QSignalSpy>
+#include <QTest>
+
+
+namespace
+{
+    constexpr int DEPTH  = 4;
+    constexpr int FANOUT = 4;
+
+    /// FANOUT subdirectories per level, each with a photo and a note.
+    void makeTree(const QString& path, int depth)
+    {
+        QVERIFY(QDir().mkpath(path));
+
+        for (const auto* name : {"Photo.JPG", "notes.txt", ".hidden.jpg"}) {
+            auto file = QFile(path + "/" + name);
+            QVERIFY(file.open(QIODevice::WriteOnly));
+        }
+
+        if (depth > 0) {
+            for (int i = 0; i < FANOUT; ++i) {
+                makeTree(QString("%1/dir%2").arg(path).arg(i), depth - 1);
+            }
+        }
+    }
+
+    /// 1 + 4 + 16 + 64 + 256
+    constexpr int DIR_COUNT = 341;
+}
+
+void TestSearch::initTestCase()
+{
+    QVERIFY(_root.isValid());
+    makeTree(_root.path(), DEPTH);
+}
+
+void TestSearch::search_data()
+{
+    QTest::addColumn<QString>("pattern");
+    QTest::addColumn<int>("hits");
+
+    QTest::newRow("substring")      << "photo"  << DIR_COUNT;
+    QTest::newRow("glob")           << "*.jpg"  << DIR_COUNT;
+    QTest::newRow("glob, anchored") << "*.jp"   << 0;
+    QTest::newRow("directories")    << "dir?"   << DIR_COUNT - 1;
+    QTest::newRow("no hits")        << "nothing" << 0;
+}
+
+void TestSearch::search()
+{
+    QFETCH(QString, pattern);
+    QFETCH(int, hits);
+
+    auto engine = core::SearchEngine();
+
+    QStringList found;
+    connect(&engine, &core::SearchEngine::found, this, [&found](const QStringList& paths) { found += paths; });
+
+    QSignalSpy finished(&engine, &core::SearchEngine::finished);
+    QSignalSpy progress(&engine, &core::SearchEngine::progress);
+
+    engine.start(_root.path(), pattern);
+
+    QVERIFY(finished.wait(10000));
+    QCOMPARE(finished.first().first().toBool(), false);
+    QVERIFY(!engine.isRunning());
+
+    QCOMPARE(found.size(), hits);
+    QCOMPARE(QSet(found.cbegin(), found.cend()).size(), hits);
+    QCOMPARE(progress.last().at(0).toLongLong(), hits);
+    QCOMPARE(progress.last().at(1).toLongLong(), DIR_COUNT);
+}
+
+void TestSearch::cancel()
+{
+    auto engine = core::SearchEngine();
+
+    QSignalSpy finished(&engine, &core::SearchEngine::finished);
+
+    engine.start(_root.path(), "*");
+    engine.cancel();
+
+    QVERIFY(finished.wait(10000));
+    QCOMPARE(finished.first().first().toBool(), true);
+    QVERIFY(!engine.isRunning());
+
+    /// a new search after a cancelled one.
+    finished.clear();
+    engine.start(_root.path(), "notes.txt");
+
+    QVERIFY(finished.wait(10000));
+    QCOMPARE(finished.first().first().toBool(), false);
+}
+
+QTEST_MAIN(TestSearch)
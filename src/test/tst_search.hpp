@@ -0,0 +1,23 @@
+/// Copyright (C) 2025 Arlen Avakian
+/// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <QObject>
+#include <QTemporaryDir>
+
+
+class TestSearch final : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void search_data();
+    void search();
+    void cancel();
+
+private:
+    QTemporaryDir _root;
+};
@@ -0,0 +1,280 @@
+/// Copyright (C) 2025 Arlen Avakian
+/// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "tst_sort.hpp"
+
+#include "core/SeekIndex.hpp"
+#include "core/SortProxyModel.hpp"
+#include "core/collation.hpp"
+
+#include <QAbstractListModel>
+#include <QFile>
+#include <QFileSystemModel>
+#include <QRandomGenerator>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+
+namespace
+{
+    /// a flat model whose rows have distinct, stable internal pointers, the
+    /// way the nodes of QFileSystemModel do; it counts how often the names
+    /// are read.
+    class NodeListModel final : public QAbstractListModel
+    {
+    public:
+        explicit NodeListModel(const QStringList& names)
+        {
+            for (const auto& name : names) {
+                _nodes.push_back(std::make_unique<QString>(name));
+            }
+        }
+
+        [[nodiscard]] QModelIndex index(int row, int column, const QModelIndex& parent = {}) const override
+        {
+            if (parent.isValid() || column != 0 || row < 0 || row >= rowCount()) {
+                return {};
+            }
+            return createIndex(row, column, _nodes[row].get());
+        }
+
+        [[nodiscard]] int rowCount(const QModelIndex& parent = {}) const override
+        {
+            return parent.isValid() ? 0 : static_cast<int>(_nodes.size());
+        }
+
+        [[nodiscard]] QVariant data(const QModelIndex& index, int role) const override
+        {
+            if (!index.isValid() || role != Qt::DisplayRole) {
+                return {};
+            }
+            ++reads;
+            return *_nodes[index.row()];
+        }
+
+        void append(const QString& name)
+        {
+            beginInsertRows({}, rowCount(), rowCount());
+            _nodes.push_back(std::make_unique<QString>(name));
+            endInsertRows();
+        }
+
+        void remove(int row)
+        {
+            beginRemoveRows({}, row, row);
+            _nodes.erase(_nodes.begin() + row);
+            endRemoveRows();
+        }
+
+        void rename(int row, const QString& name)
+        {
+            *_nodes[row] = name;
+            emit dataChanged(index(row, 0), index(row, 0));
+        }
+
+        [[nodiscard]] int rowOf(const QString& name) const
+        {
+            const auto found = std::ranges::find(_nodes, name, [](const auto& node) { return *node; });
+            return static_cast<int>(found - _nodes.cbegin());
+        }
+
+        mutable int reads{0};
+
+    private:
+        std::vector<std::unique_ptr<QString>> _nodes;
+    };
+}
+
+
+void TestSort::naturalOrder_data()
+{
+    QTest::addColumn<QString>("lhs");
+    QTest::addColumn<QString>("rhs");
+
+    QTest::newRow("numbers")        << "file2"      << "file10";
+    QTest::newRow("leading zeros")  << "file007"    << "file10";
+    QTest::newRow("case")           << "apple"      << "Banana";
+    QTest::newRow("prefix")         << "file"       << "file1";
+    QTest::newRow("prefix text")    << "abc"        << "abc.txt";
+    QTest::newRow("digits first")   << "1abc"       << "abc";
+    QTest::newRow("punctuation")    << "a-b"        << "a1";
+    QTest::newRow("second number")  << "v1.2"       << "v1.10";
+    QTest::newRow("long number")    << "n99999999999999999999" << "n100000000000000000000";
+    QTest::newRow("non-ascii")      << "éclair"     << "Émile";
+}
+
+void TestSort::naturalOrder()
+{
+    QFETCH(QString, lhs);
+    QFETCH(QString, rhs);
+
+    QVERIFY(core::collationKey(lhs) < core::collationKey(rhs));
+    QVERIFY(!(core::collationKey(rhs) < core::collationKey(lhs)));
+}
+
+void TestSort::distinctKeys()
+{
+    /// equal in the natural order, but still distinct and ordered.
+    for (const auto& [a, b] : {std::pair{"File", "file"}, std::pair{"a01", "a1"}}) {
+        const auto ka = core::collationKey(QString(a));
+        const auto kb = core::collationKey(QString(b));
+
+        QVERIFY(ka != kb);
+        QVERIFY(ka < kb || kb < ka);
+    }
+}
+
+void TestSort::parallelSort()
+{
+    auto* rng = QRandomGenerator::global();
+
+    QStringList names;
+    for (int i = 0; i < core::PARALLEL_SORT_THRESHOLD * 4 + 7; ++i) {
+        names.push_back(QString("%1-%2.txt")
+            .arg(QChar(u'a' + rng->bounded(26)))
+            .arg(rng->bounded(100000)));
+    }
+
+    const auto keys  = core::collationKeys(names);
+    const auto order = core::sortedOrder(keys);
+
+    QCOMPARE(order.size(), names.size());
+
+    for (qsizetype i = 0; i < names.size(); ++i) {
+        QCOMPARE(keys[i], core::collationKey(names[i]));
+    }
+
+    QVERIFY(std::ranges::is_sorted(order, {}, [&keys](qsizetype i) { return keys[i]; }));
+
+    auto seen = order;
+    std::ranges::sort(seen);
+    QVERIFY(std::ranges::adjacent_find(seen) == seen.end());
+}
+
+void TestSort::proxyModel()
+{
+    auto source = NodeListModel({"img10.png", "img2.png", "IMG1.png", "img100.png"});
+    auto proxy  = core::SortProxyModel();
+
+    proxy.setSourceModel(&source);
+    proxy.setDynamicSortFilter(true);
+    proxy.sort(0);
+
+    const auto names = [&proxy]
+    {
+        QStringList result;
+        for (int row = 0; row < proxy.rowCount(); ++row) {
+            result.push_back(proxy.index(row, 0).data().toString());
+        }
+        return result;
+    };
+
+    QCOMPARE(names(), QStringList({"IMG1.png", "img2.png", "img10.png", "img100.png"}));
+
+    /// sorting again compares the cached keys; no name is read.
+    auto reads = source.reads;
+    proxy.sort(0, Qt::DescendingOrder);
+    proxy.sort(0, Qt::AscendingOrder);
+    QCOMPARE(source.reads, reads);
+
+    /// inserted rows are sorted in, and only their own names are read.
+    source.append("img3.png");
+    QCOMPARE(names(), QStringList({"IMG1.png", "img2.png", "img3.png", "img10.png", "img100.png"}));
+
+    reads = source.reads;
+    source.append("img4.png");
+    QCOMPARE(source.reads - reads, 1);
+
+    /// a renamed row gets a new key, and moves.
+    source.rename(source.rowOf("img100.png"), "img0.png");
+    QCOMPARE(names(), QStringList({"img0.png", "IMG1.png", "img2.png", "img3.png", "img4.png", "img10.png"}));
+
+    source.remove(source.rowOf("img2.png"));
+    QCOMPARE(names(), QStringList({"img0.png", "IMG1.png", "img3.png", "img4.png", "img10.png"}));
+}
+
+/// the first match is the first one the view shows, not the first one in
+/// lexical order.
+void TestSort::seekInViewOrder()
+{
+    auto dir = QTemporaryDir();
+    QVERIFY(dir.isValid());
+
+    for (const auto* name : {"img10.png", "img2.png", "photo.png"}) {
+        auto file = QFile(dir.filePath(name));
+        QVERIFY(file.open(QIODevice::WriteOnly));
+    }
+
+    auto source = QFileSystemModel();
+    auto proxy  = core::SortProxyModel();
+
+    proxy.setSourceModel(&source);
+    proxy.sort(0);
+
+    const auto root = source.setRootPath(dir.path());
+    QTRY_COMPARE(source.rowCount(root), 3);
+
+    const auto parent = proxy.mapFromSource(root);
+    const auto nameAt = [&proxy, &parent](int row) { return proxy.index(row, 0, parent).data().toString(); };
+
+    QCOMPARE(nameAt(0), QString("img2.png"));
+    QCOMPARE(nameAt(1), QString("img10.png"));
+
+    const auto index = core::SeekIndex(parent);
+
+    QCOMPARE(index.find("IMG"), 0);
+    QCOMPARE(index.find("img1"), 1);
+    QCOMPARE(nameAt(index.find("p")), QString("photo.png"));
+    QCOMPARE(index.find("x"), -1);
+}
+
+/// the lookup agrees with going through the rows the view shows, for
+/// prefixes that match runs of names of every length.
+void TestSort::seekMatchesScan()
+{
+    auto dir = QTemporaryDir();
+    QVERIFY(dir.isValid());
+
+    constexpr int count = 40;
+    for (int i = 1; i <= count; ++i) {
+        auto file = QFile(dir.filePath(QString("img%1.png").arg(i)));
+        QVERIFY(file.open(QIODevice::WriteOnly));
+    }
+    for (const auto* name : {"a.txt", "Img_x.png", "imgb.png"}) {
+        auto file = QFile(dir.filePath(name));
+        QVERIFY(file.open(QIODevice::WriteOnly));
+    }
+
+    auto source = QFileSystemModel();
+    auto proxy  = core::SortProxyModel();
+
+    proxy.setSourceModel(&source);
+    proxy.sort(0);
+
+    const auto root = source.setRootPath(dir.path());
+    QTRY_COMPARE(source.rowCount(root), count + 3);
+
+    const auto parent = proxy.mapFromSource(root);
+    const auto rows   = proxy.rowCount(parent);
+    const auto index  = core::SeekIndex(parent);
+
+    const auto scan = [&](const QString& prefix)
+    {
+        for (int row = 0; row < rows; ++row) {
+            if (proxy.index(row, 0, parent).data().toString().startsWith(prefix, Qt::CaseInsensitive)) {
+                return row;
+            }
+        }
+        return -1;
+    };
+
+    for (const auto* prefix : {"", "i", "img", "IMG1", "img2", "img3", "img4", "img_", "imgb", "a", "b"}) {
+        QCOMPARE(index.find(prefix), scan(prefix));
+    }
+}
+
+QTEST_MAIN(TestSort)
@@ -0,0 +1,21 @@
+/// Copyright (C) 2025 Arlen Avakian
+/// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <QObject>
+
+
+class TestSort final : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void naturalOrder_data();
+    void naturalOrder();
+    void distinctKeys();
+    void parallelSort();
+    void proxyModel();
+    void seekInViewOrder();
+    void seekMatchesScan();
+};
@@ -2,6 +2,7 @@
 /// SPDX-License-Identifier: GPL-3.0-or-later
 
 #include "tst_theme.hpp"
+#include "core/RenderContext.hpp"
 #include "core/SessionManager.hpp"
 #include "db/db.hpp"
 #include "gui/theme/ThemeSettings.hpp"
@@ -193,6 +194,23 @@ void TestTheme::generateRangedPalette_data()
     QTest::newRow("wrap: (0.6,0.4)") << 0.6 << 0.4;
 }
 
+/// the render context follows the active palette.
+void TestTheme::renderContext()
+{
+    auto* tm = SessionManager::tm();
+
+    const auto before = tm->edgeColor();
+    auto palette      = ThemeManager::factory();
+    palette[EDGE_COLOR] = before == Qt::red ? QColor(Qt::green) : QColor(Qt::red);
+
+    tm->setActivePalette(palette);
+    QCOMPARE(SessionManager::rc().edge.color(), palette[EDGE_COLOR]);
+    QCOMPARE(SessionManager::rc().edge.widthF(), 4.0);
+
+    tm->setActivePalette(ThemeManager::factory());
+    QCOMPARE(SessionManager::rc().edge.color(), tm->edgeColor());
+}
+
 void TestTheme::generateRandomPalettes(int N)
 {
     QTest::addColumn<PaletteId>("id");
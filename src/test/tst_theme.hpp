@@ -34,6 +34,8 @@ private slots:
     void generateRangedPalette();
     void generateRangedPalette_data();
 
+    void renderContext();
+
 private:
     void generateRandomPalettes(int N);
 
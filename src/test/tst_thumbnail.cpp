@@ -0,0 +1,131 @@
+/// Copyright (C) 2025 Arlen Avakian
+/// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "tst_thumbnail.hpp"
+
+#include "core/Thumbnailer.hpp"
+
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QImage>
+#include <QImageReader>
+#include <QSignalSpy>
+#include <QTest>
+#include <QUrl>
+
+
+using core::Thumbnailer;
+
+namespace
+{
+    QImage makeImage(int width, int height, QColor color)
+    {
+        auto image = QImage(width, height, QImage::Format_RGB32);
+        image.fill(color);
+
+        return image;
+    }
+}
+
+void TestThumbnailer::initTestCase()
+{
+    QVERIFY(_root.isValid());
+    QVERIFY(_cache.isValid());
+
+    /// keeps the thumbnails of the test out of the user's cache.
+    qputenv("XDG_CACHE_HOME", QFile::encodeName(_cache.path()));
+
+    _image = _root.filePath("wide.png");
+    QVERIFY(makeImage(400, 200, Qt::red).save(_image));
+}
+
+void TestThumbnailer::decodeAndCache()
+{
+    auto thumbnailer = Thumbnailer();
+    QSignalSpy ready(&thumbnailer, &Thumbnailer::ready);
+
+    QVERIFY(thumbnailer.canThumbnail(_image));
+    QVERIFY(!thumbnailer.canThumbnail(_root.filePath("notes.txt")));
+
+    QVERIFY(thumbnailer.thumbnail(_image) == nullptr);
+    QVERIFY(ready.wait(10000));
+    QCOMPARE(ready.first().at(0).toStringList(), QStringList(_image));
+
+    const auto* pixmap = thumbnailer.thumbnail(_image);
+    QVERIFY(pixmap != nullptr);
+    QCOMPARE(pixmap->size(), QSize(Thumbnailer::SIZE, Thumbnailer::SIZE / 2));
+
+    const auto cached = Thumbnailer::cacheFilePath(_image);
+    QVERIFY(cached.startsWith(_cache.path() + "/thumbnails/normal/"));
+
+    auto reader = QImageReader(cached);
+    QCOMPARE(reader.text("Thumb::URI"), QUrl::fromLocalFile(_image).toString(QUrl::FullyEncoded));
+    QCOMPARE(reader.text("Thumb::MTime"), QString::number(QFileInfo(_image).lastModified().toSecsSinceEpoch()));
+    QCOMPARE(QFileInfo(cached).permissions() & (QFileDevice::ReadOther | QFileDevice::ReadGroup), QFileDevice::Permissions());
+}
+
+/// a current thumbnail in the cache is used as it is.
+void TestThumbnailer::fromDiskCache()
+{
+    const auto cached = Thumbnailer::cacheFilePath(_image);
+
+    auto marker = makeImage(10, 10, Qt::blue);
+    marker.setText("Thumb::URI", QUrl::fromLocalFile(_image).toString(QUrl::FullyEncoded));
+    marker.setText("Thumb::MTime", QString::number(QFileInfo(_image).lastModified().toSecsSinceEpoch()));
+    QVERIFY(marker.save(cached, "png"));
+
+    auto thumbnailer = Thumbnailer();
+    QSignalSpy ready(&thumbnailer, &Thumbnailer::ready);
+
+    QVERIFY(thumbnailer.thumbnail(_image) == nullptr);
+    QVERIFY(ready.wait(10000));
+    QCOMPARE(thumbnailer.thumbnail(_image)->size(), QSize(10, 10));
+}
+
+void TestThumbnailer::broken()
+{
+    const auto path = _root.filePath("broken.png");
+    {
+        auto file = QFile(path);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write("not a png");
+    }
+
+    auto thumbnailer = Thumbnailer();
+    QSignalSpy ready(&thumbnailer, &Thumbnailer::ready);
+
+    QVERIFY(thumbnailer.thumbnail(path) == nullptr);
+    QVERIFY(ready.wait(10000));
+
+    /// not asked again.
+    QVERIFY(thumbnailer.thumbnail(path) == nullptr);
+    QVERIFY(!ready.wait(200));
+
+    QVERIFY(!QFileInfo::exists(Thumbnailer::cacheFilePath(path)));
+    QVERIFY(QFileInfo::exists(QString(Thumbnailer::cacheFilePath(path)).replace("/normal/", "/fail/surkl/")));
+}
+
+void TestThumbnailer::invalidate()
+{
+    const auto path = _root.filePath("changing.png");
+    QVERIFY(makeImage(300, 300, Qt::green).save(path));
+
+    auto thumbnailer = Thumbnailer();
+    QSignalSpy ready(&thumbnailer, &Thumbnailer::ready);
+
+    QVERIFY(thumbnailer.thumbnail(path) == nullptr);
+    QVERIFY(ready.wait(10000));
+    QCOMPARE(thumbnailer.thumbnail(path)->size(), QSize(Thumbnailer::SIZE, Thumbnailer::SIZE));
+
+    /// a second later, so that the mtime differs.
+    QTest::qWait(1100);
+    QVERIFY(makeImage(50, 100, Qt::green).save(path));
+
+    thumbnailer.invalidate(path);
+    QVERIFY(thumbnailer.thumbnail(path) == nullptr);
+    QVERIFY(ready.wait(10000));
+    QCOMPARE(thumbnailer.thumbnail(path)->size(), QSize(50, 100));
+}
+
+QTEST_MAIN(TestThumbnailer)
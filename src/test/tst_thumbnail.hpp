@@ -0,0 +1,26 @@
+/// Copyright (C) 2025 Arlen Avakian
+/// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <QObject>
+#include <QTemporaryDir>
+
+
+class TestThumbnailer final : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void decodeAndCache();
+    void fromDiskCache();
+    void broken();
+    void invalidate();
+
+private:
+    QTemporaryDir _root;
+    QTemporaryDir _cache;
+    QString _image;
+};
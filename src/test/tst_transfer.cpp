@@ -0,0 +1,184 @@
+/// Copyright (C) 2025 Arlen Avakian
+/// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "tst_transfer.hpp"
+
+#include "core/TransferEngine.hpp"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSignalSpy>
+#include <QTest>
+
+
+using core::TransferEngine;
+
+namespace
+{
+    constexpr int FANOUT       = 3;
+    constexpr qint64 FILE_SIZE = 1000;
+
+    void writeFile(const QString& path, qint64 size)
+    {
+        auto file = QFile(path);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        QCOMPARE(file.write(QByteArray(size, 'x')), size);
+    }
+
+    /// a file, a hidden file and a link in the top directory, and FANOUT
+    /// subdirectories with a file each.
+    void makeTree(const QString& path)
+    {
+        QVERIFY(QDir().mkpath(path));
+
+        writeFile(path + "/a.bin", FILE_SIZE);
+        writeFile(path + "/.hidden", FILE_SIZE);
+        QVERIFY(QFile::link("a.bin", path + "/link"));
+
+        for (int i = 0; i < FANOUT; ++i) {
+            const auto dir = QString("%1/dir%2").arg(path).arg(i);
+            QVERIFY(QDir().mkpath(dir));
+            writeFile(dir + "/b.bin", FILE_SIZE);
+        }
+    }
+
+    /// files and links
+    constexpr qint64 FILE_COUNT = 3 + FANOUT;
+    constexpr qint64 TOTAL_SIZE = (2 + FANOUT) * FILE_SIZE;
+
+    void verifyTree(const QString& path)
+    {
+        QCOMPARE(QFileInfo(path + "/a.bin").size(), FILE_SIZE);
+        QCOMPARE(QFileInfo(path + "/.hidden").size(), FILE_SIZE);
+        QVERIFY(QFileInfo(path + "/link").isSymLink());
+        QCOMPARE(QFileInfo(path + "/link").symLinkTarget(), QFileInfo(path + "/a.bin").absoluteFilePath());
+
+        for (int i = 0; i < FANOUT; ++i) {
+            QCOMPARE(QFileInfo(QString("%1/dir%2/b.bin").arg(path).arg(i)).size(), FILE_SIZE);
+        }
+    }
+}
+
+void TestTransfer::init()
+{
+    _root = new QTemporaryDir();
+    QVERIFY(_root->isValid());
+
+    makeTree(_root->filePath("src/tree"));
+    QVERIFY(QDir().mkpath(_root->filePath("dst")));
+
+    _engine = new TransferEngine();
+}
+
+void TestTransfer::cleanup()
+{
+    delete _engine;
+    delete _root;
+}
+
+void TestTransfer::copyTree()
+{
+    QSignalSpy finished(_engine, &TransferEngine::finished);
+    QSignalSpy progress(_engine, &TransferEngine::progress);
+    QSignalSpy failed(_engine, &TransferEngine::failed);
+
+    _engine->start({_root->filePath("src/tree")}, _root->filePath("dst"), TransferEngine::Copy);
+    QVERIFY(_engine->isRunning());
+
+    QVERIFY(finished.wait(10000));
+    QVERIFY(!_engine->isRunning());
+    QVERIFY(failed.empty());
+
+    const auto args = finished.first();
+    QCOMPARE(args.at(0).toInt(), int(TransferEngine::Copy));
+    QCOMPARE(args.at(1).toLongLong(), qint64(1));
+    QCOMPARE(args.at(2).toLongLong(), qint64(0));
+    QCOMPARE(args.at(3).toBool(), false);
+
+    const auto last = progress.last();
+    QCOMPARE(last.at(0).toLongLong(), TOTAL_SIZE);
+    QCOMPARE(last.at(1).toLongLong(), TOTAL_SIZE);
+    QCOMPARE(last.at(2).toLongLong(), FILE_COUNT);
+    QCOMPARE(last.at(3).toLongLong(), FILE_COUNT);
+
+    verifyTree(_root->filePath("dst/tree"));
+    verifyTree(_root->filePath("src/tree"));
+}
+
+void TestTransfer::moveTree()
+{
+    QSignalSpy finished(_engine, &TransferEngine::finished);
+
+    _engine->start({_root->filePath("src/tree")}, _root->filePath("dst"), TransferEngine::Move);
+
+    QVERIFY(finished.wait(10000));
+    QCOMPARE(finished.first().at(1).toLongLong(), qint64(1));
+    QCOMPARE(finished.first().at(2).toLongLong(), qint64(0));
+
+    verifyTree(_root->filePath("dst/tree"));
+    QVERIFY(!QFileInfo::exists(_root->filePath("src/tree")));
+}
+
+void TestTransfer::linkFile()
+{
+    QSignalSpy finished(_engine, &TransferEngine::finished);
+
+    const auto source = _root->filePath("src/tree/a.bin");
+    _engine->start({source}, _root->filePath("dst"), TransferEngine::Link);
+
+    QVERIFY(finished.wait(10000));
+    QCOMPARE(finished.first().at(1).toLongLong(), qint64(1));
+
+    const auto link = QFileInfo(_root->filePath("dst/a.bin"));
+    QVERIFY(link.isSymLink());
+    QCOMPARE(link.symLinkTarget(), source);
+}
+
+void TestTransfer::existingTargetFails()
+{
+    QSignalSpy finished(_engine, &TransferEngine::finished);
+    QSignalSpy failed(_engine, &TransferEngine::failed);
+
+    writeFile(_root->filePath("dst/a.bin"), 1);
+
+    _engine->start({_root->filePath("src/tree/a.bin"), _root->filePath("src/tree/dir0")},
+        _root->filePath("dst"), TransferEngine::Move);
+
+    QVERIFY(finished.wait(10000));
+    QCOMPARE(finished.first().at(1).toLongLong(), qint64(1));
+    QCOMPARE(finished.first().at(2).toLongLong(), qint64(1));
+    QCOMPARE(failed.size(), 1);
+
+    /// neither overwritten nor removed.
+    QCOMPARE(QFileInfo(_root->filePath("dst/a.bin")).size(), qint64(1));
+    QCOMPARE(QFileInfo(_root->filePath("src/tree/a.bin")).size(), FILE_SIZE);
+    QVERIFY(QFileInfo::exists(_root->filePath("dst/dir0/b.bin")));
+}
+
+void TestTransfer::intoItselfFails()
+{
+    QSignalSpy finished(_engine, &TransferEngine::finished);
+
+    _engine->start({_root->filePath("src/tree")}, _root->filePath("src/tree/dir1"), TransferEngine::Copy);
+
+    QVERIFY(finished.wait(10000));
+    QCOMPARE(finished.first().at(1).toLongLong(), qint64(0));
+    QCOMPARE(finished.first().at(2).toLongLong(), qint64(1));
+    QVERIFY(!QFileInfo::exists(_root->filePath("src/tree/dir1/tree")));
+}
+
+void TestTransfer::queued()
+{
+    QSignalSpy finished(_engine, &TransferEngine::finished);
+
+    _engine->start({_root->filePath("src/tree")}, _root->filePath("dst"), TransferEngine::Copy);
+    _engine->start({_root->filePath("dst/tree")}, _root->filePath("src/tree/dir2"), TransferEngine::Copy);
+
+    QTRY_COMPARE_WITH_TIMEOUT(finished.size(), 2, 10000);
+    QCOMPARE(finished.at(1).at(2).toLongLong(), qint64(0));
+
+    verifyTree(_root->filePath("src/tree/dir2/tree"));
+}
+
+QTEST_MAIN(TestTransfer)
@@ -0,0 +1,33 @@
+/// Copyright (C) 2025 Arlen Avakian
+/// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <QObject>
+#include <QTemporaryDir>
+
+
+namespace core
+{
+    class TransferEngine;
+}
+
+class TestTransfer final : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+
+    void copyTree();
+    void moveTree();
+    void linkFile();
+    void existingTargetFails();
+    void intoItselfFails();
+    void queued();
+
+private:
+    QTemporaryDir* _root{nullptr};
+    core::TransferEngine* _engine{nullptr};
+};